@@ -14,7 +14,10 @@
 #include <time.h>
 #include <unistd.h>
 
+#include "net.h"
+
 #define PORT 8080
+#define LOCAL_SOCKET_FORMAT "@battleship.%d" // 서버 network.h와 같은 이름 (게임 포트별)
 #define GRID_SIZE 10
 #define SHIP_NUM 5
 #define MAX_BUFFER 1024
@@ -79,6 +82,7 @@ void ai_attack(char board[GRID_SIZE][GRID_SIZE], Ship ships[], int difficulty);
 
 void start_singleplayer();
 void start_multiplayer();
+void start_spectator();
 
 void clear_input_buffer();
 void handle_winch(int sig);
@@ -88,6 +92,7 @@ void write_log(const char *format, ...);
 
 void initGrid(Cell grid[GRID_SIZE][GRID_SIZE]);
 ssize_t readLine(int sockfd, char *buffer, size_t maxlen);
+void restoreGrids(const char *line, Cell own_grid[GRID_SIZE][GRID_SIZE], Cell opponent_grid[GRID_SIZE][GRID_SIZE]);
 void displayGrids(Cell own_grid[GRID_SIZE][GRID_SIZE], Cell opponent_grid[GRID_SIZE][GRID_SIZE], Cursor cursor, bool your_turn, bool attack_phase);
 void placeShipsMultiplayer(Cell own_grid[GRID_SIZE][GRID_SIZE], Ship ships[SHIP_NUM]);
 void sendGridToServer(Cell own_grid[GRID_SIZE][GRID_SIZE]);
@@ -648,6 +653,49 @@ ssize_t readLine(int sockfd, char *buffer, size_t maxlen) {
     return n;
 }
 
+// 서버 셀 문자('~', 'S', 'X', 'O', '#')를 클라이언트 셀로 변환
+static void restoreCell(Cell *cell, char c) {
+    cell->aShip = 0;
+    cell->aState = UNSHOT;
+    switch (c) {
+    case 'S':
+        cell->aShip = 1;
+        break;
+    case 'X':
+        cell->aState = HIT;
+        break;
+    case 'O':
+        cell->aState = MISS;
+        break;
+    case '#':
+        cell->aState = SUNK;
+        break;
+    default:
+        break;
+    }
+}
+
+// 서버 재시작 후 복구된 판 적용: "RESTORE <내 그리드 100칸> <상대 그리드 100칸>"
+// 이번에 배치한 배 대신 이전 게임의 배치와 공격 결과로 덮어쓴다
+void restoreGrids(const char *line, Cell own_grid[GRID_SIZE][GRID_SIZE], Cell opponent_grid[GRID_SIZE][GRID_SIZE]) {
+    const char *own = line + strlen("RESTORE ");
+    if (strlen(own) < GRID_SIZE * GRID_SIZE * 2 + 1) {
+        write_log("Malformed RESTORE line: %s", line);
+        return;
+    }
+    const char *opponent = own + GRID_SIZE * GRID_SIZE + 1;
+    for (int i = 0; i < GRID_SIZE; i++) {
+        for (int j = 0; j < GRID_SIZE; j++) {
+            restoreCell(&own_grid[i][j], own[i * GRID_SIZE + j]);
+            restoreCell(&opponent_grid[i][j], opponent[i * GRID_SIZE + j]);
+            // 공격 받은 내 배 칸도 배로 표시
+            if (own_grid[i][j].aState == HIT || own_grid[i][j].aState == SUNK) {
+                own_grid[i][j].aShip = 1;
+            }
+        }
+    }
+}
+
 void displayGrids(Cell own_grid[GRID_SIZE][GRID_SIZE], Cell opponent_grid[GRID_SIZE][GRID_SIZE], Cursor cursor, bool your_turn, bool attack_phase) {
     clear();
 
@@ -933,7 +981,11 @@ void inputLoopMultiplayer(Cell own_grid[GRID_SIZE][GRID_SIZE], Cell opponent_gri
             if (ret > 0) {
                 write_log("Received from server: %s", buf_read);
 
-                if (strcmp(buf_read, "YOUR_TURN\n") == 0) {
+                if (strncmp(buf_read, "RESTORE ", 8) == 0) {
+                    restoreGrids(buf_read, own_grid, opponent_grid);
+                    displayGrids(own_grid, opponent_grid, cursor, your_turn, attack_phase);
+                    mvprintw(LINES - 3, 0, "서버가 재시작되어 이전 게임을 이어서 진행합니다.");
+                } else if (strcmp(buf_read, "YOUR_TURN\n") == 0) {
                     your_turn = true;
                     mvprintw(LINES - 3, 0, "당신의 턴.");
                 } else if (strcmp(buf_read, "OPPONENT_TURN\n") == 0) {
@@ -1123,27 +1175,12 @@ void start_multiplayer() {
     scanw("%d", &server_port);
     noecho();
 
-    if ((sock_fd = socket(AF_INET, SOCK_STREAM, 0)) == -1) {
-        endwin();
-        fprintf(stderr, "소켓 생성 오류: %s\n", strerror(errno));
-        exit(EXIT_FAILURE);
-    }
-
-    struct sockaddr_in server_addr;
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_port = htons(server_port);
-
-    if (inet_pton(AF_INET, server_ip, &server_addr.sin_addr) <= 0) {
-        endwin();
-        fprintf(stderr, "유효하지 않은 주소/ 지원되지 않는 주소입니다.\n");
-        close(sock_fd);
-        exit(EXIT_FAILURE);
-    }
-
-    if (connect(sock_fd, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0) {
+    // 같은 컴퓨터의 서버면 Unix 소켓으로, 아니면 TCP로 연결
+    char local_name[32];
+    snprintf(local_name, sizeof(local_name), LOCAL_SOCKET_FORMAT, server_port);
+    if ((sock_fd = net_connect_local(local_name, server_ip, server_port)) < 0) {
         endwin();
         fprintf(stderr, "연결 실패: %s\n", strerror(errno));
-        close(sock_fd);
         exit(EXIT_FAILURE);
     }
 
@@ -1179,6 +1216,140 @@ void start_multiplayer() {
     }
 }
 
+// 관전 화면: 두 플레이어의 그리드를 공격 결과만으로 표시 (배 위치는 서버가 보내지 않음)
+static void displaySpectatorGrids(char grids[2][GRID_SIZE][GRID_SIZE], int turn, const char *status) {
+    clear();
+    int grid_width = GRID_SIZE * 2 + 3;
+    int left_x = (COLS - (grid_width * 2 + 10)) / 2;
+    if (left_x < 0)
+        left_x = 0;
+
+    for (int g = 0; g < 2; g++) {
+        int x = left_x + g * (grid_width + 10);
+        mvprintw(1, x, "플레이어 %d의 그리드%s", g + 1, turn == g + 1 ? " (공격 받는 중)" : "");
+        mvprintw(2, x, "  ");
+        for (int j = 0; j < GRID_SIZE; j++)
+            printw(" %d", j + 1);
+        for (int i = 0; i < GRID_SIZE; i++) {
+            mvprintw(3 + i, x, "%d ", i + 1);
+            for (int j = 0; j < GRID_SIZE; j++) {
+                char c = grids[g][i][j];
+                int pair = c == 'X' ? 2 : c == 'O' ? 3 : c == '#' ? 4 : 5;
+                attron(COLOR_PAIR(pair));
+                mvprintw(3 + i, x + 3 + j * 2, "%c", c);
+                attroff(COLOR_PAIR(pair));
+            }
+        }
+    }
+    mvprintw(GRID_SIZE + 5, left_x, "%s", status);
+    mvprintw(GRID_SIZE + 7, left_x, "q: 관전 종료");
+    refresh();
+}
+
+// 관전자 연결: 접속하면 SNAPSHOT을 받고 이후 TURN / DELTA / GAMEOVER로 갱신
+void start_spectator() {
+    clear();
+    start_color();
+    init_pair(2, COLOR_RED, COLOR_BLACK);     // Hit
+    init_pair(3, COLOR_YELLOW, COLOR_BLACK);  // Miss
+    init_pair(4, COLOR_MAGENTA, COLOR_BLACK); // Sunk
+    init_pair(5, COLOR_CYAN, COLOR_BLACK);    // Water
+
+    int mid_y = LINES / 2 - 4;
+    int mid_x = (COLS - strlen("서버 IP를 입력하세요:")) / 2;
+    char server_ip[100];
+    int server_port;
+
+    mvprintw(mid_y, mid_x, "서버 IP를 입력하세요: ");
+    echo();
+    scanw("%99s", server_ip);
+    mvprintw(mid_y + 2, mid_x, "관전 포트를 입력하세요 (게임 포트 + 1): ");
+    scanw("%d", &server_port);
+    noecho();
+
+    int fd = net_connect_tcp(server_ip, server_port);
+    if (fd < 0) {
+        mvprintw(mid_y + 4, mid_x, "관전 서버에 연결하지 못했습니다: %s", strerror(errno));
+        refresh();
+        sleep(2);
+        return;
+    }
+    write_log("Spectating %s:%d\n", server_ip, server_port);
+
+    char grids[2][GRID_SIZE][GRID_SIZE];
+    memset(grids, '~', sizeof(grids));
+    int turn = 0;
+    char status[128] = "게임 시작을 기다리는 중...";
+    char line[512];
+    bool running = true;
+
+    nodelay(stdscr, TRUE);
+    displaySpectatorGrids(grids, turn, status);
+    while (running) {
+        fd_set read_fds;
+        FD_ZERO(&read_fds);
+        FD_SET(fd, &read_fds);
+        FD_SET(STDIN_FILENO, &read_fds);
+        struct timeval tv = {0, 100000};
+        if (select(fd + 1, &read_fds, NULL, NULL, &tv) < 0 && errno != EINTR)
+            break;
+
+        if (FD_ISSET(STDIN_FILENO, &read_fds)) {
+            int ch = getch();
+            if (ch == 'q' || ch == 'Q')
+                running = false;
+        }
+        if (!FD_ISSET(fd, &read_fds))
+            continue;
+
+        if (readLine(fd, line, sizeof(line)) <= 0) {
+            snprintf(status, sizeof(status), "서버가 연결을 끊었습니다.");
+            running = false;
+        } else if (strncmp(line, "SNAPSHOT ", 9) == 0) {
+            char *p = line + 9;
+            turn = (int)strtol(p, &p, 10);
+            for (int g = 0; g < 2; g++) {
+                p++;
+                if (strlen(p) < GRID_SIZE * GRID_SIZE)
+                    break;
+                memcpy(grids[g], p, GRID_SIZE * GRID_SIZE);
+                p += GRID_SIZE * GRID_SIZE;
+            }
+            snprintf(status, sizeof(status), "관전 중: 플레이어 %d 차례", turn);
+        } else if (strncmp(line, "TURN ", 5) == 0) {
+            turn = atoi(line + 5);
+            snprintf(status, sizeof(status), "관전 중: 플레이어 %d 차례", turn);
+        } else if (strncmp(line, "DELTA ", 6) == 0) {
+            // 플레이어 N이 쏘면 상대(3 - N)의 그리드가 바뀜
+            int shooter, changed, used;
+            char result[16];
+            if (sscanf(line + 6, "%d %15s %d%n", &shooter, result, &changed, &used) == 3 && (shooter == 1 || shooter == 2)) {
+                char *p = line + 6 + used;
+                for (int k = 0; k < changed; k++) {
+                    int i, j, n;
+                    char c;
+                    if (sscanf(p, " %d %d %c%n", &i, &j, &c, &n) != 3)
+                        break;
+                    if (i >= 0 && i < GRID_SIZE && j >= 0 && j < GRID_SIZE)
+                        grids[2 - shooter][i][j] = c;
+                    p += n;
+                }
+                snprintf(status, sizeof(status), "플레이어 %d 공격: %s", shooter, result);
+            }
+        } else if (strncmp(line, "GAMEOVER ", 9) == 0) {
+            snprintf(status, sizeof(status), "게임 종료: 플레이어 %d 승리! 다음 게임을 기다리는 중...", atoi(line + 9));
+            turn = 0;
+        }
+        displaySpectatorGrids(grids, turn, status);
+    }
+
+    nodelay(stdscr, FALSE);
+    displaySpectatorGrids(grids, turn, status);
+    sleep(1);
+    close(fd);
+    write_log("Spectator session ended.\n");
+}
+
 int main(int argc, char **argv) {
 
     // 한국어 로케일
@@ -1297,7 +1468,8 @@ int main(int argc, char **argv) {
         mvprintw(box_start_y + 3, box_start_x + 2, "모드 선택");
         mvprintw(box_start_y + 5, box_start_x + 2, "1. 싱글 플레이어");
         mvprintw(box_start_y + 6, box_start_x + 2, "2. 멀티게임- 배틀넷");
-        mvprintw(box_start_y + 7, box_start_x + 2, "3. 종료");
+        mvprintw(box_start_y + 7, box_start_x + 2, "3. 관전하기");
+        mvprintw(box_start_y + 8, box_start_x + 2, "4. 종료");
         mvprintw(box_start_y + 9, box_start_x + 2, "선택: ");
         refresh();
 
@@ -1310,6 +1482,8 @@ int main(int argc, char **argv) {
         } else if (choice == 2) {
             start_multiplayer();
         } else if (choice == 3) {
+            start_spectator();
+        } else if (choice == 4) {
             break;
         } else {
             mvprintw(box_start_y + 11, box_start_x + 2, "잘못된 선택입니다. 다시 시도하세요.");
@@ -2,6 +2,8 @@
 #define GAME_LOGIC_H
 
 #include "grid.h"
+#include "movelog.h"
+#include "net.h"
 #include "ship.h"
 #include "tuple.h"
 #include <netinet/in.h>
@@ -9,14 +11,40 @@
 #include <string.h>
 #include <unistd.h>
 
-void receiveGridFromClient(int sock_pipe, struct Cell grid[GRID_SIZE][GRID_SIZE]);
-void handleClientCommunication(int sock_pipe, struct sockaddr_in client,
+// Move log record kinds (MOVE_START / MOVE_END come from movelog.h)
+#define MOVE_SHOT 16     // arg: x, y (0xff = invalid shot, the turn still passes)
+#define MOVE_GRID_ROW 17 // arg: row, 10-bit ship mask (low byte, high byte)
+
+// Player connection results (handleClientCommunication, reportGone)
+#define PLAYER_OK 0
+#define PLAYER_LEFT -1 // connection closed or failed (including TCP keepalive finding the peer gone)
+#define PLAYER_IDLE -2 // nothing received before PLAYER_IDLE_TIMEOUT
+
+// Outcome of one shot on a grid
+enum ShotResult
+{
+    SHOT_INVALID,
+    SHOT_REPEAT,
+    SHOT_MISS,
+    SHOT_HIT,
+    SHOT_SUNK,
+    SHOT_WIN
+};
+
+void receiveGridFromClient(const char *buffer, struct Cell grid[GRID_SIZE][GRID_SIZE]);
+int handleClientCommunication(NetConn *conn, const char *buf_read, struct sockaddr_in client,
                                struct Cell grid[GRID_SIZE][GRID_SIZE], int *nbShipSunk, bool *win,
-                               tuple direction[4], int nbShips, char *argv[]);
+                               tuple direction[4], int nbShips, char *argv[], MoveLog *log, int player);
+enum ShotResult applyShot(struct Cell grid[GRID_SIZE][GRID_SIZE], int tirX, int tirY, int *nbShipSunk, bool *win,
+                          tuple direction[4], int nbShips);
 
 void initGrids(struct Cell grid1[GRID_SIZE][GRID_SIZE], struct Cell grid2[GRID_SIZE][GRID_SIZE]);
 void placeShips(struct Cell grid1[GRID_SIZE][GRID_SIZE], struct Cell grid2[GRID_SIZE][GRID_SIZE]);
 void printGrid(struct Cell grid[GRID_SIZE][GRID_SIZE]);
-void gameLoop(tuple direction[4], int nbShips, char *argv[]);
+// Serve one match at a time on a NetReactor; returns only if the reactor fails
+int serveMatches(tuple direction[4], int nbShips, char *argv[]);
+
+// Resume an unfinished logged match with the next two players (off by default: players are not identified)
+extern bool resumeUnfinished;
 
 #endif // GAME_LOGIC_H
\ No newline at end of file
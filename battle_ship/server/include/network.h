@@ -1,7 +1,11 @@
 #ifndef NETWORK_H
 #define NETWORK_H
 
+// Same-machine clients connect over an abstract Unix socket named after the game port
+#define LOCAL_SOCKET_FORMAT "@battleship.%d"
+
 extern int sock;
+extern int localSock; // -1 when only TCP is available
 extern char* id;
 extern short port;
 
@@ -0,0 +1,18 @@
+#ifndef SPECTATOR_H
+#define SPECTATOR_H
+
+#include <stddef.h>
+
+#define MAX_SPECTATORS 512
+#define SPECTATOR_QUEUE_LEN 64 // pending messages per spectator before it is dropped
+
+// Starts the spectator listener and its writer thread
+int spectatorStart(short spectatorPort);
+
+// Copies the message once into a shared buffer referenced by every spectator queue
+void spectatorBroadcast(const char *data, size_t len);
+
+// Replaces the snapshot sent to spectators that join mid-game
+void spectatorSetSnapshot(const char *data, size_t len);
+
+#endif // SPECTATOR_H
@@ -2,7 +2,11 @@
 #include "../include/grid.h"
 #include "../include/network.h"
 #include "../include/ship.h"
+#include "../include/spectator.h"
 #include "../include/tuple.h"
+#include "arena.h"
+#include "net.h"
+#include "replay.h"
 #include <arpa/inet.h>
 #include <errno.h>
 #include <ncurses.h>
@@ -14,9 +18,65 @@
 #include <time.h>
 #include <unistd.h>
 
+// 한 판의 아레나 크기 (그리드 세 장 + 턴마다 쓰는 관전자 메시지 버퍼)
+#define MATCH_ARENA_SIZE 8192
+
+// 플레이어가 응답하지 않으면 리액터 타이머로 기권 처리하고 (주고받는 순서에 ping을 끼울 자리가 없음)
+// 조용히 사라진 연결은 TCP keepalive로 알아챔
+#define PLAYER_IDLE_TIMEOUT 300   // 그리드 배치나 좌표 한 줄을 기다리는 최대 시간 (초)
+#define PLAYER_KEEPALIVE_IDLE 30  // 이만큼 조용하면 keepalive probe 시작 (초)
+#define PLAYER_KEEPALIVE_INTERVAL 10
+#define PLAYER_KEEPALIVE_COUNT 3
+#define TURN_PAUSE_MS 2000        // 한 발을 쏜 뒤 다음 턴까지 쉬는 시간
+#define MATCH_TICK_MS 100         // 판 타이머 휠의 틱
+
+// 판에 앉은 플레이어 하나
+typedef struct {
+    NetConn *conn; // 연결이 닫히면 NULL
+    struct sockaddr_in addr;
+    int index;
+    bool gridReceived;
+    bool hasPending;  // 차례가 아닐 때 먼저 보낸 좌표 (그 플레이어 차례가 오면 씀)
+    char pending[256];
+} MatchPlayer;
+
+/*
+ * 판은 한 번에 하나이고 접속, 그리드, 좌표, 턴 타이머를 모두 리액터 스레드가 처리한다.
+ * 두 플레이어가 앉으면 리스닝 소켓을 리액터에서 빼서 다음 플레이어는 판이 끝날 때까지 backlog에서 기다린다.
+ * 그리드는 판 아레나에 있고 판이 끝나면 한 번에 해제한다.
+ */
+typedef struct {
+    MatchPlayer players[2];
+    int seated;
+    bool started;
+    bool waitingShot; // 차례인 플레이어의 좌표를 기다리는 중 (턴 사이 쉬는 동안은 false)
+    Arena *arena;
+    struct Cell (*grids[2])[GRID_SIZE]; // grids[i]: 플레이어 i의 배치 (상대가 쏨)
+    struct Cell (*before)[GRID_SIZE];   // 쏘기 전 그리드 (관전자 DELTA)
+    int sunk[2];                        // grids[i]에서 격침된 배 수
+    int currentTurn;                    // 0: client1, 1: client2
+    bool win;
+    MoveLog *log;
+    TimerEntry idleTimer; // 그리드 배치 또는 차례인 플레이어의 응답 마감
+    TimerEntry turnTimer; // 다음 턴 시작
+} Match;
+
+static unsigned long reapedPlayers = 0; // 응답이 없어 기권 처리한 플레이어 수
+bool resumeUnfinished = false;
+
+static NetReactor reactor;
+static TimerWheel matchTimers;
+static Match match;
+static bool listening = false; // 리스닝 소켓이 리액터에 등록되어 있음
+static tuple *shipDirections;
+static int shipCount;
+static char **serverArgs;
+
 // gamelogic.h 에 넣었다가 오류 발생
-void sendMessage(int sockfd, const char *message) {
-    write(sockfd, message, strlen(message));
+void sendMessage(NetConn *conn, const char *message) {
+    if (conn && net_conn_send(conn, message, strlen(message)) < 0) {
+        perror("메시지 전송 실패");
+    }
 }
 void initGrids(struct Cell grid1[GRID_SIZE][GRID_SIZE], struct Cell grid2[GRID_SIZE][GRID_SIZE]) {
     for (int i = 0; i < GRID_SIZE; i++) {
@@ -78,54 +138,502 @@ void printGrid(struct Cell grid[GRID_SIZE][GRID_SIZE]) {
     printf("\n");
 }
 
-void gameLoop(tuple direction[4], int nbShips, char *argv[]) {
-    struct sockaddr_in client1, client2;
-    socklen_t len1 = sizeof(client1), len2 = sizeof(client2);
-    int sock_pipe1, sock_pipe2;
+// 한 발을 그리드에 적용 (실제 게임과 이동 기록 재생이 같은 규칙을 쓰도록 분리)
+enum ShotResult applyShot(struct Cell grid[GRID_SIZE][GRID_SIZE], int tirX, int tirY, int *nbShipSunk, bool *win,
+                          tuple direction[4], int nbShips) {
+    if (tirX >= 10 || tirY >= 10 || tirX < 0 || tirY < 0) {
+        return SHOT_INVALID;
+    }
+    if (grid[tirX][tirY].aState != UNSHOT) {
+        return SHOT_REPEAT;
+    }
+    if (grid[tirX][tirY].aShip == NONE) {
+        grid[tirX][tirY].aState = MISS;
+        return SHOT_MISS;
+    }
+
+    grid[tirX][tirY].aState = HIT;
+    int orientation = 0;
+    for (int i = 0; i < 4; i++) {
+        if (grid[tirX + direction[i].x][tirY + direction[i].y].aShip == grid[tirX][tirY].aShip) {
+            orientation = i;
+        }
+    }
+    int tirXBis = tirX, tirYBis = tirY, counter = 0;
+    while (grid[tirXBis - direction[orientation].x][tirYBis - direction[orientation].y].aShip == grid[tirX][tirY].aShip) {
+        tirXBis -= direction[orientation].x;
+        tirYBis -= direction[orientation].y;
+    }
+    for (int i = 0; i < grid[tirX][tirY].aShip; i++) {
+        if (grid[tirXBis][tirYBis].aState == HIT) {
+            counter++;
+        }
+        tirXBis += direction[orientation].x;
+        tirYBis += direction[orientation].y;
+    }
+    if (counter != grid[tirX][tirY].aShip) {
+        return SHOT_HIT;
+    }
+
+    (*nbShipSunk)++;
+    tirXBis = tirX;
+    tirYBis = tirY;
+    for (int i = 0; i < grid[tirX][tirY].aShip; i++) {
+        grid[tirXBis][tirYBis].aState = SUNK;
+        tirXBis += direction[orientation].x;
+        tirYBis += direction[orientation].y;
+    }
+    if (*nbShipSunk == nbShips) {
+        *win = true;
+        return SHOT_WIN;
+    }
+    return SHOT_SUNK;
+}
+
+// 배치된 그리드를 행 단위 비트마스크로 기록 (행 하나 = 기록 한 건)
+static void logGrid(MoveLog *log, int player, struct Cell grid[GRID_SIZE][GRID_SIZE]) {
+    for (int i = 0; i < GRID_SIZE; i++) {
+        unsigned int mask = 0;
+        for (int j = 0; j < GRID_SIZE; j++) {
+            if (grid[i][j].aShip != NONE) {
+                mask |= 1u << j;
+            }
+        }
+        uint8_t arg[3] = {(uint8_t)i, (uint8_t)(mask & 0xff), (uint8_t)(mask >> 8)};
+        movelog_append(log, (uint8_t)player, MOVE_GRID_ROW, arg, sizeof(arg));
+    }
+}
+
+// 서버가 죽기 전에 끝나지 않은 게임이 있으면 이동 기록을 재생해 그리드와 턴을 복구
+static MoveLog *recoverGame(struct Cell grid1[GRID_SIZE][GRID_SIZE], struct Cell grid2[GRID_SIZE][GRID_SIZE],
+                            int *nbShipSunk1, int *nbShipSunk2, int *current_turn, tuple direction[4], int nbShips) {
+    char paths[8][MOVELOG_PATH_MAX];
+    int found = movelog_find_unfinished(MOVELOG_GAME_BATTLESHIP, paths, 8);
+
+    for (int p = 0; p < found; p++) {
+        MoveLogHeader header;
+        MoveRecord *records = NULL;
+        size_t count = 0;
+        if (movelog_load(paths[p], &header, &records, &count) < 0) {
+            // 읽을 수 없는 기록은 재시작할 때마다 다시 찾지 않도록 치움
+            movelog_set_aside(paths[p]);
+            continue;
+        }
+
+        initGrids(grid1, grid2);
+        *nbShipSunk1 = 0;
+        *nbShipSunk2 = 0;
+        *current_turn = 0;
+        bool started = false, win = false;
+        for (size_t i = 0; i < count && !win; i++) {
+            const MoveRecord *r = &records[i];
+            struct Cell(*grid)[GRID_SIZE] = r->player == 0 ? grid1 : grid2;
+            if (r->kind == MOVE_GRID_ROW && r->arg[0] < GRID_SIZE) {
+                unsigned int mask = r->arg[1] | (r->arg[2] << 8);
+                for (int j = 0; j < GRID_SIZE; j++) {
+                    grid[r->arg[0]][j].aShip = (mask & (1u << j)) ? CARRIER : NONE;
+                }
+            } else if (r->kind == MOVE_START) {
+                started = true;
+            } else if (r->kind == MOVE_SHOT) {
+                // 플레이어 0은 grid2를, 플레이어 1은 grid1을 쏜다
+                if (r->player == 0) {
+                    applyShot(grid2, r->arg[0], r->arg[1], nbShipSunk2, &win, direction, nbShips);
+                } else {
+                    applyShot(grid1, r->arg[0], r->arg[1], nbShipSunk1, &win, direction, nbShips);
+                }
+                *current_turn = 1 - *current_turn;
+            } else if (r->kind == MOVE_END) {
+                win = true;
+            }
+        }
+        free(records);
+
+        if (!started || win) {
+            // 시작 전이거나 이미 끝난 기록
+            unlink(paths[p]);
+            continue;
+        }
+        printf("이전 게임 복구: %s (이동 %zu개), 클라이언트 %d 차례\n", paths[p], count, *current_turn + 1);
+        return movelog_resume(paths[p], (uint32_t)count);
+    }
+    return NULL;
+}
+
+// 복구된 판을 클라이언트에 전송: "RESTORE <내 그리드 100칸> <상대 그리드 100칸>"
+// 내 그리드는 서버 grid[i][j] 그대로, 상대 그리드는 클라이언트가 opponent_grid[y][x]로
+// 표시하므로 전치해서 보내고 배 위치는 숨긴다
+static void sendRestore(NetConn *conn, struct Cell own[GRID_SIZE][GRID_SIZE], struct Cell target[GRID_SIZE][GRID_SIZE]) {
+    char line[8 + GRID_SIZE * GRID_SIZE * 2 + 3];
+    int idx = 0;
+    idx += sprintf(line, "RESTORE ");
+    for (int i = 0; i < GRID_SIZE; i++) {
+        for (int j = 0; j < GRID_SIZE; j++) {
+            line[idx++] = (own[i][j].aState == UNSHOT && own[i][j].aShip != NONE) ? 'S' : (char)own[i][j].aState;
+        }
+    }
+    line[idx++] = ' ';
+    for (int i = 0; i < GRID_SIZE; i++) {
+        for (int j = 0; j < GRID_SIZE; j++) {
+            line[idx++] = (char)target[j][i].aState;
+        }
+    }
+    line[idx++] = '\n';
+    line[idx] = '\0';
+    sendMessage(conn, line);
+}
+
+// 관전자용 전체 판: "SNAPSHOT <차례> <그리드1 100칸> <그리드2 100칸>"
+// 공격 결과(~ O X #)만 보내고 맞지 않은 배 위치는 숨긴다
+static void publishSnapshot(struct Cell grid1[GRID_SIZE][GRID_SIZE], struct Cell grid2[GRID_SIZE][GRID_SIZE], int turn,
+                            bool broadcast) {
+    char line[16 + GRID_SIZE * GRID_SIZE * 2 + 2];
+    int idx = sprintf(line, "SNAPSHOT %d ", turn + 1);
+    for (int g = 0; g < 2; g++) {
+        struct Cell(*grid)[GRID_SIZE] = g == 0 ? grid1 : grid2;
+        for (int i = 0; i < GRID_SIZE; i++) {
+            for (int j = 0; j < GRID_SIZE; j++) {
+                line[idx++] = (char)grid[i][j].aState;
+            }
+        }
+        line[idx++] = g == 0 ? ' ' : '\n';
+    }
+    spectatorSetSnapshot(line, (size_t)idx);
+    if (broadcast) {
+        spectatorBroadcast(line, (size_t)idx);
+    }
+}
+
+// 한 턴의 변화만 관전자에게: "DELTA <쏜 플레이어> <결과> <바뀐 칸 수> i j 상태 ..."
+// 바뀐 칸은 쏘기 전 그리드와 비교해서 구함 (격침이면 배 전체가 # 로 바뀜)
+// 메시지 버퍼는 판 아레나에서 잠깐 빌리고 보낸 뒤 되감음
+static void publishDelta(Arena *arena, int shooter, struct Cell before[GRID_SIZE][GRID_SIZE],
+                         struct Cell after[GRID_SIZE][GRID_SIZE], bool win) {
+    const size_t lineSize = 64 + GRID_SIZE * GRID_SIZE * 8;
+    ArenaMark mark = arena_mark(arena);
+    char *line = arena_alloc(arena, lineSize);
+    char *cells = arena_alloc(arena, GRID_SIZE * GRID_SIZE * 8);
+    if (!line || !cells) {
+        arena_rewind(arena, mark);
+        return;
+    }
+    int changed = 0, len = 0;
+    bool sunk = false;
+    cells[0] = '\0';
+    enum State last = UNSHOT;
+    for (int i = 0; i < GRID_SIZE; i++) {
+        for (int j = 0; j < GRID_SIZE; j++) {
+            if (before[i][j].aState == after[i][j].aState)
+                continue;
+            last = after[i][j].aState;
+            sunk = sunk || last == SUNK;
+            len += sprintf(cells + len, " %d %d %c", i, j, (char)last);
+            changed++;
+        }
+    }
+    const char *result = win ? "WIN" : sunk ? "SUNK" : changed == 0 ? "NONE" : last == HIT ? "HIT" : "MISS";
+    int n = snprintf(line, lineSize, "DELTA %d %s %d%s\n", shooter + 1, result, changed, cells);
+    spectatorBroadcast(line, (size_t)n);
+    arena_rewind(arena, mark);
+}
+
+// 배틀쉽은 한 발이 한 턴
+static int shotEndsTurn(const MoveRecord *record) {
+    return record->kind == MOVE_SHOT;
+}
+
+// 연결이 끊겼거나 응답이 없는 플레이어를 알림 (응답이 없었으면 끊은 수를 셈)
+static void reportGone(int player, int result) {
+    if (result == PLAYER_IDLE) {
+        reapedPlayers++;
+        printf("응답이 없는 연결을 끊습니다: 플레이어 %d (지금까지 %lu)\n", player + 1, reapedPlayers);
+    } else {
+        printf("플레이어 %d의 연결이 끊겼습니다.\n", player + 1);
+    }
+}
 
-    sock_pipe1 = accept(sock, (struct sockaddr *)&client1, &len1);
-    sock_pipe2 = accept(sock, (struct sockaddr *)&client2, &len2);
+static void acceptPlayer(NetReactor *r, int fd, void *arg);
 
-    struct Cell grid1[GRID_SIZE][GRID_SIZE], grid2[GRID_SIZE][GRID_SIZE];
-    initGrids(grid1, grid2);
+// 게임 포트(TCP)와 Unix 소켓을 다시 받음 (판이 끝났거나 시작하지 못했을 때)
+static void listenForPlayers(void) {
+    if (listening) {
+        return;
+    }
+    if (net_reactor_listen(&reactor, sock, acceptPlayer, NULL) < 0) {
+        perror("게임 포트 등록 실패");
+    }
+    if (localSock >= 0 && net_reactor_listen(&reactor, localSock, acceptPlayer, NULL) < 0) {
+        perror("Unix 소켓 등록 실패");
+    }
+    listening = true;
+}
 
-    printf("클라이언트 1의 그리드 수신 중...\n");
-    receiveGridFromClient(sock_pipe1, grid1);
-    printf("클라이언트 2의 그리드 수신 중...\n");
-    receiveGridFromClient(sock_pipe2, grid2);
+// 판을 비우고 다음 두 플레이어를 받음 (남은 연결은 호출한 쪽이 닫음)
+static void resetMatch(void) {
+    timer_wheel_cancel(&matchTimers, &match.idleTimer);
+    timer_wheel_cancel(&matchTimers, &match.turnTimer);
+    for (int i = 0; i < 2; i++) {
+        if (match.players[i].conn) {
+            match.players[i].conn->user = NULL;
+        }
+    }
+    arena_destroy(match.arena);
+    memset(&match, 0, sizeof(match));
+    listenForPlayers();
+}
+
+// 시작하기 전에 끝난 판: 두 연결을 닫고 기록 없이 버림
+static void abandonMatch(void) {
+    NetConn *conns[2] = {match.players[0].conn, match.players[1].conn};
+    resetMatch();
+    for (int i = 0; i < 2; i++) {
+        if (conns[i]) {
+            net_conn_close(conns[i]);
+        }
+    }
+}
+
+// 승부가 난 게임은 리플레이로 옮기고 복구 대상에서 제외 (기권이면 남은 플레이어의 승리)
+static void finishMatch(int forfeit) {
+    uint8_t winner = (uint8_t)(forfeit >= 0 ? 1 - forfeit : 1 - match.currentTurn);
+    if (forfeit >= 0) {
+        // 클라이언트는 "You won"으로 시작하는 줄을 게임 종료로 봄
+        sendMessage(match.players[winner].conn, "You won! Your opponent left the game.\n");
+    }
+    movelog_append(match.log, winner, MOVE_END, &winner, 1);
+    if (match.log) {
+        uint8_t rules[REPLAY_RULES_SIZE] = {GRID_SIZE, (uint8_t)shipCount};
+        replay_write_from_log(movelog_path(match.log), rules, winner, 0, shotEndsTurn);
+    }
+    movelog_close(match.log, 1);
 
-    bool win = false;
-    int nbShipSunk1 = 0, nbShipSunk2 = 0;
-    int current_turn = 0; // 0: client1, 1: client2
+    char overMsg[32];
+    sprintf(overMsg, "GAMEOVER %d\n", winner + 1);
+    spectatorBroadcast(overMsg, strlen(overMsg));
 
-    while (!win) {
-        if (current_turn == 0) {
-            sendMessage(sock_pipe1, "YOUR_TURN\n");
-            sendMessage(sock_pipe2, "OPPONENT_TURN\n");
-            handleClientCommunication(sock_pipe1, client1, grid2, &nbShipSunk2, &win, direction, nbShips, argv);
-        } else {
-            sendMessage(sock_pipe2, "YOUR_TURN\n");
-            sendMessage(sock_pipe1, "OPPONENT_TURN\n");
-            handleClientCommunication(sock_pipe2, client2, grid1, &nbShipSunk1, &win, direction, nbShips, argv);
+    // 마지막 메시지까지 보낸 뒤 닫음
+    NetConn *conns[2] = {match.players[0].conn, match.players[1].conn};
+    resetMatch();
+    for (int i = 0; i < 2; i++) {
+        if (conns[i]) {
+            net_conn_close_flush(conns[i]);
         }
-        current_turn = 1 - current_turn; // 턴 변경
-        sleep(2);
     }
+}
+
+static void playShot(MatchPlayer *player, const char *line);
+
+// 차례를 알리고 그 플레이어의 좌표를 기다림 (먼저 보낸 좌표가 있으면 바로 씀)
+static void beginTurn(void) {
+    MatchPlayer *shooter = &match.players[match.currentTurn];
+    MatchPlayer *waiting = &match.players[1 - match.currentTurn];
+    char turnMsg[32];
+    sprintf(turnMsg, "TURN %d\n", match.currentTurn + 1);
+    spectatorBroadcast(turnMsg, strlen(turnMsg));
+    sendMessage(shooter->conn, "YOUR_TURN\n");
+    sendMessage(waiting->conn, "OPPONENT_TURN\n");
+    memcpy(match.before, match.grids[1 - match.currentTurn], sizeof(struct Cell[GRID_SIZE][GRID_SIZE]));
+
+    match.waitingShot = true;
+    timer_wheel_schedule(&matchTimers, &match.idleTimer, PLAYER_IDLE_TIMEOUT * 1000);
+    if (shooter->hasPending) {
+        char line[sizeof(shooter->pending)];
+        memcpy(line, shooter->pending, sizeof(line));
+        shooter->hasPending = false;
+        playShot(shooter, line);
+    }
+}
+
+static void nextTurn(void *arg) {
+    (void)arg;
+    beginTurn();
+}
 
-    close(sock_pipe1);
-    close(sock_pipe2);
+// 차례인 플레이어의 좌표 한 줄로 한 턴을 진행
+static void playShot(MatchPlayer *player, const char *line) {
+    int target = 1 - player->index;
+    match.waitingShot = false;
+    timer_wheel_cancel(&matchTimers, &match.idleTimer);
+
+    int result = handleClientCommunication(player->conn, line, player->addr, match.grids[target], &match.sunk[target],
+                                           &match.win, shipDirections, shipCount, serverArgs, match.log, player->index);
+    publishDelta(match.arena, player->index, match.before, match.grids[target], match.win);
+    match.currentTurn = 1 - match.currentTurn; // 턴 변경
+    publishSnapshot(match.grids[0], match.grids[1], match.currentTurn, false);
+
+    if (result != PLAYER_OK) {
+        reportGone(player->index, result);
+        finishMatch(player->index);
+    } else if (match.win) {
+        finishMatch(-1);
+    } else {
+        timer_wheel_schedule(&matchTimers, &match.turnTimer, TURN_PAUSE_MS);
+    }
 }
-void receiveGridFromClient(int sock_pipe, struct Cell grid[GRID_SIZE][GRID_SIZE]) {
-    char buffer[GRID_SIZE * GRID_SIZE + 1];
-    int ret = read(sock_pipe, buffer, GRID_SIZE * GRID_SIZE);
-    if (ret <= 0) {
-        perror("그리드 데이터 수신 실패");
-        exit(1);
+
+// 두 그리드를 다 받으면 판을 시작
+static void startMatch(void) {
+    static uint32_t sessionCounter = 0;
+
+    // 끝나지 않은 게임이 남아 있으면 새로 받은 배치 대신 그 판을 이어서 진행
+    // 접속한 두 사람이 그 판의 플레이어인지 알 수 없으므로 운영자가 켰을 때만
+    match.log = resumeUnfinished ? recoverGame(match.grids[0], match.grids[1], &match.sunk[0], &match.sunk[1],
+                                               &match.currentTurn, shipDirections, shipCount)
+                                 : NULL;
+    if (match.log) {
+        sendRestore(match.players[0].conn, match.grids[0], match.grids[1]);
+        sendRestore(match.players[1].conn, match.grids[1], match.grids[0]);
+    } else {
+        match.log = movelog_create(MOVELOG_GAME_BATTLESHIP, ++sessionCounter, 0);
+        logGrid(match.log, 0, match.grids[0]);
+        logGrid(match.log, 1, match.grids[1]);
+        movelog_append(match.log, 0, MOVE_START, NULL, 0);
     }
+    // 관전자는 새 판(또는 복구된 판) 전체를 받고 이후에는 변화만 받음
+    publishSnapshot(match.grids[0], match.grids[1], match.currentTurn, true);
+
+    match.started = true;
+    beginTurn();
+}
 
-    // 수신된 데이터 확인
-    buffer[ret] = '\0'; // 널 문자 추가
+// 그리드 배치나 좌표를 기다리다 시간이 지남
+static void playerIdle(void *arg) {
+    (void)arg;
+    if (match.started) {
+        reportGone(match.currentTurn, PLAYER_IDLE);
+        finishMatch(match.currentTurn);
+        return;
+    }
+    // 배치를 보내지 않은 플레이어가 있으면 이 판은 시작하지 않음
+    for (int i = 0; i < match.seated; i++) {
+        if (!match.players[i].gridReceived) {
+            reportGone(i, PLAYER_IDLE);
+        }
+    }
+    abandonMatch();
+}
+
+// 배치는 정확히 100칸, 그 뒤로는 좌표 한 줄씩
+static ssize_t frameGrid(const char *data, size_t len) {
+    (void)data;
+    return len >= GRID_SIZE * GRID_SIZE ? GRID_SIZE * GRID_SIZE : 0;
+}
+
+static void playerMessage(NetConn *conn, char *data, size_t len) {
+    (void)len;
+    MatchPlayer *player = conn->user;
+    if (!player) {
+        return;
+    }
+    if (!player->gridReceived) {
+        printf("클라이언트 %d의 그리드 수신\n", player->index + 1);
+        receiveGridFromClient(data, match.grids[player->index]);
+        player->gridReceived = true;
+        conn->framer = net_frame_line;
+        if (match.seated == 2 && match.players[0].gridReceived && match.players[1].gridReceived) {
+            startMatch();
+        }
+        return;
+    }
+    if (match.waitingShot && match.currentTurn == player->index) {
+        playShot(player, data);
+    } else if (!player->hasPending) {
+        snprintf(player->pending, sizeof(player->pending), "%s", data);
+        player->hasPending = true;
+    }
+}
+
+static void playerClosed(NetConn *conn) {
+    MatchPlayer *player = conn->user;
+    if (!player) {
+        return;
+    }
+    player->conn = NULL;
+    reportGone(player->index, PLAYER_LEFT);
+    if (match.started) {
+        finishMatch(player->index);
+    } else {
+        abandonMatch();
+    }
+}
+
+// 게임 포트(TCP)나 Unix 소켓으로 들어온 플레이어를 판에 앉힘
+static void acceptPlayer(NetReactor *r, int fd, void *arg) {
+    (void)arg;
+    if (match.seated == 0) {
+        // 이 판이 쓰는 메모리는 모두 판 아레나에서 받고 판이 끝나면 한 번에 해제
+        const size_t gridBytes = sizeof(struct Cell[GRID_SIZE][GRID_SIZE]);
+        match.arena = arena_create(MATCH_ARENA_SIZE);
+        match.grids[0] = match.arena ? arena_alloc(match.arena, gridBytes) : NULL;
+        match.grids[1] = match.arena ? arena_alloc(match.arena, gridBytes) : NULL;
+        match.before = match.arena ? arena_alloc(match.arena, gridBytes) : NULL;
+        if (!match.grids[0] || !match.grids[1] || !match.before) {
+            close(fd);
+            resetMatch();
+            return;
+        }
+        initGrids(match.grids[0], match.grids[1]);
+        timer_entry_init(&match.idleTimer, playerIdle, NULL);
+        timer_entry_init(&match.turnTimer, nextTurn, NULL);
+    }
+
+    MatchPlayer *player = &match.players[match.seated];
+    socklen_t len = sizeof(player->addr);
+    if (getpeername(fd, (struct sockaddr *)&player->addr, &len) < 0 || player->addr.sin_family != AF_INET) {
+        // Unix 소켓에는 IP 주소가 없으므로 로그에는 루프백으로 표시
+        memset(&player->addr, 0, sizeof(player->addr));
+        player->addr.sin_family = AF_INET;
+        player->addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    }
+    if (net_set_keepalive(fd, PLAYER_KEEPALIVE_IDLE, PLAYER_KEEPALIVE_INTERVAL, PLAYER_KEEPALIVE_COUNT) < 0) {
+        perror("플레이어 소켓 설정 실패");
+    }
+    player->index = match.seated;
+    player->conn = net_conn_open(r, fd, frameGrid, playerMessage, playerClosed, player);
+    if (!player->conn) {
+        close(fd);
+        if (match.seated == 0) {
+            resetMatch();
+        }
+        return;
+    }
+    match.seated++;
+    if (match.seated < 2) {
+        return;
+    }
+
+    // 판이 찼으면 다음 플레이어는 이 판이 끝날 때까지 backlog에서 기다림
+    net_reactor_remove(r, sock);
+    if (localSock >= 0) {
+        net_reactor_remove(r, localSock);
+    }
+    listening = false;
+    printf("클라이언트 2명 접속, 그리드 배치를 기다립니다.\n");
+    timer_wheel_schedule(&matchTimers, &match.idleTimer, PLAYER_IDLE_TIMEOUT * 1000);
+    if (match.players[0].gridReceived && match.players[1].gridReceived) {
+        startMatch();
+    }
+}
+
+/*
+ * 판을 계속 받아 진행 (리액터가 실패하지 않으면 돌아오지 않음)
+ */
+int serveMatches(tuple direction[4], int nbShips, char *argv[]) {
+    shipDirections = direction;
+    shipCount = nbShips;
+    serverArgs = argv;
+
+    timer_wheel_init(&matchTimers, MATCH_TICK_MS);
+    if (net_reactor_init(&reactor) < 0) {
+        return -1;
+    }
+    listenForPlayers();
+    int ret = net_reactor_run(&reactor, &matchTimers);
+    net_reactor_destroy(&reactor);
+    return ret;
+}
 
+void receiveGridFromClient(const char *buffer, struct Cell grid[GRID_SIZE][GRID_SIZE]) {
     // 문자열 데이터를 Cell 구조로 변환
     int index = 0;
     for (int i = 0; i < GRID_SIZE; i++) {
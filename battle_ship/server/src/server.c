@@ -2,7 +2,9 @@
 #include "../include/grid.h"
 #include "../include/network.h"
 #include "../include/ship.h"
+#include "../include/spectator.h"
 #include "../include/tuple.h"
+#include "net.h"
 #include <arpa/inet.h>
 #include <errno.h>
 #include <ncurses.h>
@@ -17,6 +19,7 @@
 extern char *id;
 extern short port;
 extern int sock;
+extern int localSock;
 
 int main(int argc, char **argv) {
 
@@ -36,38 +39,39 @@ int main(int argc, char **argv) {
 
     int nbShips = 8;
 
-    struct sockaddr_in server; // server SAP
-
-    if (argc != 3) {
-        fprintf(stderr, "usage: %s id port\n", argv[0]);
+    if (argc == 4 && strcmp(argv[3], "--resume-unfinished") == 0) {
+        resumeUnfinished = true;
+    } else if (argc != 3) {
+        fprintf(stderr, "usage: %s id port [--resume-unfinished]\n", argv[0]);
         exit(1);
     }
     id = argv[1];
     port = atoi(argv[2]);
 
-    // Create socket
-    if ((sock = socket(AF_INET, SOCK_STREAM, 0)) == -1) {
-        fprintf(stderr, "%s: socket %s\n", argv[0], strerror(errno));
+    // Create, bind and listen (shared network library, SO_REUSEADDR so restarts don't hit TIME_WAIT)
+    if ((sock = net_listen_tcp(port, 5, 0)) < 0) {
+        fprintf(stderr, "%s: cannot listen on port %d\n", argv[0], port);
         exit(1);
     }
 
-    server.sin_family = AF_INET;
-    server.sin_port = htons(port);
-    server.sin_addr.s_addr = INADDR_ANY;
+    // 같은 컴퓨터의 클라이언트는 Unix 소켓으로 (없어도 TCP로는 접속 가능)
+    char localName[32];
+    snprintf(localName, sizeof(localName), LOCAL_SOCKET_FORMAT, port);
+    localSock = net_listen_unix(localName, 5, 0);
 
-    // Bind socket
-    if (bind(sock, (struct sockaddr *)&server, sizeof(server)) < 0) {
-        fprintf(stderr, "%s: bind %s\n", argv[0], strerror(errno));
-        exit(1);
+    // 관전자는 게임 포트 + 1로 접속
+    if (spectatorStart(port + 1) < 0) {
+        fprintf(stderr, "%s: spectators disabled\n", argv[0]);
     }
 
-    // Listen on socket
-    if (listen(sock, 5) != 0) {
-        fprintf(stderr, "%s: listen %s\n", argv[0], strerror(errno));
-        exit(1);
+    // 이동 기록 디렉터리 준비 및 fsync 스레드 시작
+    if (movelog_init() < 0) {
+        fprintf(stderr, "%s: move log disabled\n", argv[0]);
     }
 
-    while (1) {
-        gameLoop(direction, nbShips, argv);
+    // 접속, 그리드, 좌표, 턴 타이머를 모두 리액터 루프 하나에서 처리
+    if (serveMatches(direction, nbShips, argv) < 0) {
+        fprintf(stderr, "%s: reactor failed\n", argv[0]);
     }
+    exit(1);
 }
@@ -0,0 +1,287 @@
+#define _GNU_SOURCE
+#include "../include/spectator.h"
+#include "net.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// 한 번 인코딩한 메시지를 모든 관전자 큐가 공유 (마지막 참조가 해제)
+typedef struct {
+    int refs;
+    size_t len;
+    char data[];
+} SharedBuffer;
+
+typedef struct {
+    int fd;
+    SharedBuffer *queue[SPECTATOR_QUEUE_LEN];
+    unsigned head, tail; // tail - head = 대기 중인 메시지 수
+    size_t offset;       // head 메시지 중 이미 보낸 바이트 수
+    bool dropped;
+} Spectator;
+
+// 관전자 목록과 큐는 lock으로 보호. 목록 추가/삭제는 writer 스레드만 한다
+static Spectator *spectators[MAX_SPECTATORS];
+static int nbSpectators = 0;
+static SharedBuffer *snapshot = NULL;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static int listenFd = -1;
+static int wakeFd = -1;
+
+static SharedBuffer *newBuffer(const char *data, size_t len) {
+    SharedBuffer *buf = malloc(sizeof(SharedBuffer) + len);
+    if (!buf) {
+        perror("malloc");
+        return NULL;
+    }
+    buf->refs = 0;
+    buf->len = len;
+    memcpy(buf->data, data, len);
+    return buf;
+}
+
+static void releaseBuffer(SharedBuffer *buf) {
+    if (__atomic_sub_fetch(&buf->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+        free(buf);
+    }
+}
+
+// lock을 잡은 상태에서 호출. 큐가 가득 찬 느린 관전자는 버린다
+static bool enqueue(Spectator *s, SharedBuffer *buf) {
+    if (s->dropped) {
+        return false;
+    }
+    if (s->tail - s->head == SPECTATOR_QUEUE_LEN) {
+        s->dropped = true;
+        return false;
+    }
+    s->queue[s->tail++ % SPECTATOR_QUEUE_LEN] = buf;
+    return true;
+}
+
+static void markDropped(Spectator *s) {
+    pthread_mutex_lock(&lock);
+    s->dropped = true;
+    pthread_mutex_unlock(&lock);
+}
+
+static void wakeWriter() {
+    uint64_t one = 1;
+    if (write(wakeFd, &one, sizeof(one)) < 0) {
+        perror("spectator wake");
+    }
+}
+
+void spectatorBroadcast(const char *data, size_t len) {
+    if (wakeFd < 0) {
+        return;
+    }
+    SharedBuffer *buf = newBuffer(data, len);
+    if (!buf) {
+        return;
+    }
+
+    // writer는 lock 없이 큐에서 꺼낼 수 없으므로 참조 수는 다 넣은 뒤 한 번에 설정
+    int refs = 0;
+    pthread_mutex_lock(&lock);
+    for (int i = 0; i < nbSpectators; i++) {
+        if (enqueue(spectators[i], buf)) {
+            refs++;
+        }
+    }
+    __atomic_store_n(&buf->refs, refs, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&lock);
+
+    if (refs == 0) {
+        free(buf);
+        return;
+    }
+    wakeWriter();
+}
+
+void spectatorSetSnapshot(const char *data, size_t len) {
+    SharedBuffer *buf = newBuffer(data, len);
+    if (!buf) {
+        return;
+    }
+    buf->refs = 1; // 스냅샷 자리가 가진 참조
+    pthread_mutex_lock(&lock);
+    SharedBuffer *old = snapshot;
+    snapshot = buf;
+    pthread_mutex_unlock(&lock);
+    if (old) {
+        releaseBuffer(old);
+    }
+}
+
+static void acceptSpectator() {
+    int fd = accept4(listenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+    Spectator *s = calloc(1, sizeof(Spectator));
+    if (!s) {
+        close(fd);
+        return;
+    }
+    s->fd = fd;
+
+    pthread_mutex_lock(&lock);
+    if (nbSpectators == MAX_SPECTATORS) {
+        pthread_mutex_unlock(&lock);
+        close(fd);
+        free(s);
+        return;
+    }
+    if (snapshot) {
+        __atomic_add_fetch(&snapshot->refs, 1, __ATOMIC_ACQ_REL);
+        enqueue(s, snapshot);
+    }
+    spectators[nbSpectators++] = s;
+    pthread_mutex_unlock(&lock);
+    printf("관전자 접속 (%d명)\n", nbSpectators);
+}
+
+// 큐에 쌓인 메시지를 소켓이 받아주는 만큼 보냄
+static void flushSpectator(Spectator *s) {
+    while (1) {
+        pthread_mutex_lock(&lock);
+        if (s->head == s->tail) {
+            pthread_mutex_unlock(&lock);
+            return;
+        }
+        SharedBuffer *buf = s->queue[s->head % SPECTATOR_QUEUE_LEN];
+        pthread_mutex_unlock(&lock);
+
+        ssize_t n = send(s->fd, buf->data + s->offset, buf->len - s->offset, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                markDropped(s);
+            }
+            return;
+        }
+        s->offset += (size_t)n;
+        if (s->offset < buf->len) {
+            return;
+        }
+
+        pthread_mutex_lock(&lock);
+        s->head++;
+        s->offset = 0;
+        pthread_mutex_unlock(&lock);
+        releaseBuffer(buf);
+    }
+}
+
+// 끊겼거나 너무 느린 관전자를 목록에서 빼고 남은 참조를 해제
+static void removeDropped() {
+    pthread_mutex_lock(&lock);
+    for (int i = 0; i < nbSpectators;) {
+        Spectator *s = spectators[i];
+        if (!s->dropped) {
+            i++;
+            continue;
+        }
+        spectators[i] = spectators[--nbSpectators];
+        while (s->head != s->tail) {
+            releaseBuffer(s->queue[s->head++ % SPECTATOR_QUEUE_LEN]);
+        }
+        close(s->fd);
+        free(s);
+        printf("관전자 연결 종료 (%d명)\n", nbSpectators);
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+// 관전자 수락과 전송을 모두 맡는 스레드 (게임 루프는 큐에 넣기만 함)
+static void *writerThread(void *arg) {
+    (void)arg;
+    struct pollfd fds[MAX_SPECTATORS + 2];
+
+    while (1) {
+        fds[0].fd = listenFd;
+        fds[0].events = POLLIN;
+        fds[1].fd = wakeFd;
+        fds[1].events = POLLIN;
+
+        pthread_mutex_lock(&lock);
+        int count = nbSpectators;
+        for (int i = 0; i < count; i++) {
+            fds[i + 2].fd = spectators[i]->fd;
+            fds[i + 2].events = POLLIN | (spectators[i]->head != spectators[i]->tail ? POLLOUT : 0);
+            fds[i + 2].revents = 0;
+        }
+        pthread_mutex_unlock(&lock);
+
+        if (poll(fds, (nfds_t)count + 2, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("spectator poll");
+            return NULL;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            uint64_t value;
+            if (read(wakeFd, &value, sizeof(value)) < 0) {
+                perror("spectator wake");
+            }
+        }
+
+        // 목록은 이 스레드만 바꾸므로 poll 전의 인덱스가 그대로 유효
+        for (int i = 0; i < count; i++) {
+            Spectator *s = spectators[i];
+            short revents = fds[i + 2].revents;
+            if (revents & (POLLIN | POLLHUP | POLLERR)) {
+                char discard[64];
+                ssize_t n = recv(s->fd, discard, sizeof(discard), MSG_DONTWAIT);
+                if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                    markDropped(s);
+                }
+            }
+            // 방금 broadcast된 메시지도 바로 보내 본다 (대부분 소켓 버퍼에 바로 들어감)
+            if (!s->dropped) {
+                flushSpectator(s);
+            }
+        }
+
+        if (fds[0].revents & POLLIN) {
+            acceptSpectator();
+        }
+        removeDropped();
+    }
+    return NULL;
+}
+
+int spectatorStart(short spectatorPort) {
+    listenFd = net_listen_tcp(spectatorPort, 16, NET_LISTEN_NONBLOCK);
+    if (listenFd < 0) {
+        return -1;
+    }
+
+    wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    pthread_t tid;
+    if (wakeFd < 0 || pthread_create(&tid, NULL, writerThread, NULL) != 0) {
+        perror("spectator thread");
+        close(listenFd);
+        listenFd = -1;
+        if (wakeFd >= 0) {
+            close(wakeFd);
+            wakeFd = -1;
+        }
+        return -1;
+    }
+    pthread_detach(tid);
+    printf("관전자 포트 %d에서 대기 중\n", spectatorPort);
+    return 0;
+}
@@ -5,29 +5,141 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include "net.h"
+#include "protocol.h"
 #define PORT 8080
+#define LOCAL_SOCKET "@davinci_code.server" // server.c와 같은 이름
+#define STATE_WIN_HEIGHT 6
 
-WINDOW *output_win, *input_win;
+WINDOW *state_win, *output_win, *input_win;
+int sock = 0;
 
-int main() {
-    setlocale(LC_ALL, "");
-
-    int sock = 0;
-    struct sockaddr_in serv_addr;
-    char buffer[2048] = {0};
-
-    if ((sock = socket(AF_INET, SOCK_STREAM, 0)) < 0) {
-        printf("\n소켓 생성 실패\n");
-        return -1;
+// 메시지 로그창에 한 줄 추가
+void log_message(const char *message) {
+    wprintw(output_win, "%s\n", message);
+    wrefresh(output_win);
+}
+
+// 타일 한 줄 출력 (숨겨진 타일은 ?, mark_revealed면 상대에게 공개된 타일을 빨간색으로)
+void draw_tiles(int row, const char *label, const TileView *tiles, int count, int mark_revealed) {
+    mvwprintw(state_win, row, 2, "%s", label);
+    for (int i = 0; i < count; i++) {
+        if (mark_revealed && tiles[i].revealed) {
+            wattron(state_win, COLOR_PAIR(1));
+        }
+        if (tiles[i].number > 0) {
+            wprintw(state_win, "[%c%d] ", tiles[i].color, tiles[i].number);
+        } else {
+            wprintw(state_win, "[%c?] ", tiles[i].color);
+        }
+        wattroff(state_win, COLOR_PAIR(1));
     }
+}
+
+// MSG_STATE 수신 시 상태창만 다시 그림
+void draw_state(const StateView *view) {
+    werase(state_win);
+    box(state_win, 0, 0);
+    draw_tiles(1, "상대의 타일: ", view->opponent, view->opponent_count, 0);
+    draw_tiles(2, "당신의 타일: ", view->mine, view->my_count, 1);
+    mvwprintw(state_win, 4, 2, "%s", view->my_turn ? "당신의 차례입니다." : "상대방의 차례입니다. 잠시 기다려주세요.");
+    wrefresh(state_win);
+}
+
+// 추측 결과 표시
+void show_result(const Frame *frame) {
+    if (frame->length < 1) {
+        return;
+    }
+    switch (frame->payload[0]) {
+    case RESULT_CORRECT:
+        log_message("정답입니다!");
+        break;
+    case RESULT_WRONG:
+        log_message("틀렸습니다. 새로운 타일을 뽑습니다.");
+        if (frame->length >= 3 && frame->payload[2] > 0) {
+            wprintw(output_win, "새로 뽑은 타일: [%c%d]\n", frame->payload[1], frame->payload[2]);
+            wrefresh(output_win);
+        }
+        break;
+    case RESULT_BAD_INPUT:
+        log_message("입력 형식이 올바르지 않습니다. 예: 1 B 5");
+        break;
+    default:
+        break;
+    }
+}
+
+// 게임 종료 사유 표시
+void show_game_over(int reason) {
+    switch (reason) {
+    case GAMEOVER_WIN:
+        log_message("게임 종료: 당신이 이겼습니다!");
+        sleep(3);
+        break;
+    case GAMEOVER_LOSE:
+        log_message("게임 종료: 당신이 졌습니다!");
+        sleep(3);
+        break;
+    case GAMEOVER_DECLINED:
+        log_message("게임을 거부하셨습니다. 연결을 종료합니다...");
+        sleep(2);
+        break;
+    case GAMEOVER_OPPONENT_DECLINED:
+        log_message("상대 플레이어가 게임을 거부하여 연결을 종료합니다...");
+        sleep(2);
+        break;
+    case GAMEOVER_OPPONENT_LEFT:
+        log_message("상대 플레이어가 연결을 해제하여 게임을 종료합니다...");
+        sleep(2);
+        break;
+    case GAMEOVER_TIMEOUT:
+        log_message("응답 시간이 초과되어 게임을 종료합니다...");
+        sleep(2);
+        break;
+    case GAMEOVER_OPPONENT_TIMEOUT:
+        log_message("게임 종료: 상대가 시간 초과로 기권하여 당신이 이겼습니다!");
+        sleep(3);
+        break;
+    default:
+        break;
+    }
+}
 
-    serv_addr.sin_family = AF_INET;
-    serv_addr.sin_port = htons(PORT);
-
-    if (inet_pton(AF_INET, "127.0.0.1", &serv_addr.sin_addr) <= 0) {
-        printf("\n잘못된 주소/ 주소를 변환할 수 없음\n");
-        return -1;
+// 입력창에서 한 줄 입력받아 서버로 전송
+void read_and_send(const char *prompt, char *input, int size) {
+    mvwprintw(input_win, 1, 1, "%s", prompt);
+    wrefresh(input_win);
+    echo();
+    wgetnstr(input_win, input, size - 1);
+    noecho();
+    send(sock, input, strlen(input), 0);
+    werase(input_win);
+    box(input_win, 0, 0);
+    wrefresh(input_win);
+}
+
+// MSG_PROMPT 종류에 따라 입력 요청
+void handle_prompt(int kind) {
+    char choice[3];
+    char input[1024];
+    switch (kind) {
+    case PROMPT_JOIN:
+        read_and_send("게임에 참여하시겠습니까? (y/n): ", choice, sizeof(choice));
+        break;
+    case PROMPT_TURN:
+        read_and_send("당신의 차례입니다. 좌표를 입력하세요 (예: 1 B 5): ", input, sizeof(input));
+        break;
+    case PROMPT_GUESS_AGAIN:
+        read_and_send("다시 추측하시겠습니까? (y/n): ", choice, sizeof(choice));
+        break;
+    default:
+        break;
     }
+}
+
+int main() {
+    setlocale(LC_ALL, "");
 
     initscr();
     start_color();
@@ -36,7 +148,8 @@ int main() {
     cbreak();
     keypad(stdscr, TRUE);
 
-    if (connect(sock, (struct sockaddr *)&serv_addr, sizeof(serv_addr)) < 0) {
+    // 같은 컴퓨터의 서버면 Unix 소켓으로, 아니면 TCP로 연결
+    if ((sock = net_connect_local(LOCAL_SOCKET, "127.0.0.1", PORT)) < 0) {
         endwin();
         perror("\n연결 실패");
         return -1;
@@ -66,86 +179,68 @@ int main() {
     refresh();
     sleep(2);
 
-    int output_win_height = LINES - 5;
+    // 상태창(타일)과 메시지 로그창을 분리해서 바뀐 영역만 다시 그림
+    int state_win_height = STATE_WIN_HEIGHT;
+    int output_win_height = LINES - 5 - state_win_height;
     int output_win_width = COLS;
-    output_win = newwin(output_win_height, output_win_width, 0, 0);
+    state_win = newwin(state_win_height, output_win_width, 0, 0);
+    output_win = newwin(output_win_height, output_win_width, state_win_height, 0);
 
     int input_win_height = 5;
     int input_win_width = COLS;
-    input_win = newwin(input_win_height, input_win_width, output_win_height, 0);
+    input_win = newwin(input_win_height, input_win_width, state_win_height + output_win_height, 0);
 
     scrollok(output_win, TRUE);
-    box(output_win, 0, 0);
+    box(state_win, 0, 0);
     box(input_win, 0, 0);
+    wrefresh(state_win);
     wrefresh(output_win);
     wrefresh(input_win);
 
     mvprintw(LINES / 2, (COLS - strlen("다른 플레이어가 접속하기를 기다리는 중...")) / 2, "다른 플레이어가 접속하기를 기다리는 중...");
     refresh();
 
-    while (1) {
-        int valread = read(sock, buffer, sizeof(buffer) - 1);
-        if (valread > 0) {
-            buffer[valread] = '\0';
+    FrameReader reader;
+    frame_reader_init(&reader);
+    int finished = 0;
 
-            // 항상 전체 메시지 출력
-            wclear(output_win);
-            mvwprintw(output_win, 1, 1, "%s", buffer);
-            wrefresh(output_win);
+    while (!finished) {
+        if (frame_reader_fill(&reader, sock) <= 0) {
+            log_message("서버와의 연결이 끊어졌습니다.");
+            sleep(2);
+            break;
+        }
 
-            // 게임 참여 여부
-            if (strstr(buffer, "게임에 참여하시겠습니까?") != NULL) {
-                char choice[3];
-                mvwprintw(input_win, 1, 1, "게임에 참여하시겠습니까? (y/n): ");
-                wrefresh(input_win);
-                echo();
-                wgetnstr(input_win, choice, sizeof(choice) - 1);
-                noecho();
-                send(sock, choice, strlen(choice), 0);
-                werase(input_win);
-                box(input_win, 0, 0);
-                wrefresh(input_win);
-            }
-            // 게임 종료 메시지
-            else if (strstr(buffer, "상대 플레이어가 연결을 해제하여 게임을 종료합니다...") != NULL ||
-                     strstr(buffer, "연결을 해제하셨습니다.") != NULL ||
-                     strstr(buffer, "게임을 거부하셨습니다.") != NULL ||
-                     strstr(buffer, "상대 플레이어가 게임을 거부하여 연결을 종료합니다...") != NULL) {
-                sleep(2);
+        // 한 번의 read에 붙어 온 프레임을 모두 처리
+        Frame frame;
+        while (!finished && frame_reader_next(&reader, &frame)) {
+            switch (frame.type) {
+            case MSG_STATE: {
+                StateView view;
+                if (decode_state(&frame, &view) == 0) {
+                    draw_state(&view);
+                }
                 break;
             }
-            // 내 턴 안내 및 타일 정보
-            else if (strstr(buffer, "당신의 차례입니다.") != NULL) {
-                char input[1024];
-                mvwprintw(input_win, 1, 1, "당신의 차례입니다. 좌표를 입력하세요 (예: 1 B 5): ");
-                wrefresh(input_win);
-                echo();
-                wgetnstr(input_win, input, sizeof(input) - 1);
-                noecho();
-                send(sock, input, strlen(input), 0);
-                werase(input_win);
-                box(input_win, 0, 0);
-                wrefresh(input_win);
-            }
-            // 다시 추측 여부
-            else if (strstr(buffer, "다시 추측하시겠습니까?") != NULL) {
-                char choice[3];
-                mvwprintw(input_win, 1, 1, "다시 추측하시겠습니까? (y/n): ");
-                wrefresh(input_win);
-                echo();
-                wgetnstr(input_win, choice, sizeof(choice) - 1);
-                noecho();
-                send(sock, choice, strlen(choice), 0);
-                werase(input_win);
-                box(input_win, 0, 0);
-                wrefresh(input_win);
-            }
-            // 승리/패배 메시지
-            else if (strstr(buffer, "게임 종료: 당신이 이겼습니다!") != NULL) {
-                sleep(3);
+            case MSG_INFO:
+                wprintw(output_win, "%.*s\n", (int)frame.length, (const char *)frame.payload);
+                wrefresh(output_win);
+                break;
+            case MSG_RESULT:
+                show_result(&frame);
+                break;
+            case MSG_PROMPT:
+                if (frame.length >= 1) {
+                    handle_prompt(frame.payload[0]);
+                }
+                break;
+            case MSG_GAME_OVER:
+                if (frame.length >= 1) {
+                    show_game_over(frame.payload[0]);
+                }
+                finished = 1;
                 break;
-            } else if (strstr(buffer, "게임 종료: 당신이 졌습니다!") != NULL) {
-                sleep(3);
+            default:
                 break;
             }
         }
@@ -1,24 +1,8 @@
+#include "davinci.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
 
-#define MAX_TILES 12
-#define MAX_PLAYERS 2
-#define TOTAL_TILES (MAX_TILES * 2)
-
-typedef struct {
-    int number;
-    char color;
-    int revealed;
-} Tile;
-
-typedef struct {
-    Tile tiles[MAX_TILES * 2];
-    int num_tiles;
-} Player;
-
-Tile deck[TOTAL_TILES];
-int deck_index = 0;
 /*
  * Լ: compare_tiles
  * :  Ÿ Ͽ   
@@ -37,60 +21,59 @@ int compare_tiles(const void *a, const void *b) {
 }
 /*
  * Լ: shuffle_deck
- * :   
- * Է: 
+ * :  seed  ( seed ׻   -> ̵    )
+ * Է:  , seed
  * : 
  */
-void shuffle_deck() {
-    srand((unsigned int)time(NULL));
+void shuffle_deck(Deck *deck, unsigned int seed) {
     for (int i = TOTAL_TILES - 1; i > 0; i--) {
-        int j = rand() % (i + 1);
-        Tile temp = deck[i];
-        deck[i] = deck[j];
-        deck[j] = temp;
+        int j = rand_r(&seed) % (i + 1);
+        Tile temp = deck->tiles[i];
+        deck->tiles[i] = deck->tiles[j];
+        deck->tiles[j] = temp;
     }
 }
 /*
  * Լ: initialize_game
  * :  ʱȭϰ ÷̾ Ÿ й
- * Է: ÷̾ 迭
+ * Է: ÷̾ 迭, ӿ  ,   seed
  * : 
  */
-void initialize_game(Player players[]) {
+void initialize_game(Player players[], Deck *deck, unsigned int seed) {
     int index = 0;
     //Ÿ 
     for (int i = 1; i <= MAX_TILES; i++) {
-        deck[index].number = i;
-        deck[index].color = 'B';
-        deck[index++].revealed = 0;
-        deck[index].number = i;
-        deck[index].color = 'W';
-        deck[index++].revealed = 0;
+        deck->tiles[index].number = i;
+        deck->tiles[index].color = 'B';
+        deck->tiles[index++].revealed = 0;
+        deck->tiles[index].number = i;
+        deck->tiles[index].color = 'W';
+        deck->tiles[index++].revealed = 0;
     }
     // 
-    shuffle_deck();
+    shuffle_deck(deck, seed);
     int tile_index = 0;
     for (int i = 0; i < MAX_PLAYERS; i++) {
         players[i].num_tiles = 4;
         for (int j = 0; j < players[i].num_tiles; j++) {
-            players[i].tiles[j] = deck[tile_index++];
+            players[i].tiles[j] = deck->tiles[tile_index++];
         }
         // Ÿ 
         qsort(players[i].tiles, players[i].num_tiles, sizeof(Tile), compare_tiles);
 
     }
-    deck_index = tile_index;
+    deck->index = tile_index;
 }
 
 /*
  * Լ: draw_tile
  * : ÷̾  ο Ÿ 
- * Է: Ÿ  ÷̾
+ * Է: Ÿ  ÷̾, 
  * : 
  */
-void draw_tile(Player *player) {
-    if (deck_index < TOTAL_TILES) {
-        player->tiles[player->num_tiles++] = deck[deck_index++];
+void draw_tile(Player *player, Deck *deck) {
+    if (deck->index < TOTAL_TILES) {
+        player->tiles[player->num_tiles++] = deck->tiles[deck->index++];
         qsort(player->tiles, player->num_tiles, sizeof(Tile), compare_tiles);
         printf("Drew a new tile!\n");
     } else {
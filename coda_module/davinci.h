@@ -16,9 +16,14 @@ typedef struct {
     int num_tiles;
 } Player;
 
+// 게임(세션)마다 따로 가지는 타일 더미
+typedef struct {
+    Tile tiles[TOTAL_TILES];
+    int index; // 다음에 뽑을 타일 위치
+} Deck;
 
-void initialize_game(Player players[]);
-void draw_tile(Player *player);
+void initialize_game(Player players[], Deck *deck, unsigned int seed);
+void draw_tile(Player *player, Deck *deck);
 int guess_tile(Player *opponent, int index, char color, int number);
 int check_win(Player *opponent);
 int compare_tiles(const void *a, const void *b);
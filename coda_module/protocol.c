@@ -0,0 +1,159 @@
+// protocol.c
+#include "protocol.h"
+#include "net.h"
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+// 헤더와 payload를 frame 하나로 묶음, 전체 길이 (payload가 너무 크면 0)
+static size_t encode_frame(uint8_t *frame, uint8_t type, const void *payload, uint16_t length) {
+    if (length > FRAME_MAX_PAYLOAD) {
+        return 0;
+    }
+    frame[0] = type;
+    frame[1] = (uint8_t)(length >> 8);
+    frame[2] = (uint8_t)(length & 0xff);
+    if (length > 0) {
+        memcpy(frame + FRAME_HEADER_SIZE, payload, length);
+    }
+    return FRAME_HEADER_SIZE + length;
+}
+
+/*
+ * 함수: send_frame
+ * 설명: 헤더와 payload를 하나의 버퍼로 묶어 끝까지 전송 (부분 전송 재시도)
+ * 입력: 소켓, 메시지 타입, payload, payload 길이
+ * 출력: 성공 0, 실패 -1
+ */
+int send_frame(int sock, uint8_t type, const void *payload, uint16_t length) {
+    uint8_t frame[FRAME_HEADER_SIZE + FRAME_MAX_PAYLOAD];
+    size_t len = encode_frame(frame, type, payload, length);
+    return len > 0 ? net_send_all(sock, frame, len) : -1;
+}
+
+// 서버용: 리액터 연결의 쓰기 큐로 보냄 (상대가 느려도 막히지 않음)
+int conn_send_frame(NetConn *conn, uint8_t type, const void *payload, uint16_t length) {
+    uint8_t frame[FRAME_HEADER_SIZE + FRAME_MAX_PAYLOAD];
+    size_t len = encode_frame(frame, type, payload, length);
+    return len > 0 ? net_conn_send(conn, frame, len) : -1;
+}
+
+int conn_send_frame_byte(NetConn *conn, uint8_t type, uint8_t value) {
+    return conn_send_frame(conn, type, &value, 1);
+}
+
+int conn_send_frame_text(NetConn *conn, const char *text) {
+    size_t len = strlen(text);
+    if (len > FRAME_MAX_PAYLOAD) {
+        len = FRAME_MAX_PAYLOAD;
+    }
+    return conn_send_frame(conn, MSG_INFO, text, (uint16_t)len);
+}
+
+// 1바이트 payload 프레임 전송 (PROMPT, GAME_OVER 등)
+int send_frame_byte(int sock, uint8_t type, uint8_t value) {
+    return send_frame(sock, type, &value, 1);
+}
+
+// 안내 문자열 프레임 전송
+int send_frame_text(int sock, const char *text) {
+    size_t len = strlen(text);
+    if (len > FRAME_MAX_PAYLOAD) {
+        len = FRAME_MAX_PAYLOAD;
+    }
+    return send_frame(sock, MSG_INFO, text, (uint16_t)len);
+}
+
+void frame_reader_init(FrameReader *reader) {
+    reader->len = 0;
+    reader->consumed = 0;
+}
+
+/*
+ * 함수: frame_reader_fill
+ * 설명: 이미 처리한 프레임을 버퍼 앞에서 밀어내고 소켓에서 한 번 더 읽음
+ * 입력: 리더, 소켓
+ * 출력: read 반환값 (0 = 연결 종료, -1 = 오류)
+ */
+ssize_t frame_reader_fill(FrameReader *reader, int sock) {
+    if (reader->consumed > 0) {
+        memmove(reader->buf, reader->buf + reader->consumed, reader->len - reader->consumed);
+        reader->len -= reader->consumed;
+        reader->consumed = 0;
+    }
+    if (reader->len == sizeof(reader->buf)) {
+        return -1; // 최대 프레임보다 큰 입력은 프로토콜 오류
+    }
+    ssize_t n;
+    do {
+        n = read(sock, reader->buf + reader->len, sizeof(reader->buf) - reader->len);
+    } while (n < 0 && errno == EINTR);
+    if (n > 0) {
+        reader->len += (size_t)n;
+    }
+    return n;
+}
+
+/*
+ * 함수: frame_reader_next
+ * 설명: 버퍼에 완성된 프레임이 있으면 하나 꺼냄 (헤더만 보고 O(1) 판단)
+ * 입력: 리더, 결과를 담을 프레임
+ * 출력: 프레임이 있으면 1, 더 읽어야 하면 0
+ */
+int frame_reader_next(FrameReader *reader, Frame *frame) {
+    const uint8_t *head = reader->buf + reader->consumed;
+    ssize_t total = net_frame_len16((const char *)head, reader->len - reader->consumed);
+    if (total <= 0) {
+        return 0;
+    }
+    frame->type = head[0];
+    frame->length = (uint16_t)(total - FRAME_HEADER_SIZE);
+    frame->payload = head + FRAME_HEADER_SIZE;
+    reader->consumed += (size_t)total;
+    return 1;
+}
+
+/*
+ * 함수: decode_state
+ * 설명: MSG_STATE payload를 화면 표시용 구조체로 변환
+ *       [내 차례 1][상대 타일 수 1][상대 타일 2*n][내 타일 수 1][내 타일 2*m]
+ *       타일 = [색상][숫자 (0 = 숨김, 0x80 비트 = 상대에게 공개됨)]
+ * 입력: 프레임, 결과 구조체
+ * 출력: 성공 0, 형식 오류 -1
+ */
+int decode_state(const Frame *frame, StateView *view) {
+    const uint8_t *p = frame->payload;
+    size_t remaining = frame->length;
+
+    if (remaining < 2) {
+        return -1;
+    }
+    view->my_turn = p[0];
+    view->opponent_count = p[1];
+    p += 2;
+    remaining -= 2;
+    if (view->opponent_count > STATE_MAX_TILES || remaining < (size_t)view->opponent_count * 2 + 1) {
+        return -1;
+    }
+    for (int i = 0; i < view->opponent_count; i++) {
+        view->opponent[i].color = (char)p[0];
+        view->opponent[i].number = p[1] & 0x7f;
+        view->opponent[i].revealed = view->opponent[i].number != 0;
+        p += 2;
+    }
+    remaining -= (size_t)view->opponent_count * 2;
+
+    view->my_count = p[0];
+    p++;
+    remaining--;
+    if (view->my_count > STATE_MAX_TILES || remaining < (size_t)view->my_count * 2) {
+        return -1;
+    }
+    for (int i = 0; i < view->my_count; i++) {
+        view->mine[i].color = (char)p[0];
+        view->mine[i].number = p[1] & 0x7f;
+        view->mine[i].revealed = (p[1] & 0x80) != 0;
+        p += 2;
+    }
+    return 0;
+}
@@ -0,0 +1,95 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include "net.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/*
+ * coda 서버 -> 클라이언트 메시지 프레임
+ * [타입 1바이트][payload 길이 2바이트(network order)][payload]
+ * 클라이언트는 한 번의 read에 여러 프레임이 붙어 오거나 잘려 와도
+ * FrameReader로 프레임 단위로 분리해서 처리한다.
+ */
+#define FRAME_HEADER_SIZE 3
+#define FRAME_MAX_PAYLOAD 1024
+#define FRAME_READER_SIZE ((FRAME_HEADER_SIZE + FRAME_MAX_PAYLOAD) * 4)
+#define STATE_MAX_TILES 24
+
+// 메시지 타입
+typedef enum {
+    MSG_STATE = 1,     // 타일 상태 스냅샷
+    MSG_PROMPT = 2,    // 입력 요청 (payload: PromptKind 1바이트)
+    MSG_RESULT = 3,    // 추측 결과 (payload: ResultCode [+ 뽑은 타일])
+    MSG_GAME_OVER = 4, // 게임 종료 (payload: GameOverReason 1바이트)
+    MSG_INFO = 5       // 안내 문자열 (payload: UTF-8 문자열)
+} MessageType;
+
+typedef enum {
+    PROMPT_JOIN = 1,       // 게임 참여 여부 (y/n)
+    PROMPT_TURN = 2,       // 추측 입력 (예: 1 B 5)
+    PROMPT_GUESS_AGAIN = 3 // 다시 추측 여부 (y/n)
+} PromptKind;
+
+typedef enum {
+    RESULT_CORRECT = 1,  // 정답
+    RESULT_WRONG = 2,    // 오답, payload[1..2]에 새로 뽑은 타일 (없으면 0)
+    RESULT_BAD_INPUT = 3 // 입력 형식 오류
+} ResultCode;
+
+typedef enum {
+    GAMEOVER_WIN = 1,
+    GAMEOVER_LOSE = 2,
+    GAMEOVER_DECLINED = 3,          // 본인이 게임을 거부
+    GAMEOVER_OPPONENT_DECLINED = 4, // 상대가 게임을 거부
+    GAMEOVER_OPPONENT_LEFT = 5,     // 상대가 연결 해제
+    GAMEOVER_TIMEOUT = 6,           // 응답 시간 초과로 기권/정리됨
+    GAMEOVER_OPPONENT_TIMEOUT = 7   // 상대가 시간 초과로 기권
+} GameOverReason;
+
+// 수신된 프레임 (payload는 다음 frame_reader 호출 전까지만 유효)
+typedef struct {
+    uint8_t type;
+    uint16_t length;
+    const uint8_t *payload;
+} Frame;
+
+typedef struct {
+    uint8_t buf[FRAME_READER_SIZE];
+    size_t len;      // 버퍼에 쌓인 바이트 수
+    size_t consumed; // 이미 프레임으로 꺼낸 바이트 수
+} FrameReader;
+
+// 타일 한 장의 화면 표시용 정보 (number 0 = 숨겨진 타일)
+typedef struct {
+    char color;
+    int number;
+    int revealed;
+} TileView;
+
+// MSG_STATE payload 디코딩 결과
+typedef struct {
+    int my_turn;
+    int opponent_count;
+    TileView opponent[STATE_MAX_TILES];
+    int my_count;
+    TileView mine[STATE_MAX_TILES];
+} StateView;
+
+int send_frame(int sock, uint8_t type, const void *payload, uint16_t length);
+int send_frame_byte(int sock, uint8_t type, uint8_t value);
+int send_frame_text(int sock, const char *text);
+
+// 서버용 (NetReactor 연결의 쓰기 큐에 넣음), 끊긴 연결이면 -1
+int conn_send_frame(NetConn *conn, uint8_t type, const void *payload, uint16_t length);
+int conn_send_frame_byte(NetConn *conn, uint8_t type, uint8_t value);
+int conn_send_frame_text(NetConn *conn, const char *text);
+
+void frame_reader_init(FrameReader *reader);
+ssize_t frame_reader_fill(FrameReader *reader, int sock);
+int frame_reader_next(FrameReader *reader, Frame *frame);
+
+int decode_state(const Frame *frame, StateView *view);
+
+#endif
@@ -1,274 +1,717 @@
 // server.c
+#include "arena.h"
 #include "davinci.h"
+#include "movelog.h"
+#include "net.h"
+#include "protocol.h"
+#include "replay.h"
+#include "timer_wheel.h"
 #include <arpa/inet.h>
-#include <pthread.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 
 #define PORT 8080
+#define LOCAL_SOCKET "@davinci_code.server" // 같은 컴퓨터의 클라이언트용 추상 Unix 소켓
 #define MAX_PLAYERS 2
 
+// 세션 타임아웃 (초)
+#define LOBBY_TIMEOUT 300   // 상대 플레이어 접속 대기
+#define JOIN_TIMEOUT 30     // 게임 참여 여부 응답
+#define TURN_TIMEOUT 60     // 한 턴의 추측 입력
+#define MAX_MISSED_TURNS 2  // 연속 시간 초과 시 기권 처리
+#define DEADLINE_TICK_MS 100 // 마감 시간 타이머 휠의 틱
+
+// 플레이어가 지금 기다리는 입력 (ClientData.phase)
+#define PHASE_LOBBY 0 // 상대 플레이어 접속 대기 (입력은 버림)
+#define PHASE_JOIN 1  // 게임 참여 여부 응답
+#define PHASE_READY 2 // 참여했고 상대의 응답을 기다림
+#define PHASE_TURN 3  // 내 차례의 추측 입력
+#define PHASE_AGAIN 4 // 정답 후 다시 추측할지 응답
+#define PHASE_WAIT 5  // 상대 차례 (입력은 버림)
+#define PHASE_DONE 6  // 게임이 끝나 연결을 닫는 중
+
+// 이동 기록 종류 (MOVE_START / MOVE_END는 movelog.h 공통)
+#define MOVE_GUESS 16    // arg: 위치, 색상, 숫자, 정답 여부 (오답이면 타일을 뽑고 턴 넘김)
+#define MOVE_PASS 17     // 시간 초과로 타일을 뽑고 턴 넘김
+#define MOVE_END_TURN 18 // 정답 후 턴 넘김
+#define MAX_RECOVERED 32
+
+// 세션 아레나 청크 크기 (세션과 두 플레이어의 ClientData가 한 청크에 들어감)
+#define SESSION_ARENA_SIZE 4096
+
+/*
+ * 모든 세션을 리액터 스레드 하나가 처리한다 (공용 NetReactor, 마감 시간은 타이머 휠).
+ * 플레이어마다 지금 기다리는 입력(phase)과 마감 타이머가 하나씩 있고,
+ * 입력이나 마감이 오면 그 자리에서 게임을 진행해 두 플레이어에게 바로 보낸다.
+ * 상대 소켓에 쓰는 것도 쓰기 큐로 들어가므로 느린 플레이어가 다른 테이블을 막지 않는다.
+ * 세션과 ClientData는 세션 아레나에서 할당하고, 마지막 연결이 닫힐 때 아레나째 해제한다.
+ */
+typedef struct ClientData ClientData;
+
 typedef struct {
-    int socket;
+    Player players[MAX_PLAYERS];
+    Deck deck;
+    ClientData *clients[MAX_PLAYERS]; // 연결이 남아 있는 플레이어 (닫히면 NULL)
+    int ready[MAX_PLAYERS];
+    int missed_turns[MAX_PLAYERS];
+    int result[MAX_PLAYERS]; // 게임 종료 시 각 플레이어에게 보낼 GameOverReason
+    int seated;
+    int active; // 아직 닫히지 않은 연결 수
+    int current_turn;
+    int game_over;
+    uint32_t id;
+    uint32_t seed;  // 덱을 섞은 seed (이동 기록과 함께 게임을 재현)
+    MoveLog *log;   // 게임이 시작된 뒤에만 열림
+    int recovered;  // 서버 재시작 후 이동 기록으로 복구한 세션
+    Arena *arena;   // 세션이 쓰는 메모리 전체 (세션 구조체 자신 포함)
+    // 끝난 게임의 기록과 결과 (마지막 연결이 닫힐 때 리플레이로 옮김)
+    MoveLog *ended_log;
+    uint8_t ended_winner;
+    uint8_t ended_reason;
+} Session;
+
+struct ClientData {
+    NetConn *conn;
     int player_id;
-} ClientData;
-
-Player players[MAX_PLAYERS];
-int player_count = 0;
-int current_turn = 0;
-pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
-pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
-int client_sockets[MAX_PLAYERS];
-int ready[MAX_PLAYERS] = {0};
-int compare_tiles(const void *a, const void *b);
+    int phase;
+    TimerEntry deadline; // phase의 마감 시간
+    Session *session;
+};
+
+NetReactor reactor;
+TimerWheel deadlines; // 플레이어별 마감 시간 (리액터 루프가 진행)
+
+// 두 번째 플레이어를 기다리는 세션
+Session *waiting_session = NULL;
+uint32_t session_counter = 0;
+
+// 재시작 후 복구되어 다시 접속할 플레이어를 기다리는 세션
+Session *recovered_sessions[MAX_RECOVERED];
+int recovered_count = 0;
+
+void prompt_turn(Session *session);
+void on_deadline(void *arg);
+
 /*
- * 함수: handle_client
- * 설명: 클라이언트 연결을 처리하며, 게임 진행을 제어
- * 입력: ClientData 구조체
+ * 함수: create_session
+ * 설명: 새 테이블을 만들고 seed로 타일을 분배
+ * 입력: 세션 번호, 덱 seed
+ * 출력: 세션 포인터 (실패 시 NULL)
+ */
+Session *create_session(uint32_t id, uint32_t seed) {
+    Arena *arena = arena_create(SESSION_ARENA_SIZE);
+    Session *session = arena ? arena_zalloc(arena, sizeof(Session)) : NULL;
+    if (!session) {
+        perror("세션 메모리 할당 실패");
+        arena_destroy(arena);
+        return NULL;
+    }
+    session->arena = arena;
+    session->id = id;
+    session->seed = seed;
+    initialize_game(session->players, &session->deck, seed);
+    return session;
+}
+
+/*
+ * 함수: start_session_log
+ * 설명: 두 플레이어가 모두 준비되면 이동 기록을 열고 시작을 기록
+ *       기록을 못 열어도 게임은 그대로 진행 (복구만 안 됨)
+ * 입력: 세션
  * 출력: 없음
  */
-void *handle_client(void *arg) {
-    ClientData *client_data = (ClientData *)arg;
-    int client_socket = client_data->socket;
+void start_session_log(Session *session) {
+    if (session->log || session->recovered) {
+        return;
+    }
+    session->log = movelog_create(MOVELOG_GAME_CODA, session->id, session->seed);
+    movelog_append(session->log, 0, MOVE_START, NULL, 0);
+}
+
+/*
+ * 함수: log_guess
+ * 설명: 추측 한 번을 이동 기록에 남김 (범위를 벗어난 값은 절대 맞지 않는 0으로 저장)
+ * 입력: 세션, 플레이어 번호, 위치, 색상, 숫자, 정답 여부
+ * 출력: 없음
+ */
+void log_guess(Session *session, int player_id, int index, char color, int number, int correct) {
+    uint8_t arg[4];
+    arg[0] = (index >= 0 && index <= 0xff) ? (uint8_t)index : 0;
+    arg[1] = (uint8_t)color;
+    arg[2] = (number >= 0 && number <= 0xff) ? (uint8_t)number : 0;
+    arg[3] = (uint8_t)correct;
+    movelog_append(session->log, (uint8_t)player_id, MOVE_GUESS, arg, sizeof(arg));
+}
+
+/*
+ * 함수: coda_turn_ends
+ * 설명: 리플레이 턴 구분 (오답, 시간 초과, 정답 후 턴 넘김이면 턴 끝)
+ * 입력: 이동 기록
+ * 출력: 턴이 끝나면 1
+ */
+int coda_turn_ends(const MoveRecord *record) {
+    return record->kind == MOVE_PASS || record->kind == MOVE_END_TURN ||
+           (record->kind == MOVE_GUESS && !record->arg[3]);
+}
+
+/*
+ * 함수: set_phase
+ * 설명: 플레이어가 기다리는 입력을 바꾸고 마감 시간을 새로 잡음
+ * 입력: ClientData, PHASE_* 값, 제한 시간(초, 0이면 마감 없음)
+ * 출력: 없음
+ */
+void set_phase(ClientData *client_data, int phase, int timeout) {
+    client_data->phase = phase;
+    if (timeout > 0) {
+        timer_wheel_schedule(&deadlines, &client_data->deadline, (unsigned)timeout * 1000);
+    } else {
+        timer_wheel_cancel(&deadlines, &client_data->deadline);
+    }
+}
+
+/*
+ * 함수: finish_session
+ * 설명: 게임 종료 상태로 표시하고, 남아 있는 플레이어에게 결과를 보낸 뒤 연결을 닫음
+ *       리플레이 파일은 마지막 연결이 닫힐 때 leave_session이 씀
+ * 입력: 세션, 기준 플레이어, 기준 플레이어 결과, 상대 결과
+ * 출력: 없음
+ */
+void finish_session(Session *session, int player_id, int my_result, int opponent_result) {
+    if (session->game_over) {
+        return;
+    }
+    session->game_over = 1;
+    session->result[player_id] = my_result;
+    session->result[1 - player_id] = opponent_result;
+    if (waiting_session == session) {
+        waiting_session = NULL;
+    }
+
+    // 끝을 기록하고 리플레이에 쓸 결과를 남겨 둠
+    if (session->log) {
+        uint8_t reason = (uint8_t)my_result;
+        movelog_append(session->log, (uint8_t)player_id, MOVE_END, &reason, 1);
+        // 기권, 시간 초과, 연결 해제는 상대의 승리
+        session->ended_winner = (uint8_t)(my_result == GAMEOVER_WIN ? player_id : 1 - player_id);
+        session->ended_reason = reason;
+        session->ended_log = session->log;
+        session->log = NULL;
+    }
+
+    // 결과는 쓰기 큐를 다 보낸 뒤에 닫으므로 마지막 메시지까지 전달됨
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        ClientData *client_data = session->clients[i];
+        if (client_data) {
+            set_phase(client_data, PHASE_DONE, 0);
+            conn_send_frame_byte(client_data->conn, MSG_GAME_OVER, (uint8_t)session->result[i]);
+            net_conn_close_flush(client_data->conn);
+        }
+    }
+}
+
+/*
+ * 함수: leave_session
+ * 설명: 연결이 닫힌 플레이어를 세션에서 뺌. 마지막 연결이면 끝난 게임의 리플레이를 쓰고 세션 아레나를 한 번에 해제
+ *       (client_data도 아레나에 있으므로 해제 뒤에는 쓰지 않음)
+ * 입력: ClientData
+ * 출력: 없음
+ */
+void leave_session(ClientData *client_data) {
+    Session *session = client_data->session;
     int player_id = client_data->player_id;
-    client_sockets[player_id] = client_socket;
-    char buffer[1024] = {0};
-    int valread;
-
-    // 플레이어 대기(최대 2명)
-    pthread_mutex_lock(&lock);
-    while (player_count < MAX_PLAYERS) {
-        pthread_cond_wait(&cond, &lock);
-    }
-    pthread_mutex_unlock(&lock);
-
-    // 게임 참여 여부 확인
-    while (1) {
-        send(client_socket, "게임에 참여하시겠습니까? (y/n): \n", strlen("게임에 참여하시겠습니까? (y/n): \n"), 0);
-        valread = read(client_socket, buffer, 1024);
-        if (valread > 0) {
-            buffer[valread] = '\0';
-            // 레디 상태
-            if (buffer[0] == 'y' || buffer[0] == 'Y') {
-                ready[player_id] = 1;
-                send(client_socket, "다른 플레이어를 기다리는 중입니다...\n", strlen("다른 플레이어를 기다리는 중입니다...\n"), 0);
-            } else {
-                // 게임을 종료한 경우
-                ready[player_id] = -1;
-                send(client_socket, "게임을 거부하셨습니다. 연결을 종료합니다...\n", strlen("게임을 거부하셨습니다. 연결을 종료합니다...\n"), 0);
-                // 상대에게 게임이 종료되었다고 알림
-                pthread_mutex_lock(&lock);
-                int opponent_socket = client_sockets[1 - player_id];
-                if (ready[1 - player_id] != -1) {
-                    send(opponent_socket, "상대 플레이어가 게임을 거부하여 연결을 종료합니다...\n", strlen("상대 플레이어가 게임을 거부하여 연결을 종료합니다...\n"), 0);
-                    close(opponent_socket);
-                }
-                pthread_mutex_unlock(&lock);
-
-                close(client_socket);
-                free(client_data);
-                return NULL;
-            }
+
+    timer_wheel_cancel(&deadlines, &client_data->deadline);
+    session->clients[player_id] = NULL;
+    if (client_data->phase == PHASE_JOIN) {
+        // 참여 여부에 답하지 않고 나가면 거부로 봄
+        session->ready[player_id] = -1;
+        finish_session(session, player_id, GAMEOVER_DECLINED, GAMEOVER_OPPONENT_DECLINED);
+    } else {
+        // 게임 도중 빠지는 경우 상대에게는 연결 해제로 알림
+        finish_session(session, player_id, GAMEOVER_OPPONENT_LEFT, GAMEOVER_OPPONENT_LEFT);
+    }
+
+    if (--session->active == 0) {
+        // 끝난 게임은 리플레이로 옮기고 복구용 기록은 지움
+        if (session->ended_log) {
+            uint8_t rules[REPLAY_RULES_SIZE] = {MAX_TILES, 4, TURN_TIMEOUT, MAX_MISSED_TURNS};
+            replay_write_from_log(movelog_path(session->ended_log), rules, session->ended_winner,
+                                  session->ended_reason, coda_turn_ends);
+            movelog_close(session->ended_log, 1);
         }
+        movelog_close(session->log, 1);
+        arena_destroy(session->arena);
+        printf("세션이 종료되어 테이블을 정리했습니다.\n");
+    }
+}
+
+/*
+ * 함수: send_state
+ * 설명: 타일 상태 스냅샷을 MSG_STATE 프레임으로 전송
+ *       상대 타일은 공개된 것만 숫자를 보내고, 내 타일은 공개 여부 비트를 붙임
+ * 입력: ClientData, 내 차례 여부
+ * 출력: conn_send_frame 결과
+ */
+int send_state(ClientData *client_data, int my_turn) {
+    uint8_t payload[3 + STATE_MAX_TILES * 4];
+    size_t len = 0;
+    Session *session = client_data->session;
+    Player *me = &session->players[client_data->player_id];
+    Player *opponent = &session->players[1 - client_data->player_id];
+
+    payload[len++] = (uint8_t)my_turn;
+    payload[len++] = (uint8_t)opponent->num_tiles;
+    for (int i = 0; i < opponent->num_tiles; i++) {
+        payload[len++] = (uint8_t)opponent->tiles[i].color;
+        payload[len++] = opponent->tiles[i].revealed ? (uint8_t)opponent->tiles[i].number : 0;
+    }
+    payload[len++] = (uint8_t)me->num_tiles;
+    for (int i = 0; i < me->num_tiles; i++) {
+        payload[len++] = (uint8_t)me->tiles[i].color;
+        payload[len++] = (uint8_t)(me->tiles[i].number | (me->tiles[i].revealed ? 0x80 : 0));
+    }
+    return conn_send_frame(client_data->conn, MSG_STATE, payload, (uint16_t)len);
+}
 
-        // 플레이어 준비상태 확인
-        pthread_mutex_lock(&lock);
-        if (ready[0] == 1 && ready[1] == 1) {
-            pthread_cond_broadcast(&cond);
-            pthread_mutex_unlock(&lock);
-            break;
+/*
+ * 함수: pass_turn
+ * 설명: 오답 또는 시간 초과 시 타일을 한 장 뽑고 턴을 넘김
+ * 입력: 세션, 플레이어 번호, 뽑은 타일을 담을 버퍼 (색상, 숫자 / 못 뽑으면 0)
+ * 출력: 없음
+ */
+void pass_turn(Session *session, int player_id, uint8_t drawn[2]) {
+    Player *me = &session->players[player_id];
+    int before = me->num_tiles;
+    draw_tile(me, &session->deck);
+    drawn[0] = 0;
+    drawn[1] = 0;
+    if (me->num_tiles > before) {
+        // 정렬 후에는 위치가 바뀌므로 덱에서 방금 뽑은 타일을 확인
+        drawn[0] = (uint8_t)session->deck.tiles[session->deck.index - 1].color;
+        drawn[1] = (uint8_t)session->deck.tiles[session->deck.index - 1].number;
+    }
+    session->current_turn = (session->current_turn + 1) % MAX_PLAYERS;
+}
+
+/*
+ * 함수: prompt_player
+ * 설명: 차례인 플레이어에게 타일 상태를 보내고 추측을 다시 요청
+ * 입력: ClientData
+ * 출력: 없음
+ */
+void prompt_player(ClientData *client_data) {
+    send_state(client_data, 1);
+    conn_send_frame_byte(client_data->conn, MSG_PROMPT, PROMPT_TURN);
+    set_phase(client_data, PHASE_TURN, TURN_TIMEOUT);
+}
+
+/*
+ * 함수: prompt_turn
+ * 설명: 턴이 바뀌면 두 플레이어에게 타일 상태를 보내고, 차례인 플레이어에게 추측을 요청
+ * 입력: 세션
+ * 출력: 없음
+ */
+void prompt_turn(Session *session) {
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        ClientData *client_data = session->clients[i];
+        if (!client_data) {
+            continue;
         }
-        if (ready[0] == -1 || ready[1] == -1) {
-            pthread_mutex_unlock(&lock);
-            close(client_socket);
-            free(client_data);
-            return NULL;
+        if (session->current_turn == i) {
+            prompt_player(client_data);
+        } else {
+            send_state(client_data, 0);
+            set_phase(client_data, PHASE_WAIT, 0);
         }
-        pthread_mutex_unlock(&lock);
     }
-    /*
-     * 함수: 게임 시작
-     * 설명: 모든 플레이어가 준비된 후 게임을 시작
-     * 입력: 없음
-     * 출력: 클라이언트에게 게임 시작 메시지 전송
-     */
-    if (player_id == 0) {
-        send(client_socket, "게임 시작! 당신은 플레이어 1입니다.\n", strlen("게임 시작! 당신은 플레이어 1입니다.\n"), 0);
+}
+
+/*
+ * 함수: end_turn
+ * 설명: 정답을 맞힌 플레이어가 그만 추측하면 (또는 응답하지 않으면) 턴을 넘김
+ * 입력: ClientData
+ * 출력: 없음
+ */
+void end_turn(ClientData *client_data) {
+    Session *session = client_data->session;
+    movelog_append(session->log, (uint8_t)client_data->player_id, MOVE_END_TURN, NULL, 0);
+    session->current_turn = (session->current_turn + 1) % MAX_PLAYERS;
+    prompt_turn(session);
+}
+
+/*
+ * 함수: handle_turn_timeout
+ * 설명: 턴 마감 시간이 지나면 자동으로 턴을 넘기고, 연속으로 놓치면 기권 처리
+ * 입력: ClientData
+ * 출력: 없음
+ */
+void handle_turn_timeout(ClientData *client_data) {
+    Session *session = client_data->session;
+    int player_id = client_data->player_id;
+
+    session->missed_turns[player_id]++;
+    if (session->missed_turns[player_id] >= MAX_MISSED_TURNS) {
+        printf("플레이어 %d: 연속 시간 초과로 기권 처리\n", player_id + 1);
+        finish_session(session, player_id, GAMEOVER_TIMEOUT, GAMEOVER_OPPONENT_TIMEOUT);
+        return;
+    }
+    movelog_append(session->log, (uint8_t)player_id, MOVE_PASS, NULL, 0);
+    uint8_t drawn[2];
+    pass_turn(session, player_id, drawn);
+
+    printf("플레이어 %d: 턴 시간 초과, 자동으로 턴을 넘김\n", player_id + 1);
+    conn_send_frame_text(client_data->conn, "시간이 초과되어 타일을 한 장 뽑고 턴이 넘어갑니다.");
+    prompt_turn(session);
+}
+
+/*
+ * 함수: start_game
+ * 설명: 모든 플레이어가 준비된 후 게임 시작 메시지를 보내고 첫 턴을 진행
+ * 입력: 세션
+ * 출력: 없음
+ */
+void start_game(Session *session) {
+    char message[64];
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        if (session->clients[i]) {
+            snprintf(message, sizeof(message), "게임 시작! 당신은 플레이어 %d입니다.", i + 1);
+            conn_send_frame_text(session->clients[i]->conn, message);
+        }
+    }
+    prompt_turn(session);
+}
+
+/*
+ * 함수: begin_join
+ * 설명: 테이블이 차면 게임 참여 여부를 물음 (복구된 세션은 이미 둘 다 참여한 상태)
+ * 입력: ClientData
+ * 출력: 없음
+ */
+void begin_join(ClientData *client_data) {
+    if (client_data->session->recovered) {
+        conn_send_frame_text(client_data->conn, "서버가 재시작되어 진행 중이던 게임을 이어갑니다.");
+        set_phase(client_data, PHASE_READY, 0);
     } else {
-        send(client_socket, "게임 시작! 당신은 플레이어 2입니다.\n", strlen("게임 시작! 당신은 플레이어 2입니다.\n"), 0);
+        conn_send_frame_byte(client_data->conn, MSG_PROMPT, PROMPT_JOIN);
+        set_phase(client_data, PHASE_JOIN, JOIN_TIMEOUT);
     }
-    /*
-     * 함수: 게임 진행
-     * 설명: 각 플레이어의 턴을 관리, 타일 추측과 관련된 로직 실행
-     * 입력: 클라이언트로부터 받은 메시지
-     * 출력: 게임 상태에 따른 처리
-     */
-    // 게임 진행 루프
-    while (1) {
-        pthread_mutex_lock(&lock);
-        int my_turn = (current_turn == player_id);
-        pthread_mutex_unlock(&lock);
-
-        // 타일 정보 구성
-        char tile_info[2048] = "상대의 타일: ";
-        for (int i = 0; i < players[1 - player_id].num_tiles; i++) {
-            if (players[1 - player_id].tiles[i].revealed) {
-                char tile[10];
-                sprintf(tile, "[%c%d] ", players[1 - player_id].tiles[i].color, players[1 - player_id].tiles[i].number);
-                strcat(tile_info, tile);
-            } else {
-                char tile[10];
-                sprintf(tile, "[%c?] ", players[1 - player_id].tiles[i].color);
-                strcat(tile_info, tile);
-            }
+}
+
+/*
+ * 함수: handle_join
+ * 설명: 게임 참여 응답 처리, 두 플레이어가 모두 참여하면 게임 시작
+ *       상대의 응답 마감은 상대의 타이머가 처리하므로 기다리는 쪽은 마감 없이 둠
+ * 입력: ClientData, 입력
+ * 출력: 없음
+ */
+void handle_join(ClientData *client_data, const char *buffer) {
+    Session *session = client_data->session;
+    int player_id = client_data->player_id;
+
+    if (buffer[0] != 'y' && buffer[0] != 'Y') {
+        // 게임을 거부한 경우
+        session->ready[player_id] = -1;
+        finish_session(session, player_id, GAMEOVER_DECLINED, GAMEOVER_OPPONENT_DECLINED);
+        return;
+    }
+    // 레디 상태
+    session->ready[player_id] = 1;
+    conn_send_frame_text(client_data->conn, "다른 플레이어를 기다리는 중입니다...");
+    set_phase(client_data, PHASE_READY, 0);
+    if (session->ready[1 - player_id] == 1) {
+        start_session_log(session);
+        start_game(session);
+    }
+}
+
+/*
+ * 함수: handle_guess
+ * 설명: 차례인 플레이어의 추측 처리 (정답이면 다시 추측할지 묻고, 오답이면 타일을 뽑고 턴을 넘김)
+ * 입력: ClientData, 입력 (예: 1 B 5)
+ * 출력: 없음
+ */
+void handle_guess(ClientData *client_data, const char *buffer) {
+    Session *session = client_data->session;
+    int player_id = client_data->player_id;
+    printf("플레이어 %d: %s\n", player_id + 1, buffer);
+
+    // 입력 파싱
+    int guess_index, guess_number;
+    char guess_color;
+    if (sscanf(buffer, "%d %c %d", &guess_index, &guess_color, &guess_number) != 3) {
+        conn_send_frame_byte(client_data->conn, MSG_RESULT, RESULT_BAD_INPUT);
+        prompt_player(client_data);
+        return;
+    }
+
+    session->missed_turns[player_id] = 0;
+    int result = guess_tile(&session->players[1 - player_id], guess_index, guess_color, guess_number);
+    log_guess(session, player_id, guess_index, guess_color, guess_number, result);
+    if (!result) {
+        uint8_t wrong[3] = {RESULT_WRONG, 0, 0};
+        pass_turn(session, player_id, wrong + 1);
+        conn_send_frame(client_data->conn, MSG_RESULT, wrong, sizeof(wrong));
+        prompt_turn(session);
+        return;
+    }
+
+    conn_send_frame_byte(client_data->conn, MSG_RESULT, RESULT_CORRECT);
+    if (check_win(&session->players[1 - player_id])) {
+        send_state(client_data, 1);
+        finish_session(session, player_id, GAMEOVER_WIN, GAMEOVER_LOSE);
+        return;
+    }
+    conn_send_frame_byte(client_data->conn, MSG_PROMPT, PROMPT_GUESS_AGAIN);
+    set_phase(client_data, PHASE_AGAIN, TURN_TIMEOUT);
+}
+
+/*
+ * 함수: client_message
+ * 설명: 클라이언트 입력을 지금 기다리는 응답으로 처리 (기다리지 않을 때 온 입력은 버림)
+ * 입력: 연결, 입력, 길이
+ * 출력: 없음
+ */
+void client_message(NetConn *conn, char *data, size_t len) {
+    (void)len;
+    ClientData *client_data = conn->user;
+    switch (client_data->phase) {
+    case PHASE_JOIN:
+        handle_join(client_data, data);
+        break;
+    case PHASE_TURN:
+        handle_guess(client_data, data);
+        break;
+    case PHASE_AGAIN:
+        // n이면 턴을 넘기고, 그 밖에는 다시 추측
+        if (data[0] == 'n' || data[0] == 'N') {
+            end_turn(client_data);
+        } else {
+            prompt_player(client_data);
+        }
+        break;
+    }
+}
+
+/*
+ * 함수: on_deadline
+ * 설명: 플레이어의 마감 시간이 지났을 때 지금 기다리던 입력에 맞게 처리
+ * 입력: ClientData
+ * 출력: 없음
+ */
+void on_deadline(void *arg) {
+    ClientData *client_data = arg;
+    Session *session = client_data->session;
+    int player_id = client_data->player_id;
+
+    switch (client_data->phase) {
+    case PHASE_LOBBY:
+        printf("플레이어 %d: 상대 대기 중 시간 초과\n", player_id + 1);
+        finish_session(session, player_id, GAMEOVER_TIMEOUT, GAMEOVER_OPPONENT_LEFT);
+        break;
+    case PHASE_JOIN:
+        session->ready[player_id] = -1;
+        finish_session(session, player_id, GAMEOVER_TIMEOUT, GAMEOVER_OPPONENT_DECLINED);
+        break;
+    case PHASE_TURN:
+        handle_turn_timeout(client_data);
+        break;
+    case PHASE_AGAIN:
+        // 응답이 없으면 턴을 넘김
+        end_turn(client_data);
+        break;
+    }
+}
+
+void client_closed(NetConn *conn) {
+    leave_session(conn->user);
+}
+
+// 클라이언트는 응답마다 send를 한 번 부르므로 한 번에 읽은 입력을 응답 하나로 봄
+ssize_t frame_answer(const char *data, size_t len) {
+    (void)data;
+    return (ssize_t)len;
+}
+
+/*
+ * 함수: seat_player
+ * 설명: 새 연결을 대기 중인 테이블에 앉히고, 테이블이 없으면 새로 만듦 (리액터의 accept 콜백)
+ *       테이블이 차면 두 플레이어에게 참여 여부를 물음
+ * 입력: 리액터, 클라이언트 소켓, 사용하지 않음
+ * 출력: 없음
+ */
+void seat_player(NetReactor *r, int client_socket, void *arg) {
+    (void)arg;
+    if (waiting_session == NULL && recovered_count > 0) {
+        // 복구된 게임부터 먼저 채움
+        waiting_session = recovered_sessions[--recovered_count];
+    }
+    if (waiting_session == NULL) {
+        uint32_t id = ++session_counter;
+        waiting_session = create_session(id, (uint32_t)time(NULL) ^ (id * 2654435761u));
+    }
+    Session *session = waiting_session;
+    ClientData *client_data = session ? arena_zalloc(session->arena, sizeof(ClientData)) : NULL;
+    if (client_data) {
+        client_data->conn = net_conn_open(r, client_socket, frame_answer, client_message, client_closed, client_data);
+    }
+    if (client_data == NULL || client_data->conn == NULL) {
+        close(client_socket);
+        return;
+    }
+    printf("새로운 연결이 수락되었습니다.\n");
+
+    int player_id = session->seated++;
+    client_data->player_id = player_id;
+    client_data->session = session;
+    timer_entry_init(&client_data->deadline, on_deadline, client_data);
+    session->clients[player_id] = client_data;
+    session->active++;
+    if (session->seated < MAX_PLAYERS) {
+        set_phase(client_data, PHASE_LOBBY, LOBBY_TIMEOUT);
+        return;
+    }
+
+    // 테이블이 찼으면 로비에서 내리고 참여 여부를 물음
+    waiting_session = NULL;
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        if (session->clients[i]) {
+            begin_join(session->clients[i]);
         }
-        strcat(tile_info, "\n당신의 타일: ");
-        for (int i = 0; i < players[player_id].num_tiles; i++) {
-            char tile[10];
-            sprintf(tile, "[%c%d] ", players[player_id].tiles[i].color, players[player_id].tiles[i].number);
-            strcat(tile_info, tile);
+    }
+    if (session->recovered) {
+        start_game(session);
+    }
+}
+
+/*
+ * 함수: replay_move
+ * 설명: 이동 기록 한 건을 세션 상태에 다시 적용 (handle_guess와 같은 규칙)
+ * 입력: 세션, 기록
+ * 출력: 없음
+ */
+void replay_move(Session *session, const MoveRecord *record) {
+    int player_id = record->player % MAX_PLAYERS;
+    switch (record->kind) {
+    case MOVE_GUESS:
+        session->missed_turns[player_id] = 0;
+        guess_tile(&session->players[1 - player_id], record->arg[0], (char)record->arg[1], record->arg[2]);
+        if (!record->arg[3]) {
+            draw_tile(&session->players[player_id], &session->deck);
+            session->current_turn = (session->current_turn + 1) % MAX_PLAYERS;
         }
-        if (my_turn) {
-            strcat(tile_info, "\n당신의 차례입니다.\n");
-            send(client_socket, tile_info, strlen(tile_info), 0);
-
-            // 입력 받기
-            int valread = read(client_socket, buffer, 1024);
-            if (valread <= 0) {
-                // 연결 종료 처리
-                pthread_mutex_lock(&lock);
-                int opponent_socket = client_sockets[1 - player_id];
-                send(opponent_socket, "상대 플레이어가 연결을 해제하여 게임을 종료합니다...\n", strlen("상대 플레이어가 연결을 해제하여 게임을 종료합니다...\n"), 0);
-                close(opponent_socket);
-                pthread_mutex_unlock(&lock);
-                close(client_socket);
-                free(client_data);
-                return NULL;
-            }
-            buffer[valread] = '\0';
-            printf("플레이어 %d: %s\n", player_id + 1, buffer);
-
-            // 입력 파싱
-            int guess_index, guess_number;
-            char guess_color;
-            if (sscanf(buffer, "%d %c %d", &guess_index, &guess_color, &guess_number) != 3) {
-                send(client_socket, "입력 형식이 올바르지 않습니다. 예: 1 B 5\n", strlen("입력 형식이 올바르지 않습니다. 예: 1 B 5\n"), 0);
-                continue;
-            }
+        break;
+    case MOVE_PASS:
+        session->missed_turns[player_id]++;
+        draw_tile(&session->players[player_id], &session->deck);
+        session->current_turn = (session->current_turn + 1) % MAX_PLAYERS;
+        break;
+    case MOVE_END_TURN:
+        session->current_turn = (session->current_turn + 1) % MAX_PLAYERS;
+        break;
+    }
+}
 
-            int result = guess_tile(&players[1 - player_id], guess_index, guess_color, guess_number);
-            if (result) {
-                send(client_socket, "정답입니다!\n", strlen("정답입니다!\n"), 0);
-                if (check_win(&players[1 - player_id])) {
-                    send(client_socket, "게임 종료: 당신이 이겼습니다!\n", strlen("게임 종료: 당신이 이겼습니다!\n"), 0);
-                    int opponent_socket = client_sockets[1 - player_id];
-                    send(opponent_socket, "게임 종료: 당신이 졌습니다!\n", strlen("게임 종료: 당신이 졌습니다!\n"), 0);
-                    close(client_socket);
-                    close(opponent_socket);
-                    free(client_data);
-                    return NULL;
-                }
-                send(client_socket, "다시 추측하시겠습니까? (y/n): \n", strlen("다시 추측하시겠습니까? (y/n): \n"), 0);
-                valread = read(client_socket, buffer, 1024);
-                if (valread > 0 && (buffer[0] == 'n' || buffer[0] == 'N')) {
-                    pthread_mutex_lock(&lock);
-                    current_turn = (current_turn + 1) % MAX_PLAYERS;
-                    pthread_cond_broadcast(&cond);
-                    pthread_mutex_unlock(&lock);
-                }
-            } else {
-                send(client_socket, "틀렸습니다. 새로운 타일을 뽑습니다.\n", strlen("틀렸습니다. 새로운 타일을 뽑습니다.\n"), 0);
-                draw_tile(&players[player_id]);
-                char draw_msg[100];
-                sprintf(draw_msg, "새로 뽑은 타일: [%c%d]\n", players[player_id].tiles[players[player_id].num_tiles - 1].color, players[player_id].tiles[players[player_id].num_tiles - 1].number);
-                send(client_socket, draw_msg, strlen(draw_msg), 0);
-
-                pthread_mutex_lock(&lock);
-                current_turn = (current_turn + 1) % MAX_PLAYERS;
-                pthread_cond_broadcast(&cond);
-                pthread_mutex_unlock(&lock);
-            }
-        } else {
-            strcat(tile_info, "\n상대방의 차례입니다. 잠시 기다려주세요.\n");
-            send(client_socket, tile_info, strlen(tile_info), 0);
-            sleep(1);
+/*
+ * 함수: recover_sessions
+ * 설명: 서버가 죽기 전에 끝나지 않은 게임의 이동 기록을 seed부터 재생해 세션을 복구
+ *       복구된 세션은 다음에 접속하는 두 플레이어가 이어서 진행
+ *       플레이어를 확인할 방법이 없으므로 --resume-unfinished로 실행했을 때만 부름
+ * 입력: 없음
+ * 출력: 없음
+ */
+void recover_sessions() {
+    char paths[MAX_RECOVERED][MOVELOG_PATH_MAX];
+    int found = movelog_find_unfinished(MOVELOG_GAME_CODA, paths, MAX_RECOVERED);
+
+    for (int i = 0; i < found; i++) {
+        MoveLogHeader header;
+        MoveRecord *records = NULL;
+        size_t count = 0;
+        if (movelog_load(paths[i], &header, &records, &count) < 0) {
+            // 읽을 수 없는 기록은 재시작할 때마다 다시 찾지 않도록 치움
+            movelog_set_aside(paths[i]);
+            continue;
         }
+        int usable = count > 0 && records[0].kind == MOVE_START && records[count - 1].kind != MOVE_END;
+        Session *session = usable ? create_session(header.session_id, header.seed) : NULL;
+        if (!session) {
+            // 시작 전이거나 이미 끝난 기록
+            free(records);
+            unlink(paths[i]);
+            continue;
+        }
+        for (size_t j = 1; j < count; j++) {
+            replay_move(session, &records[j]);
+        }
+        free(records);
+
+        session->ready[0] = 1;
+        session->ready[1] = 1;
+        session->recovered = 1;
+        session->log = movelog_resume(paths[i], (uint32_t)count);
+        if (header.session_id > session_counter) {
+            session_counter = header.session_id;
+        }
+        recovered_sessions[recovered_count++] = session;
+        printf("게임 %u 복구: 이동 %zu개 재생, 플레이어 %d 차례\n", header.session_id, count - 1,
+               session->current_turn + 1);
     }
 }
 
-int main() {
-    int server_fd, new_socket;
-    struct sockaddr_in address;
-    int opt = 1;
-    int addrlen = sizeof(address);
+int main(int argc, char *argv[]) {
+    int tcp_fd, local_fd;
+    int resume_unfinished = argc > 1 && strcmp(argv[1], "--resume-unfinished") == 0;
+
+    timer_wheel_init(&deadlines, DEADLINE_TICK_MS);
+    if (net_reactor_init(&reactor) < 0) {
+        exit(EXIT_FAILURE);
+    }
     /*
      * 소켓 생성 및 설정
-     * 설명: 서버 소켓을 생성하고, 재사용 가능한 포트로 설정
+     * 설명: 공용 네트워크 라이브러리로 재사용 가능한 포트에 리스닝 소켓을 만들고,
+     *       같은 컴퓨터의 클라이언트용 Unix 소켓도 엶 (Unix 소켓이 없어도 TCP로는 접속 가능)
      * 입력: 없음
      * 출력: 소켓 생성 성공 여부
      */
-    if ((server_fd = socket(AF_INET, SOCK_STREAM, 0)) == 0) {
-        perror("소켓 생성 실패");
+    tcp_fd = net_listen_tcp(PORT, SOMAXCONN, NET_LISTEN_REUSEPORT);
+    if (tcp_fd < 0 || net_reactor_listen(&reactor, tcp_fd, seat_player, NULL) < 0) {
         exit(EXIT_FAILURE);
     }
-
-    if (setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR | SO_REUSEPORT, &opt, sizeof(opt))) {
-        perror("소켓 옵션 설정 실패");
-        exit(EXIT_FAILURE);
-    }
-
-    address.sin_family = AF_INET;
-    address.sin_addr.s_addr = INADDR_ANY;
-    address.sin_port = htons(PORT);
-
-    if (bind(server_fd, (struct sockaddr *)&address, sizeof(address)) < 0) {
-        perror("바인드 실패");
-        exit(EXIT_FAILURE);
+    local_fd = net_listen_unix(LOCAL_SOCKET, SOMAXCONN, 0);
+    if (local_fd >= 0 && net_reactor_listen(&reactor, local_fd, seat_player, NULL) < 0) {
+        close(local_fd);
     }
 
-    if (listen(server_fd, MAX_PLAYERS) < 0) {
-        perror("리스닝 실패");
-        exit(EXIT_FAILURE);
+    // 끝나지 않은 게임은 아무에게나 넘기지 않도록 운영자가 원할 때만 이어서 진행 (기록은 그대로 남겨 둠)
+    if (movelog_init() == 0) {
+        if (resume_unfinished) {
+            recover_sessions();
+        } else {
+            char paths[MAX_RECOVERED][MOVELOG_PATH_MAX];
+            int found = movelog_find_unfinished(MOVELOG_GAME_CODA, paths, MAX_RECOVERED);
+            if (found > 0) {
+                printf("끝나지 않은 게임 기록 %d개는 이어서 진행하지 않습니다 (--resume-unfinished).\n", found);
+            }
+        }
     }
 
     printf("포트 %d에서 서버가 대기 중입니다.\n", PORT);
-    /*
-     * 게임 초기화
-     * 설명: 플레이어 데이터를 초기화
-     * 입력: 없음
-     * 출력: 없음
-     */
-    initialize_game(players);
     /*
      * 새로운 클라이언트 연결 처리
-     * 설명: 클라이언트 연결을 수락하고, 새로운 스레드를 생성하여 처리
-     * 입력: 클라이언트 소켓 정보
+     * 설명: 접속, 입력, 마감 시간을 모두 이 스레드의 리액터 루프에서 처리
+     *       게임 초기화는 테이블(세션)이 만들어질 때 이루어짐
+     * 입력: 없음
      * 출력: 없음
      */
-    while ((new_socket = accept(server_fd, (struct sockaddr *)&address, (socklen_t *)&addrlen)) >= 0) {
-        printf("새로운 연결이 수락되었습니다.\n");
-        ClientData *client_data = malloc(sizeof(ClientData));
-        client_data->socket = new_socket;
-        client_data->player_id = player_count;
-
-        pthread_mutex_lock(&lock);
-        player_count++;
-        if (player_count == MAX_PLAYERS) {
-            pthread_cond_broadcast(&cond);
-        }
-        pthread_mutex_unlock(&lock);
-
-        pthread_t thread_id;
-        pthread_create(&thread_id, NULL, handle_client, (void *)client_data);
-        pthread_detach(thread_id);
-    }
-
-    if (new_socket < 0) {
-        perror("연결 수락 실패");
+    if (net_reactor_run(&reactor, &deadlines) < 0) {
+        net_reactor_destroy(&reactor);
         exit(EXIT_FAILURE);
     }
 
+    net_reactor_destroy(&reactor);
     return 0;
 }
@@ -0,0 +1,108 @@
+// arena.c
+#define _GNU_SOURCE
+#include "arena.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct ArenaChunk {
+    ArenaChunk *prev;
+    size_t size; // 머리를 뺀 데이터 크기
+};
+
+#define ARENA_ROUND(n) (((n) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+#define ARENA_HEADER_SIZE ARENA_ROUND(sizeof(ArenaChunk))
+
+static inline char *chunk_data(ArenaChunk *chunk) {
+    return (char *)chunk + ARENA_HEADER_SIZE;
+}
+
+static ArenaChunk *new_chunk(size_t size) {
+    ArenaChunk *chunk = malloc(ARENA_HEADER_SIZE + size);
+    if (!chunk) {
+        perror("아레나 청크 할당 실패");
+        return NULL;
+    }
+    chunk->prev = NULL;
+    chunk->size = size;
+    return chunk;
+}
+
+/*
+ * 함수: arena_create
+ * 설명: chunk_size 크기의 첫 청크를 할당하고 그 앞부분에 아레나 구조체를 둠
+ * 입력: 청크 크기
+ * 출력: 아레나 (실패 시 NULL)
+ */
+Arena *arena_create(size_t chunk_size) {
+    size_t self = ARENA_ROUND(sizeof(Arena));
+    chunk_size = ARENA_ROUND(chunk_size);
+    if (chunk_size < self + ARENA_ALIGN) {
+        chunk_size = self + ARENA_ALIGN;
+    }
+    ArenaChunk *chunk = new_chunk(chunk_size);
+    if (!chunk) {
+        return NULL;
+    }
+    Arena *arena = (Arena *)chunk_data(chunk);
+    arena->head = chunk;
+    arena->offset = self;
+    arena->chunk_size = chunk_size;
+    arena->used = self;
+    arena->reserved = ARENA_HEADER_SIZE + chunk_size;
+    return arena;
+}
+
+void arena_destroy(Arena *arena) {
+    if (!arena) {
+        return;
+    }
+    // 아레나 구조체가 첫 청크 안에 있으므로 head부터 거슬러 올라가며 해제
+    ArenaChunk *chunk = arena->head;
+    while (chunk) {
+        ArenaChunk *prev = chunk->prev;
+        free(chunk);
+        chunk = prev;
+    }
+}
+
+void *arena_alloc(Arena *arena, size_t size) {
+    size = ARENA_ROUND(size ? size : 1);
+    if (arena->offset + size > arena->head->size) {
+        ArenaChunk *chunk = new_chunk(size > arena->chunk_size ? size : arena->chunk_size);
+        if (!chunk) {
+            return NULL;
+        }
+        chunk->prev = arena->head;
+        arena->head = chunk;
+        arena->offset = 0;
+        arena->reserved += ARENA_HEADER_SIZE + chunk->size;
+    }
+    void *ptr = chunk_data(arena->head) + arena->offset;
+    arena->offset += size;
+    arena->used += size;
+    return ptr;
+}
+
+void *arena_zalloc(Arena *arena, size_t size) {
+    void *ptr = arena_alloc(arena, size);
+    if (ptr) {
+        memset(ptr, 0, size);
+    }
+    return ptr;
+}
+
+ArenaMark arena_mark(const Arena *arena) {
+    return (ArenaMark){arena->head, arena->offset, arena->used};
+}
+
+void arena_rewind(Arena *arena, ArenaMark mark) {
+    while (arena->head != mark.chunk) {
+        ArenaChunk *chunk = arena->head;
+        arena->head = chunk->prev;
+        arena->reserved -= ARENA_HEADER_SIZE + chunk->size;
+        free(chunk);
+    }
+    arena->offset = mark.offset;
+    arena->used = mark.used;
+}
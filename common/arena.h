@@ -0,0 +1,49 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+/*
+ * 세션(한 판)용 bump-pointer 아레나
+ * 청크 안에서 포인터만 앞으로 밀어 할당하고, 개별 해제는 없다.
+ * 세션이 끝날 때 arena_destroy 한 번으로 그 세션이 쓴 메모리를 모두 돌려주므로
+ * 종료 경로마다 free를 챙길 필요가 없다. 아레나 구조체도 첫 청크 안에 있어서
+ * 첫 청크를 넘지 않는 세션은 malloc/free 한 번씩으로 끝난다.
+ * 청크가 모자라면 새 청크를 이어 붙인다 (청크보다 큰 요청은 그 크기로).
+ * 잠금이 없으므로 여러 스레드가 쓰는 세션은 세션 잠금을 잡고 할당한다.
+ */
+#define ARENA_ALIGN 16
+
+typedef struct ArenaChunk ArenaChunk;
+
+typedef struct {
+    ArenaChunk *head;  // 지금 할당 중인 청크 (이전 청크는 head->prev로 연결)
+    size_t offset;     // head 청크 안에서 다음 할당 위치
+    size_t chunk_size; // 새 청크의 기본 크기
+    size_t used;       // 할당한 바이트 합 (정렬 패딩 포함)
+    size_t reserved;   // malloc한 바이트 합
+} Arena;
+
+// 되감기 지점 (한 턴처럼 잠깐 쓰는 버퍼를 한꺼번에 돌려줄 때)
+typedef struct {
+    ArenaChunk *chunk;
+    size_t offset;
+    size_t used;
+} ArenaMark;
+
+// 첫 청크에 아레나를 만듦, 메모리가 없으면 NULL
+Arena *arena_create(size_t chunk_size);
+
+// 모든 청크 해제 (아레나에서 받은 포인터도 모두 무효)
+void arena_destroy(Arena *arena);
+
+// size바이트 할당 (ARENA_ALIGN 정렬), 메모리가 없으면 NULL
+void *arena_alloc(Arena *arena, size_t size);
+// arena_alloc 후 0으로 채움
+void *arena_zalloc(Arena *arena, size_t size);
+
+ArenaMark arena_mark(const Arena *arena);
+// mark 뒤로 할당한 메모리를 돌려줌 (그 뒤에 이어 붙인 청크는 해제)
+void arena_rewind(Arena *arena, ArenaMark mark);
+
+#endif
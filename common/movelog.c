@@ -0,0 +1,366 @@
+// movelog.c
+#define _GNU_SOURCE
+#include "movelog.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+struct MoveLog {
+    int fd;
+    char path[MOVELOG_PATH_MAX];
+    uint32_t next_seq;
+    int dirty;   // 마지막 fsync 이후 기록이 있음
+    int syncing; // 플러시 스레드가 fdatasync 중
+    struct MoveLog *next;
+};
+
+// 열린 로그 목록 (플러시 스레드가 순회)
+static MoveLog *open_logs = NULL;
+static pthread_mutex_t logs_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sync_done = PTHREAD_COND_INITIALIZER;
+static int flusher_started = 0;
+
+/*
+ * 함수: flusher_thread
+ * 설명: MOVELOG_FLUSH_MS마다 더러워진 로그만 골라 fdatasync (group commit)
+ *       기록이 몇 건이 쌓였든 주기당 로그 하나에 fsync 한 번
+ * 입력: 없음
+ * 출력: 없음 (종료하지 않음)
+ */
+static void *flusher_thread(void *arg) {
+    (void)arg;
+    struct timespec interval = {0, MOVELOG_FLUSH_MS * 1000000L};
+    MoveLog **batch = NULL;
+    size_t batch_cap = 0;
+
+    while (1) {
+        nanosleep(&interval, NULL);
+
+        size_t batch_len = 0;
+        pthread_mutex_lock(&logs_lock);
+        for (MoveLog *log = open_logs; log; log = log->next) {
+            if (!log->dirty)
+                continue;
+            if (batch_len == batch_cap) {
+                size_t cap = batch_cap ? batch_cap * 2 : 16;
+                MoveLog **grown = realloc(batch, cap * sizeof(*grown));
+                if (!grown)
+                    break;
+                batch = grown;
+                batch_cap = cap;
+            }
+            log->dirty = 0;
+            log->syncing = 1;
+            batch[batch_len++] = log;
+        }
+        pthread_mutex_unlock(&logs_lock);
+
+        // fsync는 잠금 밖에서 (그 사이 append는 계속 진행)
+        for (size_t i = 0; i < batch_len; i++) {
+            if (fdatasync(batch[i]->fd) < 0) {
+                perror("fdatasync");
+            }
+        }
+
+        if (batch_len > 0) {
+            pthread_mutex_lock(&logs_lock);
+            for (size_t i = 0; i < batch_len; i++) {
+                batch[i]->syncing = 0;
+            }
+            pthread_cond_broadcast(&sync_done);
+            pthread_mutex_unlock(&logs_lock);
+        }
+    }
+    return NULL;
+}
+
+/*
+ * 함수: movelog_init
+ * 설명: 로그 디렉터리를 만들고 플러시 스레드를 시작 (여러 번 불러도 한 번만 시작)
+ * 입력: 없음
+ * 출력: 성공 0, 실패 -1
+ */
+int movelog_init() {
+    if (mkdir(MOVELOG_DIR, 0755) < 0 && errno != EEXIST) {
+        perror("mkdir movelogs");
+        return -1;
+    }
+
+    pthread_mutex_lock(&logs_lock);
+    if (!flusher_started) {
+        pthread_t tid;
+        if (pthread_create(&tid, NULL, flusher_thread, NULL) != 0) {
+            pthread_mutex_unlock(&logs_lock);
+            perror("pthread_create movelog");
+            return -1;
+        }
+        pthread_detach(tid);
+        flusher_started = 1;
+    }
+    pthread_mutex_unlock(&logs_lock);
+    return 0;
+}
+
+static void register_log(MoveLog *log) {
+    pthread_mutex_lock(&logs_lock);
+    log->next = open_logs;
+    open_logs = log;
+    pthread_mutex_unlock(&logs_lock);
+}
+
+static const char *game_name(uint16_t game) {
+    return game == MOVELOG_GAME_CODA ? "coda" : "battleship";
+}
+
+/*
+ * 함수: movelog_create
+ * 설명: 새 세션 로그 파일을 만들고 헤더를 기록 (헤더는 바로 fsync)
+ * 입력: 게임 종류, 세션 번호, 덱/게임 seed
+ * 출력: 로그 핸들, 실패 시 NULL
+ */
+MoveLog *movelog_create(uint16_t game, uint32_t session_id, uint32_t seed) {
+    MoveLog *log = calloc(1, sizeof(MoveLog));
+    if (!log) {
+        perror("calloc");
+        return NULL;
+    }
+
+    MoveLogHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MOVELOG_MAGIC, sizeof(header.magic));
+    header.version = MOVELOG_VERSION;
+    header.game = game;
+    header.session_id = session_id;
+    header.seed = seed;
+    header.started_at = (int64_t)time(NULL);
+
+    snprintf(log->path, sizeof(log->path), "%s/%s-%lld-%d-%u.wal", MOVELOG_DIR, game_name(game),
+             (long long)header.started_at, (int)getpid(), session_id);
+    log->fd = open(log->path, O_WRONLY | O_CREAT | O_EXCL | O_APPEND | O_CLOEXEC, 0644);
+    if (log->fd < 0) {
+        perror("open movelog");
+        free(log);
+        return NULL;
+    }
+    if (write(log->fd, &header, sizeof(header)) != (ssize_t)sizeof(header) || fdatasync(log->fd) < 0) {
+        perror("write movelog header");
+        close(log->fd);
+        unlink(log->path);
+        free(log);
+        return NULL;
+    }
+
+    register_log(log);
+    return log;
+}
+
+/*
+ * 함수: movelog_resume
+ * 설명: 복구한 로그 파일을 이어 쓰기 위해 다시 연다
+ *       (중간에 잘린 마지막 기록은 movelog_load가 이미 버렸으므로 그 길이로 자른다)
+ * 입력: 파일 경로, 다음 기록 번호 (= 유효한 기록 수)
+ * 출력: 로그 핸들, 실패 시 NULL
+ */
+MoveLog *movelog_resume(const char *path, uint32_t next_seq) {
+    MoveLog *log = calloc(1, sizeof(MoveLog));
+    if (!log) {
+        perror("calloc");
+        return NULL;
+    }
+    snprintf(log->path, sizeof(log->path), "%s", path);
+    log->next_seq = next_seq;
+    log->fd = open(log->path, O_WRONLY | O_APPEND | O_CLOEXEC);
+    if (log->fd < 0) {
+        perror("open movelog");
+        free(log);
+        return NULL;
+    }
+    off_t valid = (off_t)(sizeof(MoveLogHeader) + (size_t)next_seq * sizeof(MoveRecord));
+    if (ftruncate(log->fd, valid) < 0) {
+        perror("ftruncate movelog");
+    }
+
+    register_log(log);
+    return log;
+}
+
+/*
+ * 함수: movelog_append
+ * 설명: 기록 한 건을 write 한 번으로 추가 (fsync는 플러시 스레드 몫)
+ *       같은 로그에 대한 append는 호출하는 쪽에서 직렬화해야 한다 (세션 잠금 등)
+ * 입력: 로그, 플레이어 번호, 기록 종류, 인자 바이트, 인자 길이 (최대 10)
+ * 출력: 성공 0, 실패 -1
+ */
+int movelog_append(MoveLog *log, uint8_t player, uint8_t kind, const uint8_t *arg, size_t arg_len) {
+    if (!log) {
+        return 0;
+    }
+    MoveRecord record;
+    memset(&record, 0, sizeof(record));
+    record.seq = log->next_seq;
+    record.player = player;
+    record.kind = kind;
+    if (arg_len > sizeof(record.arg)) {
+        arg_len = sizeof(record.arg);
+    }
+    if (arg_len > 0) {
+        memcpy(record.arg, arg, arg_len);
+    }
+
+    ssize_t n;
+    do {
+        n = write(log->fd, &record, sizeof(record));
+    } while (n < 0 && errno == EINTR);
+    if (n != (ssize_t)sizeof(record)) {
+        perror("write movelog");
+        return -1;
+    }
+    log->next_seq++;
+
+    pthread_mutex_lock(&logs_lock);
+    log->dirty = 1;
+    pthread_mutex_unlock(&logs_lock);
+    return 0;
+}
+
+/*
+ * 함수: movelog_close
+ * 설명: 플러시 목록에서 빼고 닫는다. 끝난 게임이면 파일을 지워 복구 대상에서 제외
+ * 입력: 로그, 정상 종료 여부
+ * 출력: 없음
+ */
+void movelog_close(MoveLog *log, int finished) {
+    if (!log) {
+        return;
+    }
+
+    pthread_mutex_lock(&logs_lock);
+    for (MoveLog **p = &open_logs; *p; p = &(*p)->next) {
+        if (*p == log) {
+            *p = log->next;
+            break;
+        }
+    }
+    while (log->syncing) {
+        pthread_cond_wait(&sync_done, &logs_lock);
+    }
+    pthread_mutex_unlock(&logs_lock);
+
+    if (finished) {
+        unlink(log->path);
+    } else if (fdatasync(log->fd) < 0) {
+        perror("fdatasync");
+    }
+    close(log->fd);
+    free(log);
+}
+
+const char *movelog_path(const MoveLog *log) {
+    return log->path;
+}
+
+/*
+ * 함수: movelog_load
+ * 설명: 로그 파일 전체를 읽는다. 크래시로 잘린 마지막 기록과 순번이 어긋나는 뒤쪽 기록은 버린다
+ * 입력: 파일 경로, 헤더/기록 배열/기록 수를 받을 포인터 (기록 배열은 호출자가 free)
+ * 출력: 성공 0, 실패 -1
+ */
+int movelog_load(const char *path, MoveLogHeader *header, MoveRecord **records, size_t *count) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        perror("open movelog");
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(MoveLogHeader) ||
+        read(fd, header, sizeof(*header)) != (ssize_t)sizeof(*header) ||
+        memcmp(header->magic, MOVELOG_MAGIC, sizeof(header->magic)) != 0 || header->version != MOVELOG_VERSION) {
+        fprintf(stderr, "movelog: %s 형식이 올바르지 않습니다\n", path);
+        close(fd);
+        return -1;
+    }
+
+    size_t total = ((size_t)st.st_size - sizeof(MoveLogHeader)) / sizeof(MoveRecord);
+    MoveRecord *buf = NULL;
+    if (total > 0) {
+        buf = malloc(total * sizeof(MoveRecord));
+        if (!buf) {
+            perror("malloc");
+            close(fd);
+            return -1;
+        }
+        size_t want = total * sizeof(MoveRecord);
+        size_t got = 0;
+        while (got < want) {
+            ssize_t n = read(fd, (char *)buf + got, want - got);
+            if (n <= 0)
+                break;
+            got += (size_t)n;
+        }
+        total = got / sizeof(MoveRecord);
+    }
+    close(fd);
+
+    size_t valid = 0;
+    while (valid < total && buf[valid].seq == valid) {
+        valid++;
+    }
+    *records = buf;
+    *count = valid;
+    return 0;
+}
+
+/*
+ * 함수: movelog_find_unfinished
+ * 설명: 로그 디렉터리에서 해당 게임의 남아 있는 로그(= 끝나지 않은 세션) 경로를 모은다
+ * 입력: 게임 종류, 경로 배열, 배열 크기
+ * 출력: 찾은 개수
+ */
+int movelog_find_unfinished(uint16_t game, char paths[][MOVELOG_PATH_MAX], int max_paths) {
+    DIR *dir = opendir(MOVELOG_DIR);
+    if (!dir) {
+        return 0;
+    }
+
+    const char *prefix = game_name(game);
+    size_t prefix_len = strlen(prefix);
+    int found = 0;
+    struct dirent *entry;
+    while (found < max_paths && (entry = readdir(dir)) != NULL) {
+        size_t len = strlen(entry->d_name);
+        if (strncmp(entry->d_name, prefix, prefix_len) != 0 || entry->d_name[prefix_len] != '-' || len < 4 ||
+            strcmp(entry->d_name + len - 4, ".wal") != 0) {
+            continue;
+        }
+        if (len + sizeof(MOVELOG_DIR) + 1 > MOVELOG_PATH_MAX) {
+            continue;
+        }
+        snprintf(paths[found], MOVELOG_PATH_MAX, "%s/%.*s", MOVELOG_DIR, (int)len, entry->d_name);
+        found++;
+    }
+    closedir(dir);
+    return found;
+}
+
+/*
+ * 함수: movelog_set_aside
+ * 설명: 읽을 수 없는 로그를 .bad로 옮겨 다음 재시작부터는 찾지 않게 함 (옮기지 못하면 지움)
+ * 입력: 로그 경로
+ * 출력: 없음
+ */
+void movelog_set_aside(const char *path) {
+    char bad_path[MOVELOG_PATH_MAX + 4];
+    snprintf(bad_path, sizeof(bad_path), "%s.bad", path);
+    if (rename(path, bad_path) < 0 && errno != ENOENT) {
+        perror("rename movelog");
+        unlink(path);
+    }
+}
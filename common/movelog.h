@@ -0,0 +1,59 @@
+#ifndef MOVELOG_H
+#define MOVELOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * 세션별 이동 기록(write-ahead log)
+ * 파일 = [MoveLogHeader][MoveRecord]...
+ * 기록은 write 한 번으로 페이지 캐시에 붙이고, fsync는 플러시 스레드가
+ * 일정 주기마다 더러워진 로그를 모아서 한 번씩만 수행한다 (group commit).
+ * 서버가 죽었다 다시 뜨면 끝나지 않은 로그를 읽어 seed + 이동 순서대로 재생한다.
+ */
+#define MOVELOG_MAGIC "MLOG"
+#define MOVELOG_VERSION 1
+#define MOVELOG_DIR "movelogs"
+#define MOVELOG_FLUSH_MS 50
+#define MOVELOG_PATH_MAX 256
+
+// 게임 종류
+#define MOVELOG_GAME_CODA 1
+#define MOVELOG_GAME_BATTLESHIP 2
+
+// 공통 기록 종류 (게임별 종류는 16번부터 각 서버에서 정의)
+#define MOVE_START 1 // 게임 시작 (이 기록이 없으면 복구하지 않음)
+#define MOVE_END 2   // 게임 종료 (arg[0] = 종료 사유)
+
+// 파일 헤더 (24바이트)
+typedef struct {
+    char magic[4];
+    uint16_t version;
+    uint16_t game;
+    uint32_t session_id;
+    uint32_t seed;
+    int64_t started_at;
+} MoveLogHeader;
+
+// 이동 기록 한 건 (16바이트 고정)
+typedef struct {
+    uint32_t seq;
+    uint8_t player;
+    uint8_t kind;
+    uint8_t arg[10];
+} MoveRecord;
+
+typedef struct MoveLog MoveLog;
+
+int movelog_init();
+MoveLog *movelog_create(uint16_t game, uint32_t session_id, uint32_t seed);
+MoveLog *movelog_resume(const char *path, uint32_t next_seq);
+int movelog_append(MoveLog *log, uint8_t player, uint8_t kind, const uint8_t *arg, size_t arg_len);
+void movelog_close(MoveLog *log, int finished);
+const char *movelog_path(const MoveLog *log);
+
+int movelog_load(const char *path, MoveLogHeader *header, MoveRecord **records, size_t *count);
+int movelog_find_unfinished(uint16_t game, char paths[][MOVELOG_PATH_MAX], int max_paths);
+void movelog_set_aside(const char *path);
+
+#endif
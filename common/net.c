@@ -0,0 +1,961 @@
+// net.c
+#define _GNU_SOURCE
+#include "net.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define NET_KIND_LISTENER 1
+#define NET_KIND_CONN 2
+#define NET_KIND_WATCH 3
+
+struct NetBuffer {
+    NetBuffer *next;
+    size_t start; // 이미 보낸 바이트
+    size_t len;   // 채운 바이트
+    char data[NET_WRITE_CHUNK];
+};
+
+/*
+ * 함수: net_listen_tcp
+ * 설명: 모든 주소의 port에 바인드하고 listen (SO_REUSEADDR는 항상, 나머지는 플래그로)
+ * 입력: 포트, backlog, NET_LISTEN_* 플래그
+ * 출력: 리스닝 소켓 (실패 시 -1)
+ */
+int net_listen_tcp(int port, int backlog, int flags) {
+    int type = SOCK_STREAM | SOCK_CLOEXEC | ((flags & NET_LISTEN_NONBLOCK) ? SOCK_NONBLOCK : 0);
+    int fd = socket(AF_INET, type, 0);
+    if (fd < 0) {
+        perror("소켓 생성 실패");
+        return -1;
+    }
+
+    int opt = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0 ||
+        ((flags & NET_LISTEN_REUSEPORT) && setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0)) {
+        perror("소켓 옵션 설정 실패");
+        close(fd);
+        return -1;
+    }
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons((uint16_t)port);
+    if (bind(fd, (struct sockaddr *)&address, sizeof(address)) < 0) {
+        perror("바인드 실패");
+        close(fd);
+        return -1;
+    }
+    if (listen(fd, backlog) < 0) {
+        perror("리스닝 실패");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// name을 Unix 소켓 주소로 ('@'로 시작하면 추상 이름공간, 아니면 파일 경로)
+static int unix_address(const char *name, struct sockaddr_un *address, socklen_t *len) {
+    size_t name_len = strlen(name);
+    if (name_len == 0 || name_len >= sizeof(address->sun_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    memset(address, 0, sizeof(*address));
+    address->sun_family = AF_UNIX;
+    memcpy(address->sun_path, name, name_len);
+    if (name[0] == '@') {
+        // 추상 소켓: 첫 바이트가 '\0'이고 길이로 이름 끝을 정함 (파일이 남지 않음)
+        address->sun_path[0] = '\0';
+        *len = (socklen_t)(offsetof(struct sockaddr_un, sun_path) + name_len);
+    } else {
+        *len = (socklen_t)sizeof(*address);
+    }
+    return 0;
+}
+
+/*
+ * 함수: net_listen_unix
+ * 설명: 같은 컴퓨터의 클라이언트용 Unix 소켓에서 listen (TCP 소켓과 함께 리액터나 accept 루프에 등록)
+ *       파일 경로면 이전 실행이 남긴 소켓 파일을 지우고 바인드
+ * 입력: 소켓 이름 ('@'로 시작하면 추상 소켓), backlog, NET_LISTEN_NONBLOCK 플래그
+ * 출력: 리스닝 소켓 (실패 시 -1)
+ */
+int net_listen_unix(const char *name, int backlog, int flags) {
+    struct sockaddr_un address;
+    socklen_t address_len;
+    if (unix_address(name, &address, &address_len) < 0) {
+        perror("Unix 소켓 이름 오류");
+        return -1;
+    }
+
+    int type = SOCK_STREAM | SOCK_CLOEXEC | ((flags & NET_LISTEN_NONBLOCK) ? SOCK_NONBLOCK : 0);
+    int fd = socket(AF_UNIX, type, 0);
+    if (fd < 0) {
+        perror("소켓 생성 실패");
+        return -1;
+    }
+    if (name[0] != '@') {
+        unlink(name);
+    }
+    if (bind(fd, (struct sockaddr *)&address, address_len) < 0) {
+        perror("Unix 소켓 바인드 실패");
+        close(fd);
+        return -1;
+    }
+    if (listen(fd, backlog) < 0) {
+        perror("리스닝 실패");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// 여러 리스닝 소켓 중 먼저 들어온 연결을 받음 (블로킹)
+int net_accept_any(const int *listen_fds, int count, int *which) {
+    struct pollfd fds[NET_MAX_LISTENERS];
+    if (count < 1 || count > NET_MAX_LISTENERS) {
+        errno = EINVAL;
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        fds[i].fd = listen_fds[i];
+        fds[i].events = POLLIN;
+        fds[i].revents = 0;
+    }
+    while (1) {
+        if (poll(fds, (nfds_t)count, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        for (int i = 0; i < count; i++) {
+            if (!(fds[i].revents & POLLIN))
+                continue;
+            int fd = accept(fds[i].fd, NULL, NULL);
+            if (fd < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == ECONNABORTED)) {
+                continue; // 다른 스레드가 먼저 받았거나 바로 끊긴 연결
+            }
+            if (which != NULL) {
+                *which = i;
+            }
+            return fd;
+        }
+    }
+}
+
+int net_connect_tcp(const char *host, int port) {
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons((uint16_t)port);
+    if (strcmp(host, "localhost") == 0) {
+        host = "127.0.0.1";
+    }
+    if (inet_pton(AF_INET, host, &address.sin_addr) <= 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    while (connect(fd, (struct sockaddr *)&address, sizeof(address)) < 0) {
+        if (errno == EINTR)
+            continue;
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+    // 게임 메시지는 작고 바로 응답을 기다리므로 Nagle 지연을 끔
+    int opt = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+    return fd;
+}
+
+int net_connect_unix(const char *name) {
+    struct sockaddr_un address;
+    socklen_t address_len;
+    if (unix_address(name, &address, &address_len) < 0) {
+        return -1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (connect(fd, (struct sockaddr *)&address, address_len) < 0) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+    return fd;
+}
+
+// 이 컴퓨터를 가리키는 주소인지 (루프백 127.0.0.0/8, localhost)
+static int is_local_host(const char *host) {
+    struct in_addr addr;
+    if (strcmp(host, "localhost") == 0) {
+        return 1;
+    }
+    if (inet_pton(AF_INET, host, &addr) <= 0) {
+        return 0;
+    }
+    return (ntohl(addr.s_addr) >> 24) == 127;
+}
+
+/*
+ * 함수: net_connect_local
+ * 설명: 서버가 같은 컴퓨터에 있으면 Unix 소켓으로 먼저 연결하고 (TCP 스택을 거치지 않음),
+ *       원격 주소이거나 Unix 소켓이 없으면 (예전 서버) TCP로 연결
+ * 입력: Unix 소켓 이름 (NULL이면 TCP만), 호스트, 포트
+ * 출력: 연결된 블로킹 소켓 (실패 시 -1, errno는 TCP 연결 실패 값)
+ */
+int net_connect_local(const char *unix_name, const char *host, int port) {
+    if (unix_name != NULL && is_local_host(host)) {
+        int fd = net_connect_unix(unix_name);
+        if (fd >= 0) {
+            return fd;
+        }
+    }
+    return net_connect_tcp(host, port);
+}
+
+int net_set_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * 함수: net_set_keepalive
+ * 설명: TCP keepalive를 켜서 상대가 사라진 (반쯤 열린) 연결의 블로킹 recv가 영원히 막히지 않게 함
+ *       idle_s초 동안 오간 것이 없으면 interval_s초마다 probe를 보내고 count번 답이 없으면 recv가 ETIMEDOUT으로 실패
+ *       프로토콜을 바꾸지 않으므로 ping을 끼워 넣을 수 없는 서버용 (Unix 소켓은 상대가 사라지면 바로 끊기므로 무시)
+ * 입력: 소켓, 대기 시간, probe 간격, probe 수
+ * 출력: 성공 0, 실패 -1
+ */
+int net_set_keepalive(int fd, int idle_s, int interval_s, int count) {
+    int on = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &on, sizeof(on)) < 0) {
+        return -1;
+    }
+    if (setsockopt(fd, IPPROTO_TCP, TCP_KEEPIDLE, &idle_s, sizeof(idle_s)) < 0 ||
+        setsockopt(fd, IPPROTO_TCP, TCP_KEEPINTVL, &interval_s, sizeof(interval_s)) < 0 ||
+        setsockopt(fd, IPPROTO_TCP, TCP_KEEPCNT, &count, sizeof(count)) < 0) {
+        return errno == EOPNOTSUPP || errno == ENOPROTOOPT ? 0 : -1;
+    }
+    return 0;
+}
+
+int net_set_recv_timeout(int fd, int seconds) {
+    struct timeval timeout = {seconds, 0};
+    return setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+}
+
+int net_send_all(int fd, const void *data, size_t len) {
+    const char *p = data;
+    while (len > 0) {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+ssize_t net_recv_all(int fd, void *buf, size_t len) {
+    char *p = buf;
+    size_t got = 0;
+    while (got < len) {
+        ssize_t n = recv(fd, p + got, len - got, 0);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        if (n == 0) {
+            return 0;
+        }
+        got += (size_t)n;
+    }
+    return (ssize_t)got;
+}
+
+ssize_t net_frame_line(const char *data, size_t len) {
+    const char *newline = memchr(data, '\n', len);
+    if (newline != NULL) {
+        return newline - data + 1;
+    }
+    return len >= NET_READ_BUFFER ? (ssize_t)len : 0;
+}
+
+ssize_t net_frame_len16(const char *data, size_t len) {
+    if (len < 3) {
+        return 0;
+    }
+    size_t total = 3 + (((size_t)(uint8_t)data[1] << 8) | (uint8_t)data[2]);
+    if (total > NET_READ_BUFFER) {
+        return -1;
+    }
+    return len >= total ? (ssize_t)total : 0;
+}
+
+int net_reactor_init(NetReactor *reactor) {
+    memset(reactor, 0, sizeof(*reactor));
+    if (slab_pool_init(&reactor->conn_pool, "NetConn", sizeof(NetConn), NET_POOL_CHUNK) < 0 ||
+        slab_pool_init(&reactor->buffer_pool, "NetBuffer", sizeof(NetBuffer), NET_POOL_CHUNK) < 0) {
+        slab_pool_destroy(&reactor->conn_pool);
+        return -1;
+    }
+    reactor->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    reactor->wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    reactor->spare_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    if (reactor->epoll_fd < 0 || reactor->wake_fd < 0) {
+        perror("리액터 생성 실패");
+        net_reactor_destroy(reactor);
+        return -1;
+    }
+    struct epoll_event event = {.events = EPOLLIN, .data.ptr = NULL};
+    if (epoll_ctl(reactor->epoll_fd, EPOLL_CTL_ADD, reactor->wake_fd, &event) < 0) {
+        perror("리액터 생성 실패");
+        net_reactor_destroy(reactor);
+        return -1;
+    }
+    return 0;
+}
+
+static void free_write_queue(NetConn *conn) {
+    NetBuffer *buf = conn->write_head;
+    while (buf) {
+        NetBuffer *next = buf->next;
+        slab_free(&conn->reactor->buffer_pool, buf);
+        buf = next;
+    }
+    conn->write_head = conn->write_tail = NULL;
+    conn->write_queued = 0;
+}
+
+// 닫힌 연결을 풀로 돌려줌 (이벤트 배열을 다 처리한 뒤에만 호출)
+static void release_closed(NetReactor *reactor) {
+    while (reactor->free_list) {
+        NetConn *conn = reactor->free_list;
+        reactor->free_list = conn->next_free;
+        slab_free(&reactor->conn_pool, conn);
+    }
+}
+
+// 연결 정리: on_close 후 소켓을 닫음, 메모리는 이번 루프가 끝난 뒤 해제
+static void conn_destroy(NetConn *conn) {
+    if (conn->closed) {
+        return;
+    }
+    NetReactor *reactor = conn->reactor;
+    conn->closing = 1;
+    if (conn->lingering) {
+        conn->lingering = 0;
+        reactor->lingering_count--;
+    }
+    if (conn->on_close) {
+        conn->on_close(conn);
+    }
+    conn->closed = 1;
+    epoll_ctl(reactor->epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+    close(conn->fd);
+    if (conn->fd < reactor->conn_capacity && reactor->conns[conn->fd] == conn) {
+        reactor->conns[conn->fd] = NULL;
+    }
+    reactor->conn_count--;
+    free_write_queue(conn);
+    conn->next_free = reactor->free_list;
+    reactor->free_list = conn;
+}
+
+void net_reactor_destroy(NetReactor *reactor) {
+    for (int fd = 0; fd < reactor->conn_capacity; fd++) {
+        if (reactor->conns[fd]) {
+            conn_destroy(reactor->conns[fd]);
+        }
+    }
+    release_closed(reactor);
+    free(reactor->conns);
+    reactor->conns = NULL;
+    reactor->conn_capacity = 0;
+    for (int i = 0; i < reactor->listener_count; i++) {
+        if (reactor->listeners[i].fd >= 0) {
+            close(reactor->listeners[i].fd);
+        }
+    }
+    reactor->listener_count = 0;
+    if (reactor->epoll_fd >= 0) {
+        close(reactor->epoll_fd);
+    }
+    if (reactor->wake_fd >= 0) {
+        close(reactor->wake_fd);
+    }
+    if (reactor->spare_fd >= 0) {
+        close(reactor->spare_fd);
+    }
+    reactor->epoll_fd = reactor->wake_fd = reactor->spare_fd = -1;
+    slab_pool_destroy(&reactor->conn_pool);
+    slab_pool_destroy(&reactor->buffer_pool);
+}
+
+static int reactor_add(NetReactor *reactor, int kind, int fd, NetAcceptCallback callback, void *arg) {
+    // net_reactor_remove로 비운 자리부터 다시 씀
+    int slot = 0;
+    while (slot < reactor->listener_count && reactor->listeners[slot].fd >= 0) {
+        slot++;
+    }
+    if (slot == NET_MAX_LISTENERS || net_set_nonblocking(fd) < 0) {
+        return -1;
+    }
+    NetListener *listener = &reactor->listeners[slot];
+    listener->kind = kind;
+    listener->fd = fd;
+    listener->callback = callback;
+    listener->arg = arg;
+    struct epoll_event event = {.events = EPOLLIN, .data.ptr = listener};
+    if (epoll_ctl(reactor->epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+        perror("리스닝 소켓 등록 실패");
+        listener->kind = 0;
+        listener->fd = -1;
+        return -1;
+    }
+    if (slot == reactor->listener_count) {
+        reactor->listener_count++;
+    }
+    return 0;
+}
+
+int net_reactor_listen(NetReactor *reactor, int listen_fd, NetAcceptCallback callback, void *arg) {
+    return reactor_add(reactor, NET_KIND_LISTENER, listen_fd, callback, arg);
+}
+
+int net_reactor_watch(NetReactor *reactor, int fd, NetAcceptCallback callback, void *arg) {
+    return reactor_add(reactor, NET_KIND_WATCH, fd, callback, arg);
+}
+
+/*
+ * 함수: net_reactor_remove
+ * 설명: net_reactor_listen / net_reactor_watch로 등록한 소켓을 리액터에서 뺌 (소켓은 닫지 않음)
+ *       콜백 안에서 불러도 됨 (같은 이벤트 배열에 남은 그 소켓의 이벤트는 건너뜀)
+ * 입력: 리액터, 소켓
+ * 출력: 등록되지 않은 소켓이면 -1
+ */
+int net_reactor_remove(NetReactor *reactor, int fd) {
+    for (int i = 0; i < reactor->listener_count; i++) {
+        NetListener *listener = &reactor->listeners[i];
+        if (listener->fd == fd && fd >= 0) {
+            epoll_ctl(reactor->epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+            listener->kind = 0;
+            listener->fd = -1;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+NetConn *net_conn_open(NetReactor *reactor, int fd, NetFramer framer, NetMessageCallback on_message,
+                       NetCloseCallback on_close, void *user) {
+    if (fd >= reactor->conn_capacity) {
+        int capacity = reactor->conn_capacity ? reactor->conn_capacity : 256;
+        while (capacity <= fd) {
+            capacity *= 2;
+        }
+        NetConn **conns = realloc(reactor->conns, (size_t)capacity * sizeof(NetConn *));
+        if (!conns) {
+            perror("연결 표 할당 실패");
+            return NULL;
+        }
+        memset(conns + reactor->conn_capacity, 0, (size_t)(capacity - reactor->conn_capacity) * sizeof(NetConn *));
+        reactor->conns = conns;
+        reactor->conn_capacity = capacity;
+    }
+
+    NetConn *conn = slab_alloc(&reactor->conn_pool);
+    if (!conn) {
+        perror("연결 할당 실패");
+        return NULL;
+    }
+    memset(conn, 0, offsetof(NetConn, read_buf));
+    conn->kind = NET_KIND_CONN;
+    conn->fd = fd;
+    conn->reactor = reactor;
+    conn->framer = framer ? framer : net_frame_line;
+    conn->on_message = on_message;
+    conn->on_close = on_close;
+    conn->user = user;
+    conn->last_read_ms = timer_wheel_now_ms();
+
+    if (net_set_nonblocking(fd) < 0) {
+        perror("논블로킹 설정 실패");
+        slab_free(&reactor->conn_pool, conn);
+        return NULL;
+    }
+    struct epoll_event event = {.events = EPOLLIN | EPOLLRDHUP, .data.ptr = conn};
+    if (epoll_ctl(reactor->epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+        perror("연결 등록 실패");
+        slab_free(&reactor->conn_pool, conn);
+        return NULL;
+    }
+    reactor->conns[fd] = conn;
+    reactor->conn_count++;
+    return conn;
+}
+
+NetConn *net_conn_of(NetReactor *reactor, int fd) {
+    if (fd < 0 || fd >= reactor->conn_capacity) {
+        return NULL;
+    }
+    return reactor->conns[fd];
+}
+
+static void set_want_write(NetConn *conn, int want) {
+    if (conn->want_write == want) {
+        return;
+    }
+    struct epoll_event event = {.events = EPOLLIN | EPOLLRDHUP | (want ? EPOLLOUT : 0), .data.ptr = conn};
+    if (epoll_ctl(conn->reactor->epoll_fd, EPOLL_CTL_MOD, conn->fd, &event) == 0) {
+        conn->want_write = want;
+    }
+}
+
+// 마지막 버퍼의 빈자리부터 채우고, 모자라면 풀에서 NET_WRITE_CHUNK 버퍼를 더 이어 붙임
+static int queue_bytes(NetConn *conn, const char *data, size_t len) {
+    while (len > 0) {
+        NetBuffer *tail = conn->write_tail;
+        if (tail == NULL || tail->len == NET_WRITE_CHUNK) {
+            NetBuffer *buf = slab_alloc(&conn->reactor->buffer_pool);
+            if (!buf) {
+                perror("쓰기 큐 할당 실패");
+                return -1;
+            }
+            buf->next = NULL;
+            buf->start = 0;
+            buf->len = 0;
+            if (tail) {
+                tail->next = buf;
+            } else {
+                conn->write_head = buf;
+            }
+            conn->write_tail = tail = buf;
+        }
+        size_t n = NET_WRITE_CHUNK - tail->len;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(tail->data + tail->len, data, n);
+        tail->len += n;
+        conn->write_queued += n;
+        data += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/*
+ * 함수: net_conn_send
+ * 설명: 쓰기 큐가 비어 있으면 바로 send하고, 보내지 못한 나머지만 큐에 넣고 EPOLLOUT을 켬
+ *       큐가 NET_WRITE_QUEUE_MAX를 넘는 느린 연결이나 전송 오류는 연결을 끊음
+ * 입력: 연결, 데이터, 길이
+ * 출력: 성공 0 (일부는 큐에 있을 수 있음), 끊긴 연결이면 -1
+ */
+int net_conn_send(NetConn *conn, const void *data, size_t len) {
+    if (conn == NULL || conn->closing) {
+        return -1;
+    }
+    const char *p = data;
+    if (conn->write_head == NULL) {
+        while (len > 0) {
+            ssize_t n = send(conn->fd, p, len, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (n < 0) {
+                if (errno == EINTR)
+                    continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                    break;
+                net_conn_close(conn);
+                return -1;
+            }
+            p += n;
+            len -= (size_t)n;
+        }
+    }
+    if (len == 0) {
+        return 0;
+    }
+    if (conn->write_queued + len > NET_WRITE_QUEUE_MAX || queue_bytes(conn, p, len) < 0) {
+        net_conn_close(conn);
+        return -1;
+    }
+    set_want_write(conn, 1);
+    return 0;
+}
+
+void net_conn_close(NetConn *conn) {
+    if (conn->closing) {
+        return;
+    }
+    conn->closing = 1;
+    // 소켓을 닫지는 않고 끊기만 하면 epoll이 HUP을 알려주고, 그때 conn_destroy가 정리
+    shutdown(conn->fd, SHUT_RDWR);
+}
+
+/*
+ * 함수: net_conn_close_flush
+ * 설명: 더 보내지 않고 쓰기 큐를 다 보낸 뒤 보내기만 닫음 (SHUT_WR), 그 뒤 상대가 닫으면 정리
+ *       읽지 않은 입력을 남긴 채 닫으면 커널이 RST를 보내 상대가 아직 읽지 않은 마지막 메시지까지
+ *       버려질 수 있으므로, 기다리는 동안 들어오는 입력은 읽어 버림 (NET_LINGER_MS가 지나면 그냥 닫음)
+ * 입력: 연결
+ * 출력: 없음
+ */
+void net_conn_close_flush(NetConn *conn) {
+    if (conn->closing) {
+        return;
+    }
+    conn->closing = 1;
+    conn->lingering = 1;
+    conn->linger_ms = timer_wheel_now_ms() + NET_LINGER_MS;
+    conn->reactor->lingering_count++;
+    if (conn->write_head == NULL) {
+        shutdown(conn->fd, SHUT_WR);
+    }
+}
+
+// 상대가 NET_LINGER_MS 안에 닫지 않은 연결을 정리
+static void expire_lingering(NetReactor *reactor) {
+    uint64_t now = timer_wheel_now_ms();
+    for (int fd = 0; fd < reactor->conn_capacity && reactor->lingering_count > 0; fd++) {
+        NetConn *conn = reactor->conns[fd];
+        if (conn != NULL && conn->lingering && now >= conn->linger_ms) {
+            conn_destroy(conn);
+        }
+    }
+}
+
+// 쓰기 큐를 소켓이 받아주는 만큼 보냄
+static void conn_writable(NetConn *conn) {
+    while (conn->write_head) {
+        NetBuffer *buf = conn->write_head;
+        ssize_t n = send(conn->fd, buf->data + buf->start, buf->len - buf->start, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                conn_destroy(conn);
+            }
+            return;
+        }
+        buf->start += (size_t)n;
+        conn->write_queued -= (size_t)n;
+        if (buf->start < buf->len) {
+            return;
+        }
+        conn->write_head = buf->next;
+        if (conn->write_head == NULL) {
+            conn->write_tail = NULL;
+        }
+        slab_free(&conn->reactor->buffer_pool, buf);
+    }
+    set_want_write(conn, 0);
+    if (conn->lingering) {
+        shutdown(conn->fd, SHUT_WR); // 다 보냈으니 상대에게 EOF
+    }
+}
+
+// 읽기 버퍼의 완성된 메시지를 모두 콜백으로 넘기고 남은 입력을 앞으로 당김
+static void conn_dispatch(NetConn *conn) {
+    size_t start = 0;
+    while (!conn->closing && start < conn->read_len) {
+        ssize_t frame = conn->framer(conn->read_buf + start, conn->read_len - start);
+        if (frame == 0) {
+            break;
+        }
+        if (frame < 0) {
+            conn_destroy(conn); // 프로토콜 오류
+            return;
+        }
+        char *message = conn->read_buf + start;
+        conn->read_next = start + (size_t)frame;
+        conn->read_next_byte = message[frame];
+        message[frame] = '\0';
+        conn->on_message(conn, message, (size_t)frame);
+        message[frame] = conn->read_next_byte;
+        conn->read_next = 0;
+        start += (size_t)frame;
+    }
+    if (conn->closed) {
+        return;
+    }
+    conn->read_len -= start;
+    memmove(conn->read_buf, conn->read_buf + start, conn->read_len);
+    if (conn->read_len == NET_READ_BUFFER) {
+        conn_destroy(conn); // 버퍼보다 큰 메시지
+    }
+}
+
+// 한 번 읽고 완성된 메시지를 모두 콜백으로 넘김 (레벨 트리거라 남은 입력은 다음 루프에서)
+static void conn_readable(NetConn *conn) {
+    ssize_t n;
+    if (conn->closing) {
+        conn->read_len = 0; // 닫는 중에 들어온 입력은 처리하지 않고 버림 (상대가 닫기만 기다림)
+    }
+    do {
+        n = recv(conn->fd, conn->read_buf + conn->read_len, NET_READ_BUFFER - conn->read_len, 0);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return;
+    }
+    if (n <= 0) {
+        conn_destroy(conn);
+        return;
+    }
+    if (conn->closing) {
+        return;
+    }
+    conn->read_len += (size_t)n;
+    conn->last_read_ms = timer_wheel_now_ms();
+    conn_dispatch(conn);
+}
+
+int net_conn_snapshot(const NetConn *conn, char *buf, size_t size, size_t *input_len, size_t *output_len) {
+    size_t from = conn->read_next;
+    size_t input = conn->read_len - from;
+    if (input + conn->write_queued > size) {
+        return -1;
+    }
+    memcpy(buf, conn->read_buf + from, input);
+    if (from > 0 && input > 0) {
+        buf[0] = conn->read_next_byte; // 콜백 동안 '\0'으로 바꿔 둔 바이트
+    }
+    size_t output = 0;
+    for (const NetBuffer *b = conn->write_head; b != NULL; b = b->next) {
+        memcpy(buf + input + output, b->data + b->start, b->len - b->start);
+        output += b->len - b->start;
+    }
+    *input_len = input;
+    *output_len = output;
+    return 0;
+}
+
+/*
+ * 함수: net_conn_detach
+ * 설명: conn_destroy와 같이 연결을 정리하되 on_close를 부르지 않고 소켓도 닫지 않음
+ *       (다른 프로세스로 넘긴 뒤 호출한 쪽이 닫음), 메모리는 이번 루프가 끝난 뒤 해제
+ * 입력: 연결
+ * 출력: 소켓 fd (이미 닫힌 연결이면 -1)
+ */
+int net_conn_detach(NetConn *conn) {
+    if (conn->closed) {
+        return -1;
+    }
+    NetReactor *reactor = conn->reactor;
+    conn->closing = 1;
+    conn->closed = 1;
+    if (conn->lingering) {
+        conn->lingering = 0;
+        reactor->lingering_count--;
+    }
+    epoll_ctl(reactor->epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+    if (conn->fd < reactor->conn_capacity && reactor->conns[conn->fd] == conn) {
+        reactor->conns[conn->fd] = NULL;
+    }
+    reactor->conn_count--;
+    free_write_queue(conn);
+    conn->next_free = reactor->free_list;
+    reactor->free_list = conn;
+    return conn->fd;
+}
+
+int net_conn_feed(NetConn *conn, const char *data, size_t len) {
+    if (conn->closing || len > NET_READ_BUFFER - conn->read_len) {
+        return -1;
+    }
+    memcpy(conn->read_buf + conn->read_len, data, len);
+    conn->read_len += len;
+    conn_dispatch(conn);
+    return 0;
+}
+
+/*
+ * 함수: heartbeat_tick
+ * 설명: 모든 연결을 훑어 오래 받은 것이 없는 연결은 끊고, 조금 조용한 연결에는 ping을 보냄
+ *       (연결마다 타이머를 두지 않으므로 받을 때마다 타이머를 옮기는 비용이 없음)
+ * 입력: 하트비트
+ * 출력: 없음 (다음 훑기를 예약)
+ */
+static void heartbeat_tick(void *arg) {
+    NetHeartbeat *heartbeat = arg;
+    NetReactor *reactor = heartbeat->reactor;
+    uint64_t now = timer_wheel_now_ms();
+    for (int fd = 0; fd < reactor->conn_capacity; fd++) {
+        NetConn *conn = reactor->conns[fd];
+        if (conn == NULL || conn->closing) {
+            continue;
+        }
+        uint64_t idle = now - conn->last_read_ms;
+        if (idle >= heartbeat->timeout_ms) {
+            heartbeat->reaped++;
+            if (heartbeat->on_reap) {
+                heartbeat->on_reap(conn);
+            }
+            conn_destroy(conn); // 상대가 사라졌으면 shutdown 뒤의 HUP도 오지 않을 수 있으므로 바로 정리
+        } else if (idle >= heartbeat->interval_ms && now - conn->last_ping_ms >= heartbeat->interval_ms) {
+            conn->last_ping_ms = now;
+            heartbeat->pings++;
+            net_conn_send(conn, heartbeat->ping, heartbeat->ping_len);
+        }
+    }
+    timer_wheel_schedule(heartbeat->timers, &heartbeat->timer, heartbeat->interval_ms / 2 + 1);
+}
+
+void net_heartbeat_start(NetHeartbeat *heartbeat, NetReactor *reactor, TimerWheel *timers, unsigned interval_ms,
+                         unsigned timeout_ms, const void *ping, size_t ping_len, NetCloseCallback on_reap) {
+    memset(heartbeat, 0, sizeof(*heartbeat));
+    heartbeat->reactor = reactor;
+    heartbeat->timers = timers;
+    heartbeat->timeout_ms = timeout_ms;
+    heartbeat->interval_ms = interval_ms > 0 && interval_ms <= timeout_ms / 2 ? interval_ms : timeout_ms / 2;
+    heartbeat->ping = ping;
+    heartbeat->ping_len = ping_len;
+    heartbeat->on_reap = on_reap;
+    timer_entry_init(&heartbeat->timer, heartbeat_tick, heartbeat);
+    if (timeout_ms > 0) {
+        timer_wheel_schedule(timers, &heartbeat->timer, heartbeat->interval_ms / 2 + 1);
+    }
+}
+
+void net_heartbeat_stop(NetHeartbeat *heartbeat) {
+    if (heartbeat->timers != NULL) {
+        timer_wheel_cancel(heartbeat->timers, &heartbeat->timer);
+    }
+}
+
+static void accept_all(NetReactor *reactor, NetListener *listener) {
+    while (1) {
+        int fd = accept4(listener->fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            if ((errno == EMFILE || errno == ENFILE) && reactor->spare_fd >= 0) {
+                // 파일 디스크립터가 바닥나면 대기 중인 연결 때문에 epoll이 계속 깨우므로
+                // 예비 fd를 잠깐 비워 한 연결을 받아 바로 끊음 (클라이언트는 거절로 봄)
+                close(reactor->spare_fd);
+                int dropped = accept(listener->fd, NULL, NULL);
+                if (dropped >= 0) {
+                    close(dropped);
+                }
+                reactor->spare_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+                if (dropped >= 0)
+                    continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                perror("어셉트 실패");
+            }
+            return;
+        }
+        // 리액터가 쓰기 큐로 이미 모아 보내므로 Nagle 지연은 끔 (Unix 소켓에서는 실패해도 무시)
+        int opt = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+        listener->callback(reactor, fd, listener->arg);
+        if (listener->kind != NET_KIND_LISTENER) {
+            return; // 콜백이 이 리스너를 뺐음
+        }
+    }
+}
+
+/*
+ * 함수: net_reactor_run
+ * 설명: 다음 타이머 틱까지 epoll_wait하고, 준비된 소켓을 처리한 뒤 타이머 휠을 진행
+ *       닫힌 연결은 이벤트 배열을 다 처리한 뒤 해제 (같은 배열에 남은 이벤트가 해제된 연결을 가리키지 않도록)
+ * 입력: 리액터, 타이머 휠 (NULL이면 타이머 없음)
+ * 출력: net_reactor_stop으로 끝나면 0, epoll 오류 -1
+ */
+int net_reactor_run(NetReactor *reactor, TimerWheel *timers) {
+    struct epoll_event events[NET_MAX_EVENTS];
+    reactor->running = 1;
+    while (reactor->running) {
+        int timeout = timers ? timer_wheel_timeout_ms(timers, timer_wheel_now_ms()) : -1;
+        if (reactor->lingering_count > 0 && (timeout < 0 || timeout > NET_LINGER_CHECK_MS)) {
+            timeout = NET_LINGER_CHECK_MS;
+        }
+        int count = epoll_wait(reactor->epoll_fd, events, NET_MAX_EVENTS, timeout);
+        if (count < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("epoll_wait 실패");
+            return -1;
+        }
+
+        for (int i = 0; i < count; i++) {
+            int *kind = events[i].data.ptr;
+            if (kind == NULL) {
+                uint64_t value;
+                if (read(reactor->wake_fd, &value, sizeof(value)) < 0 && errno != EAGAIN) {
+                    perror("리액터 깨우기 실패");
+                }
+                continue;
+            }
+            if (*kind == NET_KIND_LISTENER) {
+                accept_all(reactor, (NetListener *)kind);
+                continue;
+            }
+            if (*kind == NET_KIND_WATCH) {
+                NetListener *watch = (NetListener *)kind;
+                watch->callback(reactor, watch->fd, watch->arg);
+                continue;
+            }
+            if (*kind != NET_KIND_CONN) {
+                continue; // 이번 배열을 처리하는 동안 net_reactor_remove로 뺀 소켓
+            }
+            NetConn *conn = (NetConn *)kind;
+            if (!conn->closed && (events[i].events & EPOLLOUT)) {
+                conn_writable(conn);
+            }
+            if (!conn->closed && (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))) {
+                conn_readable(conn);
+            }
+        }
+        if (reactor->lingering_count > 0) {
+            expire_lingering(reactor);
+        }
+        release_closed(reactor);
+
+        if (timers) {
+            timer_wheel_advance(timers, timer_wheel_now_ms());
+            release_closed(reactor);
+        }
+    }
+    return 0;
+}
+
+void net_reactor_stop(NetReactor *reactor) {
+    uint64_t one = 1;
+    reactor->running = 0;
+    // 시그널 핸들러에서도 부를 수 있으므로 실패해도 출력하지 않음 (이미 깨울 값이 쌓여 있으면 EAGAIN)
+    ssize_t n = write(reactor->wake_fd, &one, sizeof(one));
+    (void)n;
+}
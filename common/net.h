@@ -0,0 +1,181 @@
+#ifndef NET_H
+#define NET_H
+
+#include "slab.h"
+#include "timer_wheel.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/*
+ * 게임 서버 공용 네트워크 라이브러리
+ * - 리스닝 소켓 생성, 블로킹 소켓용 전송/수신 (부분 전송, EINTR 재시도, SIGPIPE 없음)
+ * - 프레임 함수: 받은 바이트에서 메시지 하나의 길이를 찾음 (줄 단위, 타입+길이 헤더)
+ * - epoll 리액터: 논블로킹 연결마다 읽기 버퍼와 쓰기 큐를 두고, 읽은 바이트를 프레임 함수로
+ *   잘라 메시지마다 콜백을 부른다. 소켓이 바로 받아주지 않은 나머지는 쓰기 큐에 쌓았다가
+ *   EPOLLOUT 때 보낸다. 타이머 휠도 같은 루프에서 진행하므로 타이머 스레드가 따로 없다.
+ * - 하트비트: 그 타이머 휠에서 주기적으로 연결을 훑어 조용한 연결에 ping을 보내고,
+ *   오래 응답이 없는 연결 (반쯤 열린 TCP 등)을 끊는다.
+ * 리액터 함수와 콜백은 모두 리액터 스레드 하나에서만 불린다 (net_reactor_stop 제외).
+ */
+#define NET_READ_BUFFER 4096          // 연결 하나의 읽기 버퍼 (메시지 최대 크기)
+#define NET_WRITE_CHUNK 4096          // 쓰기 큐 버퍼 하나의 기본 크기 (작은 메시지는 합침)
+#define NET_WRITE_QUEUE_MAX (1 << 20) // 이보다 많이 밀린 연결은 느린 클라이언트로 보고 끊음
+#define NET_MAX_EVENTS 64
+#define NET_LINGER_MS 2000            // net_conn_close_flush가 상대가 닫기를 기다리는 최대 시간
+#define NET_LINGER_CHECK_MS 100       // 그 시간이 지났는지 확인하는 간격
+#define NET_MAX_LISTENERS 8
+#define NET_POOL_CHUNK 64             // 연결과 쓰기 버퍼 풀이 한 번에 늘리는 개수
+
+// net_listen_tcp, net_listen_unix 플래그 (REUSEPORT는 TCP만)
+#define NET_LISTEN_NONBLOCK 1
+#define NET_LISTEN_REUSEPORT 2
+
+typedef struct NetReactor NetReactor;
+typedef struct NetConn NetConn;
+typedef struct NetBuffer NetBuffer;
+
+// data 앞부분에 완성된 메시지가 있으면 그 길이, 더 읽어야 하면 0, 프로토콜 오류면 -1
+typedef ssize_t (*NetFramer)(const char *data, size_t len);
+// 메시지 하나 (data[len]은 '\0'이라 문자열로 써도 됨, 콜백이 끝나면 무효)
+typedef void (*NetMessageCallback)(NetConn *conn, char *data, size_t len);
+// 연결이 끊김 (콜백이 끝나면 소켓을 닫고 NetConn을 해제)
+typedef void (*NetCloseCallback)(NetConn *conn);
+// 새 연결 (논블로킹 소켓), net_conn_open으로 등록하거나 닫아야 함
+// net_reactor_watch로 등록한 소켓이면 읽을 것이 생긴 그 소켓
+typedef void (*NetAcceptCallback)(NetReactor *reactor, int fd, void *arg);
+
+struct NetConn {
+    int kind; // epoll 이벤트 구분용 (NetListener와 같은 위치)
+    int fd;
+    NetReactor *reactor;
+    NetFramer framer;
+    NetMessageCallback on_message;
+    NetCloseCallback on_close;
+    void *user;              // 서버가 붙이는 연결별 상태
+    int closing;             // net_conn_close 또는 전송 실패 (더 보내지 않음)
+    int lingering;           // net_conn_close_flush: 쓰기 큐를 다 보내고 상대가 닫기를 기다리는 중
+    int closed;              // on_close까지 끝남 (이번 루프가 끝나면 해제)
+    int want_write;          // EPOLLOUT 등록 여부
+    NetBuffer *write_head;   // 쓰기 큐
+    NetBuffer *write_tail;
+    size_t write_queued;     // 쓰기 큐에 남은 바이트
+    NetConn *next_free;      // 해제 대기 목록
+    size_t read_next;        // 메시지 콜백 중이면 지금 메시지 다음 위치 (아니면 0)
+    char read_next_byte;     // 그 자리의 원래 바이트 (콜백 동안 '\0'으로 바꿔 둠)
+    size_t read_len;
+    uint64_t last_read_ms;   // 마지막으로 무엇이든 받은 시각 (하트비트)
+    uint64_t last_ping_ms;   // 마지막으로 ping을 보낸 시각
+    uint64_t linger_ms;      // 이때까지 상대가 닫지 않으면 그냥 닫음 (lingering)
+    char read_buf[NET_READ_BUFFER + 1]; // 메시지 끝에 '\0'을 붙일 자리 1바이트
+};
+
+typedef struct {
+    int kind;
+    int fd;
+    NetAcceptCallback callback;
+    void *arg;
+} NetListener;
+
+struct NetReactor {
+    int epoll_fd;
+    int wake_fd; // net_reactor_stop이 깨우는 eventfd
+    int spare_fd; // 파일 디스크립터가 바닥났을 때 대기 중인 연결을 받아 끊는 데 쓰는 예비 fd
+    volatile int running;
+    NetListener listeners[NET_MAX_LISTENERS];
+    int listener_count;
+    NetConn **conns; // fd로 찾는 연결 표 (net_conn_of)
+    int conn_capacity;
+    size_t conn_count;
+    NetConn *free_list; // 이번 루프에서 닫은 연결 (루프 끝에 풀로 돌려줌)
+    SlabPool conn_pool;   // NetConn (accept마다 malloc하지 않음)
+    SlabPool buffer_pool; // 쓰기 큐 버퍼 (NET_WRITE_CHUNK 크기 하나로 통일)
+    size_t lingering_count; // net_conn_close_flush로 닫는 중인 연결 수
+};
+
+// 하트비트 (net_heartbeat_start로 시작, 리액터와 같은 스레드의 타이머 휠에서 돈다)
+// 받은 바이트는 무엇이든 살아 있다는 표시이므로 상대는 ping에 짧은 답 (PONG 등)만 보내면 됨
+typedef struct {
+    NetReactor *reactor;
+    TimerWheel *timers;
+    TimerEntry timer;
+    unsigned interval_ms;     // 이만큼 받은 것이 없으면 ping (그 뒤로도 이 간격마다)
+    unsigned timeout_ms;      // 이만큼 받은 것이 없으면 끊음
+    const void *ping;         // 보낼 ping 메시지 (프레임 한 개)
+    size_t ping_len;
+    NetCloseCallback on_reap; // 끊기 직전에 부름 (NULL이어도 됨), 이어서 연결의 on_close
+    unsigned long pings;      // 보낸 ping 수
+    unsigned long reaped;     // 응답이 없어 끊은 연결 수
+} NetHeartbeat;
+
+// 모든 주소의 port에서 듣는 TCP 소켓 (SO_REUSEADDR), 실패 시 -1
+int net_listen_tcp(int port, int backlog, int flags);
+// 같은 컴퓨터용 Unix 소켓 ('@'로 시작하면 추상 소켓, 아니면 파일 경로), 실패 시 -1
+int net_listen_unix(const char *name, int backlog, int flags);
+// 여러 리스닝 소켓 중 먼저 들어온 연결을 받음 (which에 몇 번째 소켓인지), 실패 시 -1
+int net_accept_any(const int *listen_fds, int count, int *which);
+int net_set_nonblocking(int fd);
+// 블로킹 소켓용: 상대가 사라진 연결 감지 (TCP keepalive), recv 제한 시간 (넘으면 EAGAIN)
+int net_set_keepalive(int fd, int idle_s, int interval_s, int count);
+int net_set_recv_timeout(int fd, int seconds);
+
+// 클라이언트 연결 (실패 시 -1, errno 유지, 메시지는 호출한 쪽이 출력)
+int net_connect_tcp(const char *host, int port);
+int net_connect_unix(const char *name);
+// host가 이 컴퓨터면 unix_name으로 먼저 연결하고, 안 되면 host:port TCP로
+int net_connect_local(const char *unix_name, const char *host, int port);
+
+// 블로킹 소켓에 len바이트를 끝까지 보냄, 실패 시 -1
+int net_send_all(int fd, const void *data, size_t len);
+// 블로킹 소켓에서 정확히 len바이트를 받음, 그 전에 끊기면 0, 오류면 -1
+ssize_t net_recv_all(int fd, void *buf, size_t len);
+
+// 프레임 함수
+// 줄바꿈까지 한 줄 (줄바꿈 없이 버퍼가 차면 그때까지를 한 줄로)
+ssize_t net_frame_line(const char *data, size_t len);
+// [타입 1바이트][payload 길이 2바이트 (network order)][payload]
+ssize_t net_frame_len16(const char *data, size_t len);
+
+int net_reactor_init(NetReactor *reactor);
+void net_reactor_destroy(NetReactor *reactor);
+// 리스닝 소켓 등록 (논블로킹으로 바꿈), 실패 시 -1
+int net_reactor_listen(NetReactor *reactor, int listen_fd, NetAcceptCallback callback, void *arg);
+// 읽을 것이 생기면 callback을 부를 소켓 등록 (논블로킹으로 바꿈, 리스너와 자리를 같이 씀), 실패 시 -1
+int net_reactor_watch(NetReactor *reactor, int fd, NetAcceptCallback callback, void *arg);
+// 리스닝 / 감시 소켓을 리액터에서 뺌 (소켓은 닫지 않음, 콜백 안에서도 됨), 없는 소켓이면 -1
+int net_reactor_remove(NetReactor *reactor, int fd);
+// net_reactor_stop까지 이벤트와 timers를 처리 (timers는 NULL이어도 됨), 오류 시 -1
+int net_reactor_run(NetReactor *reactor, TimerWheel *timers);
+// 다른 스레드나 시그널 핸들러에서 불러도 됨
+void net_reactor_stop(NetReactor *reactor);
+
+// 연결 등록, 실패 시 NULL (fd는 호출한 쪽이 닫음)
+NetConn *net_conn_open(NetReactor *reactor, int fd, NetFramer framer, NetMessageCallback on_message,
+                       NetCloseCallback on_close, void *user);
+// fd의 연결 (없으면 NULL)
+NetConn *net_conn_of(NetReactor *reactor, int fd);
+// 보낼 수 있는 만큼 바로 보내고 나머지는 쓰기 큐에, 연결이 끊겼으면 -1
+int net_conn_send(NetConn *conn, const void *data, size_t len);
+// 연결 종료 요청 (on_close는 다음 이벤트 처리 때 리액터가 부름)
+// 쓰기 큐에 남은 것은 버리고, 읽지 않은 입력이 있으면 상대는 RST를 받을 수 있음
+void net_conn_close(NetConn *conn);
+// 쓰기 큐를 다 보낸 뒤 닫음 (거절 메시지를 보내고 끊을 때)
+// 보내기를 닫고 (SHUT_WR) 상대가 닫을 때까지 입력은 읽어 버림, NET_LINGER_MS가 지나면 그냥 닫음
+void net_conn_close_flush(NetConn *conn);
+
+// 하트비트 시작 (timeout_ms가 0이면 하지 않음, interval_ms는 timeout_ms의 절반 이하로 맞춤)
+// timers는 net_reactor_run에 넘기는 휠이어야 함 (콜백이 리액터 스레드에서 돌도록)
+void net_heartbeat_start(NetHeartbeat *heartbeat, NetReactor *reactor, TimerWheel *timers, unsigned interval_ms,
+                         unsigned timeout_ms, const void *ping, size_t ping_len, NetCloseCallback on_reap);
+void net_heartbeat_stop(NetHeartbeat *heartbeat);
+
+// 연결을 다른 프로세스로 넘길 때 (SCM_RIGHTS)
+// 아직 처리하지 않은 입력 (메시지 콜백 안이면 지금 메시지 다음부터)과 보내지 못한 출력을
+// buf에 [입력][출력] 순서로 복사, 공간이 모자라면 -1
+int net_conn_snapshot(const NetConn *conn, char *buf, size_t size, size_t *input_len, size_t *output_len);
+// 소켓을 닫지 않고 리액터에서 떼어 냄 (on_close 없음, 메시지 콜백 안에서도 됨), 소켓 fd를 돌려줌
+int net_conn_detach(NetConn *conn);
+// 다른 프로세스에서 넘겨받은 입력을 소켓에서 읽은 것처럼 처리, 읽기 버퍼가 모자라면 -1
+int net_conn_feed(NetConn *conn, const char *data, size_t len);
+
+#endif
@@ -0,0 +1,176 @@
+// net_bench.c
+// 같은 컴퓨터에서 TCP 루프백과 Unix 소켓을 비교하는 벤치마크
+//   net_bench [왕복 횟수] [메시지 크기]
+// 리액터 스레드에 줄 단위 에코 서버를 두고 (게임 서버와 같은 경로: net_conn_send, 쓰기 큐),
+// 클라이언트는 블로킹 소켓으로
+//   - 왕복: 한 줄 보내고 에코를 받을 때까지 기다리기를 반복 (지연 시간 분포)
+//   - 연속: 한 번에 여러 줄을 보내고 모두 받기 (초당 메시지 수)
+// 를 재고, 프로세스 전체의 CPU 시간(서버 + 클라이언트)을 메시지당으로 나눠 출력
+#define _GNU_SOURCE
+#include "net.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_PORT 39871
+#define BENCH_UNIX_NAME "@net_bench"
+#define BENCH_WARMUP 1000
+#define BENCH_BURST 64 // 연속 측정에서 한 번에 보내는 줄 수
+
+static NetReactor reactor;
+
+static void echo_message(NetConn *conn, char *data, size_t len) {
+    net_conn_send(conn, data, len);
+}
+
+static void echo_closed(NetConn *conn) {
+    (void)conn;
+}
+
+static void echo_accept(NetReactor *r, int fd, void *arg) {
+    (void)arg;
+    if (!net_conn_open(r, fd, net_frame_line, echo_message, echo_closed, NULL)) {
+        close(fd);
+    }
+}
+
+static void *reactor_thread(void *arg) {
+    (void)arg;
+    net_reactor_run(&reactor, NULL);
+    return NULL;
+}
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static double cpu_us(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e6 + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// 한 줄을 보내고 에코를 모두 받음
+static int round_trip(int fd, const char *line, char *reply, size_t size) {
+    if (net_send_all(fd, line, size) < 0 || net_recv_all(fd, reply, size) <= 0) {
+        return -1;
+    }
+    return 0;
+}
+
+static int run_transport(const char *label, int fd, int rounds, size_t size) {
+    char *line = malloc(size * BENCH_BURST);
+    char *reply = malloc(size * BENCH_BURST);
+    double *samples = malloc(sizeof(double) * (size_t)rounds);
+    if (!line || !reply || !samples) {
+        free(line);
+        free(reply);
+        free(samples);
+        return -1;
+    }
+    memset(line, 'x', size * BENCH_BURST);
+    for (int i = 0; i < BENCH_BURST; i++) {
+        line[(size_t)i * size + size - 1] = '\n';
+    }
+
+    int result = -1;
+    for (int i = 0; i < BENCH_WARMUP; i++) {
+        if (round_trip(fd, line, reply, size) < 0)
+            goto out;
+    }
+
+    // 왕복 지연 시간
+    double cpu_start = cpu_us();
+    double wall_start = now_us();
+    for (int i = 0; i < rounds; i++) {
+        double start = now_us();
+        if (round_trip(fd, line, reply, size) < 0)
+            goto out;
+        samples[i] = now_us() - start;
+    }
+    double wall = now_us() - wall_start;
+    double cpu = cpu_us() - cpu_start;
+    qsort(samples, (size_t)rounds, sizeof(double), compare_double);
+
+    // 연속 전송 (한 번에 BENCH_BURST줄, 응답이 쌓이기 전에 모두 읽음)
+    int bursts = rounds / BENCH_BURST > 0 ? rounds / BENCH_BURST : 1;
+    double burst_cpu_start = cpu_us();
+    double burst_start = now_us();
+    for (int i = 0; i < bursts; i++) {
+        if (round_trip(fd, line, reply, size * BENCH_BURST) < 0)
+            goto out;
+    }
+    double burst_wall = now_us() - burst_start;
+    double burst_cpu = cpu_us() - burst_cpu_start;
+    double burst_messages = (double)bursts * BENCH_BURST;
+
+    printf("%-6s %9.1f %9.1f %9.1f %9.2f %12.0f %9.2f\n", label, wall / rounds, samples[rounds / 2],
+           samples[(size_t)rounds * 99 / 100], cpu / rounds, burst_messages / (burst_wall / 1e6),
+           burst_cpu / burst_messages);
+    result = 0;
+out:
+    free(line);
+    free(reply);
+    free(samples);
+    return result;
+}
+
+int main(int argc, char **argv) {
+    int rounds = argc > 1 ? atoi(argv[1]) : 20000;
+    size_t size = argc > 2 ? (size_t)atol(argv[2]) : 64;
+    if (rounds < 1 || size < 2 || size > NET_READ_BUFFER) {
+        fprintf(stderr, "usage: %s [round_trips] [message_size (2..%d)]\n", argv[0], NET_READ_BUFFER);
+        return 1;
+    }
+
+    int tcp_fd = net_listen_tcp(BENCH_PORT, SOMAXCONN, 0);
+    int unix_fd = net_listen_unix(BENCH_UNIX_NAME, SOMAXCONN, 0);
+    if (tcp_fd < 0 || unix_fd < 0 || net_reactor_init(&reactor) < 0 ||
+        net_reactor_listen(&reactor, tcp_fd, echo_accept, NULL) < 0 ||
+        net_reactor_listen(&reactor, unix_fd, echo_accept, NULL) < 0) {
+        return 1;
+    }
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, reactor_thread, NULL) != 0) {
+        perror("리액터 스레드 생성 실패");
+        return 1;
+    }
+
+    printf("왕복 %d회, 메시지 %zu바이트, 연속 전송은 %d줄씩\n", rounds, size, BENCH_BURST);
+    printf("%-6s %9s %9s %9s %9s %12s %9s\n", "", "avg(us)", "p50(us)", "p99(us)", "cpu/rt", "burst msg/s",
+           "cpu/msg");
+
+    int status = 0;
+    int fd = net_connect_tcp("127.0.0.1", BENCH_PORT);
+    if (fd < 0 || run_transport("tcp", fd, rounds, size) < 0) {
+        perror("TCP 측정 실패");
+        status = 1;
+    }
+    if (fd >= 0)
+        close(fd);
+
+    fd = net_connect_unix(BENCH_UNIX_NAME);
+    if (fd < 0 || run_transport("unix", fd, rounds, size) < 0) {
+        perror("Unix 소켓 측정 실패");
+        status = 1;
+    }
+    if (fd >= 0)
+        close(fd);
+
+    net_reactor_stop(&reactor);
+    pthread_join(thread, NULL);
+    net_reactor_destroy(&reactor);
+    return status;
+}
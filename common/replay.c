@@ -0,0 +1,213 @@
+// replay.c
+#define _GNU_SOURCE
+#include "replay.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// 버퍼 전체를 끝까지 기록
+static int write_all(int fd, const void *buf, size_t len) {
+    const char *p = buf;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+/*
+ * 함수: build_turn_index
+ * 설명: MOVE_START 이후 게임 기록(16번 이상)을 턴 단위로 나눠 각 턴의 첫 기록 위치를 모음
+ * 입력: 기록 배열, 기록 수, 턴 구분 함수, 결과 배열 (기록 수 이상 크기)
+ * 출력: 턴 수
+ */
+static uint32_t build_turn_index(const MoveRecord *records, size_t count, replay_turn_end_fn turn_ends,
+                                 uint32_t *index) {
+    uint32_t turns = 0;
+    int started = 0, open_turn = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (records[i].kind == MOVE_START) {
+            started = 1;
+            continue;
+        }
+        if (!started || records[i].kind < 16) {
+            continue;
+        }
+        if (!open_turn) {
+            index[turns++] = (uint32_t)i;
+            open_turn = 1;
+        }
+        if (turn_ends(&records[i])) {
+            open_turn = 0;
+        }
+    }
+    return turns;
+}
+
+/*
+ * 함수: replay_write_from_log
+ * 설명: 끝난 게임의 이동 기록을 리플레이 파일로 옮김 (임시 파일에 쓰고 fsync 후 rename)
+ *       이동 기록은 호출한 쪽에서 이후에 지운다
+ * 입력: 이동 기록 경로, 규칙 값, 이긴 자리, 종료 사유, 턴 구분 함수
+ * 출력: 성공 0, 실패 -1
+ */
+int replay_write_from_log(const char *log_path, const uint8_t rules[REPLAY_RULES_SIZE], uint8_t winner,
+                          uint8_t end_reason, replay_turn_end_fn turn_ends) {
+    MoveLogHeader log_header;
+    MoveRecord *records = NULL;
+    size_t count = 0;
+    if (movelog_load(log_path, &log_header, &records, &count) < 0) {
+        return -1;
+    }
+
+    uint32_t *index = malloc((count + 1) * sizeof(uint32_t));
+    if (!index) {
+        perror("malloc");
+        free(records);
+        return -1;
+    }
+
+    ReplayHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, REPLAY_MAGIC, sizeof(header.magic));
+    header.version = REPLAY_VERSION;
+    header.game = log_header.game;
+    header.session_id = log_header.session_id;
+    header.seed = log_header.seed;
+    header.started_at = log_header.started_at;
+    header.finished_at = (int64_t)time(NULL);
+    memcpy(header.rules, rules, REPLAY_RULES_SIZE);
+    header.record_count = (uint32_t)count;
+    header.turn_count = build_turn_index(records, count, turn_ends, index);
+    header.winner = winner;
+    header.end_reason = end_reason;
+
+    ReplayFooter footer;
+    memset(&footer, 0, sizeof(footer));
+    footer.index_offset = (uint32_t)(sizeof(ReplayHeader) + count * sizeof(MoveRecord));
+    footer.turn_count = header.turn_count;
+    memcpy(footer.magic, REPLAY_FOOTER_MAGIC, sizeof(footer.magic));
+
+    char path[MOVELOG_PATH_MAX], tmp_path[MOVELOG_PATH_MAX + 4];
+    snprintf(path, sizeof(path), "%s/%s-%lld-%u.rpl", REPLAY_DIR, header.game == MOVELOG_GAME_CODA ? "coda" : "battleship",
+             (long long)header.started_at, header.session_id);
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    int rc = -1;
+    if (mkdir(REPLAY_DIR, 0755) < 0 && errno != EEXIST) {
+        perror("mkdir replays");
+    } else {
+        int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            perror("open replay");
+        } else {
+            if (write_all(fd, &header, sizeof(header)) == 0 &&
+                write_all(fd, records, count * sizeof(MoveRecord)) == 0 &&
+                write_all(fd, index, header.turn_count * sizeof(uint32_t)) == 0 &&
+                write_all(fd, &footer, sizeof(footer)) == 0 && fdatasync(fd) == 0) {
+                rc = 0;
+            } else {
+                perror("write replay");
+            }
+            close(fd);
+            if (rc == 0 && rename(tmp_path, path) < 0) {
+                perror("rename replay");
+                rc = -1;
+            }
+            if (rc < 0) {
+                unlink(tmp_path);
+            }
+        }
+    }
+
+    free(index);
+    free(records);
+    return rc;
+}
+
+/*
+ * 함수: replay_open
+ * 설명: 리플레이 파일을 읽기 전용으로 mmap하고 헤더/푸터 크기를 검증
+ * 입력: 파일 경로, 결과 Replay
+ * 출력: 성공 0, 실패 -1
+ */
+int replay_open(const char *path, Replay *replay) {
+    memset(replay, 0, sizeof(*replay));
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(ReplayHeader) + sizeof(ReplayFooter)) {
+        close(fd);
+        return -1;
+    }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+
+    const ReplayHeader *header = map;
+    size_t expected = sizeof(ReplayHeader) + (size_t)header->record_count * sizeof(MoveRecord) +
+                      (size_t)header->turn_count * sizeof(uint32_t) + sizeof(ReplayFooter);
+    const ReplayFooter *footer = (const ReplayFooter *)((const char *)map + st.st_size - sizeof(ReplayFooter));
+    if (memcmp(header->magic, REPLAY_MAGIC, sizeof(header->magic)) != 0 || header->version != REPLAY_VERSION ||
+        expected != (size_t)st.st_size || memcmp(footer->magic, REPLAY_FOOTER_MAGIC, sizeof(footer->magic)) != 0 ||
+        footer->turn_count != header->turn_count ||
+        footer->index_offset != sizeof(ReplayHeader) + (size_t)header->record_count * sizeof(MoveRecord)) {
+        munmap(map, (size_t)st.st_size);
+        return -1;
+    }
+
+    replay->map = map;
+    replay->map_size = (size_t)st.st_size;
+    replay->header = header;
+    replay->records = (const MoveRecord *)(header + 1);
+    replay->turn_index = (const uint32_t *)((const char *)map + footer->index_offset);
+    return 0;
+}
+
+void replay_close(Replay *replay) {
+    if (replay->map) {
+        munmap(replay->map, replay->map_size);
+    }
+    memset(replay, 0, sizeof(*replay));
+}
+
+/*
+ * 함수: replay_turn
+ * 설명: 턴 인덱스로 해당 턴의 기록 범위를 바로 찾음 (앞의 기록을 읽지 않음)
+ * 입력: Replay, 턴 번호(0부터), 첫 기록과 기록 수를 받을 포인터
+ * 출력: 성공 0, 범위 밖 -1
+ */
+int replay_turn(const Replay *replay, uint32_t turn, const MoveRecord **first, size_t *count) {
+    const ReplayHeader *header = replay->header;
+    if (turn >= header->turn_count) {
+        return -1;
+    }
+    uint32_t begin = replay->turn_index[turn];
+    uint32_t end = turn + 1 < header->turn_count ? replay->turn_index[turn + 1] : header->record_count;
+    if (begin > end || end > header->record_count) {
+        return -1;
+    }
+    // 마지막 턴 뒤의 MOVE_END 같은 공통 기록은 턴에 포함하지 않음
+    while (end > begin && replay->records[end - 1].kind < 16) {
+        end--;
+    }
+    *first = &replay->records[begin];
+    *count = end - begin;
+    return 0;
+}
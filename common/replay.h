@@ -0,0 +1,62 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "movelog.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * 끝난 게임의 리플레이 파일
+ * [ReplayHeader 64바이트][MoveRecord * record_count][턴 인덱스 uint32 * turn_count][ReplayFooter]
+ * 이동 기록(movelog)을 그대로 옮기고, 각 턴이 시작하는 기록 위치를 인덱스로 붙인다.
+ * 모든 위치가 헤더의 개수로 계산되므로 mmap 후 임의의 턴을 O(1)로 찾을 수 있다.
+ */
+#define REPLAY_MAGIC "RPLY"
+#define REPLAY_FOOTER_MAGIC "RIDX"
+#define REPLAY_VERSION 1
+#define REPLAY_DIR "replays"
+#define REPLAY_RULES_SIZE 16
+#define REPLAY_NO_WINNER 0xff
+
+typedef struct {
+    char magic[4];
+    uint16_t version;
+    uint16_t game;
+    uint32_t session_id;
+    uint32_t seed;
+    int64_t started_at;
+    int64_t finished_at;
+    uint8_t rules[REPLAY_RULES_SIZE]; // 게임별 규칙 값 (각 서버에서 정의)
+    uint32_t record_count;
+    uint32_t turn_count;
+    uint8_t winner; // 이긴 자리 번호, 없으면 REPLAY_NO_WINNER
+    uint8_t end_reason;
+    uint8_t reserved[6];
+} ReplayHeader;
+
+typedef struct {
+    uint32_t index_offset; // 파일 처음부터 턴 인덱스까지의 거리
+    uint32_t turn_count;
+    char magic[4];
+    uint32_t reserved;
+} ReplayFooter;
+
+// 게임별 턴 구분: 이 기록으로 현재 턴이 끝나면 1
+typedef int (*replay_turn_end_fn)(const MoveRecord *record);
+
+// mmap으로 연 리플레이 (records, turn_index는 매핑된 메모리를 가리킴)
+typedef struct {
+    void *map;
+    size_t map_size;
+    const ReplayHeader *header;
+    const MoveRecord *records;
+    const uint32_t *turn_index;
+} Replay;
+
+int replay_write_from_log(const char *log_path, const uint8_t rules[REPLAY_RULES_SIZE], uint8_t winner,
+                          uint8_t end_reason, replay_turn_end_fn turn_ends);
+int replay_open(const char *path, Replay *replay);
+void replay_close(Replay *replay);
+int replay_turn(const Replay *replay, uint32_t turn, const MoveRecord **first, size_t *count);
+
+#endif
@@ -0,0 +1,186 @@
+// replay_tool.c
+// 리플레이 파일 조회/통계 도구
+//   replay_tool show <파일> [턴]   헤더와 턴 목록, 또는 지정한 턴의 이동만 출력
+//   replay_tool stats <디렉터리|파일>...   여러 리플레이의 헤더만 읽어 통계 출력
+#define _GNU_SOURCE
+#include "replay.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+// 게임별 기록 종류 이름 (coda_module/server.c, battle_ship/server/include/gameLogic.h와 같은 번호)
+static const char *kind_name(uint16_t game, uint8_t kind) {
+    if (kind == MOVE_START)
+        return "START";
+    if (kind == MOVE_END)
+        return "END";
+    if (game == MOVELOG_GAME_CODA) {
+        switch (kind) {
+        case 16:
+            return "GUESS";
+        case 17:
+            return "PASS";
+        case 18:
+            return "END_TURN";
+        }
+    } else if (game == MOVELOG_GAME_BATTLESHIP) {
+        switch (kind) {
+        case 16:
+            return "SHOT";
+        case 17:
+            return "GRID_ROW";
+        }
+    }
+    return "?";
+}
+
+static const char *game_label(uint16_t game) {
+    if (game == MOVELOG_GAME_CODA)
+        return "coda";
+    if (game == MOVELOG_GAME_BATTLESHIP)
+        return "battleship";
+    return "unknown";
+}
+
+static void print_record(uint16_t game, const MoveRecord *r) {
+    printf("  #%-5u P%d %-8s", r->seq, r->player + 1, kind_name(game, r->kind));
+    if (game == MOVELOG_GAME_CODA && r->kind == 16) {
+        printf(" %d %c %d -> %s", r->arg[0], r->arg[1] ? r->arg[1] : '?', r->arg[2], r->arg[3] ? "정답" : "오답");
+    } else if (game == MOVELOG_GAME_BATTLESHIP && r->kind == 16) {
+        if (r->arg[0] == 0xff)
+            printf(" (무효)");
+        else
+            printf(" (%d %d)", r->arg[0] + 1, r->arg[1] + 1);
+    } else {
+        for (int i = 0; i < 4; i++)
+            printf(" %02x", r->arg[i]);
+    }
+    printf("\n");
+}
+
+static int cmd_show(const char *path, long turn) {
+    Replay replay;
+    if (replay_open(path, &replay) < 0) {
+        fprintf(stderr, "%s: 리플레이 파일을 열 수 없습니다\n", path);
+        return 1;
+    }
+    const ReplayHeader *h = replay.header;
+    printf("%s 세션 %u  seed %u  기록 %u  턴 %u  %lld초\n", game_label(h->game), h->session_id, h->seed, h->record_count,
+           h->turn_count, (long long)(h->finished_at - h->started_at));
+    if (h->winner == REPLAY_NO_WINNER)
+        printf("승자 없음 (종료 사유 %d)\n", h->end_reason);
+    else
+        printf("승자 P%d (종료 사유 %d)\n", h->winner + 1, h->end_reason);
+
+    if (turn < 0) {
+        for (uint32_t t = 0; t < h->turn_count; t++) {
+            const MoveRecord *first;
+            size_t count;
+            if (replay_turn(&replay, t, &first, &count) == 0 && count > 0)
+                printf("턴 %-4u P%d  이동 %zu개\n", t, first->player + 1, count);
+        }
+    } else {
+        const MoveRecord *first;
+        size_t count;
+        if (replay_turn(&replay, (uint32_t)turn, &first, &count) < 0) {
+            fprintf(stderr, "턴 %ld 없음 (0 ~ %u)\n", turn, h->turn_count ? h->turn_count - 1 : 0);
+            replay_close(&replay);
+            return 1;
+        }
+        printf("턴 %ld:\n", turn);
+        for (size_t i = 0; i < count; i++)
+            print_record(h->game, &first[i]);
+    }
+    replay_close(&replay);
+    return 0;
+}
+
+// 게임 종류별 누적 통계
+typedef struct {
+    unsigned long games;
+    unsigned long long turns;
+    unsigned long long records;
+    unsigned long long seconds;
+    uint32_t max_turns;
+    unsigned long wins[3]; // P1, P2, 승자 없음
+} GameStats;
+
+static GameStats stats[3];
+static unsigned long bad_files = 0;
+
+static void add_file(const char *path) {
+    Replay replay;
+    if (replay_open(path, &replay) < 0) {
+        bad_files++;
+        return;
+    }
+    const ReplayHeader *h = replay.header;
+    GameStats *g = &stats[h->game <= MOVELOG_GAME_BATTLESHIP ? h->game : 0];
+    g->games++;
+    g->turns += h->turn_count;
+    g->records += h->record_count;
+    if (h->finished_at > h->started_at)
+        g->seconds += (unsigned long long)(h->finished_at - h->started_at);
+    if (h->turn_count > g->max_turns)
+        g->max_turns = h->turn_count;
+    g->wins[h->winner < 2 ? h->winner : 2]++;
+    replay_close(&replay);
+}
+
+static void add_path(const char *path) {
+    struct stat st;
+    if (stat(path, &st) < 0) {
+        perror(path);
+        return;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        add_file(path);
+        return;
+    }
+    DIR *dir = opendir(path);
+    if (!dir) {
+        perror(path);
+        return;
+    }
+    struct dirent *entry;
+    char full[4096];
+    while ((entry = readdir(dir)) != NULL) {
+        size_t len = strlen(entry->d_name);
+        if (len < 4 || strcmp(entry->d_name + len - 4, ".rpl") != 0)
+            continue;
+        snprintf(full, sizeof(full), "%s/%s", path, entry->d_name);
+        add_file(full);
+    }
+    closedir(dir);
+}
+
+static int cmd_stats(int argc, char **argv) {
+    for (int i = 0; i < argc; i++)
+        add_path(argv[i]);
+
+    for (int game = MOVELOG_GAME_CODA; game <= MOVELOG_GAME_BATTLESHIP; game++) {
+        GameStats *g = &stats[game];
+        if (g->games == 0)
+            continue;
+        printf("%s: %lu판\n", game_label((uint16_t)game), g->games);
+        printf("  평균 턴 %.1f (최대 %u), 평균 기록 %.1f, 평균 %.1f초\n", (double)g->turns / g->games, g->max_turns,
+               (double)g->records / g->games, (double)g->seconds / g->games);
+        printf("  승리 P1 %lu / P2 %lu / 승자 없음 %lu\n", g->wins[0], g->wins[1], g->wins[2]);
+    }
+    if (bad_files > 0)
+        printf("읽을 수 없는 파일 %lu개\n", bad_files);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc >= 3 && strcmp(argv[1], "show") == 0)
+        return cmd_show(argv[2], argc >= 4 ? atol(argv[3]) : -1);
+    if (argc >= 3 && strcmp(argv[1], "stats") == 0)
+        return cmd_stats(argc - 2, argv + 2);
+
+    fprintf(stderr, "usage: %s show <file> [turn]\n", argv[0]);
+    fprintf(stderr, "       %s stats <dir|file>...\n", argv[0]);
+    return 1;
+}
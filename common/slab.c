@@ -0,0 +1,105 @@
+// slab.c
+#define _GNU_SOURCE
+#include "slab.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+struct SlabChunk {
+    SlabChunk *next;
+};
+
+// 청크 머리 뒤 첫 객체 위치 (정렬 유지)
+#define SLAB_HEADER_SIZE ((sizeof(SlabChunk) + SLAB_ALIGN - 1) & ~(size_t)(SLAB_ALIGN - 1))
+
+// 잠금을 잡은 상태에서 호출
+static int add_chunk(SlabPool *pool) {
+    SlabChunk *chunk = malloc(SLAB_HEADER_SIZE + pool->object_size * pool->per_chunk);
+    if (!chunk) {
+        perror("slab 청크 할당 실패");
+        return -1;
+    }
+    chunk->next = pool->chunks;
+    pool->chunks = chunk;
+
+    // 청크 안의 객체를 앞에서부터 꺼내도록 뒤에서부터 free list에 넣음
+    char *base = (char *)chunk + SLAB_HEADER_SIZE;
+    for (size_t i = pool->per_chunk; i > 0; i--) {
+        void *object = base + (i - 1) * pool->object_size;
+        *(void **)object = pool->free_list;
+        pool->free_list = object;
+    }
+    pool->stats.capacity += pool->per_chunk;
+    pool->stats.chunks++;
+    return 0;
+}
+
+/*
+ * 함수: slab_pool_init
+ * 설명: 객체 크기를 정렬 단위로 올려 풀을 만들고 첫 청크를 미리 할당
+ * 입력: 풀, 이름 (통계 출력용), 객체 크기, 청크당 객체 수
+ * 출력: 성공 0, 실패 -1
+ */
+int slab_pool_init(SlabPool *pool, const char *name, size_t object_size, size_t per_chunk) {
+    pthread_mutex_init(&pool->lock, NULL);
+    pool->name = name;
+    if (object_size < sizeof(void *)) {
+        object_size = sizeof(void *);
+    }
+    pool->object_size = (object_size + SLAB_ALIGN - 1) & ~(size_t)(SLAB_ALIGN - 1);
+    pool->per_chunk = per_chunk ? per_chunk : 1;
+    pool->free_list = NULL;
+    pool->chunks = NULL;
+    pool->stats = (SlabStats){0};
+    return add_chunk(pool);
+}
+
+void slab_pool_destroy(SlabPool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    SlabChunk *chunk = pool->chunks;
+    while (chunk) {
+        SlabChunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    pool->chunks = NULL;
+    pool->free_list = NULL;
+    pool->stats.capacity = 0;
+    pool->stats.chunks = 0;
+    pool->stats.in_use = 0;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void *slab_alloc(SlabPool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    if (!pool->free_list && add_chunk(pool) < 0) {
+        pthread_mutex_unlock(&pool->lock);
+        return NULL;
+    }
+    void *object = pool->free_list;
+    pool->free_list = *(void **)object;
+    pool->stats.allocs++;
+    pool->stats.in_use++;
+    if (pool->stats.in_use > pool->stats.peak) {
+        pool->stats.peak = pool->stats.in_use;
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return object;
+}
+
+void slab_free(SlabPool *pool, void *object) {
+    if (!object) {
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    *(void **)object = pool->free_list;
+    pool->free_list = object;
+    pool->stats.frees++;
+    pool->stats.in_use--;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void slab_pool_stats(SlabPool *pool, SlabStats *out) {
+    pthread_mutex_lock(&pool->lock);
+    *out = pool->stats;
+    pthread_mutex_unlock(&pool->lock);
+}
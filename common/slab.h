@@ -0,0 +1,51 @@
+#ifndef SLAB_H
+#define SLAB_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * 고정 크기 객체 풀 (slab)
+ * 객체 여러 개를 담은 청크를 한 번에 malloc하고, 해제된 객체는 풀의 free list로 돌려서
+ * 다음 할당에 그대로 재사용한다. 청크는 풀을 없앨 때까지 돌려주지 않으므로
+ * 접속이 들어왔다 나가기를 반복해도 요청 처리 중에는 malloc/free를 부르지 않는다
+ * (free list가 비었을 때만 새 청크를 할당).
+ * 객체 종류마다 풀을 하나씩 두며, 여러 스레드에서 써도 된다.
+ */
+#define SLAB_ALIGN 16
+
+typedef struct SlabChunk SlabChunk;
+
+typedef struct {
+    uint64_t allocs;   // 누적 할당 수
+    uint64_t frees;    // 누적 해제 수
+    size_t in_use;     // 지금 쓰는 객체 수
+    size_t peak;       // in_use 최댓값
+    size_t capacity;   // 청크에 있는 전체 객체 수
+    size_t chunks;     // malloc한 청크 수
+} SlabStats;
+
+typedef struct {
+    pthread_mutex_t lock;
+    const char *name;
+    size_t object_size; // SLAB_ALIGN 배수로 올린 크기
+    size_t per_chunk;
+    void *free_list;    // 해제된 객체 (객체 첫 부분에 다음 포인터를 씀)
+    SlabChunk *chunks;
+    SlabStats stats;
+} SlabPool;
+
+// per_chunk개씩 청크를 할당하는 풀 (첫 청크는 바로 할당), 실패 시 -1
+int slab_pool_init(SlabPool *pool, const char *name, size_t object_size, size_t per_chunk);
+
+// 풀의 모든 청크 해제 (아직 쓰는 객체도 함께 사라짐)
+void slab_pool_destroy(SlabPool *pool);
+
+// 객체 하나 할당 (내용은 초기화하지 않음), 메모리가 없으면 NULL
+void *slab_alloc(SlabPool *pool);
+void slab_free(SlabPool *pool, void *object);
+
+void slab_pool_stats(SlabPool *pool, SlabStats *out);
+
+#endif
@@ -0,0 +1,147 @@
+// timer_wheel.c
+#define _GNU_SOURCE
+#include "timer_wheel.h"
+#include <time.h>
+
+uint64_t timer_wheel_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+void timer_wheel_init(TimerWheel *wheel, unsigned tick_ms) {
+    pthread_mutex_init(&wheel->lock, NULL);
+    wheel->tick_ms = tick_ms ? tick_ms : 1;
+    wheel->start_ms = timer_wheel_now_ms();
+    wheel->current = 0;
+    wheel->count = 0;
+    for (int i = 0; i < TIMER_WHEEL_SLOTS; i++) {
+        wheel->slots[i].next = &wheel->slots[i];
+        wheel->slots[i].prev = &wheel->slots[i];
+    }
+}
+
+void timer_entry_init(TimerEntry *entry, TimerCallback callback, void *arg) {
+    entry->next = entry->prev = NULL;
+    entry->expires = 0;
+    entry->callback = callback;
+    entry->arg = arg;
+    entry->pending = 0;
+}
+
+// 잠금을 잡은 상태에서 호출
+static void unlink_entry(TimerWheel *wheel, TimerEntry *entry) {
+    entry->prev->next = entry->next;
+    entry->next->prev = entry->prev;
+    entry->next = entry->prev = NULL;
+    entry->pending = 0;
+    wheel->count--;
+}
+
+/*
+ * 함수: timer_wheel_schedule
+ * 설명: delay_ms 뒤에 만료되도록 등록 (이미 등록되어 있으면 새 시각으로 옮김)
+ *       만료 틱은 올림이라 delay_ms보다 일찍 불리지 않음
+ * 입력: 휠, 엔트리, 지연 시간
+ * 출력: 없음
+ */
+void timer_wheel_schedule(TimerWheel *wheel, TimerEntry *entry, unsigned delay_ms) {
+    uint64_t now = timer_wheel_now_ms();
+    pthread_mutex_lock(&wheel->lock);
+    if (entry->pending) {
+        unlink_entry(wheel, entry);
+    }
+    uint64_t expires = (now - wheel->start_ms + delay_ms + wheel->tick_ms - 1) / wheel->tick_ms;
+    if (expires <= wheel->current) {
+        expires = wheel->current + 1; // 이미 지난 틱이면 다음 틱에
+    }
+    entry->expires = expires;
+    TimerEntry *head = &wheel->slots[expires % TIMER_WHEEL_SLOTS];
+    entry->next = head;
+    entry->prev = head->prev;
+    head->prev->next = entry;
+    head->prev = entry;
+    entry->pending = 1;
+    wheel->count++;
+    pthread_mutex_unlock(&wheel->lock);
+}
+
+int timer_wheel_cancel(TimerWheel *wheel, TimerEntry *entry) {
+    pthread_mutex_lock(&wheel->lock);
+    int was_pending = entry->pending;
+    if (was_pending) {
+        unlink_entry(wheel, entry);
+    }
+    pthread_mutex_unlock(&wheel->lock);
+    return was_pending;
+}
+
+// 슬롯에서 target 틱까지 만료된 엔트리를 꺼내 콜백을 배열에 복사 (잠금을 잡은 상태에서 호출)
+static int collect_slot(TimerWheel *wheel, TimerEntry *head, uint64_t target, TimerCallback *callbacks, void **args, int n) {
+    TimerEntry *entry = head->next;
+    while (entry != head && n < TIMER_WHEEL_BATCH) {
+        TimerEntry *next = entry->next;
+        if (entry->expires <= target) {
+            callbacks[n] = entry->callback;
+            args[n] = entry->arg;
+            n++;
+            unlink_entry(wheel, entry);
+        }
+        entry = next;
+    }
+    return n;
+}
+
+/*
+ * 함수: timer_wheel_advance
+ * 설명: now_ms까지의 틱을 차례로 처리하고 만료된 콜백을 실행
+ *       한 바퀴 이상 밀렸으면 모든 슬롯을 한 번만 훑음
+ *       콜백은 잠금 밖에서 실행하므로 콜백 안에서 다시 등록해도 됨
+ * 입력: 휠, 현재 시각 (timer_wheel_now_ms)
+ * 출력: 실행한 콜백 수
+ */
+int timer_wheel_advance(TimerWheel *wheel, uint64_t now_ms) {
+    TimerCallback callbacks[TIMER_WHEEL_BATCH];
+    void *args[TIMER_WHEEL_BATCH];
+    int fired = 0;
+
+    pthread_mutex_lock(&wheel->lock);
+    uint64_t target = now_ms > wheel->start_ms ? (now_ms - wheel->start_ms) / wheel->tick_ms : 0;
+    while (wheel->current < target) {
+        int n = 0;
+        if (target - wheel->current >= TIMER_WHEEL_SLOTS) {
+            for (int i = 0; i < TIMER_WHEEL_SLOTS && n < TIMER_WHEEL_BATCH; i++) {
+                n = collect_slot(wheel, &wheel->slots[i], target, callbacks, args, n);
+            }
+            if (n < TIMER_WHEEL_BATCH) {
+                wheel->current = target;
+            }
+        } else {
+            uint64_t tick = wheel->current + 1;
+            n = collect_slot(wheel, &wheel->slots[tick % TIMER_WHEEL_SLOTS], tick, callbacks, args, 0);
+            if (n < TIMER_WHEEL_BATCH) {
+                wheel->current = tick;
+            }
+        }
+        if (n == 0) {
+            continue;
+        }
+
+        // 꺼낸 콜백은 잠금을 풀고 실행 (가득 찼으면 같은 틱을 다시 훑음)
+        pthread_mutex_unlock(&wheel->lock);
+        for (int i = 0; i < n; i++) {
+            callbacks[i](args[i]);
+        }
+        fired += n;
+        pthread_mutex_lock(&wheel->lock);
+    }
+    pthread_mutex_unlock(&wheel->lock);
+    return fired;
+}
+
+int timer_wheel_timeout_ms(TimerWheel *wheel, uint64_t now_ms) {
+    pthread_mutex_lock(&wheel->lock);
+    uint64_t next_ms = wheel->start_ms + (wheel->current + 1) * wheel->tick_ms;
+    pthread_mutex_unlock(&wheel->lock);
+    return next_ms > now_ms ? (int)(next_ms - now_ms) : 0;
+}
@@ -0,0 +1,58 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <pthread.h>
+#include <stdint.h>
+
+/*
+ * 해시 타이머 휠
+ * 만료 틱을 슬롯 수로 나눈 나머지 슬롯의 이중 연결 리스트에 넣는다.
+ * 등록/취소는 O(1), 틱을 진행할 때는 그 틱의 슬롯만 훑는다
+ * (슬롯 수보다 먼 타이머는 같은 슬롯에 남아 있다가 해당 바퀴에서 만료).
+ * 엔트리는 호출한 쪽 구조체 안에 두므로 등록할 때 메모리 할당이 없다.
+ * 여러 스레드에서 등록/취소할 수 있고, 콜백은 잠금을 푼 상태에서
+ * timer_wheel_advance를 호출한 스레드에서 실행된다.
+ * 콜백이 이미 꺼내진 뒤의 취소는 효과가 없으므로 콜백에서 상태를 다시 확인할 것.
+ */
+#define TIMER_WHEEL_SLOTS 512
+#define TIMER_WHEEL_BATCH 64 // 잠금 한 번에 꺼내는 만료 타이머 수
+
+typedef void (*TimerCallback)(void *arg);
+
+typedef struct TimerEntry {
+    struct TimerEntry *next;
+    struct TimerEntry *prev;
+    uint64_t expires; // 만료 틱
+    TimerCallback callback;
+    void *arg;
+    int pending; // 휠에 들어 있으면 1
+} TimerEntry;
+
+typedef struct {
+    pthread_mutex_t lock;
+    unsigned tick_ms;
+    uint64_t start_ms;   // 틱 0의 시각 (단조 시계)
+    uint64_t current;    // 마지막으로 처리한 틱
+    int count;           // 등록된 타이머 수
+    TimerEntry slots[TIMER_WHEEL_SLOTS]; // 슬롯별 리스트의 머리 (센티널)
+} TimerWheel;
+
+// 단조 시계 (밀리초)
+uint64_t timer_wheel_now_ms(void);
+
+void timer_wheel_init(TimerWheel *wheel, unsigned tick_ms);
+void timer_entry_init(TimerEntry *entry, TimerCallback callback, void *arg);
+
+// delay_ms 뒤에 콜백 (이미 등록되어 있으면 새 시각으로 옮김)
+void timer_wheel_schedule(TimerWheel *wheel, TimerEntry *entry, unsigned delay_ms);
+
+// 취소, 등록되어 있었으면 1
+int timer_wheel_cancel(TimerWheel *wheel, TimerEntry *entry);
+
+// now_ms까지의 틱을 처리하고 만료된 콜백을 실행, 실행한 콜백 수
+int timer_wheel_advance(TimerWheel *wheel, uint64_t now_ms);
+
+// 다음 틱까지 남은 시간 (poll 타임아웃용, 밀리초)
+int timer_wheel_timeout_ms(TimerWheel *wheel, uint64_t now_ms);
+
+#endif
@@ -0,0 +1,119 @@
+// admission.c
+#include "admission.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+
+#define DEFAULT_MAX_CONNECTIONS 4096
+#define RESERVED_FILES 64 // 로그, 순위표, 리스닝 / shard 소켓 몫으로 남기는 파일 수
+#define DEFAULT_IP_RATE 5
+#define DEFAULT_IP_BURST 20
+#define DEFAULT_MESSAGE_RATE 20 // 타자 중 KILL 보고를 넉넉히 받는 값
+#define DEFAULT_MESSAGE_BURST 40
+#define DEFAULT_MAX_MESSAGE 2048
+#define DEFAULT_MAX_ROOMS 256
+#define DEFAULT_PING_INTERVAL_MS 15000
+#define DEFAULT_IDLE_TIMEOUT_MS 45000 // PING 세 번에 답이 없으면
+#define DEFAULT_RESUME_GRACE_MS 30000
+
+// 음이 아닌 정수 환경 변수 (없거나 잘못된 값이면 fallback)
+static int env_int(const char *name, int fallback) {
+    const char *value = getenv(name);
+    if (value == NULL || *value == '\0') {
+        return fallback;
+    }
+    char *end;
+    long parsed = strtol(value, &end, 10);
+    if (*end != '\0' || parsed < 0 || parsed > INT_MAX) {
+        fprintf(stderr, "%s 값이 올바르지 않아 기본값 %d을 씁니다.\n", name, fallback);
+        return fallback;
+    }
+    return (int)parsed;
+}
+
+void admission_limits_load(AdmissionLimits *limits, int room_capacity, int message_capacity) {
+    // 열 수 있는 파일 수를 넘으면 accept부터 실패하므로 그 안에서 거절
+    int max_connections = DEFAULT_MAX_CONNECTIONS;
+    struct rlimit files;
+    if (getrlimit(RLIMIT_NOFILE, &files) == 0 && files.rlim_cur != RLIM_INFINITY &&
+        files.rlim_cur < (rlim_t)(DEFAULT_MAX_CONNECTIONS + RESERVED_FILES)) {
+        max_connections = files.rlim_cur > RESERVED_FILES * 2 ? (int)files.rlim_cur - RESERVED_FILES
+                                                                : (int)files.rlim_cur / 2;
+    }
+
+    // 0이면 제한 없음 (방 수와 메시지 길이는 버퍼 크기까지)
+    limits->max_connections = env_int(ADMISSION_MAX_CONNECTIONS_ENV, max_connections);
+    limits->ip_rate = env_int(ADMISSION_IP_RATE_ENV, DEFAULT_IP_RATE);
+    limits->ip_burst = env_int(ADMISSION_IP_BURST_ENV, DEFAULT_IP_BURST);
+    limits->message_rate = env_int(ADMISSION_MESSAGE_RATE_ENV, DEFAULT_MESSAGE_RATE);
+    limits->message_burst = env_int(ADMISSION_MESSAGE_BURST_ENV, DEFAULT_MESSAGE_BURST);
+    limits->max_message = env_int(ADMISSION_MAX_MESSAGE_ENV, DEFAULT_MAX_MESSAGE);
+    limits->max_rooms = env_int(ADMISSION_MAX_ROOMS_ENV, DEFAULT_MAX_ROOMS);
+    limits->ping_interval_ms = env_int(ADMISSION_PING_INTERVAL_ENV, DEFAULT_PING_INTERVAL_MS);
+    limits->idle_timeout_ms = env_int(ADMISSION_IDLE_TIMEOUT_ENV, DEFAULT_IDLE_TIMEOUT_MS);
+    limits->resume_grace_ms = env_int(ADMISSION_RESUME_GRACE_ENV, DEFAULT_RESUME_GRACE_MS);
+
+    if (limits->ip_burst < 1) {
+        limits->ip_burst = 1;
+    }
+    if (limits->message_burst < 1) {
+        limits->message_burst = 1;
+    }
+    if (limits->max_message == 0 || limits->max_message > message_capacity) {
+        limits->max_message = message_capacity;
+    }
+    if (limits->max_rooms == 0 || limits->max_rooms > room_capacity) {
+        limits->max_rooms = room_capacity;
+    }
+}
+
+void token_bucket_init(TokenBucket *bucket, int burst, uint64_t now_ms) {
+    bucket->tokens = (int64_t)burst * 1000;
+    bucket->last_ms = now_ms;
+}
+
+int token_bucket_take(TokenBucket *bucket, int rate, int burst, uint64_t now_ms) {
+    if (rate <= 0) {
+        return 1;
+    }
+    // 지난 시간만큼 채움 (초당 rate개 = 1ms에 rate/1000개 = rate 단위)
+    if (now_ms > bucket->last_ms) {
+        int64_t capacity = (int64_t)burst * 1000;
+        bucket->tokens += (int64_t)(now_ms - bucket->last_ms) * rate;
+        if (bucket->tokens > capacity) {
+            bucket->tokens = capacity;
+        }
+        bucket->last_ms = now_ms;
+    }
+    if (bucket->tokens < 1000) {
+        return 0;
+    }
+    bucket->tokens -= 1000;
+    return 1;
+}
+
+int admission_ip_allow(AdmissionIpTable *table, const AdmissionLimits *limits, uint32_t ip, uint64_t now_ms) {
+    if (limits->ip_rate <= 0 || ip == 0) {
+        return 1;
+    }
+    // 가까운 몇 칸만 보고, 없으면 빈 칸이나 가장 오래 조용한 IP의 칸을 씀 (칸을 비우지 않으므로 빈 칸 뒤에는 없음)
+    uint32_t index = (ip * 2654435761u) >> 20;
+    AdmissionIp *victim = NULL;
+    for (int probe = 0; probe < ADMISSION_IP_PROBE; probe++) {
+        AdmissionIp *entry = &table->entries[(index + (uint32_t)probe) & (ADMISSION_IP_SLOTS - 1)];
+        if (entry->ip == ip) {
+            return token_bucket_take(&entry->bucket, limits->ip_rate, limits->ip_burst, now_ms);
+        }
+        if (entry->ip == 0) {
+            victim = entry;
+            break;
+        }
+        if (victim == NULL || entry->bucket.last_ms < victim->bucket.last_ms) {
+            victim = entry;
+        }
+    }
+    victim->ip = ip;
+    token_bucket_init(&victim->bucket, limits->ip_burst, now_ms);
+    return token_bucket_take(&victim->bucket, limits->ip_rate, limits->ip_burst, now_ms);
+}
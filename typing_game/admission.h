@@ -0,0 +1,70 @@
+// admission.h
+// 접속 제한과 과부하 차단 (연결 폭주나 메시지를 쏟아내는 클라이언트가 서버 전체를 멈추지 않도록)
+//
+// 제한은 환경 변수로 바꿀 수 있고 (없으면 기본값), 넘으면 처리하지 않고 바로 ERROR 한 줄로 거절한다.
+//   - 동시 연결 수 (shard마다, 기본값은 열 수 있는 파일 수에 맞춤)
+//   - IP 하나의 새 연결 속도 (shard마다 토큰 버킷, 같은 컴퓨터의 Unix 소켓 연결은 제외)
+//   - 연결 하나의 메시지 속도 (토큰 버킷, 계속 넘으면 연결을 끊음)
+//   - 메시지 (한 줄) 길이
+//   - 방 수 (모든 shard 합계, 공유 방 디렉터리에서 셈)
+//   - 조용한 연결: PING 간격과 응답이 없으면 끊는 시간 (반쯤 열린 연결이 방 자리를 잡고 있지 않도록)
+//   - 끊긴 연결의 자리를 남겨 두는 시간 (그 안에 /resume으로 다시 접속하면 방과 준비 상태가 그대로)
+#ifndef ADMISSION_H
+#define ADMISSION_H
+
+#include <stdint.h>
+
+#define ADMISSION_MAX_CONNECTIONS_ENV "TYPING_MAX_CONNECTIONS"
+#define ADMISSION_IP_RATE_ENV "TYPING_IP_CONN_RATE"
+#define ADMISSION_IP_BURST_ENV "TYPING_IP_CONN_BURST"
+#define ADMISSION_MESSAGE_RATE_ENV "TYPING_MSG_RATE"
+#define ADMISSION_MESSAGE_BURST_ENV "TYPING_MSG_BURST"
+#define ADMISSION_MAX_MESSAGE_ENV "TYPING_MAX_MESSAGE"
+#define ADMISSION_MAX_ROOMS_ENV "TYPING_MAX_ROOMS"
+#define ADMISSION_PING_INTERVAL_ENV "TYPING_PING_INTERVAL_MS"
+#define ADMISSION_IDLE_TIMEOUT_ENV "TYPING_IDLE_TIMEOUT_MS"
+#define ADMISSION_RESUME_GRACE_ENV "TYPING_RESUME_GRACE_MS"
+
+#define ADMISSION_IP_SLOTS 4096 // IP별 연결 속도 표 크기 (가득 차면 가장 오래 조용한 IP를 덮어씀)
+#define ADMISSION_IP_PROBE 8
+
+typedef struct {
+    int max_connections; // shard 하나의 동시 연결 수
+    int ip_rate;         // IP 하나의 초당 새 연결 수 (shard마다)
+    int ip_burst;        // 한꺼번에 허용하는 새 연결 수
+    int message_rate;    // 연결 하나의 초당 메시지 수
+    int message_burst;   // 한꺼번에 허용하는 메시지 수
+    int max_message;     // 메시지 한 줄의 최대 바이트 (줄바꿈 포함)
+    int max_rooms;       // 모든 shard의 방 수
+    int ping_interval_ms; // 이만큼 받은 것이 없는 연결에 PING
+    int idle_timeout_ms;  // 이만큼 받은 것이 없으면 끊음 (0이면 끊지 않음)
+    int resume_grace_ms;  // 끊긴 사용자의 자리를 남겨 두는 시간 (0이면 바로 지움)
+} AdmissionLimits;
+
+// 토큰 버킷 (토큰은 1/1000 단위라 초당 속도가 작아도 정수로 셈)
+typedef struct {
+    int64_t tokens;
+    uint64_t last_ms;
+} TokenBucket;
+
+typedef struct {
+    uint32_t ip; // 0이면 빈 칸
+    TokenBucket bucket;
+} AdmissionIp;
+
+typedef struct {
+    AdmissionIp entries[ADMISSION_IP_SLOTS];
+} AdmissionIpTable;
+
+// 기본값에 환경 변수를 덮어 씀 (max_rooms는 room_capacity, max_message는 message_capacity 이하로)
+void admission_limits_load(AdmissionLimits *limits, int room_capacity, int message_capacity);
+
+// 가득 찬 버킷으로 시작
+void token_bucket_init(TokenBucket *bucket, int burst, uint64_t now_ms);
+// 토큰 하나를 씀, 허용이면 1 / 모자라면 0
+int token_bucket_take(TokenBucket *bucket, int rate, int burst, uint64_t now_ms);
+
+// ip (network order)의 새 연결 허용 여부, 허용이면 1
+int admission_ip_allow(AdmissionIpTable *table, const AdmissionLimits *limits, uint32_t ip, uint64_t now_ms);
+
+#endif
@@ -3,19 +3,25 @@
 // 또는 makefile 이용 - make
 
 #define _XOPEN_SOURCE_EXTENDED // 한글깨짐현상 방지
+#define _DEFAULT_SOURCE        // usleep, strdup, readlink (-std=c99로 빌드할 때)
 
 #include <arpa/inet.h>
 #include <ctype.h> // 한글깨짐현상 방지
 #include <errno.h>
 #include <locale.h>
 #include <ncursesw/ncurses.h> 
+#include <poll.h>
 #include <pthread.h>
 #include <signal.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/timerfd.h>
 #include <sys/wait.h>
+#include <time.h>
 #include <unistd.h>
 #include <wchar.h>
 #include <wctype.h>
@@ -23,20 +29,31 @@
 #include <curl/curl.h>
 #include <json-c/json.h>
 
+#include "event_queue.h"
+#include "net.h"
+#include "topic_cache.h"
+#include "word_dict.h"
+#include "word_pool.h"
+#include "word_stream.h"
+
 
 #define SERVER_IP "127.0.0.1"
 #define SERVER_PORT 12345
+#define SERVER_UNIX_SOCKET "@typing_game.server" // server.c와 같은 이름
 #define BUFFER_SIZE 2048
 #define INPUT_BUFFER_SIZE 1024 // 오버플로 방지
 #define LOG_FILE "client.log" // 에러 및 디버그 체크용 로그파일
 #define GPT_API_URL "https://api.openai.com/v1/chat/completions"
 //gpt api key 설정해야됨
 #define GPT_API_KEY "your-api-key-here" 
-#define MAX_DYNAMIC_WORDS 30
+#define MAX_DYNAMIC_WORDS TOPIC_MAX_WORDS
+#define RESUME_ATTEMPTS 5      // 연결이 끊겼을 때 다시 접속해 보는 횟수 (1초 간격, 서버가 자리를 남겨 두는 동안)
+#define RESUME_REPLY_TIMEOUT 3 // /resume 답을 기다리는 시간 (초)
 
 int sock = 0;
 pthread_t recv_thread;
 int running = 1;
+char session_token[64] = ""; // 서버가 준 재접속 토큰 (수신 쓰레드만 씀)
 
 // 게임 설정 변수
 char current_game_mode[50] = "산성비"; // 산성비 다른로직들을 추가하여야함
@@ -45,18 +62,39 @@ int current_time_limit = 90;           // 기본 시간 제한
 // 게임 실행 중 여부를 나타내는 플래그
 int game_running = 0;
 
+// UI 쓰레드로 넘기는 이벤트 (ncurses와 게임 상태는 메인 쓰레드만 건드림)
+EventRing net_events;     // 수신 쓰레드 -> UI
+EventQueue worker_events; // 주제 단어 작업 쓰레드 -> UI
+int event_fd = -1;        // 이벤트를 넣은 쪽이 UI 쓰레드를 깨움
+pthread_t ui_thread;
+
+// 로비 입력 상태
+wchar_t lobby_input[INPUT_BUFFER_SIZE];
+int lobby_pos = 0;
+int ui_waiting_ready = 0; // 게임 설정을 받고 Enter를 기다리는 중
+
 // 함수 선언
 void *recv_handler(void *arg);
+int answer_pings(char *text);
+void take_session(char *text);
+size_t complete_lines(const char *data, size_t len, size_t size);
+int resume_connection();
 void send_message_to_server(const char *message);
 void cleanup();
 void log_event(const char *format, ...);
 void initialize_windows();
 void run_game(int game_duration); // 게임 실행 함수 선언
+void game_open_dict();             // 사전 파일 열기
+void game_start_round();           // 게임 한 판 실행 후 결과 전송
+void ui_dispatch_events();         // 쌓인 이벤트 처리
+void ui_handle_message(char *buffer);
+void ui_take_leaderboard(char *text);
+void lobby_draw_prompt();
+int lobby_handle_key();
 
 // ncurses 창 선언
 WINDOW *chat_win;
 WINDOW *input_win;
-pthread_mutex_t window_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 // 로그 파일 포인터
 FILE *log_fp = NULL;
@@ -65,6 +103,7 @@ FILE *log_fp = NULL;
 int game_GAME_DURATION = 90;    // 게임 시간 (초 단위)
 #define GAME_MAX_WORD_LENGTH 30 // 단어의 최대 길이 증가
 #define GAME_MAX_WORDS 100
+#define GAME_MAX_CATCHUP_STEPS 5 // 한 번에 따라잡는 최대 스텝 수 (그 이상 밀리면 버림)
 
 // 게임용 창들
 WINDOW *game_win;      // 게임 메인 창
@@ -140,34 +179,7 @@ void show_start_page() {
     refresh();
 }
 
-// 기본 단어 데이터베이스
-const char *game_wordDB[] = {
-    "apple", "banana", "cherry", "dragon", "elephant",
-    "flower", "guitar", "house", "island", "jungle",
-    "keyboard", "lemon", "mountain", "notebook", "orange",
-    "pumpkin", "queen", "river", "sunflower", "tree",
-    "umbrella", "violin", "watermelon", "xylophone", "yacht", "zebra",
-    "cloud", "horizon", "desert", "ocean", "valley",
-    "forest", "planet", "galaxy", "comet", "asteroid",
-    "rocket", "spaceship", "satellite", "meteor", "nebula",
-    "castle", "kingdom", "village", "harbor", "mountain",
-    "stream", "meadow", "canyon", "volcano", "waterfall",
-    "island", "plateau", "cliff", "prairie", "peninsula"};
-const int game_wordDB_size = sizeof(game_wordDB) / sizeof(game_wordDB[0]);
-
-// 파워업 단어 리스트
-const char *game_powerUpDB[] = {
-    "power", "boost", "extra", "golden", "silver", "diamond",
-    "energy", "shield", "rocket", "laser", "turbo", "invincible"};
-const int game_powerUpDB_size = sizeof(game_powerUpDB) / sizeof(game_powerUpDB[0]);
-
-// 단어 노드 구조체
-typedef struct game_word_node {
-    int row, col;                    // 위치
-    char word[GAME_MAX_WORD_LENGTH]; // 내려오는 단어
-    int is_power_up;                 // 파워업 여부 (0: 일반, 1: 파워업)
-    struct game_word_node *next;     // 다음 노드
-} GameWordNode;
+// 기본 단어와 파워업 단어 목록은 word_stream.c에 있음 (서버와 같은 목록을 써야 하므로)
 
 // 플레이어 구조체
 typedef struct {
@@ -176,19 +188,36 @@ typedef struct {
 } GamePlayer;
 
 // 게임 전역 변수
-GameWordNode *game_word_head = NULL; // 단어 리스트 헤드
+WordPool game_words;                 // 화면에 떨어지는 단어들
 GamePlayer game_player;              // 플레이어
 volatile int game_game_over = 0;     // 게임 종료 플래그
 int game_score = 0;                  // 점수
 int game_level = 1;                  // 레벨
 int game_word_speed = 1;             // 단어 하강 속도
 int game_word_interval = 2;          // 단어 생성 간격 (프레임 수)
-int game_frame_delay = 1000000;      // 프레임 대기 시간
+int game_frame_delay = 1000000;      // 시뮬레이션 스텝 간격 (us)
+int game_frame = 0;                  // 진행한 스텝 수
 
-// 동적 단어 데이터베이스 관련 변수
-char *dynamic_wordDB[MAX_DYNAMIC_WORDS] = {NULL};
+// 서버가 GAME_STARTED에 시드와 일정을 보냈으면 모두 같은 단어 흐름으로 진행 (맞힌 단어는 KILL로 보고)
+WordStreamSchedule game_stream;
+int game_stream_active = 0;
+
+// 동적 단어 데이터베이스 관련 변수 (작업 쓰레드가 보낸 이벤트를 UI 쓰레드에서 반영)
+char dynamic_wordDB[MAX_DYNAMIC_WORDS][TOPIC_WORD_MAX_LENGTH];
 int dynamic_wordDB_size = 0;
 int use_dynamic_words = 0; // 0: 기본 단어, 1: 동적 단어
+char current_topic[TOPIC_MAX_LENGTH] = ""; // 마지막으로 요청한 주제
+
+// 사전 파일 (없으면 위의 기본 단어 배열 사용)
+WordDict game_dict;
+int game_dict_loaded = 0;
+
+// 게임 중에 받은 결과 메시지 (게임이 끝난 뒤 채팅 창에 출력)
+char game_result_message[BUFFER_SIZE];
+
+// 서버가 틱마다 모아 보내는 실시간 순위 ("1.이름 점수  2.이름 점수 ...", 점수 줄 오른쪽에 표시)
+char game_leaderboard[256];
+int game_leaderboard_dirty = 0;
 
 // 입력 처리 관련
 char game_typingText[GAME_MAX_WORD_LENGTH] = {0};
@@ -197,6 +226,18 @@ int game_enter_position = 0;
 // 타이머 관련
 time_t game_start_time;
 
+// 화면에 마지막으로 그린 단어 상태 (텍스트 칸 번호별, 바뀐 단어만 다시 그리기 위함)
+typedef struct {
+    int row, col, length;
+    int pair;  // 색상 쌍, 0이면 화면에 없음
+    int typed; // 강조한 입력 길이
+    char text[WORD_POOL_TEXT_STRIDE]; // 같은 칸이 다른 단어로 재사용됐는지 확인용
+} GameDrawnWord;
+
+GameDrawnWord game_drawn[WORD_POOL_CAPACITY];
+int game_drawn_score, game_drawn_level; // 마지막으로 그린 점수 / 레벨
+int game_player_drawn;
+
 // 게임 함수 선언
 void game_define_colors(); 
 // 색상 정의
@@ -209,18 +250,36 @@ void game_add_word();
 void game_update_words();
 // 단어 업데이트    
 void game_draw_words();
-// 단어 출력
+// 바뀐 단어만 다시 그림
 void game_word_Check(char *str);
 // 단어 확인    
-void game_handle_input();
+int game_handle_input();
+// 키 하나 처리, 처리할 키가 없으면 0
 void game_cleanup();
 void game_end_game_handler(int signum);
-void *game_game_thread_func(void *arg);
-
-// GPT API 관련 함수 선언
-size_t write_callback(void *contents, size_t size, size_t nmemb, void *userp);
-int get_words_from_gpt(const char *topic);
-void free_dynamic_words();
+void game_step();
+// 시뮬레이션 한 스텝
+void game_stream_step();
+// 공용 단어 흐름 한 스텝
+void game_render();
+// 현재 상태 그리기
+void game_set_leaderboard(const char *entries);
+// 실시간 순위 반영
+
+// 프레임 시간 / 입력 지연 통계
+typedef struct {
+    int count;
+    long long total_ns;
+    long long max_ns;
+} GameTimingStats;
+
+long long game_now_ns();
+void game_stat_add(GameTimingStats *stat, long long ns);
+double game_stat_avg_ms(const GameTimingStats *stat);
+
+// 주제 단어 관련 함수 선언
+void topic_words_ready(const TopicWords *words, int from_cache);
+void topic_words_apply(const TopicWords *words, int from_cache);
 void load_dynamic_words(const char *topic);
 
 //  error check 용도 : 로그 기록 함수
@@ -235,192 +294,103 @@ void log_event(const char *format, ...) {
     fflush(log_fp);
 }
 
-// 게임 쓰레드 함수
-void *game_thread_func(void *arg) {
+// 게임 한 판 실행 (UI 쓰레드에서 GAME_STARTED를 처리할 때 호출)
+void game_start_round() {
     // 게임 실행 준비 로그
-    log_event("게임 쓰레드 시작: 모드=%s, 제한 시간=%d초\n", current_game_mode, current_time_limit);
+    log_event("게임 시작: 모드=%s, 제한 시간=%d초\n", current_game_mode, current_time_limit);
 
-    // 게임 실행
+    // 게임 실행 (끝날 때까지 이 루프가 입력과 이벤트를 처리)
     run_game(current_time_limit);
 
     // 게임 종료 후 점수 저장
     int score = game_score;
 
-    // 서버에 게임 종료 메시지 전송
+    // 서버에 게임 종료 메시지 전송 (마지막 틱도 함께 보내 서버가 같은 시점까지 검증)
     char game_over_msg[50];
-    snprintf(game_over_msg, sizeof(game_over_msg), "GAME_OVER %d\n", score);
+    snprintf(game_over_msg, sizeof(game_over_msg), "GAME_OVER %d %d\n", score, game_frame);
     send_message_to_server(game_over_msg);
 
     // 게임 실행 종료 로그
     log_event("게임이 종료되었습니다. 점수: %d\n", score);
 
-    pthread_mutex_lock(&window_mutex);
+    // 게임 중에 받은 승자 정보와 최종 점수 출력
+    if (game_result_message[0] != '\0') {
+        wprintw(chat_win, "%s\n", game_result_message);
+    }
     wprintw(chat_win, "게임이 종료되었습니다. 최종 점수: %d\n", score);
-    wrefresh(chat_win);
-    pthread_mutex_unlock(&window_mutex);
-
-    // 서버에 게임 종료 후 준비 완료 메시지 전송
-    // char ready_msg[] = "/ready\n";
-    // send_message_to_server(ready_msg);
-    // log_event("서버에 READY 메시지 전송: %s", ready_msg);
+    wnoutrefresh(chat_win);
 
-    return NULL;
+    // 로비 입력 다시 받기
+    lobby_pos = 0;
+    lobby_input[0] = L'\0';
+    nodelay(input_win, TRUE);
+    lobby_draw_prompt();
 }
 
-// GPT API 응답을 저장할 구조체
-struct MemoryStruct {
-    char *memory;
-    size_t size;
-};
-
-// CURL write callback 함수
-size_t write_callback(void *contents, size_t size, size_t nmemb, void *userp) {
-    size_t realsize = size * nmemb;
-    struct MemoryStruct *mem = (struct MemoryStruct *)userp;
-
-    char *ptr = realloc(mem->memory, mem->size + realsize + 1);
-    if (!ptr) {
-        return 0;
+// 주제 단어가 준비되면 호출됨 (작업 쓰레드 또는 캐시 적중 시 UI 쓰레드)
+// 작업 쓰레드에서는 이벤트로 넘기고 실제 반영은 UI 쓰레드가 함
+void topic_words_ready(const TopicWords *words, int from_cache) {
+    if (pthread_equal(pthread_self(), ui_thread)) {
+        topic_words_apply(words, from_cache);
+        return;
     }
-
-    mem->memory = ptr;
-    memcpy(&(mem->memory[mem->size]), contents, realsize);
-    mem->size += realsize;
-    mem->memory[mem->size] = 0;
-
-    return realsize;
+    Event event;
+    event.type = EVENT_TOPIC_WORDS;
+    event.from_cache = from_cache;
+    event.data.words = *words;
+    while (event_queue_push(&worker_events, &event) < 0 && running) {
+        usleep(1000); // UI 쓰레드가 비울 때까지 잠깐 대기
+    }
+    event_wakeup_signal(event_fd);
 }
 
-// GPT API에서 단어 가져오기
-int get_words_from_gpt(const char *topic) {
-    CURL *curl;
-    CURLcode res;
-    struct MemoryStruct chunk;
-    chunk.memory = malloc(1);
-    chunk.size = 0;
-
-    curl = curl_easy_init();
-    if (!curl) {
-        free(chunk.memory);
-        return -1;
+// 받은 주제 단어를 동적 단어 DB에 반영 (UI 쓰레드 전용)
+void topic_words_apply(const TopicWords *words, int from_cache) {
+    // 그 사이 다른 주제를 요청했다면 무시
+    if (strcmp(words->topic, current_topic) != 0) {
+        return;
     }
-
-    // JSON 요청 생성
-    struct json_object *json_obj = json_object_new_object();
-    struct json_object *messages_array = json_object_new_array();
-    struct json_object *message_obj = json_object_new_object();
-    
-    json_object_object_add(message_obj, "role", json_object_new_string("user"));
-    
-    char prompt[1024];
-    snprintf(prompt, sizeof(prompt), 
-        "다음 주제와 관련된 영어 단어 30개를 쉼표로 구분해서 알려줘. "
-        "단어는 3-10글자 사이여야 하고, 게임에서 사용할 수 있는 단순한 단어여야 해. "
-        "주제: %s", topic);
-    
-    json_object_object_add(message_obj, "content", json_object_new_string(prompt));
-    json_object_array_add(messages_array, message_obj);
-    json_object_object_add(json_obj, "messages", messages_array);
-    json_object_object_add(json_obj, "model", json_object_new_string("gpt-3.5-turbo"));
-    json_object_object_add(json_obj, "max_tokens", json_object_new_int(200));
-
-    const char *json_string = json_object_to_json_string(json_obj);
-
-    // 헤더 설정
-    struct curl_slist *headers = NULL;
-    headers = curl_slist_append(headers, "Content-Type: application/json");
-    char auth_header[256];
-    snprintf(auth_header, sizeof(auth_header), "Authorization: Bearer %s", GPT_API_KEY);
-    headers = curl_slist_append(headers, auth_header);
-
-    curl_easy_setopt(curl, CURLOPT_URL, GPT_API_URL);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&chunk);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_string);
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-
-    res = curl_easy_perform(curl);
-
-    if (res != CURLE_OK) {
-        fprintf(stderr, "curl_easy_perform() failed: %s\n", curl_easy_strerror(res));
-        curl_easy_cleanup(curl);
-        curl_slist_free_all(headers);
-        json_object_put(json_obj);
-        free(chunk.memory);
-        return -1;
+    dynamic_wordDB_size = 0;
+    for (int i = 0; i < words->count && i < MAX_DYNAMIC_WORDS; i++) {
+        snprintf(dynamic_wordDB[i], sizeof(dynamic_wordDB[i]), "%s", words->words[i]);
+        dynamic_wordDB_size++;
     }
+    use_dynamic_words = dynamic_wordDB_size > 0;
+    int count = dynamic_wordDB_size;
 
-    // JSON 응답 파싱
-    struct json_object *response_obj = json_tokener_parse(chunk.memory);
-    struct json_object *choices_array, *first_choice, *message, *content;
-    
-    if (json_object_object_get_ex(response_obj, "choices", &choices_array) &&
-        json_object_array_length(choices_array) > 0) {
-        
-        first_choice = json_object_array_get_idx(choices_array, 0);
-        if (json_object_object_get_ex(first_choice, "message", &message) &&
-            json_object_object_get_ex(message, "content", &content)) {
-            
-            const char *content_str = json_object_get_string(content);
-            
-            // 단어 파싱
-            char *content_copy = strdup(content_str);
-            char *token = strtok(content_copy, ",");
-            int word_count = 0;
-            
-            while (token != NULL && word_count < MAX_DYNAMIC_WORDS) {
-                // 공백 제거
-                while (*token == ' ' || *token == '\n' || *token == '\r') token++;
-                char *end = token + strlen(token) - 1;
-                while (end > token && (*end == ' ' || *end == '\n' || *end == '\r')) end--;
-                *(end + 1) = '\0';
-                
-                if (strlen(token) > 0) {
-                    dynamic_wordDB[word_count] = strdup(token);
-                    word_count++;
-                }
-                token = strtok(NULL, ",");
-            }
-            
-            dynamic_wordDB_size = word_count;
-            free(content_copy);
-        }
+    if (count > 0) {
+        log_event("동적 단어 로드 완료: 주제=%s, 단어 수=%d, 캐시=%d\n", words->topic, count, from_cache);
+    } else {
+        log_event("동적 단어 로드 실패: 주제=%s\n", words->topic);
     }
 
-    // 정리
-    curl_easy_cleanup(curl);
-    curl_slist_free_all(headers);
-    json_object_put(json_obj);
-    json_object_put(response_obj);
-    free(chunk.memory);
-
-    return dynamic_wordDB_size;
-}
-
-// 동적 단어 메모리 해제
-void free_dynamic_words() {
-    for (int i = 0; i < dynamic_wordDB_size; i++) {
-        if (dynamic_wordDB[i]) {
-            free(dynamic_wordDB[i]);
-            dynamic_wordDB[i] = NULL;
-        }
+    // 게임 중에는 채팅 창을 그리지 않음
+    if (game_running) {
+        return;
     }
-    dynamic_wordDB_size = 0;
+    if (count > 0) {
+        wprintw(chat_win, "동적 단어 로드 완료! %d개의 단어가 준비되었습니다.%s\n", count, from_cache ? " (캐시)" : "");
+    } else {
+        wprintw(chat_win, "동적 단어 로드에 실패했습니다. 기본 단어를 사용합니다.\n");
+    }
+    wnoutrefresh(chat_win);
 }
 
-// 동적 단어 로드
+// 동적 단어 로드 요청 (가져오기는 백그라운드에서, 끝나면 topic_words_ready 호출)
 void load_dynamic_words(const char *topic) {
-    // 기존 동적 단어 해제
-    free_dynamic_words();
-    
-    // GPT에서 단어 가져오기
-    if (get_words_from_gpt(topic) > 0) {
-        use_dynamic_words = 1;
-        log_event("동적 단어 로드 완료: 주제=%s, 단어 수=%d\n", topic, dynamic_wordDB_size);
+    snprintf(current_topic, sizeof(current_topic), "%s", topic);
+
+    int result = topic_cache_request(topic);
+    if (result == 1) {
+        return; // 캐시 적중, 이미 적용됨
+    }
+
+    if (result == 0) {
+        wprintw(chat_win, "주제 '%s'에 대한 단어를 GPT에서 가져오는 중...\n", topic);
     } else {
-        use_dynamic_words = 0;
-        log_event("동적 단어 로드 실패: 주제=%s\n", topic);
+        wprintw(chat_win, "요청이 너무 많습니다. 잠시 후 다시 시도하세요.\n");
     }
+    wnoutrefresh(chat_win);
 }
 
 // 창 초기화 함수
@@ -457,150 +427,316 @@ void initialize_windows() {
     wrefresh(input_win);
 }
 
-// 메시지 수신 및 출력 함수
+// 메시지 수신 함수 (수신 쓰레드: 받은 내용을 링에 넣고 UI 쓰레드를 깨우기만 함)
 void *recv_handler(void *arg) {
-    char buffer[BUFFER_SIZE];
+    Event event;
+    char received[EVENT_TEXT_SIZE]; // 받은 바이트 (앞에서부터 줄바꿈까지만 넘기고 나머지는 다음 수신과 이어 붙임)
+    size_t received_len;
     int bytes_read;
 
-    while ((bytes_read = recv(sock, buffer, sizeof(buffer) - 1, 0)) > 0 && running) {
-        buffer[bytes_read] = '\0';
+    event.type = EVENT_NET_MESSAGE;
+    event.from_cache = 0;
+    // 연결이 끊기면 재접속 토큰으로 이어서 받음 (이어지지 않으면 끝)
+    do {
+        received_len = 0; // 끊긴 연결에서 받다 만 줄은 버림
+        while ((bytes_read = recv(sock, received + received_len, sizeof(received) - 1 - received_len, 0)) > 0 &&
+               running) {
+            received_len += (size_t)bytes_read;
+
+            // 서버는 여러 메시지를 한 번에 보내므로 한 줄이 두 번에 나뉘어 올 수 있음
+            // 완성된 줄만 넘김 (줄바꿈 없이 버퍼가 차면 그때까지를 한 줄로)
+            size_t complete = complete_lines(received, received_len, sizeof(received) - 1);
+            if (complete == 0) {
+                continue;
+            }
+            memcpy(event.data.text, received, complete);
+            event.data.text[complete] = '\0';
+            received_len -= complete;
+            memmove(received, received + complete, received_len);
+
+            // 서버의 PING에는 이 쓰레드에서 바로 답함 (UI가 이름 입력이나 게임 중이어도 연결이 끊기지 않게)
+            // 재접속 토큰 줄도 여기서 빼서 보관
+            take_session(event.data.text);
+            answer_pings(event.data.text);
+            if (event.data.text[0] == '\0') {
+                continue;
+            }
 
-        // 로그 파일에 기록
-        if (log_fp != NULL) {
-            fprintf(log_fp, "수신된 메시지: %s", buffer);
-            fflush(log_fp);
+            // 로그 파일에 기록
+            if (log_fp != NULL) {
+                fprintf(log_fp, "수신된 메시지: %s", event.data.text);
+                fflush(log_fp);
+            }
+
+            // 링이 가득 차면 UI 쓰레드가 비울 때까지 기다림 (그동안 소켓 읽기도 멈춤)
+            while (event_ring_push(&net_events, &event) < 0 && running) {
+                usleep(1000);
+            }
+            event_wakeup_signal(event_fd);
         }
 
-        // 게임 실행 중일 때는 수신된 메시지를 처리하지 않음
-        if (game_running) {
-            // 게임 종료 메시지인 경우 처리
+        if (bytes_read == 0) {
+            log_event("서버가 연결을 종료했습니다.\n");
+        } else if (bytes_read < 0 && running) {
+            log_event("recv 실패: %s\n", strerror(errno));
+        }
+    } while (running && resume_connection());
 
-            if (strncmp(buffer, "GAME_OVER", 9) == 0) {
-                // 게임 종료 플래그 설정
-                game_game_over = 1;
+    // 연결 종료를 UI 쓰레드에 알림
+    event.type = EVENT_NET_CLOSED;
+    while (event_ring_push(&net_events, &event) < 0 && running) {
+        usleep(1000);
+    }
+    event_wakeup_signal(event_fd);
+    pthread_exit(NULL);
+}
 
-                // 승자 정보 파싱
-                char winner_message[BUFFER_SIZE];
-                sscanf(buffer + 10, "%[^\n]", winner_message);
+// 앞에서부터 마지막 줄바꿈까지의 길이 (줄바꿈이 없으면 0, 그대로 size만큼 찼으면 size)
+size_t complete_lines(const char *data, size_t len, size_t size) {
+    size_t end = len;
+    while (end > 0 && data[end - 1] != '\n') {
+        end--;
+    }
+    return end == 0 && len == size ? len : end;
+}
 
-                // 게임 종료 후 메시지 출력
-                pthread_mutex_lock(&window_mutex);
-                wprintw(chat_win, "%s\n", winner_message);
-                wrefresh(chat_win);
-                pthread_mutex_unlock(&window_mutex);
+// 받은 텍스트에서 PING 줄을 빼고 줄마다 PONG으로 답함, 뺀 줄 수
+int answer_pings(char *text) {
+    int count = 0;
+    char *line = text;
+    while (*line != '\0') {
+        char *next = strchr(line, '\n');
+        next = next != NULL ? next + 1 : line + strlen(line);
+        if (strncmp(line, "PING\n", 5) == 0) {
+            memmove(line, next, strlen(next) + 1);
+            count++;
+        } else {
+            line = next;
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        // send는 한 번에 끝나는 짧은 메시지라 UI 쓰레드의 전송과 섞이지 않음
+        if (send(sock, "PONG\n", 5, MSG_NOSIGNAL) < 0) {
+            break;
+        }
+    }
+    return count;
+}
 
-                // 클라이언트 종료 플래그 설정을 제거하여 클라이언트가 종료되지 않도록 함
-                // running = 0; // 이 줄을 주석 처리하거나 제거
-            }
-            continue;
+// 받은 텍스트에서 SESSION 줄을 빼고 마지막 토큰을 보관
+void take_session(char *text) {
+    char *line = text;
+    while (*line != '\0') {
+        char *next = strchr(line, '\n');
+        next = next != NULL ? next + 1 : line + strlen(line);
+        if (strncmp(line, "SESSION ", 8) == 0) {
+            sscanf(line + 8, "%63s", session_token);
+            memmove(line, next, strlen(next) + 1);
+        } else {
+            line = next;
         }
+    }
+}
 
-        // 메시지 출력
-        pthread_mutex_lock(&window_mutex);
-        if (strncmp(buffer, "CHAT ", 5) == 0) {
-            wprintw(chat_win, "%s", buffer + 5); // "CHAT " 이후의 메시지만 출력
-        } else if (strncmp(buffer, "WELCOME ", 8) == 0) {
-            // 서버에서 보내는 환영 메시지 형식: "WELCOME <이름>"
-            char user_name[50];
-            sscanf(buffer + 8, "%49s", user_name);
-            wprintw(chat_win, "어서오세요~~ 타이핑게임에 오신것을 환영합니다 %s님!\n", user_name);
-        } else if (strncmp(buffer, "ROOM_CREATED ", 13) == 0) {
-            // 서버에서 보내는 방 생성 메시지 형식: "ROOM_CREATED <방 ID> <방 이름>"
-            int room_id;
-            char room_name[100];
-            sscanf(buffer + 13, "%d %99[^\n]", &room_id, room_name);
-            wprintw(chat_win, "방이 생성되었습니다. 방 ID: %d, 방 이름: %s\n", room_id, room_name);
-        } else if (strncmp(buffer, "USER_JOINED ", 12) == 0) {
-            // 서버에서 보내는 사용자 입장 메시지 형식: "USER_JOINED <이름>"
-            char user_name[50];
-            sscanf(buffer + 12, "%49s", user_name);
-            wprintw(chat_win, "%s님이 방에 입장하셨습니다.\n", user_name);
-        } else if (strncmp(buffer, "GAME_SETTINGS ", 14) == 0) {
-            char game_mode[50];
-            int time_limit;
-            sscanf(buffer + 14, "%49s %d", game_mode, &time_limit);
-
-            // 게임 설정 저장
-            strncpy(current_game_mode, game_mode, sizeof(current_game_mode) - 1);
-            current_game_mode[sizeof(current_game_mode) - 1] = '\0';
-            current_time_limit = time_limit;
-
-            // 게임 설정 창 표시
-            werase(chat_win);
-            mvwprintw(chat_win, 1, 1, "게임 모드: %s, 제한 시간: %d초", current_game_mode, current_time_limit);
-            wrefresh(chat_win);
-
-            // 설정 완료 메시지
-            pthread_mutex_lock(&window_mutex);
-            werase(input_win);
-            box(input_win, 0, 0);
-            mvwprintw(input_win, 1, 1, "설정을 완료하려면 Enter를 누르세요.");
-            wrefresh(input_win);
-            pthread_mutex_unlock(&window_mutex);
+// 끊긴 연결을 재접속 토큰으로 이어 붙임 (서버가 방, 준비 상태를 남겨 둔 동안), 이어졌으면 1
+// 새 소켓을 같은 fd 번호로 옮기므로 (dup2) UI 쓰레드는 그대로 sock으로 보내면 됨
+int resume_connection() {
+    if (session_token[0] == '\0') {
+        return 0;
+    }
+    char line[96];
+    snprintf(line, sizeof(line), "/resume %s\n", session_token);
+    for (int attempt = 0; attempt < RESUME_ATTEMPTS && running; attempt++) {
+        if (attempt > 0) {
+            sleep(1);
+        }
+        int fd = net_connect_local(SERVER_UNIX_SOCKET, SERVER_IP, SERVER_PORT);
+        if (fd < 0) {
+            continue;
+        }
+        // 답은 엿보기만 하고 수신 루프가 이어서 읽음 (RESUMED 뒤의 새 SESSION도 같이 처리)
+        struct timeval timeout = {RESUME_REPLY_TIMEOUT, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        char reply[16] = "";
+        ssize_t n = net_send_all(fd, line, strlen(line)) == 0 ? recv(fd, reply, sizeof(reply) - 1, MSG_PEEK) : -1;
+        if (n >= 7 && strncmp(reply, "RESUMED", 7) == 0) {
+            struct timeval none = {0, 0};
+            setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &none, sizeof(none));
+            dup2(fd, sock);
+            close(fd);
+            log_event("서버에 다시 연결되었습니다.\n");
+            return 1;
+        }
+        close(fd);
+        if (n > 0) {
+            break; // 서버가 세션을 모름 (자리를 남겨 둔 시간이 지남)
+        }
+    }
+    log_event("서버에 다시 연결하지 못했습니다.\n");
+    return 0;
+}
 
-            // 로그 파일에 기록
-            if (log_fp != NULL) {
-                fprintf(log_fp, "게임 설정 수신: 모드=%s, 시간 제한=%d\n", game_mode, time_limit);
-                fflush(log_fp);
-            }
+// 쌓인 이벤트 처리 (UI 쓰레드 전용, 게임 루프 안에서도 호출됨)
+void ui_dispatch_events() {
+    Event event;
 
-            // Enter 키 대기
-            wgetch(input_win); // Enter 키 대기
+    // 먼저 깨움 신호를 지워야 처리 도중 들어온 이벤트의 신호를 놓치지 않음
+    event_wakeup_clear(event_fd);
+    while (running) {
+        if (event_queue_pop(&worker_events, &event)) {
+            topic_words_apply(&event.data.words, event.from_cache);
+            continue;
+        }
+        if (!event_ring_pop(&net_events, &event)) {
+            break;
+        }
 
-            // 서버에 설정 완료 메시지 전송
-            char ready_msg[] = "/ready\n";
-            send_message_to_server(ready_msg);
-            log_event("서버에 READY 메시지 전송: %s", ready_msg);
-        } else if (strncmp(buffer, "GAME_STARTED", 12) == 0) {
-            // 게임 시작 메시지 수신 시 게임 모듈 실행
-            wprintw(chat_win, "게임이 시작됩니다!\n");
-            wrefresh(chat_win);
-
-            // 게임 실행을 위한 쓰레드 생성
-            pthread_t game_thread;
-            if (pthread_create(&game_thread, NULL, game_thread_func, NULL) != 0) {
-                wprintw(chat_win, "게임 쓰레드 생성 실패\n");
-                wrefresh(chat_win);
-                log_event("게임 쓰레드 생성 실패\n");
-            } else {
-                pthread_detach(game_thread);
+        if (event.type == EVENT_NET_CLOSED) {
+            if (!game_running) {
+                wprintw(chat_win, "서버가 연결을 종료했습니다.\n");
+                wnoutrefresh(chat_win);
             }
-        } else if (strncmp(buffer, "GAME_OVER", 9) == 0) {
-            // 이미 위에서 처리됨
-            // 필요에 따라 추가적인 처리를 할 수 있음
-        } else if (strncmp(buffer, "SERVER_SHUTDOWN", 15) == 0) {
-            // 서버 종료 메시지 수신 시 클린업 및 종료
-            wprintw(chat_win, "서버가 종료되었습니다.\n");
-            wrefresh(chat_win);
+            game_game_over = 1;
             running = 0;
-        } else if (strncmp(buffer, "ERROR ", 6) == 0) {
-            // 오류 메시지 수신 시 표시
-            wprintw(chat_win, "오류: %s", buffer + 6);
-        } else if (strstr(buffer, "사용 가능한 명령어는") != NULL || strstr(buffer, "Available commands are") != NULL) {
-            // /help 출력 처리
-            wattron(chat_win, COLOR_PAIR(2));
-            wprintw(chat_win, "%s", buffer);
-            wattroff(chat_win, COLOR_PAIR(2));
         } else {
-            // 그 외의 메시지 처리
-            wprintw(chat_win, "%s\n", buffer);
+            // 실시간 순위는 다른 메시지와 한 번에 올 수 있으므로 먼저 떼어 냄
+            ui_take_leaderboard(event.data.text);
+            if (event.data.text[0] == '\0') {
+                continue;
+            }
+            if (!game_running) {
+                ui_handle_message(event.data.text);
+                continue;
+            }
+
+            // 게임 실행 중일 때는 게임 종료 메시지만 처리
+            char *game_over = strstr(event.data.text, "GAME_OVER");
+            if (game_over != NULL && (game_over == event.data.text || game_over[-1] == '\n')) {
+                // 게임 종료 플래그 설정
+                game_game_over = 1;
+
+                // 승자 정보는 게임 창을 닫은 뒤 출력
+                game_result_message[0] = '\0';
+                sscanf(game_over + 9, " %2047[^\n]", game_result_message);
+            }
         }
+    }
+}
 
-        wrefresh(chat_win);
-        pthread_mutex_unlock(&window_mutex);
+// 받은 텍스트에서 LEADERBOARD 줄을 빼냄 (게임 중이면 순위 표시에 반영, 로비에서는 버림)
+void ui_take_leaderboard(char *text) {
+    char *line = text;
+    while (*line != '\0') {
+        char *next = strchr(line, '\n');
+        next = next != NULL ? next + 1 : line + strlen(line);
+        if (strncmp(line, "LEADERBOARD ", 12) == 0) {
+            if (game_running) {
+                // "LEADERBOARD <틱>" 뒤의 항목만 넘김
+                char *entries = strchr(line + 12, '\t');
+                char *end = next[-1] == '\n' ? next - 1 : next;
+                *end = '\0';
+                game_set_leaderboard(entries != NULL ? entries + 1 : end);
+            }
+            memmove(line, next, strlen(next) + 1);
+        } else {
+            line = next;
+        }
     }
+}
+
+// 서버 메시지 출력 (로비 화면, 화면 반영은 호출한 쪽에서 doupdate)
+void ui_handle_message(char *buffer) {
+    if (strncmp(buffer, "CHAT ", 5) == 0) {
+        wprintw(chat_win, "%s", buffer + 5); // "CHAT " 이후의 메시지만 출력
+    } else if (strncmp(buffer, "WELCOME ", 8) == 0) {
+        // 서버에서 보내는 환영 메시지 형식: "WELCOME <이름>"
+        char user_name[50];
+        sscanf(buffer + 8, "%49s", user_name);
+        wprintw(chat_win, "어서오세요~~ 타이핑게임에 오신것을 환영합니다 %s님!\n", user_name);
+    } else if (strncmp(buffer, "RESUMED ", 8) == 0) {
+        // 끊겼던 연결을 이어 붙임 (방과 준비 상태는 서버가 그대로 남겨 둠)
+        wprintw(chat_win, "서버에 다시 연결되었습니다.\n");
+    } else if (strncmp(buffer, "ROOM_CREATED ", 13) == 0) {
+        // 서버에서 보내는 방 생성 메시지 형식: "ROOM_CREATED <방 ID> <방 이름>"
+        int room_id;
+        char room_name[100];
+        sscanf(buffer + 13, "%d %99[^\n]", &room_id, room_name);
+        wprintw(chat_win, "방이 생성되었습니다. 방 ID: %d, 방 이름: %s\n", room_id, room_name);
+    } else if (strncmp(buffer, "USER_JOINED ", 12) == 0) {
+        // 서버에서 보내는 사용자 입장 메시지 형식: "USER_JOINED <이름>"
+        char user_name[50];
+        sscanf(buffer + 12, "%49s", user_name);
+        wprintw(chat_win, "%s님이 방에 입장하셨습니다.\n", user_name);
+    } else if (strncmp(buffer, "GAME_SETTINGS ", 14) == 0) {
+        char game_mode[50];
+        int time_limit;
+        sscanf(buffer + 14, "%49s %d", game_mode, &time_limit);
+
+        // 게임 설정 저장
+        strncpy(current_game_mode, game_mode, sizeof(current_game_mode) - 1);
+        current_game_mode[sizeof(current_game_mode) - 1] = '\0';
+        current_time_limit = time_limit;
+
+        // 게임 시작 전에 선택한 주제의 캐시를 미리 채워 둠 (만료됐으면 다시 가져옴)
+        if (current_topic[0] != '\0') {
+            topic_cache_prefetch(current_topic);
+        }
 
-    if (bytes_read == 0) {
-        printf("서버가 연결을 종료했습니다.\n");
-        log_event("서버가 연결을 종료했습니다.\n");
-    } else if (bytes_read < 0) {
-        perror("recv 실패");
-        log_event("recv 실패: %s\n", strerror(errno));
+        // 게임 설정 창 표시
+        werase(chat_win);
+        mvwprintw(chat_win, 1, 1, "게임 모드: %s, 제한 시간: %d초", current_game_mode, current_time_limit);
+        wnoutrefresh(chat_win);
+
+        // 설정 완료 메시지 (Enter는 lobby_handle_key에서 처리)
+        werase(input_win);
+        box(input_win, 0, 0);
+        mvwprintw(input_win, 1, 1, "설정을 완료하려면 Enter를 누르세요.");
+        wnoutrefresh(input_win);
+        ui_waiting_ready = 1;
+
+        // 로그 파일에 기록
+        if (log_fp != NULL) {
+            fprintf(log_fp, "게임 설정 수신: 모드=%s, 시간 제한=%d\n", game_mode, time_limit);
+            fflush(log_fp);
+        }
+    } else if (strncmp(buffer, "GAME_STARTED", 12) == 0) {
+        // 게임 시작 메시지 수신 시 게임 모듈 실행 (게임이 끝날 때까지 여기서 돌아옴)
+        // 서버가 시드와 틱 일정을 보냈으면 공용 단어 흐름 사용, 없으면 혼자 무작위로 생성
+        game_stream_active = word_stream_parse(&game_stream, buffer + 12) == 0;
+        if (game_stream_active) {
+            log_event("공용 단어 흐름: 시드=%llu, 틱=%dms\n", (unsigned long long)game_stream.seed, game_stream.tick_ms);
+        }
+        wprintw(chat_win, "게임이 시작됩니다!\n");
+        ui_waiting_ready = 0;
+        game_start_round();
+    } else if (strncmp(buffer, "GAME_OVER", 9) == 0) {
+        // 먼저 끝낸 플레이어는 서버가 모든 점수를 받거나 제한 시간이 지난 뒤 로비에서 승자 발표를 받음
+        const char *result = buffer + 9;
+        while (*result == '\n') {
+            result++;
+        }
+        if (*result != '\0') {
+            wprintw(chat_win, "%s", result);
+        }
+    } else if (strncmp(buffer, "SERVER_SHUTDOWN", 15) == 0) {
+        // 서버 종료 메시지 수신 시 클린업 및 종료
+        wprintw(chat_win, "서버가 종료되었습니다.\n");
+        running = 0;
+    } else if (strncmp(buffer, "ERROR ", 6) == 0) {
+        // 오류 메시지 수신 시 표시
+        wprintw(chat_win, "오류: %s", buffer + 6);
+    } else if (strstr(buffer, "사용 가능한 명령어는") != NULL || strstr(buffer, "Available commands are") != NULL) {
+        // /help 출력 처리
+        wattron(chat_win, COLOR_PAIR(2));
+        wprintw(chat_win, "%s", buffer);
+        wattroff(chat_win, COLOR_PAIR(2));
+    } else {
+        // 그 외의 메시지 처리
+        wprintw(chat_win, "%s\n", buffer);
     }
 
-    //***************errorcheck****************
-    running = 0;
-    pthread_exit(NULL);
+
+    wnoutrefresh(chat_win);
 }
 
 // 메시지 전송 함수
@@ -613,7 +749,7 @@ void send_message_to_server(const char *message) {
         strncat(msg_with_newline, "\n", sizeof(msg_with_newline) - strlen(msg_with_newline) - 1);
     }
 
-    if (send(sock, msg_with_newline, strlen(msg_with_newline), 0) < 0) {
+    if (send(sock, msg_with_newline, strlen(msg_with_newline), MSG_NOSIGNAL) < 0) {
         perror("메시지 전송 실패");
         // 로그 파일에 기록
         if (log_fp != NULL) {
@@ -629,14 +765,40 @@ void send_message_to_server(const char *message) {
     }
 }
 
+// 사전 파일 열기: 현재 디렉토리, 없으면 실행 파일이 있는 디렉토리에서 찾음
+void game_open_dict() {
+    char path[512] = WORD_DICT_FILE;
+    if (word_dict_open(&game_dict, path) != 0) {
+        ssize_t n = readlink("/proc/self/exe", path, sizeof(path) - 1);
+        char *slash = NULL;
+        if (n > 0) {
+            path[n] = '\0';
+            slash = strrchr(path, '/');
+        }
+        if (slash == NULL || (size_t)(slash - path) + sizeof("/" WORD_DICT_FILE) > sizeof(path)) {
+            log_event("사전 파일 없음, 기본 단어 사용: %s\n", WORD_DICT_FILE);
+            return;
+        }
+        strcpy(slash + 1, WORD_DICT_FILE);
+        if (word_dict_open(&game_dict, path) != 0) {
+            log_event("사전 파일 없음, 기본 단어 사용: %s\n", WORD_DICT_FILE);
+            return;
+        }
+    }
+    game_dict_loaded = 1;
+    log_event("사전 로드 완료: %s, 단어 수=%u\n", path, game_dict.word_count);
+}
+
 // 클린업 함수
 void cleanup() {
     running = 0;
     close(sock);
     endwin();
 
-    // 동적 단어 메모리 해제
-    free_dynamic_words();
+    // 주제 단어 작업 쓰레드 종료 (진행 중인 요청은 중단)
+    topic_cache_shutdown();
+    word_dict_close(&game_dict);
+    close(event_fd);
 
     // CURL 정리
     curl_global_cleanup();
@@ -649,7 +811,6 @@ void cleanup() {
 
 // 메인 함수
 int main() {
-    struct sockaddr_in serv_addr;
     char name[50];
 
     setlocale(LC_ALL, ""); // 로케일 설정
@@ -664,6 +825,21 @@ int main() {
         exit(EXIT_FAILURE);
     }
 
+    // 사전 파일 열기 (mmap이라 단어 수와 관계없이 바로 끝남)
+    game_open_dict();
+
+    // UI 쓰레드로 넘길 이벤트 큐 (작업 쓰레드가 시작되기 전에 준비)
+    ui_thread = pthread_self();
+    event_ring_init(&net_events);
+    event_queue_init(&worker_events);
+    event_fd = event_wakeup_open();
+    if (event_fd < 0) {
+        exit(EXIT_FAILURE);
+    }
+
+    // 주제 단어 작업 쓰레드 시작
+    topic_cache_init(GPT_API_URL, GPT_API_KEY, topic_words_ready);
+
     // ncurses 초기화
     initscr();
     cbreak();
@@ -678,26 +854,16 @@ int main() {
     // 창 초기화 함수 호출
     initialize_windows();
 
-    // 소켓 생성
-    if ((sock = socket(AF_INET, SOCK_STREAM, 0)) < 0) {
-        perror("소켓 생성 실패");
-        cleanup();
-        exit(EXIT_FAILURE);
-    }
-
-    serv_addr.sin_family = AF_INET;
-    serv_addr.sin_port = htons(SERVER_PORT);
-
-    // 서버 IP 변환
-    if (inet_pton(AF_INET, SERVER_IP, &serv_addr.sin_addr) <= 0) {
-        perror("잘못된 주소/주소 형식");
+    // 서버에 연결 (같은 컴퓨터면 Unix 소켓, 아니면 TCP)
+    if ((sock = net_connect_local(SERVER_UNIX_SOCKET, SERVER_IP, SERVER_PORT)) < 0) {
+        perror("서버에 연결할 수 없습니다");
         cleanup();
         exit(EXIT_FAILURE);
     }
 
-    // 서버에 연결
-    if (connect(sock, (struct sockaddr *)&serv_addr, sizeof(serv_addr)) < 0) {
-        perror("서버에 연결할 수 없습니다");
+    // 리시브 스레드 생성 (이름을 입력하는 동안에도 서버의 PING에 답하도록 먼저 띄움)
+    if (pthread_create(&recv_thread, NULL, recv_handler, NULL) != 0) {
+        perror("리시브 스레드 생성 실패");
         cleanup();
         exit(EXIT_FAILURE);
     }
@@ -723,133 +889,136 @@ int main() {
     // 로그: 이름 전송 완료
     log_event("이름 전송 완료: %s\n", name);
 
-    // 입력창 초기화 후 명령어 안내 출력
-    werase(input_win);
-    box(input_win, 0, 0);
-    mvwprintw(input_win, 1, 1, "입력: ");
-    mvwprintw(input_win, 2, 1, "사용 가능한 명령어는 /help를 입력하세요. /topic <주제>로 단어를 가져올 수 있습니다.");
-    wrefresh(input_win);
+    // 이후 입력은 UI 루프가 poll로 기다리므로 읽기는 막히지 않게
+    nodelay(input_win, TRUE);
+    lobby_draw_prompt();
+    doupdate();
 
-    // 리시브 스레드 생성
-    if (pthread_create(&recv_thread, NULL, recv_handler, NULL) != 0) {
-        perror("리시브 스레드 생성 실패");
-        cleanup();
-        exit(EXIT_FAILURE);
-    }
-
-    // 메인 루프: 사용자 입력 처리
+    // 메인 루프 (UI 쓰레드): 키 입력과 다른 쓰레드가 보낸 이벤트를 함께 기다림
     while (running) {
-        // 게임 실행 중이면 입력을 받지 않음
-        if (game_running) {
-            sleep(1);
-            continue;
+        struct pollfd fds[2] = {{STDIN_FILENO, POLLIN, 0}, {event_fd, POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("poll 실패");
+            break;
+        }
+        if (fds[1].revents & POLLIN) {
+            ui_dispatch_events();
+        }
+        if (fds[0].revents & POLLIN) {
+            while (running && lobby_handle_key())
+                ;
         }
 
-        // 입력 창 초기화
-        pthread_mutex_lock(&window_mutex);
-        werase(input_win);
-        box(input_win, 0, 0);
-        mvwprintw(input_win, 1, 1, "입력: ");
-        mvwprintw(input_win, 3, 1, "사용 가능한 명령어는 /help를 입력하세요. /topic <주제>로 단어를 가져올 수 있습니다."); // 메뉴얼 안내
-        wrefresh(input_win);
-        pthread_mutex_unlock(&window_mutex);
-
-        // 멀티바이트 문자 입력 처리
-        wchar_t winput_buffer[INPUT_BUFFER_SIZE];
-        memset(winput_buffer, 0, sizeof(winput_buffer));
-        int wpos = 0;
+        // 이번에 바뀐 창을 한 번에 화면에 반영 (커서는 입력창에)
+        wnoutrefresh(input_win);
+        doupdate();
+    }
 
-        while (1) {
-            wint_t wch;
-            int wret = wget_wch(input_win, &wch);
+    // 수신 쓰레드를 recv에서 깨운 뒤 종료 대기
+    running = 0;
+    shutdown(sock, SHUT_RDWR);
+    pthread_join(recv_thread, NULL);
 
-            if (wret == ERR) {
-                continue;
-            }
+    // 클린업
+    cleanup();
+    return 0;
+}
 
-            // 엔터 키로 입력 종료
-            if (wch == L'\n') {
-                winput_buffer[wpos] = L'\0'; // 입력된 문자열 종료
-                break;
-            }
+// 로비 입력창 그리기 (입력 중인 내용 포함)
+void lobby_draw_prompt() {
+    werase(input_win);
+    box(input_win, 0, 0);
+    mvwprintw(input_win, 1, 1, "입력: ");
+    mvwprintw(input_win, 3, 1, "사용 가능한 명령어는 /help를 입력하세요. /topic <주제>로 단어를 가져올 수 있습니다."); // 메뉴얼 안내
+    mvwprintw(input_win, 1, 8, "%ls", lobby_input);
+    wnoutrefresh(input_win);
+}
 
-            // 백스페이스 처리
-            if ((wch == KEY_BACKSPACE || wch == 127 || wch == '\b') && wpos > 0) {
-                wpos--;
-                winput_buffer[wpos] = L'\0'; // 마지막 문자 제거
-                pthread_mutex_lock(&window_mutex);
-                mvwprintw(input_win, 1, 8, "%ls ", winput_buffer); // 입력창 갱신
-                wclrtoeol(input_win);                              // 라인 끝 지우기
-                wrefresh(input_win);                               // 입력창 업데이트
-                pthread_mutex_unlock(&window_mutex);
-            } else if (iswprint(wch) && wpos < (int)(sizeof(winput_buffer) / sizeof(wchar_t) - 1)) {
-                winput_buffer[wpos++] = wch; // 입력 문자 추가
-                winput_buffer[wpos] = L'\0';
-                pthread_mutex_lock(&window_mutex);
-                mvwprintw(input_win, 1, 8, "%ls", winput_buffer); // 입력창 갱신
-                wrefresh(input_win);                              // 입력창 업데이트
-                pthread_mutex_unlock(&window_mutex);
-            }
+// 입력 한 줄 처리 (명령어 / 채팅)
+static void lobby_submit() {
+    // 입력 버퍼 정리 (앞뒤 공백 제거)
+    wchar_t *wtrimmed_input = lobby_input;
+    while (iswspace(*wtrimmed_input))
+        wtrimmed_input++;
+
+    wchar_t *wend = wtrimmed_input + wcslen(wtrimmed_input) - 1;
+    while (wend > wtrimmed_input && iswspace(*wend))
+        wend--;
+    *(wend + 1) = L'\0';
+
+    // Wide char를 멀티바이트 문자열로 변환
+    char input_buffer[INPUT_BUFFER_SIZE];
+    wcstombs(input_buffer, wtrimmed_input, INPUT_BUFFER_SIZE - 1);
+    input_buffer[INPUT_BUFFER_SIZE - 1] = '\0'; // Ensure null termination
+
+    log_event("사용자 입력: '%s'\n", input_buffer);
+
+    // 명령어 파싱 및 전송
+    if (strncmp(input_buffer, "/", 1) == 0) {
+        // /topic 명령어 처리
+        if (strncmp(input_buffer, "/topic ", 7) == 0) {
+            char topic[TOPIC_MAX_LENGTH];
+            snprintf(topic, sizeof(topic), "%s", input_buffer + 7); // "/topic " 이후의 문자열
+
+            // 응답을 기다리지 않음 (결과는 topic_words_ready에서 출력)
+            load_dynamic_words(topic);
+        } else {
+            // 다른 명령어인 경우 그대로 전송
+            send_message_to_server(input_buffer);
         }
+    } else if (strlen(input_buffer) > 0) {
+        // 기본 채팅 메시지로 간주
+        char chat_msg[BUFFER_SIZE];
+        snprintf(chat_msg, sizeof(chat_msg), "/chat %s\n", input_buffer);
+        send_message_to_server(chat_msg);
+    }
+}
 
-        // 입력 버퍼 정리 (앞뒤 공백 제거)
-        wchar_t *wtrimmed_input = winput_buffer;
-        while (iswspace(*wtrimmed_input))
-            wtrimmed_input++;
-
-        wchar_t *wend = wtrimmed_input + wcslen(wtrimmed_input) - 1;
-        while (wend > wtrimmed_input && iswspace(*wend))
-            wend--;
-        *(wend + 1) = L'\0';
-
-        // Wide char를 멀티바이트 문자열로 변환
-        char input_buffer[INPUT_BUFFER_SIZE];
-        wcstombs(input_buffer, wtrimmed_input, INPUT_BUFFER_SIZE - 1);
-        input_buffer[INPUT_BUFFER_SIZE - 1] = '\0'; // Ensure null termination
-
-        log_event("사용자 입력: '%s'\n", input_buffer);
-
-        // 명령어 파싱 및 전송
-        if (strncmp(input_buffer, "/", 1) == 0) {
-            // /topic 명령어 처리
-            if (strncmp(input_buffer, "/topic ", 7) == 0) {
-                char topic[256];
-                strcpy(topic, input_buffer + 7); // "/topic " 이후의 문자열
-                
-                pthread_mutex_lock(&window_mutex);
-                wprintw(chat_win, "주제 '%s'에 대한 단어를 GPT에서 가져오는 중...\n", topic);
-                wrefresh(chat_win);
-                pthread_mutex_unlock(&window_mutex);
-                
-                // GPT에서 단어 가져오기
-                load_dynamic_words(topic);
-                
-                pthread_mutex_lock(&window_mutex);
-                if (use_dynamic_words) {
-                    wprintw(chat_win, "동적 단어 로드 완료! %d개의 단어가 준비되었습니다.\n", dynamic_wordDB_size);
-                } else {
-                    wprintw(chat_win, "동적 단어 로드에 실패했습니다. 기본 단어를 사용합니다.\n");
-                }
-                wrefresh(chat_win);
-                pthread_mutex_unlock(&window_mutex);
-            } else {
-                // 다른 명령어인 경우 그대로 전송
-                send_message_to_server(input_buffer);
-            }
-        } else if (strlen(input_buffer) > 0) {
-            // 기본 채팅 메시지로 간주
-            char chat_msg[BUFFER_SIZE];
-            snprintf(chat_msg, sizeof(chat_msg), "/chat %s\n", input_buffer);
-            send_message_to_server(chat_msg);
+// 로비 키 하나 처리, 처리할 키가 없으면 0 (멀티바이트 문자 입력 처리)
+int lobby_handle_key() {
+    wint_t wch;
+    if (wget_wch(input_win, &wch) == ERR) {
+        return 0;
+    }
+
+    // 게임 설정 확인 중이면 Enter만 받음
+    if (ui_waiting_ready) {
+        if (wch == L'\n') {
+            ui_waiting_ready = 0;
+
+            // 서버에 설정 완료 메시지 전송
+            char ready_msg[] = "/ready\n";
+            send_message_to_server(ready_msg);
+            log_event("서버에 READY 메시지 전송: %s", ready_msg);
+            lobby_draw_prompt();
         }
+        return 1;
     }
 
-    // 스레드 종료 대기
-    pthread_join(recv_thread, NULL);
+    // 엔터 키로 입력 종료
+    if (wch == L'\n') {
+        lobby_input[lobby_pos] = L'\0';
+        lobby_submit();
+        lobby_pos = 0;
+        lobby_input[0] = L'\0';
+        lobby_draw_prompt();
+        return 1;
+    }
 
-    // 클린업
-    cleanup();
-    return 0;
+    // 백스페이스 처리
+    if ((wch == KEY_BACKSPACE || wch == 127 || wch == '\b') && lobby_pos > 0) {
+        lobby_pos--;
+        lobby_input[lobby_pos] = L'\0';                    // 마지막 문자 제거
+        mvwprintw(input_win, 1, 8, "%ls ", lobby_input); // 입력창 갱신
+        wclrtoeol(input_win);                            // 라인 끝 지우기
+    } else if (iswprint(wch) && lobby_pos < INPUT_BUFFER_SIZE - 1) {
+        lobby_input[lobby_pos++] = wch; // 입력 문자 추가
+        lobby_input[lobby_pos] = L'\0';
+        mvwprintw(input_win, 1, 8, "%ls", lobby_input); // 입력창 갱신
+    }
+    return 1;
 }
 
 // 게임 실행 함수
@@ -864,7 +1033,15 @@ void run_game(int game_duration) {
     game_level = 1;
     game_word_speed = 1;
     game_word_interval = 2;
-    game_frame_delay = 1000000;
+    game_frame_delay = game_stream_active ? game_stream.tick_ms * 1000 : 1000000;
+    game_frame = 0;
+    word_pool_init(&game_words);
+    memset(game_drawn, 0, sizeof(game_drawn));
+    game_drawn_score = game_drawn_level = -1;
+    game_player_drawn = 0;
+    game_result_message[0] = '\0';
+    game_leaderboard[0] = '\0';
+    game_leaderboard_dirty = 0;
 
     // 입력 처리 관련
     memset(game_typingText, 0, sizeof(game_typingText));
@@ -874,7 +1051,6 @@ void run_game(int game_duration) {
     time(&game_start_time);
 
     // 게임 UI 초기화
-    pthread_mutex_lock(&window_mutex);
     clear();
     refresh();
     curs_set(FALSE); // 게임 중에는 커서 숨기기
@@ -884,41 +1060,95 @@ void run_game(int game_duration) {
     game_win = newwin(LINES - 3, COLS, 0, 0); // 게임 메인 창 (하단 3줄 제외)
     game_input_win = newwin(3, COLS, LINES - 3, 0); // 게임용 입력창 (하단 3줄)
     
-    // 입력창 초기화
+    // 입력창 초기화 (poll로 기다리므로 읽기는 막히지 않게)
+    nodelay(game_input_win, TRUE);
+    keypad(game_input_win, TRUE);
     box(game_input_win, 0, 0);
     mvwprintw(game_input_win, 1, 1, "Enter Word: ");
     wrefresh(game_input_win);
-    
-    pthread_mutex_unlock(&window_mutex);
 
     // 플레이어 초기화
     game_init_player();
 
-    // 게임 쓰레드 생성
-    pthread_t game_thread_id;
-    if (pthread_create(&game_thread_id, NULL, game_game_thread_func, NULL) != 0) {
-        perror("게임 쓰레드 생성 실패");
+    // 한 루프에서 입력(stdin), 시뮬레이션 틱(timerfd), 다른 쓰레드의 이벤트(eventfd)를 함께 기다림
+    int timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timer_fd < 0) {
+        perror("timerfd 생성 실패");
+        game_running = 0;
         return;
     }
-
-    // 메인 쓰레드는 사용자 입력 처리
+    struct itimerspec tick;
+    tick.it_interval.tv_sec = game_frame_delay / 1000000;
+    tick.it_interval.tv_nsec = (long)(game_frame_delay % 1000000) * 1000;
+    tick.it_value = tick.it_interval;
+    timerfd_settime(timer_fd, 0, &tick, NULL);
+
+    GameTimingStats frame_stats = {0}, late_stats = {0}, input_stats = {0};
+    int catchup_steps = 0;
+    long long next_tick = game_now_ns() + (long long)game_frame_delay * 1000;
+    long long end_time = game_now_ns() + (long long)game_GAME_DURATION * 1000000000LL;
+
+    game_render();
     while (!game_game_over) {
-        game_handle_input();
-        // 현재 시간 체크
-        time_t current_time;
-        time(&current_time);
-        if (difftime(current_time, game_start_time) >= game_GAME_DURATION) {
+        // 남은 게임 시간만큼만 기다림 (시간이 다 되면 바로 종료)
+        long long remaining = end_time - game_now_ns();
+        if (remaining <= 0) {
             game_game_over = 1;
             break;
         }
-        usleep(10000); // 10ms 대기
+        struct pollfd fds[3] = {{STDIN_FILENO, POLLIN, 0}, {timer_fd, POLLIN, 0}, {event_fd, POLLIN, 0}};
+        if (poll(fds, 3, (int)((remaining + 999999) / 1000000)) < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("poll 실패");
+            break;
+        }
+        long long woke = game_now_ns();
+
+        // 서버 메시지 / 주제 단어 (GAME_OVER를 받으면 game_game_over가 켜짐)
+        if (fds[2].revents & POLLIN) {
+            ui_dispatch_events();
+            if (game_leaderboard_dirty && !game_game_over)
+                game_render();
+        }
+
+        // 입력: 쌓인 키를 모두 처리하고 화면에 반영되기까지의 시간을 기록
+        if (fds[0].revents & POLLIN) {
+            int handled = 0;
+            while (game_handle_input())
+                handled = 1;
+            if (handled) {
+                game_render();
+                game_stat_add(&input_stats, game_now_ns() - woke);
+            }
+        }
+
+        // 시뮬레이션: 밀린 틱만큼 고정 간격 스텝을 돌린 뒤 한 번만 그림
+        if (fds[1].revents & POLLIN) {
+            uint64_t expirations = 0;
+            if (read(timer_fd, &expirations, sizeof(expirations)) != sizeof(expirations) || expirations == 0)
+                continue;
+            game_stat_add(&late_stats, woke - next_tick);
+            next_tick += (long long)expirations * game_frame_delay * 1000;
+
+            uint64_t steps = expirations < GAME_MAX_CATCHUP_STEPS ? expirations : GAME_MAX_CATCHUP_STEPS;
+            if (expirations > 1)
+                catchup_steps += (int)(steps - 1);
+            for (uint64_t i = 0; i < steps && !game_game_over; i++)
+                game_step();
+            game_render();
+            game_stat_add(&frame_stats, game_now_ns() - woke);
+        }
     }
+    close(timer_fd);
 
-    // 쓰레드 종료 대기
-    pthread_join(game_thread_id, NULL);
+    log_event("프레임 %d회: 평균 %.2fms, 최대 %.2fms / 틱 지연 평균 %.2fms, 최대 %.2fms / 따라잡은 스텝 %d\n",
+              frame_stats.count, game_stat_avg_ms(&frame_stats), frame_stats.max_ns / 1e6,
+              game_stat_avg_ms(&late_stats), late_stats.max_ns / 1e6, catchup_steps);
+    log_event("입력->화면 %d회: 평균 %.3fms, 최대 %.3fms\n",
+              input_stats.count, game_stat_avg_ms(&input_stats), input_stats.max_ns / 1e6);
 
     // 게임 종료 처리
-    pthread_mutex_lock(&window_mutex);
     game_cleanup();
     delwin(game_win);
     delwin(game_input_win);
@@ -926,7 +1156,6 @@ void run_game(int game_duration) {
     refresh();
     initialize_windows(); // 창 재초기화
     curs_set(TRUE);       // 커서 보이기
-    pthread_mutex_unlock(&window_mutex);
 
     // 게임 실행 중 플래그 해제
     game_running = 0;
@@ -941,6 +1170,7 @@ void game_define_colors() {
     init_pair(4, COLOR_GREEN, COLOR_CYAN); // 플레이어 색상
     init_pair(5, COLOR_BLACK, COLOR_CYAN); // 입력 창 색상
     init_pair(6, COLOR_WHITE, COLOR_CYAN); // 배경색
+    init_pair(7, COLOR_YELLOW, COLOR_CYAN); // 입력 중인 단어의 입력된 부분
 }
 
 // 플레이어 초기화 함수
@@ -952,6 +1182,11 @@ void game_init_player() {
 
 // 플레이어 그리기 함수
 void game_draw_player() {
+    // 플레이어는 움직이지 않으므로 처음이나 가려졌을 때만 그림
+    if (game_player_drawn)
+        return;
+    game_player_drawn = 1;
+
     // 플레이어 위치를 게임 창 범위 내로 조정
     int player_row = game_player.row;
     if (player_row >= LINES - 3) {
@@ -965,160 +1200,176 @@ void game_draw_player() {
 
 // 단어 추가 함수
 void game_add_word() {
-    GameWordNode *new_word = (GameWordNode *)malloc(sizeof(GameWordNode));
-    if (!new_word) {
-        perror("메모리 할당 실패");
-        exit(EXIT_FAILURE);
-    }
-    memset(new_word, 0, sizeof(GameWordNode)); // 메모리 초기화
-
-    // 단어 선택
+    // 단어 선택 (문자열은 풀이 복사하므로 DB 포인터만 고름)
+    const char *word;
     int is_power_up = 0;
     if (rand() % 100 < 20) { // 20% 확률로 파워업 단어
         is_power_up = 1;
-        strcpy(new_word->word, game_powerUpDB[rand() % game_powerUpDB_size]);
+        word = word_stream_power_ups[rand() % word_stream_power_ups_size];
     } else {
         // 동적 단어 사용 여부 확인
+        word = NULL;
         if (use_dynamic_words && dynamic_wordDB_size > 0) {
-            strcpy(new_word->word, dynamic_wordDB[rand() % dynamic_wordDB_size]);
-        } else {
-            strcpy(new_word->word, game_wordDB[rand() % game_wordDB_size]);
+            word = dynamic_wordDB[rand() % dynamic_wordDB_size];
+        }
+        if (word == NULL && game_dict_loaded) {
+            // 레벨이 오를수록 어려운 단어 (화면 폭에 들어가는 길이만)
+            int difficulty = (game_level - 1) / 4;
+            if (difficulty >= WORD_DICT_DIFFICULTIES)
+                difficulty = WORD_DICT_DIFFICULTIES - 1;
+            word = word_dict_random_max_length(&game_dict, difficulty, COLS - 2);
+        }
+        if (word == NULL) {
+            word = word_stream_words[rand() % word_stream_words_size];
         }
     }
-    new_word->is_power_up = is_power_up;
-
-    new_word->row = 1;
 
     // 단어 길이를 고려하여 최대 컬럼 값을 계산
-    int max_col = COLS - (int)strlen(new_word->word) - 1;
+    int max_col = COLS - (int)strlen(word) - 1;
     if (max_col < 1)
         max_col = 1;
 
-    new_word->col = rand() % max_col;
-
-    new_word->next = NULL;
-
-    // 리스트에 추가
-    if (game_word_head == NULL) {
-        game_word_head = new_word;
-    } else {
-        GameWordNode *temp = game_word_head;
-        while (temp->next != NULL)
-            temp = temp->next;
-        temp->next = new_word;
+    if (word_pool_spawn(&game_words, word, 1, rand() % max_col, is_power_up, -1) < 0) {
+        log_event("단어 풀이 가득 차서 단어를 건너뜀: %s\n", word);
     }
 }
 
 // 단어 업데이트 함수
 void game_update_words() {
-    GameWordNode *current = game_word_head;
-    GameWordNode *prev = NULL;
-
-    while (current != NULL) {
-        // 기존 위치를 지움 (좌표 값 검사 추가)
-        if (current->row >= 0 && current->row < LINES - 3 && current->col >= 0 && current->col < COLS) {
-            mvwprintw(game_win, current->row, current->col, "%*s", (int)strlen(current->word), "");
-        }
-
-        // 단어의 위치를 업데이트
-        current->row += game_word_speed;
+    // 뒤에서부터 순회해야 제거 시 옮겨 온 단어를 다시 처리하지 않음
+    for (int i = game_words.count - 1; i >= 0; i--) {
+        // 단어의 위치를 업데이트 (지우고 다시 그리는 것은 game_draw_words에서)
+        int length = game_words.length[i];
+        game_words.row[i] += game_word_speed;
 
         // 화면을 벗어난 단어 처리
-        if (current->row >= LINES - 5) { // 게임 창 높이에 맞춰 조정
-            // 점수 감점
-            game_score -= strlen(current->word);
-
-            // 리스트에서 제거
-            GameWordNode *temp = current;
-            if (prev == NULL) { // 첫 노드인 경우
-                game_word_head = current->next;
-                current = game_word_head;
-            } else {
-                prev->next = current->next;
-                current = prev->next;
-            }
-            free(temp);
-
-            continue;
+        if (game_words.row[i] >= LINES - 5) { // 게임 창 높이에 맞춰 조정
+            // 점수 감점 후 풀에서 제거
+            game_score -= length;
+            word_pool_despawn(&game_words, i);
         }
+    }
+}
 
-        prev = current;
-        current = current->next;
+// 지운 영역과 겹치는지 확인
+static int game_overlaps(const GameDrawnWord *spans, int span_count, int row, int col, int length) {
+    for (int i = 0; i < span_count; i++) {
+        if (spans[i].row == row && spans[i].col < col + length && col < spans[i].col + spans[i].length)
+            return 1;
     }
+    return 0;
 }
 
-// 단어 그리기 함수
+// 단어 그리기 함수 (움직였거나 모양이 바뀐 단어, 지운 영역과 겹친 단어만 다시 그림)
 void game_draw_words() {
-    GameWordNode *current = game_word_head;
+    GameDrawnWord want[WORD_POOL_CAPACITY];
+    GameDrawnWord erased[WORD_POOL_CAPACITY];
+    int erased_count = 0;
+    memset(want, 0, sizeof(want));
+
+    // 입력한 접두사로 시작하는 단어만 색인에서 찾음
+    int target = word_pool_target(&game_words, game_typingText);
 
-    while (current != NULL) {
+    // 이번 프레임에 그려야 할 모습 (텍스트 칸 번호별)
+    for (int i = 0; i < game_words.count; i++) {
+        int row = game_words.row[i], col = game_words.col[i], length = game_words.length[i];
         // 좌표 값 검사 추가 (게임 창 범위 내에서만)
-        if (current->row >= 0 && current->row < LINES - 3 && current->col >= 0 && current->col < COLS - (int)strlen(current->word)) {
-            if (current->is_power_up) {
-                // 파워업 단어 색상
-                wattron(game_win, COLOR_PAIR(3));
-                mvwprintw(game_win, current->row, current->col, "%s", current->word);
-                wattroff(game_win, COLOR_PAIR(3));
-            } else {
-                // 일반 단어 색상
-                wattron(game_win, COLOR_PAIR(1));
-                mvwprintw(game_win, current->row, current->col, "%s", current->word);
-                wattroff(game_win, COLOR_PAIR(1));
-            }
+        if (row >= 0 && row < LINES - 3 && col >= 0 && col < COLS - length) {
+            GameDrawnWord *w = &want[game_words.text_offset[i] / WORD_POOL_TEXT_STRIDE];
+            w->row = row;
+            w->col = col;
+            w->length = length;
+            w->pair = game_words.power_up[i] ? 3 : 1; // 파워업 단어 / 일반 단어 색상
+            w->typed = i == target ? game_enter_position : 0;
+            memcpy(w->text, word_pool_text(&game_words, i), (size_t)length + 1);
+        }
+    }
+
+    // 사라졌거나 움직인 단어의 이전 자리를 지움
+    for (int slot = 0; slot < WORD_POOL_CAPACITY; slot++) {
+        GameDrawnWord *old = &game_drawn[slot], *w = &want[slot];
+        if (old->pair == 0)
+            continue;
+        if (w->pair == 0 || w->row != old->row || w->col != old->col || w->length != old->length ||
+            strcmp(w->text, old->text) != 0) {
+            mvwprintw(game_win, old->row, old->col, "%*s", old->length, "");
+            erased[erased_count++] = *old;
+            old->pair = 0;
+        }
+    }
+
+    // 바뀐 단어와 지운 자리에 겹친 단어만 그림
+    for (int slot = 0; slot < WORD_POOL_CAPACITY; slot++) {
+        GameDrawnWord *old = &game_drawn[slot], *w = &want[slot];
+        if (w->pair == 0)
+            continue;
+        if (old->pair == w->pair && old->typed == w->typed &&
+            !game_overlaps(erased, erased_count, w->row, w->col, w->length))
+            continue;
+
+        const char *text = w->text;
+        wattron(game_win, COLOR_PAIR(w->pair));
+        mvwprintw(game_win, w->row, w->col, "%s", text);
+        wattroff(game_win, COLOR_PAIR(w->pair));
+
+        // 입력 중인 단어는 입력된 부분을 강조
+        if (w->typed > 0) {
+            wattron(game_win, COLOR_PAIR(7) | A_BOLD);
+            mvwprintw(game_win, w->row, w->col, "%.*s", w->typed, text);
+            wattroff(game_win, COLOR_PAIR(7) | A_BOLD);
         }
-        current = current->next;
+        *old = *w;
+    }
+
+    // 플레이어가 지운 영역에 걸렸으면 다시 그림
+    if (game_player_drawn) {
+        int player_row = game_player.row >= LINES - 3 ? LINES - 4 : game_player.row;
+        if (game_overlaps(erased, erased_count, player_row, game_player.col, 1))
+            game_player_drawn = 0;
     }
 }
 
 // 단어 체크 함수
 void game_word_Check(char *str) {
-    GameWordNode *temp = game_word_head;
-    GameWordNode *prev = NULL;
-
-    while (temp != NULL) {
-        if (strcmp(temp->word, str) == 0) {
-            // 단어 일치 시 점수 증가
-            if (temp->is_power_up) {
-                game_score += strlen(temp->word) * 2; // 파워업 단어는 추가 점수
-            } else {
-                game_score += strlen(temp->word);
-            }
+    // 트라이에서 입력 길이만큼만 내려가 일치하는 단어를 찾음
+    int i = word_pool_find(&game_words, str);
+    if (i >= 0) {
+        int length = game_words.length[i];
+
+        // 공용 단어 흐름의 단어면 맞힌 틱과 id만 서버에 보고 (서버가 같은 흐름으로 검증)
+        if (game_words.stream_id[i] >= 0) {
+            char kill_msg[50];
+            snprintf(kill_msg, sizeof(kill_msg), "KILL %d %d\n", game_frame, game_words.stream_id[i]);
+            send_message_to_server(kill_msg);
+        }
 
-            // 화면에서 단어 지우기 (게임 창 범위 내에서만)
-            if (temp->row >= 0 && temp->row < LINES - 3 && temp->col >= 0 && temp->col < COLS) {
-                mvwprintw(game_win, temp->row, temp->col, "%*s", (int)strlen(temp->word), "");
-            }
+        // 단어 일치 시 점수 증가
+        if (game_words.power_up[i]) {
+            game_score += length * 2; // 파워업 단어는 추가 점수
+        } else {
+            game_score += length;
+        }
 
-            // 단어 제거
-            if (prev == NULL) {
-                game_word_head = temp->next;
-            } else {
-                prev->next = temp->next;
-            }
-            free(temp);
-
-            // 여기서 점수 체크 및 게임 종료 메시지 전송
-            if (game_score >= 150 && !game_game_over) {
-                // 게임 종료 메시지 전송
-                char game_over_msg[50];
-                snprintf(game_over_msg, sizeof(game_over_msg), "GAME_OVER %d\n", game_score);
-                send_message_to_server(game_over_msg);
-                // 게임 종료 플래그 설정
-                game_game_over = 1;
-            }
+        // 단어 제거 (화면에서는 다음 game_draw_words에서 지워짐)
+        word_pool_despawn(&game_words, i);
 
-            return;
+        // 여기서 점수 체크 및 게임 종료 메시지 전송
+        if (game_score >= 150 && !game_game_over) {
+            // 게임 종료 메시지 전송
+            char game_over_msg[50];
+            snprintf(game_over_msg, sizeof(game_over_msg), "GAME_OVER %d %d\n", game_score, game_frame);
+            send_message_to_server(game_over_msg);
+            // 게임 종료 플래그 설정
+            game_game_over = 1;
         }
-        prev = temp;
-        temp = temp->next;
     }
 }
 
-// 사용자 입력 처리 함수
-void game_handle_input() {
-    int c = wgetch(game_input_win); // game_input_win에서 입력 받기
+// 사용자 입력 처리 함수 (키 하나 처리, 처리할 키가 없으면 0 / 화면 반영은 game_render에서)
+int game_handle_input() {
+    int c = wgetch(game_input_win); // game_input_win에서 입력 받기 (nodelay)
     if (c == ERR)
-        return;
+        return 0;
 
     if (c == '\n') {
         game_typingText[game_enter_position] = '\0';
@@ -1132,78 +1383,152 @@ void game_handle_input() {
         werase(game_input_win);
         box(game_input_win, 0, 0);
         mvwprintw(game_input_win, 1, 1, "Enter Word: ");
-        wrefresh(game_input_win);
     } else if (c == KEY_BACKSPACE || c == 127) {
         if (game_enter_position > 0) {
             game_enter_position--;
             game_typingText[game_enter_position] = '\0';
             mvwprintw(game_input_win, 1, 13, "%s ", game_typingText);
             wmove(game_input_win, 1, 13 + game_enter_position);
-            wrefresh(game_input_win);
         }
     } else if (isprint(c) && game_enter_position < (int)(sizeof(game_typingText) - 1)) {
         game_typingText[game_enter_position++] = c;
         game_typingText[game_enter_position] = '\0';
         mvwprintw(game_input_win, 1, 13, "%s", game_typingText);
         wmove(game_input_win, 1, 13 + game_enter_position);
-        wrefresh(game_input_win);
     }
+    return 1;
 }
 
-// 게임 쓰레드 함수
-void *game_game_thread_func(void *arg) {
-    int frame = 0;
-
-    while (!game_game_over) {
-        frame++;
+// 시뮬레이션 한 스텝 (단어 생성/이동, 레벨 업)
+void game_step() {
+    game_frame++;
 
+    if (game_stream_active) {
+        game_stream_step();
+    } else {
         // 단어 생성 간격에 도달하면 단어 추가
-        if (frame % game_word_interval == 0) {
+        if (game_frame % game_word_interval == 0) {
             game_add_word();
         }
 
-        // 단어 업데이트 (위치 변경 및 그리기)
+        // 단어 업데이트 (위치 변경)
         game_update_words();
+    }
 
-        // 단어 그리기
-        game_draw_words();
+    // 레벨 업 로직
+    if (game_score >= game_level * 20 && game_level < 10) {
+        game_level++;
+        if (game_level % 2 == 0) { // 레벨이 짝수일 때만 속도 증가
+            game_word_speed++;     // 단어 하강 속도 증가
+        }
+        if (game_word_interval > 5)
+            game_word_interval -= 1;
+    }
+}
+
+// 공용 단어 흐름 한 스텝 (이번 틱의 단어를 만들고 위치는 틱으로 계산, 서버와 같은 결과)
+void game_stream_step() {
+    int tick = game_frame;
+    WordStreamWord word;
+
+    if (tick % game_stream.spawn_every == 0) {
+        word_stream_word(&game_stream, word_stream_spawned(&game_stream, tick) - 1, &word);
+        // 가로 위치는 비율로 받아 화면 폭에 맞춤
+        int max_col = COLS - word.length - 1;
+        if (max_col < 1)
+            max_col = 1;
+        if (word_pool_spawn(&game_words, word.text, word_stream_row(&word, tick), word.col_permille * max_col / 1000,
+                            word.power_up, word.id) < 0) {
+            log_event("단어 풀이 가득 차서 단어를 건너뜀: %s\n", word.text);
+        }
+    }
+
+    // 바닥(일정의 height)에 닿은 단어는 감점 후 제거
+    for (int i = game_words.count - 1; i >= 0; i--) {
+        word_stream_word(&game_stream, game_words.stream_id[i], &word);
+        if (tick >= word.expire_tick) {
+            game_score -= word.length;
+            word_pool_despawn(&game_words, i);
+            continue;
+        }
+        game_words.row[i] = word_stream_row(&word, tick);
+    }
+}
 
-        // 플레이어 그리기
-        game_draw_player();
+// 현재 상태 그리기 (바뀐 부분만 그리고 두 창을 한 번에 화면에 반영)
+void game_render() {
+    // 단어 그리기
+    game_draw_words();
 
-        // 점수 및 상태 표시 (게임 창에 표시)
-        pthread_mutex_lock(&window_mutex);
+    // 플레이어 그리기
+    game_draw_player();
+
+    // 점수 및 상태 표시 (바뀌었을 때만)
+    if (game_score != game_drawn_score || game_level != game_drawn_level || game_leaderboard_dirty) {
         wattron(game_win, COLOR_PAIR(5));
         mvwprintw(game_win, 0, 0, "Score: %d  Level: %d", game_score, game_level);
-        wattroff(game_win, COLOR_PAIR(5));
-        wrefresh(game_win);
-        pthread_mutex_unlock(&window_mutex);
-
-        // 레벨 업 로직
-        if (game_score >= game_level * 20 && game_level < 10) {
-            game_level++;
-            if (game_level % 2 == 0) { // 레벨이 짝수일 때만 속도 증가
-                game_word_speed++;     // 단어 하강 속도 증가
-            }
-            if (game_word_interval > 5)
-                game_word_interval -= 1;
+        if (game_leaderboard[0] != '\0') {
+            wprintw(game_win, "   | %s", game_leaderboard);
         }
+        wattroff(game_win, COLOR_PAIR(5));
+        wclrtoeol(game_win); // 자릿수가 줄었을 때 남는 글자 지움
+        game_drawn_score = game_score;
+        game_drawn_level = game_level;
+        game_leaderboard_dirty = 0;
+    }
 
-        // 속도 조절 (프레임당 대기 시간)
-        usleep(game_frame_delay); // 500,000 us (0.5초)
+    wnoutrefresh(game_win);
+    wnoutrefresh(game_input_win); // 커서가 입력창에 남도록 마지막에
+    doupdate();
+}
+
+// "<점수> <이름>\t<점수> <이름>..." 을 "1.이름 점수  2.이름 점수" 로 바꿔 둠 (다음 game_render에서 그림)
+void game_set_leaderboard(const char *entries) {
+    size_t len = 0;
+    int rank = 1;
+    game_leaderboard[0] = '\0';
+    while (*entries != '\0' && len < sizeof(game_leaderboard)) {
+        int score, used = 0;
+        char name[50];
+        if (sscanf(entries, "%d %49[^\t]%n", &score, name, &used) != 2) {
+            break;
+        }
+        int n = snprintf(game_leaderboard + len, sizeof(game_leaderboard) - len, "%s%d.%s %d",
+                         rank > 1 ? "  " : "", rank, name, score);
+        if (n < 0) {
+            break;
+        }
+        len += (size_t)n;
+        rank++;
+        entries += used;
+        if (*entries == '\t') {
+            entries++;
+        }
     }
+    game_leaderboard_dirty = 1;
+}
 
-    return NULL;
+// 단조 시계 (나노초)
+long long game_now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
 }
 
-// 게임 종료 및 메모리 정리 함수
+void game_stat_add(GameTimingStats *stat, long long ns) {
+    if (ns < 0)
+        ns = 0;
+    stat->count++;
+    stat->total_ns += ns;
+    if (ns > stat->max_ns)
+        stat->max_ns = ns;
+}
+
+double game_stat_avg_ms(const GameTimingStats *stat) {
+    return stat->count ? stat->total_ns / 1e6 / stat->count : 0.0;
+}
+
+// 게임 종료 및 정리 함수 (단어 풀은 비우기만 하면 됨)
 void game_cleanup() {
-    // 단어 리스트 메모리 해제
-    GameWordNode *current = game_word_head;
-    while (current != NULL) {
-        GameWordNode *temp = current;
-        current = current->next;
-        free(temp);
-    }
-    game_word_head = NULL;
+    word_pool_init(&game_words);
 }
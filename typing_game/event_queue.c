@@ -0,0 +1,104 @@
+// event_queue.c
+#define _DEFAULT_SOURCE
+#include "event_queue.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+void event_ring_init(EventRing *ring) {
+    ring->head = 0;
+    ring->tail = 0;
+}
+
+int event_ring_push(EventRing *ring, const Event *event) {
+    unsigned tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    unsigned head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    if (tail - head == EVENT_RING_LEN) {
+        return -1;
+    }
+    ring->slots[tail & (EVENT_RING_LEN - 1)] = *event;
+    // 칸을 다 쓴 뒤에 tail을 올려야 소비자가 반쯤 쓴 이벤트를 보지 않음
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+int event_ring_pop(EventRing *ring, Event *out) {
+    unsigned head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    unsigned tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+        return 0;
+    }
+    *out = ring->slots[head & (EVENT_RING_LEN - 1)];
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+void event_queue_init(EventQueue *queue) {
+    queue->head = 0;
+    queue->tail = 0;
+    for (unsigned i = 0; i < EVENT_QUEUE_LEN; i++) {
+        queue->cells[i].seq = i;
+    }
+}
+
+// 칸의 순번이 tail과 같으면 비어 있는 칸, CAS로 tail을 차지한 생산자만 그 칸에 씀
+int event_queue_push(EventQueue *queue, const Event *event) {
+    unsigned pos = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+    EventCell *cell;
+    for (;;) {
+        cell = &queue->cells[pos & (EVENT_QUEUE_LEN - 1)];
+        unsigned seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        int diff = (int)(seq - pos);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&queue->tail, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+            // 실패하면 pos가 현재 tail로 바뀌어 있음
+        } else if (diff < 0) {
+            return -1; // 소비자가 아직 비우지 않은 칸 (가득 참)
+        } else {
+            pos = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+        }
+    }
+    cell->event = *event;
+    __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+int event_queue_pop(EventQueue *queue, Event *out) {
+    unsigned pos = queue->head;
+    EventCell *cell = &queue->cells[pos & (EVENT_QUEUE_LEN - 1)];
+    unsigned seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+    if (seq != pos + 1) {
+        return 0; // 아직 채워지지 않음
+    }
+    *out = cell->event;
+    // 한 바퀴 뒤의 생산자가 쓸 수 있게 순번을 넘겨 줌
+    __atomic_store_n(&cell->seq, pos + EVENT_QUEUE_LEN, __ATOMIC_RELEASE);
+    queue->head = pos + 1;
+    return 1;
+}
+
+int event_wakeup_open() {
+    int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd < 0) {
+        perror("eventfd 생성 실패");
+    }
+    return fd;
+}
+
+void event_wakeup_signal(int fd) {
+    uint64_t one = 1;
+    if (write(fd, &one, sizeof(one)) < 0) {
+        // 카운터가 넘칠 때만 실패하며, 그때는 이미 깨울 신호가 남아 있음
+    }
+}
+
+void event_wakeup_clear(int fd) {
+    uint64_t value;
+    if (read(fd, &value, sizeof(value)) < 0) {
+        // EAGAIN: 이미 비어 있음
+    }
+}
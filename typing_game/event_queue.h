@@ -0,0 +1,69 @@
+// event_queue.h
+// 클라이언트의 UI 쓰레드로 이벤트를 넘기는 락 없는 큐
+//
+// ncurses와 게임 상태는 UI 쓰레드(메인 쓰레드)만 건드리고,
+// 다른 쓰레드는 이벤트를 큐에 넣은 뒤 eventfd로 깨우기만 함
+//   수신 쓰레드 -> UI      : 단일 생산자 / 단일 소비자 링 (EventRing)
+//   작업 쓰레드들 -> UI    : 다중 생산자 / 단일 소비자 큐 (EventQueue, 칸마다 순번)
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+#include "topic_cache.h"
+
+#define EVENT_TEXT_SIZE 2048    // 서버 메시지 한 번 수신분 (클라이언트 BUFFER_SIZE)
+#define EVENT_RING_LEN 64       // 수신 쓰레드용 링 크기 (2의 거듭제곱)
+#define EVENT_QUEUE_LEN 16      // 작업 쓰레드용 큐 크기 (2의 거듭제곱)
+#define EVENT_CACHE_LINE 64
+
+typedef enum {
+    EVENT_NET_MESSAGE, // 서버에서 받은 메시지 (text)
+    EVENT_NET_CLOSED,  // 서버 연결 끊김
+    EVENT_TOPIC_WORDS  // 주제 단어 준비됨 (words, from_cache)
+} EventType;
+
+typedef struct {
+    int type;
+    int from_cache;
+    union {
+        char text[EVENT_TEXT_SIZE];
+        TopicWords words;
+    } data;
+} Event;
+
+// 단일 생산자 / 단일 소비자 링 (head는 소비자, tail은 생산자만 씀)
+typedef struct {
+    unsigned head __attribute__((aligned(EVENT_CACHE_LINE)));
+    unsigned tail __attribute__((aligned(EVENT_CACHE_LINE)));
+    Event slots[EVENT_RING_LEN] __attribute__((aligned(EVENT_CACHE_LINE)));
+} EventRing;
+
+// 다중 생산자 / 단일 소비자 큐 (칸의 순번으로 채워졌는지 판단)
+typedef struct {
+    unsigned seq;
+    Event event;
+} EventCell;
+
+typedef struct {
+    unsigned head __attribute__((aligned(EVENT_CACHE_LINE)));
+    unsigned tail __attribute__((aligned(EVENT_CACHE_LINE)));
+    EventCell cells[EVENT_QUEUE_LEN] __attribute__((aligned(EVENT_CACHE_LINE)));
+} EventQueue;
+
+void event_ring_init(EventRing *ring);
+// 생산자 쪽: 가득 차면 -1
+int event_ring_push(EventRing *ring, const Event *event);
+// 소비자 쪽: 비어 있으면 0
+int event_ring_pop(EventRing *ring, Event *out);
+
+void event_queue_init(EventQueue *queue);
+// 여러 쓰레드에서 호출 가능: 가득 차면 -1
+int event_queue_push(EventQueue *queue, const Event *event);
+// 소비자 쪽 (한 쓰레드만): 비어 있으면 0
+int event_queue_pop(EventQueue *queue, Event *out);
+
+// UI 쓰레드를 깨우는 eventfd
+int event_wakeup_open();
+void event_wakeup_signal(int fd);
+void event_wakeup_clear(int fd);
+
+#endif
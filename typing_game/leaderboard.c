@@ -0,0 +1,512 @@
+// leaderboard.c
+#define _DEFAULT_SOURCE
+#include "leaderboard.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define LEADERBOARD_CHECKPOINT_MAGIC "LEADERBOARD_CHECKPOINT 1"
+#define LEADERBOARD_ALL_NAME "*" // 체크포인트에서 전체 순위를 가리키는 이름
+
+static uint32_t next_priority(Leaderboard *board) {
+    // xorshift32 (트립 균형용이므로 예측 가능해도 상관없음)
+    uint32_t x = board->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    board->rng = x;
+    return x;
+}
+
+// 이름 해시 (FNV-1a)
+static size_t hash_name(const char *name) {
+    uint32_t h = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)name; *p; p++) {
+        h = (h ^ *p) * 16777619u;
+    }
+    return h;
+}
+
+static int grow_buckets(Leaderboard *board) {
+    size_t count = board->bucket_count ? board->bucket_count * 2 : 1024;
+    LeaderPlayer **buckets = calloc(count, sizeof(*buckets));
+    if (!buckets) {
+        perror("순위표 해시 할당 실패");
+        return -1;
+    }
+    for (size_t i = 0; i < board->bucket_count; i++) {
+        LeaderPlayer *player = board->buckets[i];
+        while (player) {
+            LeaderPlayer *next = player->next;
+            size_t b = hash_name(player->name) & (count - 1);
+            player->next = buckets[b];
+            buckets[b] = player;
+            player = next;
+        }
+    }
+    free(board->buckets);
+    board->buckets = buckets;
+    board->bucket_count = count;
+    return 0;
+}
+
+static LeaderPlayer *find_player(const Leaderboard *board, const char *name) {
+    if (board->bucket_count == 0) {
+        return NULL;
+    }
+    LeaderPlayer *player = board->buckets[hash_name(name) & (board->bucket_count - 1)];
+    while (player && strcmp(player->name, name) != 0) {
+        player = player->next;
+    }
+    return player;
+}
+
+static LeaderPlayer *get_player(Leaderboard *board, const char *name) {
+    LeaderPlayer *player = find_player(board, name);
+    if (player) {
+        return player;
+    }
+    if (board->player_count >= board->bucket_count && grow_buckets(board) < 0) {
+        return NULL;
+    }
+    player = calloc(1, sizeof(*player));
+    if (!player) {
+        perror("순위표 플레이어 할당 실패");
+        return NULL;
+    }
+    strncpy(player->name, name, sizeof(player->name) - 1);
+    for (int i = 0; i < LEADERBOARD_BOARDS; i++) {
+        player->nodes[i].player = player;
+    }
+    size_t b = hash_name(player->name) & (board->bucket_count - 1);
+    player->next = board->buckets[b];
+    board->buckets[b] = player;
+    board->player_count++;
+    return player;
+}
+
+// 순서: 점수 내림차순, 같으면 이름 오름차순
+static int ahead(const LeaderNode *node, int score, const char *name) {
+    return node->score > score || (node->score == score && strcmp(node->player->name, name) < 0);
+}
+
+static int node_size(const LeaderNode *node) {
+    return node ? node->size : 0;
+}
+
+static void update_size(LeaderNode *node) {
+    node->size = 1 + node_size(node->left) + node_size(node->right);
+}
+
+// left에는 (score, name)보다 앞선 노드, right에는 나머지
+static void split(LeaderNode *node, int score, const char *name, LeaderNode **left, LeaderNode **right) {
+    if (!node) {
+        *left = *right = NULL;
+        return;
+    }
+    if (ahead(node, score, name)) {
+        split(node->right, score, name, &node->right, right);
+        *left = node;
+    } else {
+        split(node->left, score, name, left, &node->left);
+        *right = node;
+    }
+    update_size(node);
+}
+
+// left의 모든 노드가 right보다 앞선다고 가정
+static LeaderNode *merge(LeaderNode *left, LeaderNode *right) {
+    if (!left || !right) {
+        return left ? left : right;
+    }
+    if (left->priority > right->priority) {
+        left->right = merge(left->right, right);
+        update_size(left);
+        return left;
+    }
+    right->left = merge(left, right->left);
+    update_size(right);
+    return right;
+}
+
+static LeaderNode *erase(LeaderNode *root, LeaderNode *node) {
+    if (root == node) {
+        return merge(node->left, node->right);
+    }
+    if (ahead(root, node->score, node->player->name)) {
+        root->right = erase(root->right, node);
+    } else {
+        root->left = erase(root->left, node);
+    }
+    update_size(root);
+    return root;
+}
+
+// 보드 index에서 player의 최고 점수를 score로 올림 (낮으면 무시)
+static void raise_score(Leaderboard *board, int index, LeaderPlayer *player, int score) {
+    LeaderNode *node = &player->nodes[index];
+    if (node->ranked) {
+        if (score <= node->score) {
+            return;
+        }
+        board->roots[index] = erase(board->roots[index], node);
+    }
+    node->score = score;
+    node->ranked = 1;
+    node->left = node->right = NULL;
+    node->size = 1;
+    node->priority = next_priority(board);
+
+    LeaderNode *left, *right;
+    split(board->roots[index], score, player->name, &left, &right);
+    board->roots[index] = merge(merge(left, node), right);
+}
+
+int leaderboard_board(const Leaderboard *board, const char *mode) {
+    if (mode == NULL || mode[0] == '\0') {
+        return 0;
+    }
+    for (int i = 0; i < board->mode_count; i++) {
+        if (strcmp(board->modes[i], mode) == 0) {
+            return i + 1;
+        }
+    }
+    return -1;
+}
+
+const char *leaderboard_board_name(const Leaderboard *board, int index) {
+    return index > 0 && index <= board->mode_count ? board->modes[index - 1] : "전체";
+}
+
+// 로그 한 줄 적용 (<점수> <모드> <이름>)
+static int apply_result(Leaderboard *board, const char *mode, const char *name, int score) {
+    LeaderPlayer *player = get_player(board, name);
+    if (!player) {
+        return -1;
+    }
+    raise_score(board, 0, player, score);
+    int index = leaderboard_board(board, mode);
+    if (index > 0) {
+        raise_score(board, index, player, score);
+    }
+    return 0;
+}
+
+static int compare_nodes(const void *a, const void *b) {
+    const LeaderNode *x = *(LeaderNode *const *)a;
+    const LeaderNode *y = *(LeaderNode *const *)b;
+    if (x->score != y->score) {
+        return x->score > y->score ? -1 : 1;
+    }
+    return strcmp(x->player->name, y->player->name);
+}
+
+static int fix_sizes(LeaderNode *node) {
+    if (!node) {
+        return 0;
+    }
+    node->size = 1 + fix_sizes(node->left) + fix_sizes(node->right);
+    return node->size;
+}
+
+// 순서대로 정렬된 노드로 트립 만들기 (오른쪽 가장자리 스택, O(n))
+static LeaderNode *build_sorted(LeaderNode **nodes, size_t count, LeaderNode **stack) {
+    size_t top = 0;
+    for (size_t i = 0; i < count; i++) {
+        LeaderNode *node = nodes[i];
+        LeaderNode *last = NULL;
+        node->left = node->right = NULL;
+        while (top > 0 && stack[top - 1]->priority < node->priority) {
+            last = stack[--top];
+        }
+        node->left = last;
+        if (top > 0) {
+            stack[top - 1]->right = node;
+        }
+        stack[top++] = node;
+    }
+    LeaderNode *root = top > 0 ? stack[0] : NULL;
+    fix_sizes(root);
+    return root;
+}
+
+// 체크포인트 읽기: 보드별 최고 점수를 노드에 채운 뒤 보드마다 정렬해서 한 번에 트리로 만듦
+static int load_checkpoint(Leaderboard *board) {
+    FILE *fp = fopen(board->checkpoint_path, "r");
+    if (!fp) {
+        return 0; // 처음 실행
+    }
+    char line[256];
+    if (!fgets(line, sizeof(line), fp) || strncmp(line, LEADERBOARD_CHECKPOINT_MAGIC, strlen(LEADERBOARD_CHECKPOINT_MAGIC)) != 0) {
+        fprintf(stderr, "순위표 체크포인트 형식이 올바르지 않습니다: %s\n", board->checkpoint_path);
+        fclose(fp);
+        return -1;
+    }
+
+    size_t counts[LEADERBOARD_BOARDS] = {0};
+    while (fgets(line, sizeof(line), fp)) {
+        char mode[LEADERBOARD_NAME_LENGTH], name[LEADERBOARD_NAME_LENGTH];
+        int score;
+        line[strcspn(line, "\n")] = '\0';
+        if (sscanf(line, "%49s %d %49[^\n]", mode, &score, name) != 3) {
+            continue;
+        }
+        int index = strcmp(mode, LEADERBOARD_ALL_NAME) == 0 ? 0 : leaderboard_board(board, mode);
+        LeaderPlayer *player = index >= 0 ? get_player(board, name) : NULL;
+        if (!player) {
+            continue; // 없어진 모드
+        }
+        LeaderNode *node = &player->nodes[index];
+        if (!node->ranked) {
+            node->ranked = 1;
+            node->score = score;
+            node->priority = next_priority(board);
+            counts[index]++;
+        } else if (score > node->score) {
+            node->score = score;
+        }
+    }
+    fclose(fp);
+
+    LeaderNode **nodes = malloc((board->player_count + 1) * sizeof(*nodes));
+    LeaderNode **stack = malloc((board->player_count + 1) * sizeof(*stack));
+    if (!nodes || !stack) {
+        perror("순위표 체크포인트 메모리 할당 실패");
+        free(nodes);
+        free(stack);
+        return -1;
+    }
+    for (int index = 0; index < LEADERBOARD_BOARDS; index++) {
+        size_t n = 0;
+        for (size_t b = 0; b < board->bucket_count; b++) {
+            for (LeaderPlayer *player = board->buckets[b]; player; player = player->next) {
+                if (player->nodes[index].ranked) {
+                    nodes[n++] = &player->nodes[index];
+                }
+            }
+        }
+        qsort(nodes, n, sizeof(*nodes), compare_nodes);
+        board->roots[index] = build_sorted(nodes, n, stack);
+    }
+    free(nodes);
+    free(stack);
+    return 0;
+}
+
+// 체크포인트 뒤에 쌓인 로그 다시 적용
+static int replay_log(Leaderboard *board) {
+    FILE *fp = fopen(board->log_path, "r");
+    if (!fp) {
+        return 0;
+    }
+    char line[256];
+    while (fgets(line, sizeof(line), fp)) {
+        char mode[LEADERBOARD_NAME_LENGTH], name[LEADERBOARD_NAME_LENGTH];
+        int score;
+        if (strchr(line, '\n') == NULL) {
+            break; // 쓰다가 끊긴 마지막 줄
+        }
+        line[strcspn(line, "\n")] = '\0';
+        if (sscanf(line, "%d %49s %49[^\n]", &score, mode, name) == 3) {
+            apply_result(board, mode, name, score);
+            board->since_checkpoint++;
+        }
+    }
+    fclose(fp);
+    return 0;
+}
+
+int leaderboard_open(Leaderboard *board, const char *log_path, const char *checkpoint_path,
+                     const char *const *modes, int mode_count) {
+    memset(board, 0, sizeof(*board));
+    pthread_mutex_init(&board->lock, NULL);
+    board->modes = modes;
+    board->mode_count = mode_count < LEADERBOARD_MAX_MODES ? mode_count : LEADERBOARD_MAX_MODES;
+    board->rng = 2463534242u;
+    snprintf(board->log_path, sizeof(board->log_path), "%s", log_path);
+    snprintf(board->checkpoint_path, sizeof(board->checkpoint_path), "%s", checkpoint_path);
+
+    if (grow_buckets(board) < 0 || load_checkpoint(board) < 0 || replay_log(board) < 0) {
+        leaderboard_close(board);
+        return -1;
+    }
+    board->log = fopen(board->log_path, "a");
+    if (!board->log) {
+        perror("순위표 로그 열기 실패");
+        leaderboard_close(board);
+        return -1;
+    }
+    // 지난번 로그는 체크포인트로 합쳐 두어 다음 시작이 빠르도록
+    return leaderboard_checkpoint(board) < 0 ? -1 : 0;
+}
+
+void leaderboard_close(Leaderboard *board) {
+    if (board->log) {
+        leaderboard_checkpoint(board);
+        fclose(board->log);
+        board->log = NULL;
+    }
+    for (size_t b = 0; b < board->bucket_count; b++) {
+        LeaderPlayer *player = board->buckets[b];
+        while (player) {
+            LeaderPlayer *next = player->next;
+            free(player);
+            player = next;
+        }
+    }
+    free(board->buckets);
+    board->buckets = NULL;
+    board->bucket_count = 0;
+    board->player_count = 0;
+    memset(board->roots, 0, sizeof(board->roots));
+}
+
+void leaderboard_detach_log(Leaderboard *board) {
+    pthread_mutex_lock(&board->lock);
+    if (board->log) {
+        fclose(board->log); // fork로 물려받은 사본만 닫음 (버퍼는 쓸 때마다 비우므로 남은 것이 없음)
+        board->log = NULL;
+    }
+    board->since_checkpoint = 0;
+    pthread_mutex_unlock(&board->lock);
+}
+
+int leaderboard_attach_log(Leaderboard *board) {
+    pthread_mutex_lock(&board->lock);
+    if (board->log == NULL) {
+        board->log = fopen(board->log_path, "a");
+    }
+    int result = board->log != NULL ? 0 : -1;
+    pthread_mutex_unlock(&board->lock);
+    return result;
+}
+
+int leaderboard_submit(Leaderboard *board, const char *mode, const char *name, int score) {
+    char safe_mode[LEADERBOARD_NAME_LENGTH], safe_name[LEADERBOARD_NAME_LENGTH];
+    // 로그는 공백으로 나누므로 모드에는 공백이 없어야 하고, 이름은 줄바꿈만 없으면 됨
+    if (sscanf(mode, "%49s", safe_mode) != 1) {
+        snprintf(safe_mode, sizeof(safe_mode), "-");
+    }
+    snprintf(safe_name, sizeof(safe_name), "%s", name);
+    safe_name[strcspn(safe_name, "\r\n")] = '\0';
+    if (safe_name[0] == '\0') {
+        return -1;
+    }
+
+    pthread_mutex_lock(&board->lock);
+    int result = apply_result(board, safe_mode, safe_name, score);
+    if (result == 0 && board->log) {
+        // 한 줄씩 바로 내보내서 서버가 죽어도 로그에 남음
+        fprintf(board->log, "%d %s %s\n", score, safe_mode, safe_name);
+        fflush(board->log);
+        board->since_checkpoint++;
+    }
+    pthread_mutex_unlock(&board->lock);
+    return result;
+}
+
+static void collect_top(const LeaderNode *node, LeaderEntry *out, int count, int *filled) {
+    if (!node || *filled >= count) {
+        return;
+    }
+    collect_top(node->left, out, count, filled);
+    if (*filled < count) {
+        snprintf(out[*filled].name, sizeof(out[*filled].name), "%s", node->player->name);
+        out[*filled].score = node->score;
+        (*filled)++;
+    }
+    collect_top(node->right, out, count, filled);
+}
+
+int leaderboard_top(Leaderboard *board, int index, LeaderEntry *out, int count) {
+    int filled = 0;
+    if (index < 0 || index >= LEADERBOARD_BOARDS) {
+        return 0;
+    }
+    if (count > LEADERBOARD_TOP_MAX) {
+        count = LEADERBOARD_TOP_MAX;
+    }
+    pthread_mutex_lock(&board->lock);
+    collect_top(board->roots[index], out, count, &filled);
+    pthread_mutex_unlock(&board->lock);
+    return filled;
+}
+
+int leaderboard_rank(Leaderboard *board, int index, const char *name, int *score, int *total) {
+    int rank = 0;
+    if (index < 0 || index >= LEADERBOARD_BOARDS) {
+        return 0;
+    }
+    pthread_mutex_lock(&board->lock);
+    *total = node_size(board->roots[index]);
+    LeaderPlayer *player = find_player(board, name);
+    if (player && player->nodes[index].ranked) {
+        // 루트에서 내려가며 자기보다 앞선 노드 수를 셈
+        const LeaderNode *target = &player->nodes[index];
+        const LeaderNode *node = board->roots[index];
+        while (node && node != target) {
+            if (ahead(node, target->score, name)) {
+                rank += node_size(node->left) + 1;
+                node = node->right;
+            } else {
+                node = node->left;
+            }
+        }
+        rank += node_size(target->left) + 1;
+        *score = target->score;
+    }
+    pthread_mutex_unlock(&board->lock);
+    return rank;
+}
+
+static void write_board(FILE *fp, const char *mode, const LeaderNode *node) {
+    if (!node) {
+        return;
+    }
+    write_board(fp, mode, node->left);
+    fprintf(fp, "%s %d %s\n", mode, node->score, node->player->name);
+    write_board(fp, mode, node->right);
+}
+
+int leaderboard_checkpoint(Leaderboard *board) {
+    char tmp_path[LEADERBOARD_PATH_LENGTH + 8];
+    int result = 0;
+
+    pthread_mutex_lock(&board->lock);
+    if (board->since_checkpoint == 0) {
+        pthread_mutex_unlock(&board->lock);
+        return 0;
+    }
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", board->checkpoint_path);
+    FILE *fp = fopen(tmp_path, "w");
+    if (!fp) {
+        perror("순위표 체크포인트 열기 실패");
+        pthread_mutex_unlock(&board->lock);
+        return -1;
+    }
+    fprintf(fp, "%s\n", LEADERBOARD_CHECKPOINT_MAGIC);
+    for (int index = 0; index <= board->mode_count; index++) {
+        write_board(fp, index == 0 ? LEADERBOARD_ALL_NAME : board->modes[index - 1], board->roots[index]);
+    }
+    // 새 체크포인트가 디스크에 닿은 뒤에 바꿔 끼우고, 그다음에 로그를 비움
+    if (fflush(fp) != 0 || fsync(fileno(fp)) != 0) {
+        perror("순위표 체크포인트 쓰기 실패");
+        result = -1;
+    }
+    fclose(fp);
+    if (result == 0 && rename(tmp_path, board->checkpoint_path) != 0) {
+        perror("순위표 체크포인트 교체 실패");
+        result = -1;
+    }
+    if (result == 0 && board->log) {
+        if (ftruncate(fileno(board->log), 0) != 0) {
+            perror("순위표 로그 비우기 실패"); // 다음 시작 때 다시 적용될 뿐
+        }
+        board->since_checkpoint = 0;
+    }
+    if (result != 0) {
+        unlink(tmp_path);
+    }
+    pthread_mutex_unlock(&board->lock);
+    return result;
+}
@@ -0,0 +1,89 @@
+// leaderboard.h
+// 영구 순위표 (전체 + 게임 모드별)
+//
+// 게임 결과는 추가만 하는 점수 로그에 한 줄씩 쓰고, 메모리에서는 보드마다
+// 부분 트리 크기를 가진 트립(순서 통계 트리)에 플레이어별 최고 점수를 둔다.
+// 상위 N명은 O(log n + N), 내 순위는 O(log n)으로 계산한다.
+// 체크포인트는 보드별 최고 점수를 통째로 쓴 파일이며, 시작할 때 체크포인트를 읽어
+// 정렬된 배열에서 트립을 O(n)으로 만들고 그 뒤의 로그만 다시 적용한다.
+// 최고 점수 갱신은 max라서 같은 로그를 두 번 적용해도 결과가 같다
+// (체크포인트를 쓴 뒤 로그를 비우기 전에 죽어도 문제 없음).
+#ifndef LEADERBOARD_H
+#define LEADERBOARD_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define LEADERBOARD_MAX_MODES 8
+#define LEADERBOARD_BOARDS (1 + LEADERBOARD_MAX_MODES) // 0번은 전체 순위
+#define LEADERBOARD_NAME_LENGTH 50
+#define LEADERBOARD_TOP_MAX 100
+#define LEADERBOARD_PATH_LENGTH 256
+
+typedef struct LeaderNode {
+    struct LeaderNode *left;
+    struct LeaderNode *right;
+    uint32_t priority; // 트립 힙 우선순위 (부모가 더 큼)
+    int size;          // 부분 트리의 노드 수
+    int score;
+    int ranked;        // 보드 트리에 들어 있으면 1
+    struct LeaderPlayer *player;
+} LeaderNode;
+
+// 플레이어 하나 (보드별 노드를 안에 두므로 점수를 올릴 때 메모리 할당이 없음)
+typedef struct LeaderPlayer {
+    char name[LEADERBOARD_NAME_LENGTH];
+    struct LeaderPlayer *next; // 이름 해시 체인
+    LeaderNode nodes[LEADERBOARD_BOARDS];
+} LeaderPlayer;
+
+typedef struct {
+    char name[LEADERBOARD_NAME_LENGTH];
+    int score;
+} LeaderEntry;
+
+typedef struct {
+    pthread_mutex_t lock;
+    const char *const *modes; // 보드 1..mode_count의 모드 이름
+    int mode_count;
+    LeaderNode *roots[LEADERBOARD_BOARDS];
+    LeaderPlayer **buckets;
+    size_t bucket_count;
+    size_t player_count;
+    uint32_t rng;
+    FILE *log;
+    int since_checkpoint; // 마지막 체크포인트 뒤로 로그에 쓴 결과 수
+    char log_path[LEADERBOARD_PATH_LENGTH];
+    char checkpoint_path[LEADERBOARD_PATH_LENGTH];
+} Leaderboard;
+
+// 체크포인트와 로그를 읽어 순위표를 만들고 로그를 추가 모드로 엶, 실패 시 -1
+int leaderboard_open(Leaderboard *board, const char *log_path, const char *checkpoint_path,
+                     const char *const *modes, int mode_count);
+void leaderboard_close(Leaderboard *board);
+// 이 프로세스에서는 로그와 체크포인트를 쓰지 않음 (같은 파일을 다른 shard 프로세스가 기록할 때)
+// 이후 leaderboard_submit은 메모리에만 반영
+void leaderboard_detach_log(Leaderboard *board);
+// detach_log 뒤에 로그를 다시 추가 모드로 엶 (새 서버로 넘기기가 취소됐을 때), 실패 시 -1
+int leaderboard_attach_log(Leaderboard *board);
+
+// 모드 이름의 보드 번호 (NULL이나 빈 문자열은 전체 순위 0), 없는 모드는 -1
+int leaderboard_board(const Leaderboard *board, const char *mode);
+const char *leaderboard_board_name(const Leaderboard *board, int index);
+
+// 게임 결과 기록 (로그에 쓰고 전체 + 해당 모드 보드의 최고 점수 갱신)
+// 목록에 없는 모드는 전체 순위에만 반영, 실패 시 -1
+int leaderboard_submit(Leaderboard *board, const char *mode, const char *name, int score);
+
+// 상위 count명 (최대 LEADERBOARD_TOP_MAX), 채운 수
+int leaderboard_top(Leaderboard *board, int index, LeaderEntry *out, int count);
+
+// name의 순위 (1부터), 기록이 없으면 0 / score와 total은 최고 점수와 보드 인원
+int leaderboard_rank(Leaderboard *board, int index, const char *name, int *score, int *total);
+
+// 지금 상태를 체크포인트로 쓰고 로그를 비움 (새 결과가 없으면 아무것도 안 함), 실패 시 -1
+int leaderboard_checkpoint(Leaderboard *board);
+
+#endif
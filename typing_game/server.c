@@ -3,18 +3,46 @@
 #include <arpa/inet.h>
 #include <ctype.h>
 #include <errno.h>
+#include <limits.h>
 #include <netinet/in.h>
 #include <pthread.h>
 #include <signal.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/random.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
 #include <unistd.h>
 
+#include "admission.h"
+#include "leaderboard.h"
+#include "net.h"
+#include "shard.h"
+#include "slab.h"
+#include "timer_wheel.h"
+#include "upgrade.h"
+#include "word_stream.h"
+
 #define SERVER_PORT 12345
+#define SERVER_UNIX_SOCKET "@typing_game.server" // 같은 컴퓨터의 클라이언트용 추상 Unix 소켓
 #define BUFFER_SIZE 2048
 #define LOG_FILE "server.log"
+#define LEADERBOARD_LOG "leaderboard.log"          // 게임 결과 로그 (추가만 함)
+#define LEADERBOARD_CHECKPOINT "leaderboard.ckpt"  // 순위표 체크포인트
+#define LEADERBOARD_CHECKPOINT_MS 30000            // 체크포인트 간격
+#define POOL_STATS_MS 60000                        // 객체 풀 통계를 로그에 남기는 간격
+#define ROOM_MAX_MEMBERS 16      // 방 하나의 최대 인원 (점수 배열의 슬롯 수)
+#define ROOM_TIMER_TICK_MS 100   // 방 타이머 휠의 틱 간격
+#define GAME_END_GRACE_MS 3000   // 제한 시간 뒤 클라이언트 점수를 기다리는 시간
+#define GAME_TIME_LIMIT_MIN 10   // /set_game으로 정할 수 있는 제한 시간 (초)
+#define GAME_TIME_LIMIT_MAX WORD_STREAM_MAX_SECONDS
+#define GAME_TARGET_SCORE 150    // 이 점수에 먼저 도달하면 바로 게임 종료 (클라이언트와 같은 값)
+#define LEADERBOARD_INTERVAL_MS 100 // 실시간 순위를 모아 보내는 간격 (방마다 초당 최대 10번)
+#define UPGRADE_DRAIN_MS 500     // 새 서버로 넘기는 중에 게임이 끝난 방을 확인하는 간격
 
 // 사용 가능한 게임 모드 목록
 const char *available_game_modes[] = {
@@ -30,22 +58,24 @@ typedef struct user {
     char name[50];
     int room_id; // 현재 참여 중인 방 ID (-1이면 참여하지 않음)
     int is_ready;
+    int directory_slot; // 공유 사용자 색인의 칸 (-1이면 없음)
+    TokenBucket messages; // 메시지 속도 제한
+    int dropped;          // 속도 제한으로 연달아 버린 메시지 수
+    uint64_t warned_ms;   // 마지막으로 속도 경고를 보낸 시각
+    int discarding;       // 너무 긴 줄의 나머지를 버리는 중
+    char session[40];     // 다시 접속할 때 쓰는 토큰 ("<shard 번호>.<임의 16바이트>", 없으면 빈 문자열)
+    TimerEntry away_timer; // 연결이 끊긴 뒤 자리를 남겨 두는 시간 (끊긴 동안 socket_fd는 음수)
     struct user *next; // 글로벌 사용자 목록을 위한 포인터
 } User;
 
 // 방 내 사용자 목록을 위한 구조체
 typedef struct room_user {
     User *user;
+    int slot;              // 방 안의 자리 번호 (점수 배열 인덱스)
+    WordStreamPlayer play; // 이번 게임에서 검증한 KILL과 점수
     struct room_user *next;
 } RoomUser;
 
-// 점수 노드 구조체
-typedef struct score_node {
-    User *user;
-    int score;
-    struct score_node *next;
-} ScoreNode;
-
 // 방 구조체 정의
 typedef struct room {
     int id;
@@ -56,8 +86,26 @@ typedef struct room {
     int ready_count;
     int game_started;
     int game_over;     // 게임 종료 여부 추가
-    ScoreNode *scores; // 게임 점수 목록
     int host_fd;       // 호스트 소켓 fd
+    WordStreamSchedule stream; // 이번 게임의 시드와 틱 일정
+    int stream_active;         // 게임 중이면 1 (KILL 검증)
+    uint64_t started_ms;       // GAME_STARTED를 보낸 시각 (단조 시계)
+    // 슬롯별 상태 (결과 계산이 방 인원 수에만 비례하도록 배열로 둠)
+    RoomUser *slots[ROOM_MAX_MEMBERS];  // 슬롯을 차지한 멤버 (빈 슬롯은 NULL)
+    int scores[ROOM_MAX_MEMBERS];       // 이번 게임 점수
+    uint8_t playing[ROOM_MAX_MEMBERS];  // 게임 시작 때 있던 멤버
+    uint8_t reported[ROOM_MAX_MEMBERS]; // 점수를 받은 멤버
+    int players;                        // 아직 방에 남은 플레이어 수
+    int reports;                        // 그중 점수를 보낸 수
+    TimerEntry end_timer;               // 제한 시간 + 유예가 지나면 게임 종료
+    uint64_t ends_at_ms;
+    // 실시간 순위 (KILL과 놓친 단어를 바로 반영하고, 보내기는 board_timer 틱마다 한 번으로 모음)
+    int live[ROOM_MAX_MEMBERS];         // 게임 중 현재 점수 (인정된 KILL - 놓친 단어)
+    uint8_t charged[WORD_STREAM_MAX_WORDS]; // 단어 id별로 놓친 단어 감점을 반영했는지 (게임마다 지워서 씀)
+    int charged_capacity;               // 이번 게임에서 쓰는 칸 수 (게임 밖에서는 0)
+    int charge_from;                    // 이 id 앞의 단어는 모두 감점 반영이 끝남
+    int board_dirty;                    // 마지막 LEADERBOARD 이후 점수가 바뀌었으면 1
+    TimerEntry board_timer;
     struct room *next;
 } Room;
 
@@ -66,20 +114,86 @@ User *user_head = NULL;
 Room *room_head = NULL;
 pthread_mutex_t user_mutex = PTHREAD_MUTEX_INITIALIZER;
 pthread_mutex_t room_mutex = PTHREAD_MUTEX_INITIALIZER;
-int next_room_id = 1;
+TimerWheel room_timers; // 방마다 게임 종료 타이머 하나 (리액터 루프가 진행)
+Leaderboard leaderboard; // 전체 / 모드별 영구 순위표
+TimerEntry leaderboard_timer;
+
+// 사용자 / 방 / 방 멤버 객체 풀 (접속과 입퇴장이 반복돼도 malloc을 부르지 않음)
+SlabPool user_pool;
+SlabPool room_pool;
+SlabPool room_user_pool;
+TimerEntry pool_stats_timer;
+
+// 모든 클라이언트 입출력과 방 타이머를 처리하는 리액터 (shard 프로세스마다 스레드 하나)
+// 연결마다 쓰기 큐가 있어 느린 클라이언트 때문에 다른 플레이어에게 보내는 것이 막히지 않음
+NetReactor reactor;
+// 조용한 연결에 PING을 보내고 답이 없으면 끊음 (반쯤 열린 연결이 사용자 목록과 방 자리를 잡고 있지 않도록)
+NetHeartbeat heartbeat;
+
+// shard 프로세스들 (방 ID, 방 목록, 방 주인은 공유 메모리의 디렉터리에서)
+ShardSet shards;
+pid_t shard_pids[SHARD_MAX];
+
+// 무중단 재시작 (server --upgrade로 띄운 새 서버가 실행 중인 서버의 리스닝 소켓, 연결, 방을 넘겨받음)
+int tcp_listen_fd = -1;     // 이 shard의 TCP 리스닝 소켓
+int local_listen_fd = -1;   // 모든 shard가 함께 받는 Unix 소켓
+int upgrade_listen_fd = -1; // 다음 새 서버가 연결해 올 제어 소켓
+int upgrade_to = -1;        // 이전 서버: 넘기는 중인 새 shard
+int upgrade_from = -1;      // 새 서버: 넘겨주는 중인 이전 shard
+int draining = 0;           // 이전 서버: 리스닝 소켓을 넘겼고, 게임 중인 방이 끝나는 대로 넘기는 중
+TimerEntry drain_timer;
+
+// 새 서버: 멤버가 모두 넘어오기 전의 방 (멤버들의 입력은 방이 다 채워진 뒤에 처리)
+typedef struct {
+    int fd;
+    size_t len;
+    char data[NET_READ_BUFFER];
+} PendingInput;
+Room *restoring_room = NULL;
+int restoring_members = 0;
+int restoring_count = 0;
+PendingInput restoring_input[ROOM_MAX_MEMBERS];
+
+// 접속 제한 (main에서 환경 변수로 읽음, 넘으면 바로 ERROR로 거절)
+AdmissionLimits limits;
+AdmissionIpTable ip_table; // IP별 새 연결 속도 (이 shard에서)
+unsigned long rejected_connections = 0;
+unsigned long rejected_messages = 0;
+
+// 연결이 끊긴 사용자는 잠시 방과 준비 상태째 남겨 두고, /resume <토큰>으로 다시 접속하면 이어서 씀
+int next_away_fd = -2;             // 끊긴 사용자에게 주는 소켓 번호 (다른 연결과 겹치지 않도록 음수)
+unsigned long resumed_sessions = 0;
+unsigned long expired_sessions = 0;
 
 // 로그 파일 포인터
 FILE *log_fp = NULL;
 
 // 함수 선언
-void *client_handler(void *arg);
-void add_user(int socket_fd, const char *name);
+void client_accept(NetReactor *r, int fd, void *arg);
+void client_message(NetConn *conn, char *buffer, size_t len);
+void reject_connection(NetReactor *r, int fd, const char *reason);
+int admit_message(NetConn *conn, User *client, const char *buffer, size_t len);
+void client_closed(NetConn *conn);
+void client_idle(NetConn *conn);
+void release_user(User *client);
+void detach_user(User *user);
+void away_expired(void *arg);
+void release_away_users(void);
+void rekey_user(User *user, int socket_fd);
+void new_session_token(User *user);
+void send_session(User *user);
+void resume_session(NetConn *conn, char *buffer, size_t len);
+void handle_command(User *client, char *buffer);
+User *add_user(int socket_fd, const char *name);
 void remove_user(int socket_fd);
 User *find_user(int socket_fd);
 void broadcast_message(const char *message, int room_id, int exclude_fd);
+Room *alloc_room(const char *name, int host_fd);
 Room *create_room(const char *name, const char *host_name, int host_fd);
+void destroy_room(Room *room);
+void publish_room(Room *room);
 Room *find_room(int room_id);
-void add_user_to_room(Room *room, User *user);
+int add_user_to_room(Room *room, User *user);
 void remove_user_from_room(Room *room, User *user);
 void send_message(int socket_fd, const char *message);
 void send_help_message(int socket_fd);
@@ -88,19 +202,35 @@ void send_game_list(int socket_fd);
 void start_game(Room *room);
 void log_event(const char *format, ...);
 void cleanup_server(int signum);
-
-// 점수 추가 함수
-void add_score(Room *room, User *user, int score) {
-    ScoreNode *new_score = (ScoreNode *)malloc(sizeof(ScoreNode));
-    if (!new_score) {
-        perror("ScoreNode 메모리 할당 실패");
-        return;
-    }
-    new_score->user = user;
-    new_score->score = score;
-    new_score->next = room->scores;
-    room->scores = new_score;
-}
+void handle_gameover_all_clients(int sender_fd);
+RoomUser *find_room_user(Room *room, int socket_fd);
+void reset_room_stream(Room *room);
+int verified_score(Room *room, User *user, int claimed, int claimed_tick);
+int record_score(Room *room, RoomUser *member, int score, char *winner_msg, size_t size);
+void finish_game(Room *room, char *winner_msg, size_t size);
+void room_time_up(void *arg);
+void room_board_tick(void *arg);
+void report_score(int socket_fd, int room_id, int claimed, int claimed_tick);
+void send_top_list(int socket_fd, const char *args);
+void send_rank(int socket_fd, const char *name, const char *args);
+void leaderboard_checkpoint_tick(void *arg);
+void pool_stats_tick(void *arg);
+void submit_result(const char *game_mode, const char *name, int score);
+int hand_off_conn(NetConn *conn, int target, const char *command, size_t len);
+void shard_inbox(NetReactor *r, int fd, void *arg);
+void upgrade_accept(NetReactor *r, int fd, void *arg);
+void upgrade_abort(void);
+int forward_result(const char *game_mode, const char *name, int score);
+int transfer_conn(NetConn *conn, User *user, int room_id, int is_host);
+void transfer_room(Room *room);
+int transfer_idle(int announce);
+void drain_tick(void *arg);
+int receive_upgrade(void);
+void upgrade_inbox(NetReactor *r, int fd, void *arg);
+void apply_upgrade_message(NetReactor *r, const UpgradeMessage *msg, const char *data, int fd);
+Room *restore_room(const UpgradeMessage *msg);
+void restore_conn(NetReactor *r, const UpgradeMessage *msg, const char *data, int fd);
+void finish_restoring_room(void);
 
 // 로그 기록 함수
 void log_event(const char *format, ...) {
@@ -114,20 +244,28 @@ void log_event(const char *format, ...) {
     fflush(log_fp);
 }
 
-// 사용자 추가 함수
-void add_user(int socket_fd, const char *name) {
-    User *new_user = (User *)malloc(sizeof(User));
+// 사용자 추가 함수 (실패 시 NULL)
+User *add_user(int socket_fd, const char *name) {
+    User *new_user = (User *)slab_alloc(&user_pool);
     if (!new_user) {
-        perror("사용자 메모리 할당 실패");
-        return;
+        perror("사용자 객체 할당 실패");
+        return NULL;
     }
     new_user->socket_fd = socket_fd;
     strncpy(new_user->name, name, sizeof(new_user->name) - 1);
     new_user->name[sizeof(new_user->name) - 1] = '\0';
     new_user->room_id = -1;
     new_user->is_ready = 0;
+    new_user->directory_slot = -1;
+    token_bucket_init(&new_user->messages, limits.message_burst, timer_wheel_now_ms());
+    new_user->dropped = 0;
+    new_user->warned_ms = 0;
+    new_user->discarding = 0;
+    new_session_token(new_user);
+    timer_entry_init(&new_user->away_timer, away_expired, new_user);
     new_user->next = user_head;
     user_head = new_user;
+    return new_user;
 }
 
 // 사용자 제거 함수
@@ -142,7 +280,8 @@ void remove_user(int socket_fd) {
             } else {
                 prev->next = current->next;
             }
-            free(current);
+            timer_wheel_cancel(&room_timers, &current->away_timer);
+            slab_free(&user_pool, current);
             return;
         }
         prev = current;
@@ -174,14 +313,22 @@ Room *find_room(int room_id) {
     return NULL;
 }
 
-// 방 생성 함수
-Room *create_room(const char *name, const char *host_name, int host_fd) {
-    Room *new_room = (Room *)malloc(sizeof(Room));
+// 제한 시간을 /set_game이 받는 범위로 맞춤 (이전 서버에서 넘어온 값도 타이머에 넣기 전에 거침)
+static int clamp_time_limit(int seconds) {
+    if (seconds < GAME_TIME_LIMIT_MIN) {
+        return GAME_TIME_LIMIT_MIN;
+    }
+    return seconds > GAME_TIME_LIMIT_MAX ? GAME_TIME_LIMIT_MAX : seconds;
+}
+
+// 방 객체 할당과 초기화 (ID와 방 목록 연결은 호출한 쪽에서)
+Room *alloc_room(const char *name, int host_fd) {
+    Room *new_room = (Room *)slab_alloc(&room_pool);
     if (!new_room) {
-        perror("방 메모리 할당 실패");
+        perror("방 객체 할당 실패");
         return NULL;
     }
-    new_room->id = next_room_id++;
+    new_room->charged_capacity = 0;
     strncpy(new_room->name, name, sizeof(new_room->name) - 1);
     new_room->name[sizeof(new_room->name) - 1] = '\0';
     new_room->users = NULL;
@@ -191,8 +338,31 @@ Room *create_room(const char *name, const char *host_name, int host_fd) {
     new_room->ready_count = 0;
     new_room->game_started = 0;
     new_room->game_over = 0; // 초기화
-    new_room->scores = NULL;
     new_room->host_fd = host_fd;
+    new_room->stream_active = 0;
+    memset(new_room->slots, 0, sizeof(new_room->slots));
+    memset(new_room->playing, 0, sizeof(new_room->playing));
+    new_room->players = 0;
+    new_room->reports = 0;
+    timer_entry_init(&new_room->end_timer, room_time_up, new_room);
+    timer_entry_init(&new_room->board_timer, room_board_tick, new_room);
+    return new_room;
+}
+
+// 방 생성 함수
+Room *create_room(const char *name, const char *host_name, int host_fd) {
+    Room *new_room = alloc_room(name, host_fd);
+    if (!new_room) {
+        return NULL;
+    }
+
+    // 방 ID는 모든 shard에서 겹치지 않도록 공유 디렉터리에서 받음
+    new_room->id = shard_room_add(&shards, new_room->name, new_room->game_mode, new_room->time_limit);
+    if (new_room->id < 0) {
+        log_event("방 수 제한 (%d개)에 걸렸습니다.\n", limits.max_rooms);
+        slab_free(&room_pool, new_room);
+        return NULL;
+    }
     new_room->next = room_head;
     room_head = new_room;
 
@@ -200,28 +370,68 @@ Room *create_room(const char *name, const char *host_name, int host_fd) {
     return new_room;
 }
 
-// 방에 사용자 추가 함수
-void add_user_to_room(Room *room, User *user) {
+// 마지막 멤버가 나간 방 삭제 (room_mutex를 잡은 상태에서 호출, 디렉터리 칸도 돌려줌)
+void destroy_room(Room *room) {
+    Room **link = &room_head;
+    while (*link != NULL && *link != room) {
+        link = &(*link)->next;
+    }
+    if (*link == NULL) {
+        return;
+    }
+    *link = room->next;
+    timer_wheel_cancel(&room_timers, &room->end_timer);
+    timer_wheel_cancel(&room_timers, &room->board_timer);
+    shard_room_remove(&shards, room->id);
+    log_event("방 삭제: ID=%d, 이름=%s\n", room->id, room->name);
+    slab_free(&room_pool, room);
+}
+
+// 방의 인원과 설정을 공유 디렉터리에 반영 (room_mutex를 잡은 상태에서 호출)
+void publish_room(Room *room) {
+    int members = 0;
+    for (RoomUser *member = room->users; member != NULL; member = member->next) {
+        members++;
+    }
+    shard_room_update(&shards, room->id, members, room->game_mode, room->time_limit);
+}
+
+// 방에 사용자 추가 함수 (빈 슬롯이 없으면 -1)
+int add_user_to_room(Room *room, User *user) {
     // 중복 추가 방지
     RoomUser *current = room->users;
     while (current != NULL) {
         if (current->user->socket_fd == user->socket_fd) {
-            return;
+            return 0;
         }
         current = current->next;
     }
 
-    RoomUser *new_room_user = (RoomUser *)malloc(sizeof(RoomUser));
+    int slot = 0;
+    while (slot < ROOM_MAX_MEMBERS && room->slots[slot] != NULL) {
+        slot++;
+    }
+    if (slot == ROOM_MAX_MEMBERS) {
+        return -1;
+    }
+
+    RoomUser *new_room_user = (RoomUser *)slab_alloc(&room_user_pool);
     if (!new_room_user) {
-        perror("RoomUser 메모리 할당 실패");
-        return;
+        perror("RoomUser 객체 할당 실패");
+        return -1;
     }
     new_room_user->user = user;
+    new_room_user->slot = slot;
+    room->slots[slot] = new_room_user;
+    memset(&new_room_user->play, 0, sizeof(new_room_user->play)); // 게임 도중 들어오면 검증 상태 없음
     new_room_user->next = room->users;
     room->users = new_room_user;
+    publish_room(room);
+    return 0;
 }
 
 // 방에서 사용자 제거 함수
+// 게임 도중이면 그 자리는 결과에서 빠짐 (남은 플레이어가 모두 점수를 보냈는지는 호출한 쪽에서 확인)
 void remove_user_from_room(Room *room, User *user) {
     RoomUser *current = room->users;
     RoomUser *prev = NULL;
@@ -232,7 +442,18 @@ void remove_user_from_room(Room *room, User *user) {
             } else {
                 prev->next = current->next;
             }
-            free(current);
+            int slot = current->slot;
+            room->slots[slot] = NULL;
+            if (room->playing[slot]) {
+                room->playing[slot] = 0;
+                room->players--;
+                if (room->reported[slot]) {
+                    room->reports--;
+                }
+            }
+            word_stream_player_free(&current->play);
+            slab_free(&room_user_pool, current);
+            publish_room(room);
             return;
         }
         prev = current;
@@ -240,6 +461,277 @@ void remove_user_from_room(Room *room, User *user) {
     }
 }
 
+// 방 사용자 찾기 함수 (room_mutex를 잡은 상태에서 호출)
+RoomUser *find_room_user(Room *room, int socket_fd) {
+    RoomUser *current = room->users;
+    while (current != NULL) {
+        if (current->user->socket_fd == socket_fd) {
+            return current;
+        }
+        current = current->next;
+    }
+    return NULL;
+}
+
+// 서버가 보는 방의 현재 틱
+static int room_tick(const Room *room) {
+    return (int)((timer_wheel_now_ms() - room->started_ms) / (uint64_t)room->stream.tick_ms);
+}
+
+// 게임이 끝난 틱 (제한 시간을 넘지 않음)
+static int room_end_tick(const Room *room) {
+    int tick = room_tick(room);
+    int limit = word_stream_ticks(&room->stream, room->time_limit);
+    return tick < limit ? tick : limit;
+}
+
+// 방의 공용 단어 흐름 종료 (플레이어별 검증 상태 해제, room_mutex를 잡은 상태에서 호출)
+void reset_room_stream(Room *room) {
+    room->stream_active = 0;
+    room->charged_capacity = 0;
+    for (RoomUser *member = room->users; member != NULL; member = member->next) {
+        word_stream_player_free(&member->play);
+    }
+}
+
+// tick까지 바닥에 닿은 단어를 맞히지 못한 플레이어의 실시간 점수에서 감점 (room_mutex를 잡은 상태에서 호출)
+// 단어는 id 순서대로 사라지지 않으므로 charge_from부터 나타난 단어까지만 확인 (화면에 있는 단어 수만큼)
+static void room_charge_missed(Room *room, int tick) {
+    int spawned = word_stream_spawned(&room->stream, tick);
+    if (spawned > room->charged_capacity) {
+        spawned = room->charged_capacity;
+    }
+    for (int id = room->charge_from; id < spawned; id++) {
+        if (room->charged[id]) {
+            continue;
+        }
+        WordStreamWord word;
+        word_stream_word(&room->stream, id, &word);
+        if (word.expire_tick > tick) {
+            continue;
+        }
+        room->charged[id] = 1;
+        for (int slot = 0; slot < ROOM_MAX_MEMBERS; slot++) {
+            RoomUser *member = room->slots[slot];
+            if (room->playing[slot] && member != NULL && member->play.capacity > 0 && !member->play.killed[id]) {
+                room->live[slot] -= word.length;
+                room->board_dirty = 1;
+            }
+        }
+    }
+    while (room->charge_from < spawned && room->charged[room->charge_from]) {
+        room->charge_from++;
+    }
+}
+
+// 인정된 KILL을 실시간 점수에 반영 (room_mutex를 잡은 상태에서 호출)
+static void room_apply_kill(Room *room, RoomUser *member, int word_id, int points) {
+    room->live[member->slot] += points;
+    if (word_id < room->charged_capacity && room->charged[word_id]) {
+        // 틱 오차 안에서 늦게 도착한 KILL: 이미 뺀 감점을 되돌림
+        WordStreamWord word;
+        word_stream_word(&room->stream, word_id, &word);
+        room->live[member->slot] += word.length;
+    }
+    room->board_dirty = 1;
+}
+
+// LEADERBOARD <틱>\t<점수> <이름>\t... (점수 내림차순), 바뀐 것이 없으면 0
+static int room_format_board(Room *room, int tick, char *msg, size_t size) {
+    int order[ROOM_MAX_MEMBERS];
+    int count = 0;
+    if (!room->board_dirty) {
+        return 0;
+    }
+    for (int slot = 0; slot < ROOM_MAX_MEMBERS; slot++) {
+        if (!room->playing[slot] || room->slots[slot] == NULL) {
+            continue;
+        }
+        int i = count++;
+        while (i > 0 && room->live[order[i - 1]] < room->live[slot]) {
+            order[i] = order[i - 1];
+            i--;
+        }
+        order[i] = slot;
+    }
+    size_t len = (size_t)snprintf(msg, size, "LEADERBOARD %d", tick);
+    for (int i = 0; i < count && len < size; i++) {
+        len += (size_t)snprintf(msg + len, size - len, "\t%d %s", room->live[order[i]], room->slots[order[i]]->user->name);
+    }
+    if (len >= size - 1) {
+        len = size - 2;
+    }
+    msg[len] = '\n';
+    msg[len + 1] = '\0';
+    room->board_dirty = 0;
+    return 1;
+}
+
+// 공용 단어 흐름으로 진행한 게임이면 클라이언트가 보낸 점수 대신 서버가 검증한 점수 사용
+// claimed_tick은 클라이언트가 마지막으로 진행한 틱 (모르면 -1), 서버 틱보다 조금 늦는 것만 인정
+int verified_score(Room *room, User *user, int claimed, int claimed_tick) {
+    if (!room->stream_active) {
+        return claimed;
+    }
+    RoomUser *member = find_room_user(room, user->socket_fd);
+    if (member == NULL || member->play.capacity == 0) {
+        return claimed;
+    }
+    int end_tick = room_end_tick(room);
+    if (claimed_tick >= 0 && claimed_tick < end_tick && claimed_tick >= end_tick - WORD_STREAM_KILL_SLACK) {
+        end_tick = claimed_tick;
+    }
+    int score = word_stream_player_final(&member->play, &room->stream, end_tick);
+    if (score != claimed) {
+        log_event("점수 불일치: 사용자=%s, 보고=%d, 검증=%d (KILL %d개 인정, %d개 거부)\n", user->name, claimed, score,
+                  member->play.kills, member->play.rejected);
+    }
+    return score;
+}
+
+/*
+ * 게임 종료 처리 (room_mutex를 잡은 상태에서 호출)
+ * 점수를 보내지 않은 플레이어는 서버가 인정한 KILL로 점수를 채우고
+ * 슬롯 배열에서 최고 점수를 골라 승자 메시지를 winner_msg에 씀 (남은 플레이어가 없으면 빈 문자열)
+ * 보내기는 broadcast_message가 room_mutex를 잡으므로 호출한 쪽에서 잠금을 푼 뒤에
+ */
+void finish_game(Room *room, char *winner_msg, size_t size) {
+    int end_tick = room->stream_active ? room_end_tick(room) : 0;
+    int best = -1;
+    for (int slot = 0; slot < ROOM_MAX_MEMBERS; slot++) {
+        RoomUser *member = room->slots[slot];
+        if (!room->playing[slot] || member == NULL) {
+            continue;
+        }
+        if (!room->reported[slot]) {
+            room->scores[slot] = member->play.capacity > 0
+                                     ? word_stream_player_final(&member->play, &room->stream, end_tick)
+                                     : 0;
+            log_event("점수 미수신: 사용자=%s, 서버 계산 점수=%d\n", member->user->name, room->scores[slot]);
+        }
+        if (best < 0 || room->scores[slot] > room->scores[best]) {
+            best = slot;
+        }
+        submit_result(room->game_mode, member->user->name, room->scores[slot]);
+    }
+
+    winner_msg[0] = '\0';
+    if (best >= 0) {
+        snprintf(winner_msg, size, "GAME_OVER\n승자가 결정되었습니다: %s님!\n", room->slots[best]->user->name);
+    }
+
+    // 게임 상태 초기화 (다음 게임을 위해 READY도 다시 받음)
+    timer_wheel_cancel(&room_timers, &room->end_timer);
+    timer_wheel_cancel(&room_timers, &room->board_timer);
+    reset_room_stream(room);
+    memset(room->playing, 0, sizeof(room->playing));
+    room->players = 0;
+    room->reports = 0;
+    room->game_started = 0;
+    room->game_over = 1;
+    room->ready_count = 0;
+    for (RoomUser *member = room->users; member != NULL; member = member->next) {
+        member->user->is_ready = 0;
+    }
+}
+
+// 플레이어 점수 기록 (room_mutex를 잡은 상태에서 호출)
+// 목표 점수에 도달했거나 남은 플레이어가 모두 보냈으면 게임을 끝내고 1
+int record_score(Room *room, RoomUser *member, int score, char *winner_msg, size_t size) {
+    int slot = member->slot;
+    room->scores[slot] = score;
+    if (!room->reported[slot]) {
+        room->reported[slot] = 1;
+        room->reports++;
+    }
+    if (score >= GAME_TARGET_SCORE || room->reports >= room->players) {
+        finish_game(room, winner_msg, size);
+        return 1;
+    }
+    return 0;
+}
+
+// 제한 시간 + 유예가 지난 방의 게임 종료 (리액터 루프의 타이머에서 호출)
+void room_time_up(void *arg) {
+    Room *room = (Room *)arg;
+    char winner_msg[BUFFER_SIZE] = "";
+
+    pthread_mutex_lock(&room_mutex);
+    // 취소 직전에 꺼내졌거나 다음 게임을 위해 다시 등록됐을 수 있으므로 상태를 다시 확인
+    if (room->game_started && !room->game_over && timer_wheel_now_ms() >= room->ends_at_ms) {
+        printf("방 ID %d 제한 시간 종료 (점수 %d/%d명 수신)\n", room->id, room->reports, room->players);
+        log_event("방 ID %d 제한 시간 종료 (점수 %d/%d명 수신)\n", room->id, room->reports, room->players);
+        finish_game(room, winner_msg, sizeof(winner_msg));
+    }
+    int room_id = room->id;
+    pthread_mutex_unlock(&room_mutex);
+
+    if (winner_msg[0] != '\0') {
+        broadcast_message(winner_msg, room_id, -1);
+        printf("GAME_OVER 메시지 브로드캐스트: %s", winner_msg);
+        log_event("GAME_OVER 메시지 브로드캐스트: %s", winner_msg);
+    }
+}
+
+// 실시간 순위 틱: 그동안 바뀐 점수를 LEADERBOARD 한 번으로 모아 보냄 (리액터 루프의 타이머에서 호출)
+// 타자 속도나 KILL 수와 관계없이 방마다 LEADERBOARD_INTERVAL_MS에 한 번까지만 보냄
+void room_board_tick(void *arg) {
+    Room *room = (Room *)arg;
+    char msg[BUFFER_SIZE];
+    int changed = 0;
+
+    pthread_mutex_lock(&room_mutex);
+    if (!room->game_started || room->game_over || !room->stream_active) {
+        pthread_mutex_unlock(&room_mutex);
+        return; // 게임이 끝났으면 다시 등록하지 않음
+    }
+    int tick = room_end_tick(room);
+    room_charge_missed(room, tick);
+    changed = room_format_board(room, tick, msg, sizeof(msg));
+    timer_wheel_schedule(&room_timers, &room->board_timer, LEADERBOARD_INTERVAL_MS);
+    int room_id = room->id;
+    pthread_mutex_unlock(&room_mutex);
+
+    if (changed) {
+        broadcast_message(msg, room_id, -1);
+        log_event("LEADERBOARD 브로드캐스트: %s", msg);
+    }
+}
+
+// 플레이어 점수 보고 처리 (GAME_OVER <점수> <틱> / SCORE <점수>)
+void report_score(int socket_fd, int room_id, int claimed, int claimed_tick) {
+    char winner_msg[BUFFER_SIZE] = "";
+    const char *error = NULL;
+
+    pthread_mutex_lock(&room_mutex);
+    Room *room = find_room(room_id);
+    RoomUser *member = room != NULL ? find_room_user(room, socket_fd) : NULL;
+    if (room == NULL) {
+        error = "ERROR 방을 찾을 수 없습니다.\n";
+    } else if (!room->game_started || room->game_over) {
+        error = "ERROR 게임이 이미 종료되었습니다.\n";
+    } else if (member == NULL || !room->playing[member->slot]) {
+        error = "ERROR 이번 게임에 참여하지 않았습니다.\n";
+    } else {
+        int score = verified_score(room, member->user, claimed, claimed_tick);
+        record_score(room, member, score, winner_msg, sizeof(winner_msg));
+    }
+    pthread_mutex_unlock(&room_mutex);
+
+    if (error != NULL) {
+        send_message(socket_fd, error);
+        printf("점수 보고 거부: %s", error);
+        log_event("점수 보고 거부: %s", error);
+        return;
+    }
+    if (winner_msg[0] != '\0') {
+        // 승자 메시지 브로드캐스트 (먼저 끝낸 플레이어도 받도록 모든 클라이언트에게)
+        broadcast_message(winner_msg, room_id, -1);
+        printf("GAME_OVER 메시지 브로드캐스트: %s", winner_msg);
+        log_event("GAME_OVER 메시지 브로드캐스트: %s", winner_msg);
+    }
+}
+
 // 메시지 브로드캐스트 함수 (room_id에 속한 사용자들에게만 전송)
 void broadcast_message(const char *message, int room_id, int exclude_fd) {
     pthread_mutex_lock(&room_mutex);
@@ -271,17 +763,15 @@ void broadcast_message(const char *message, int room_id, int exclude_fd) {
     pthread_mutex_unlock(&room_mutex);
 }
 
-// 메시지 전송 함수
+// 메시지 전송 함수 (소켓이 바로 받지 못한 나머지는 연결의 쓰기 큐에 쌓였다가 리액터가 보냄)
 void send_message(int socket_fd, const char *message) {
-    if (socket_fd < 0) {
+    NetConn *conn = net_conn_of(&reactor, socket_fd);
+    if (conn == NULL) {
         return; // 유효하지 않은 소켓
     }
-    
-    if (send(socket_fd, message, strlen(message), 0) < 0) {
-        // 소켓이 이미 닫혔거나 오류가 발생한 경우 조용히 무시
-        if (errno != EBADF && errno != EPIPE && errno != ECONNRESET) {
-            perror("메시지 전송 실패");
-        }
+
+    if (net_conn_send(conn, message, strlen(message)) < 0) {
+        // 연결이 이미 끊겼거나 쓰기 큐가 넘친 경우 조용히 무시 (리액터가 연결을 정리)
     } else {
         // 로그 파일에 기록
         if (log_fp != NULL) {
@@ -302,9 +792,11 @@ void send_help_message(int socket_fd) {
         "/set_game <모드> <시간>    : 게임 설정을 변경합니다. (방장만 가능)\n"
         "/game_list                : 사용 가능한 게임 모드를 조회합니다.\n"
         "/ready                    : 게임 준비를 완료합니다.\n"
+        "/top [모드] [개수]         : 순위표 상위 기록을 조회합니다. (기본 10명, 최대 100명)\n"
+        "/rank [모드]               : 내 순위를 조회합니다.\n"
         "/topic <주제>              : GPT를 통해 주제에 맞는 단어를 가져옵니다.\n"
-        "/help                     : 도움말을 표시합니다.\n";
-        "<topic mode는 single player 모드에서 가능합니다>."
+        "/help                     : 도움말을 표시합니다.\n"
+        "<topic mode는 single player 모드에서 가능합니다>.\n";
     send_message(socket_fd, help_msg);
     log_event("HELP 메시지 전송: %s", help_msg);
 }
@@ -321,154 +813,941 @@ void send_game_list(int socket_fd) {
     log_event("GAME_LIST 메시지 전송: %s", game_list_msg);
 }
 
-// 방 목록 전송 함수
+// 방 목록 전송 함수 (모든 shard의 방, 공유 디렉터리에서)
 void send_room_list(int socket_fd) {
-    pthread_mutex_lock(&room_mutex);
-    if (room_head == NULL) {
+    static ShardRoom rooms[SHARD_ROOMS];
+    int count = shard_room_list(&shards, rooms, SHARD_ROOMS);
+    if (count == 0) {
         send_message(socket_fd, "현재 사용 가능한 방이 없습니다.\n");
         printf("현재 사용 가능한 방이 없습니다. 메시지 전송\n");
         log_event("현재 사용 가능한 방이 없습니다. 메시지 전송\n");
     } else {
         char list_msg[BUFFER_SIZE] = "현재 방 목록:\n";
-        Room *current_room = room_head;
-        while (current_room != NULL) {
+        for (int i = 0; i < count; i++) {
             char room_info[256]; // 버퍼 크기 증가
             snprintf(room_info, sizeof(room_info), "방 ID: %d, 방 이름: %s, 게임 모드: %s, 시간 제한: %d초\n",
-                     current_room->id, current_room->name, current_room->game_mode, current_room->time_limit);
+                     rooms[i].id, rooms[i].name, rooms[i].game_mode, rooms[i].time_limit);
             strncat(list_msg, room_info, sizeof(list_msg) - strlen(list_msg) - 1);
-            current_room = current_room->next;
         }
         send_message(socket_fd, list_msg);
         printf("방 목록 전송: %s", list_msg);
         log_event("방 목록 전송: %s", list_msg);
     }
-    pthread_mutex_unlock(&room_mutex);
 }
 
-// 게임 시작 함수
-void start_game(Room *room) {
-    // 게임 시작 메시지 전송
-    char msg[BUFFER_SIZE];
-    snprintf(msg, sizeof(msg), "GAME_STARTED\n");
-    broadcast_message(msg, room->id, -1);
-    log_event("GAME_STARTED 메시지 브로드캐스트: %s", msg);
-
-    room->game_started = 1;
-    room->game_over = 0; // 게임 종료 상태 초기화
+// 순위표 상위 목록 전송 (/top [모드] [개수], 클라이언트 버퍼를 넘지 않게 여러 번에 나눠 보냄)
+void send_top_list(int socket_fd, const char *args) {
+    char mode[50] = "";
+    int count = 10;
+    if (sscanf(args, "%d", &count) != 1 && sscanf(args, "%49s %d", mode, &count) < 1) {
+        mode[0] = '\0';
+    }
+    int index = leaderboard_board(&leaderboard, mode);
+    if (index < 0) {
+        send_message(socket_fd, "ERROR 존재하지 않는 게임 모드입니다. /game_list로 확인하세요.\n");
+        return;
+    }
+    if (count < 1 || count > LEADERBOARD_TOP_MAX) {
+        count = count < 1 ? 1 : LEADERBOARD_TOP_MAX;
+    }
 
-    // 게임 시작 시점에 scores 초기화
-    pthread_mutex_lock(&room_mutex);
-    // 이전 점수 초기화
-    ScoreNode *current_score = room->scores;
-    while (current_score != NULL) {
-        ScoreNode *temp = current_score;
-        current_score = current_score->next;
-        free(temp);
-    }
-    room->scores = NULL;
-    pthread_mutex_unlock(&room_mutex);
+    LeaderEntry entries[LEADERBOARD_TOP_MAX];
+    int filled = leaderboard_top(&leaderboard, index, entries, count);
+    char msg[BUFFER_SIZE];
+    size_t len = (size_t)snprintf(msg, sizeof(msg), "순위표 (%s) 상위 %d명:\n", leaderboard_board_name(&leaderboard, index), filled);
+    if (filled == 0) {
+        len += (size_t)snprintf(msg + len, sizeof(msg) - len, "아직 기록이 없습니다.\n");
+    }
+    for (int i = 0; i < filled; i++) {
+        char line[100];
+        int n = snprintf(line, sizeof(line), "%3d. %s %d\n", i + 1, entries[i].name, entries[i].score);
+        if (len + (size_t)n >= sizeof(msg)) {
+            send_message(socket_fd, msg);
+            len = 0;
+            msg[0] = '\0';
+        }
+        memcpy(msg + len, line, (size_t)n + 1);
+        len += (size_t)n;
+    }
+    send_message(socket_fd, msg);
+    log_event("순위표 전송: %s 상위 %d명\n", leaderboard_board_name(&leaderboard, index), filled);
 }
 
-// 서버 종료 시 클린업 함수
-void cleanup_server(int signum) {
-    printf("\n서버 종료 시그널 수신. 클린업을 진행합니다...\n");
-    log_event("서버 종료 시그널 수신. 클린업을 진행합니다...\n");
+// 내 순위 전송 (/rank [모드])
+void send_rank(int socket_fd, const char *name, const char *args) {
+    char mode[50] = "";
+    char msg[BUFFER_SIZE];
+    sscanf(args, "%49s", mode);
+    int index = leaderboard_board(&leaderboard, mode);
+    if (index < 0) {
+        send_message(socket_fd, "ERROR 존재하지 않는 게임 모드입니다. /game_list로 확인하세요.\n");
+        return;
+    }
+    int score = 0, total = 0;
+    int rank = leaderboard_rank(&leaderboard, index, name, &score, &total);
+    if (rank == 0) {
+        snprintf(msg, sizeof(msg), "순위 (%s): 아직 기록이 없습니다. (%d명 기록)\n", leaderboard_board_name(&leaderboard, index), total);
+    } else {
+        snprintf(msg, sizeof(msg), "순위 (%s): %d위 / %d명, 최고 점수 %d\n", leaderboard_board_name(&leaderboard, index), rank, total, score);
+    }
+    send_message(socket_fd, msg);
+    log_event("순위 전송: %s", msg);
+}
 
-    // 시그널 핸들러 중복 호출 방지
-    static int cleanup_in_progress = 0;
-    if (cleanup_in_progress) {
-        printf("클린업이 이미 진행 중입니다. 강제 종료합니다.\n");
-        exit(1);
+// 순위표 체크포인트 (리액터 루프의 타이머에서 주기적으로 호출, 시작 시간을 줄이려고 로그를 합침)
+void leaderboard_checkpoint_tick(void *arg) {
+    (void)arg;
+    if (leaderboard_checkpoint(&leaderboard) < 0) {
+        log_event("순위표 체크포인트 실패\n");
     }
-    cleanup_in_progress = 1;
+    timer_wheel_schedule(&room_timers, &leaderboard_timer, LEADERBOARD_CHECKPOINT_MS);
+}
 
-    // 먼저 모든 소켓을 닫는다 (브로드캐스트 없이)
-    pthread_mutex_lock(&user_mutex);
-    User *current = user_head;
-    while (current != NULL) {
-        if (current->socket_fd >= 0) {
-            shutdown(current->socket_fd, SHUT_RDWR); // 소켓을 안전하게 닫기
-            close(current->socket_fd);
+// 객체 풀 통계 로그 (리액터 루프의 타이머에서 주기적으로 호출)
+void pool_stats_tick(void *arg) {
+    (void)arg;
+    SlabPool *pools[] = {&user_pool, &room_pool, &room_user_pool, &reactor.conn_pool, &reactor.buffer_pool};
+    for (size_t i = 0; i < sizeof(pools) / sizeof(pools[0]); i++) {
+        SlabStats stats;
+        slab_pool_stats(pools[i], &stats);
+        log_event("객체 풀 %s: 사용 %zu / 최대 %zu / 용량 %zu (청크 %zu), 누적 할당 %llu, 해제 %llu\n", pools[i]->name,
+                  stats.in_use, stats.peak, stats.capacity, stats.chunks,
+                  (unsigned long long)stats.allocs, (unsigned long long)stats.frees);
+    }
+    if (rejected_connections > 0 || rejected_messages > 0) {
+        log_event("접속 제한: 거절한 연결 %lu, 버린 메시지 %lu\n", rejected_connections, rejected_messages);
+    }
+    if (resumed_sessions > 0 || expired_sessions > 0) {
+        log_event("재접속: 이어서 접속 %lu, 자리를 비워 정리 %lu\n", resumed_sessions, expired_sessions);
+    }
+    if (heartbeat.reaped > 0) {
+        log_event("하트비트: PING %lu번, 응답이 없어 끊은 연결 %lu개\n", heartbeat.pings, heartbeat.reaped);
+    }
+    if (shards.index == 0 && shards.count > 1) {
+        int counts[SHARD_MAX];
+        shard_user_counts(&shards, counts);
+        for (int i = 0; i < shards.count; i++) {
+            log_event("shard %d: 접속자 %d명\n", i, counts[i]);
         }
-        current = current->next;
     }
-    pthread_mutex_unlock(&user_mutex);
+    timer_wheel_schedule(&room_timers, &pool_stats_timer, POOL_STATS_MS);
+}
 
-    // 방 메모리 해제
-    pthread_mutex_lock(&room_mutex);
-    Room *room_current = room_head;
-    while (room_current != NULL) {
-        // 방 내 사용자 목록 해제
-        RoomUser *room_user = room_current->users;
-        while (room_user != NULL) {
-            RoomUser *temp_room_user = room_user;
-            room_user = room_user->next;
-            free(temp_room_user);
-        }
+// 게임 결과 한 명분을 순위표에 반영하고 다른 shard에도 알림
+// 로그 파일은 0번 shard만 쓰고 (다른 shard는 leaderboard_detach_log), 메모리 순위표는 모든 shard가 같게 유지
+void submit_result(const char *game_mode, const char *name, int score) {
+    // 새 서버로 넘기는 중이면 기록은 새 서버가 맡음 (이 shard의 순위표는 곧 버려짐)
+    if (draining && forward_result(game_mode, name, score) == 0) {
+        return;
+    }
+    if (leaderboard_submit(&leaderboard, game_mode, name, score) < 0) {
+        log_event("순위표 기록 실패: 사용자=%s\n", name);
+    }
+    if (shards.count > 1 && shard_broadcast_result(&shards, game_mode, name, score) > 0) {
+        log_event("다른 shard에 결과를 알리지 못했습니다: 사용자=%s\n", name);
+    }
+}
 
-        // 점수 목록 해제
-        ScoreNode *score_current = room_current->scores;
-        while (score_current != NULL) {
-            ScoreNode *temp_score = score_current;
-            score_current = score_current->next;
-            free(temp_score);
-        }
+// 연결을 다른 shard로 넘김 (다른 shard의 방에 들어가려는 로비 사용자, 다른 shard의 토큰으로 /resume한 연결)
+// command (지금 처리 중인 줄)부터 받은 shard가 이어서 처리하므로 응답은 그 shard가 보냄
+// 넘겼으면 0 (이 shard에서는 사용자를 지움), 받는 shard가 밀려 있으면 -1
+int hand_off_conn(NetConn *conn, int target, const char *command, size_t len) {
+    static char data[SHARD_MESSAGE_MAX];
+    User *client = conn != NULL ? conn->user : NULL;
+    size_t input_len = 0, output_len = 0;
+    size_t room = sizeof(data) - sizeof(ShardMessage);
+    if (conn == NULL || len > room) {
+        return -1;
+    }
+    memcpy(data, command, len);
+    if (net_conn_snapshot(conn, data + len, room - len, &input_len, &output_len) < 0) {
+        return -1;
+    }
+    if (shard_send_handoff(&shards, target, conn->fd, client != NULL ? client->directory_slot : -1,
+                           client != NULL ? client->name : "", data, len + input_len, output_len) < 0) {
+        return -1;
+    }
 
-        Room *temp_room = room_current;
-        room_current = room_current->next;
-        free(temp_room);
+    int socket_fd = net_conn_detach(conn);
+    printf("사용자 %s를 shard %d로 넘김 (소켓 FD %d)\n", client != NULL ? client->name : "(재접속)", target, socket_fd);
+    log_event("사용자 %s를 shard %d로 넘김 (소켓 FD %d)\n", client != NULL ? client->name : "(재접속)", target, socket_fd);
+    if (client != NULL) {
+        pthread_mutex_lock(&user_mutex);
+        remove_user(socket_fd);
+        pthread_mutex_unlock(&user_mutex);
     }
-    room_head = NULL; // 헤드 포인터 초기화
-    pthread_mutex_unlock(&room_mutex);
+    close(socket_fd);
+    return 0;
+}
 
-    // 사용자 메모리 해제
-    pthread_mutex_lock(&user_mutex);
-    User *user_current = user_head;
-    while (user_current != NULL) {
-        User *temp_user = user_current;
-        user_current = user_current->next;
-        free(temp_user);
+// 다른 shard가 보낸 메시지 처리 (리액터가 받는 소켓에 읽을 것이 생기면 호출)
+void shard_inbox(NetReactor *r, int fd, void *arg) {
+    static char data[SHARD_MESSAGE_MAX];
+    (void)fd;
+    (void)arg;
+    ShardMessage msg;
+    int socket_fd;
+    int received = shard_receive(&shards, &msg, data, sizeof(data), &socket_fd);
+    if (received < 0) {
+        perror("shard 메시지 수신 실패");
+        return;
+    }
+    if (received == 0) {
+        return;
     }
-    user_head = NULL; // 헤드 포인터 초기화
-    pthread_mutex_unlock(&user_mutex);
 
-    // 로그 파일 닫기
-    if (log_fp != NULL) {
-        fclose(log_fp);
-        log_fp = NULL;
+    if (msg.type == SHARD_MSG_RESULT) {
+        // 넘기는 중인 0번 shard는 로그를 놓았으므로, 넘기기 전에 다른 shard가 보낸 결과도 새 서버에 맡김
+        if (draining && shards.index == 0 && forward_result(msg.game_mode, msg.name, msg.score) == 0) {
+            return;
+        }
+        if (leaderboard_submit(&leaderboard, msg.game_mode, msg.name, msg.score) < 0) {
+            log_event("순위표 기록 실패: 사용자=%s\n", msg.name);
+        }
+        return;
+    }
+    if (msg.type != SHARD_MSG_HANDOFF || socket_fd < 0) {
+        if (socket_fd >= 0) {
+            close(socket_fd);
+        }
+        return;
     }
 
-    printf("서버가 정상적으로 종료되었습니다.\n");
-    exit(0);
+    // 넘겨받은 연결: 이름은 이미 받았으므로 사용자로 바로 등록하고, 밀린 출력을 먼저 보낸 뒤 입력을 이어서 처리
+    // 이름이 없으면 /resume으로 이 shard를 찾아온 연결 (사용자 없이 등록하고 /resume 줄부터 처리)
+    printf("shard에서 사용자 %s를 넘겨받음 (소켓 FD %d)\n", msg.name, socket_fd);
+    log_event("shard에서 사용자 %s를 넘겨받음 (소켓 FD %d)\n", msg.name, socket_fd);
+    User *user = NULL;
+    if (msg.name[0] != '\0') {
+        pthread_mutex_lock(&user_mutex);
+        user = add_user(socket_fd, msg.name);
+        pthread_mutex_unlock(&user_mutex);
+    }
+    NetConn *conn = msg.name[0] == '\0' || user != NULL
+                        ? net_conn_open(r, socket_fd, net_frame_line, client_message, client_closed, user)
+                        : NULL;
+    if (conn == NULL) {
+        if (user != NULL) {
+            pthread_mutex_lock(&user_mutex);
+            remove_user(socket_fd);
+            pthread_mutex_unlock(&user_mutex);
+        }
+        shard_user_remove(&shards, msg.user_slot);
+        close(socket_fd);
+        return;
+    }
+    if (user != NULL) {
+        user->directory_slot = msg.user_slot;
+        shard_user_move(&shards, msg.user_slot, shards.index);
+    }
+    if (msg.output_len > 0) {
+        net_conn_send(conn, data + msg.input_len, msg.output_len);
+    }
+    // 토큰은 shard 번호를 담으므로 이 shard의 새 토큰으로 바꿔 알림
+    if (user != NULL) {
+        send_session(user);
+    }
+    if (net_conn_feed(conn, data, msg.input_len) < 0) {
+        net_conn_close(conn);
+    }
 }
 
-// 클라이언트 핸들러 함수
-void *client_handler(void *arg) {
-    int socket_fd = (intptr_t)arg;
-    char buffer[BUFFER_SIZE];
-    int bytes_read;
-    char name[50] = {0};
-    int current_room_id = -1; // 사용자가 속한 방 ID
-
-    // 클라이언트로부터 이름 수신
-    bytes_read = recv(socket_fd, buffer, sizeof(buffer) - 1, 0);
-    if (bytes_read <= 0) {
-        printf("소켓 FD %d에서 이름을 수신하지 못했습니다. 연결 종료.\n", socket_fd);
-        log_event("소켓 FD %d에서 이름을 수신하지 못했습니다. 연결 종료.\n", socket_fd);
-        close(socket_fd);
-        pthread_exit(NULL);
+// 이전 서버: 새 서버와 연결이 끊김
+// 리스닝 소켓을 아직 넘기지 않았으면 넘기기를 취소하고 그대로 서비스, 넘겼으면 남은 방과 연결을 끝까지 처리
+void upgrade_abort(void) {
+    perror("새 서버로 넘기기 실패");
+    log_event("새 서버로 넘기기 실패 (shard %d)\n", shards.index);
+    close(upgrade_to);
+    upgrade_to = -1;
+    if (tcp_listen_fd >= 0) {
+        draining = 0;
+        if (shards.index == 0 && leaderboard_attach_log(&leaderboard) < 0) {
+            perror("순위표 로그 열기 실패");
+        }
     }
-    buffer[bytes_read] = '\0';
-    strncpy(name, buffer, sizeof(name) - 1);
-    name[sizeof(name) - 1] = '\0';
+}
+
+// 이전 서버: 게임 결과를 새 서버에 맡김, 보냈으면 0
+int forward_result(const char *game_mode, const char *name, int score) {
+    if (upgrade_to < 0) {
+        return -1;
+    }
+    UpgradeMessage msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.type = UPGRADE_MSG_RESULT;
+    msg.score = score;
+    snprintf(msg.name, sizeof(msg.name), "%s", name);
+    snprintf(msg.game_mode, sizeof(msg.game_mode), "%s", game_mode);
+    if (upgrade_send(upgrade_to, &msg, NULL, -1) < 0) {
+        upgrade_abort();
+        return -1;
+    }
+    return 0;
+}
+
+// 이전 서버: 연결 하나를 새 서버로 넘기고 이 shard에서 지움 (user가 NULL이면 이름을 받기 전 연결)
+// 보내지 못하면 연결은 끊김 (클라이언트가 다시 접속), 넘겼으면 0
+int transfer_conn(NetConn *conn, User *user, int room_id, int is_host) {
+    static char data[UPGRADE_DATA_MAX];
+    UpgradeMessage msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.type = UPGRADE_MSG_USER;
+    msg.room_id = room_id;
+    msg.is_host = is_host;
+    if (user != NULL) {
+        snprintf(msg.name, sizeof(msg.name), "%s", user->name);
+        msg.is_ready = user->is_ready;
+    }
+
+    int sent = -1;
+    size_t input_len, output_len;
+    if (net_conn_snapshot(conn, data, sizeof(data), &input_len, &output_len) == 0) {
+        msg.input_len = (uint32_t)input_len;
+        msg.output_len = (uint32_t)output_len;
+        sent = upgrade_send(upgrade_to, &msg, data, conn->fd);
+    }
+    int socket_fd = net_conn_detach(conn);
+    if (user != NULL) {
+        shard_user_remove(&shards, user->directory_slot);
+        pthread_mutex_lock(&user_mutex);
+        remove_user(socket_fd);
+        pthread_mutex_unlock(&user_mutex);
+    }
+    close(socket_fd);
+    if (sent < 0) {
+        upgrade_abort();
+    }
+    return sent;
+}
+
+// 이전 서버: 게임 중이 아닌 방을 멤버와 함께 새 서버로 넘기고 이 shard에서 지움 (room_mutex를 잡은 상태에서 호출)
+void transfer_room(Room *room) {
+    // 밀린 입출력이 너무 많은 멤버는 넘기지 않고 끊음
+    RoomUser *members[ROOM_MAX_MEMBERS];
+    int count = 0;
+    for (RoomUser *member = room->users; member != NULL; member = member->next) {
+        NetConn *conn = net_conn_of(&reactor, member->user->socket_fd);
+        if (conn != NULL && !conn->closing && conn->read_len + conn->write_queued <= UPGRADE_DATA_MAX) {
+            members[count++] = member;
+        }
+    }
+
+    UpgradeMessage msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.type = UPGRADE_MSG_ROOM;
+    msg.room_id = room->id;
+    msg.members = count;
+    msg.time_limit = room->time_limit;
+    msg.ready_count = room->ready_count;
+    msg.game_over = room->game_over;
+    snprintf(msg.name, sizeof(msg.name), "%s", room->name);
+    snprintf(msg.game_mode, sizeof(msg.game_mode), "%s", room->game_mode);
+    if (count > 0 && upgrade_send(upgrade_to, &msg, NULL, -1) < 0) {
+        upgrade_abort();
+        return; // 방은 이 shard에 그대로
+    }
+    printf("방 ID %d를 새 서버로 넘김 (%d명)\n", room->id, count);
+    log_event("방 ID %d를 새 서버로 넘김 (%d명)\n", room->id, count);
+
+    // 목록 앞쪽이 최근에 들어온 멤버이므로 오래된 멤버부터 보내 새 서버의 목록 순서를 같게 함 (다음 방장이 같음)
+    for (RoomUser *member = room->users; member != NULL; member = member->next) {
+        int sending = 0;
+        for (int i = 0; i < count; i++) {
+            sending |= members[i] == member;
+        }
+        NetConn *conn = net_conn_of(&reactor, member->user->socket_fd);
+        if (!sending) {
+            member->user->room_id = -1;
+            if (conn != NULL) {
+                net_conn_close(conn);
+            }
+        }
+    }
+    for (int i = count - 1; i >= 0; i--) {
+        User *user = members[i]->user;
+        NetConn *conn = net_conn_of(&reactor, user->socket_fd);
+        if (upgrade_to < 0) {
+            user->room_id = -1;
+            net_conn_close(conn);
+            continue;
+        }
+        transfer_conn(conn, user, room->id, room->host_fd == user->socket_fd);
+    }
+
+    RoomUser *member = room->users;
+    while (member != NULL) {
+        RoomUser *next = member->next;
+        word_stream_player_free(&member->play);
+        slab_free(&room_user_pool, member);
+        member = next;
+    }
+    room->users = NULL;
+    destroy_room(room);
+}
+
+// 이전 서버: 넘길 수 있는 것을 모두 새 서버로 (게임 중이 아닌 방, 로비 사용자, 이름을 받기 전 연결)
+// announce면 게임 중인 방을 새 서버의 방 목록에 미리 올림, 이 shard에 남은 것이 없으면 1
+int transfer_idle(int announce) {
+    pthread_mutex_lock(&room_mutex);
+    Room *room = room_head;
+    while (room != NULL && upgrade_to >= 0) {
+        Room *next = room->next;
+        if (!room->game_started) {
+            transfer_room(room);
+        } else if (announce) {
+            int members = 0;
+            for (RoomUser *member = room->users; member != NULL; member = member->next) {
+                members++;
+            }
+            UpgradeMessage msg;
+            memset(&msg, 0, sizeof(msg));
+            msg.type = UPGRADE_MSG_PENDING;
+            msg.room_id = room->id;
+            msg.members = members;
+            msg.time_limit = room->time_limit;
+            snprintf(msg.name, sizeof(msg.name), "%s", room->name);
+            snprintf(msg.game_mode, sizeof(msg.game_mode), "%s", room->game_mode);
+            if (upgrade_send(upgrade_to, &msg, NULL, -1) < 0) {
+                upgrade_abort();
+            }
+        }
+        room = next;
+    }
+    pthread_mutex_unlock(&room_mutex);
+
+    for (int fd = 0; fd < reactor.conn_capacity && upgrade_to >= 0; fd++) {
+        NetConn *conn = reactor.conns[fd];
+        if (conn == NULL || conn->closing) {
+            continue;
+        }
+        User *user = conn->user;
+        if (user != NULL && user->room_id != -1) {
+            continue; // 게임 중인 방의 멤버
+        }
+        if (conn->read_len + conn->write_queued > UPGRADE_DATA_MAX) {
+            net_conn_close(conn);
+            continue;
+        }
+        transfer_conn(conn, user, -1, 0);
+    }
+    return room_head == NULL && reactor.conn_count == 0;
+}
+
+// 이전 서버: 새 서버가 제어 소켓에 연결함 (리액터가 부름)
+// HELLO를 보내고 GO를 기다린 뒤 리스닝 소켓과 넘길 수 있는 것을 모두 넘기고, 나머지는 drain_tick이 넘김
+void upgrade_accept(NetReactor *r, int fd, void *arg) {
+    (void)arg;
+    if (draining || upgrade_accepted(fd) < 0) {
+        close(fd);
+        return;
+    }
+
+    // 순위표 로그는 새 서버가 이어서 씀 (새 서버는 모든 shard의 HELLO를 받은 뒤 파일을 읽음)
+    if (shards.index == 0) {
+        leaderboard_detach_log(&leaderboard);
+    }
+    // GO를 받을 때까지 이 shard는 멈춤 (모든 shard가 멈춘 뒤에 새 서버가 방 ID를 이어서 줌)
+    UpgradeMessage msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.type = UPGRADE_MSG_HELLO;
+    msg.shard_count = shards.count;
+    msg.next_room_id = shard_room_next_id(&shards);
+    int pass_fd = -1;
+    if (upgrade_send(fd, &msg, NULL, -1) < 0 || upgrade_receive(fd, &msg, NULL, 0, &pass_fd) != 1 ||
+        msg.type != UPGRADE_MSG_GO) {
+        if (pass_fd >= 0) {
+            close(pass_fd);
+        }
+        perror("새 서버가 응답하지 않아 넘기기를 취소합니다");
+        log_event("새 서버가 응답하지 않아 넘기기를 취소합니다 (shard %d)\n", shards.index);
+        if (shards.index == 0 && leaderboard_attach_log(&leaderboard) < 0) {
+            perror("순위표 로그 열기 실패");
+        }
+        close(fd);
+        return;
+    }
+    upgrade_to = fd;
+    draining = 1;
+    printf("새 서버로 넘기기 시작 (shard %d)\n", shards.index);
+    log_event("새 서버로 넘기기 시작 (shard %d)\n", shards.index);
+
+    // 리스닝 소켓을 통째로 넘기므로 아직 받지 않은 연결 (backlog)도 새 서버가 받음
+    int *listeners[] = {&tcp_listen_fd, &local_listen_fd};
+    for (int i = 0; i < 2 && upgrade_to >= 0; i++) {
+        if (*listeners[i] < 0) {
+            continue;
+        }
+        memset(&msg, 0, sizeof(msg));
+        msg.type = UPGRADE_MSG_LISTENER;
+        msg.listener = i == 0 ? UPGRADE_LISTENER_TCP : UPGRADE_LISTENER_UNIX;
+        if (upgrade_send(upgrade_to, &msg, NULL, *listeners[i]) < 0) {
+            upgrade_abort();
+            break;
+        }
+        net_reactor_remove(r, *listeners[i]);
+        close(*listeners[i]);
+        *listeners[i] = -1;
+    }
+    if (!draining) {
+        return;
+    }
+
+    // 제어 소켓 이름은 새 서버가 다음 재시작을 위해 씀
+    net_reactor_remove(r, upgrade_listen_fd);
+    close(upgrade_listen_fd);
+    upgrade_listen_fd = -1;
+
+    // 연결이 끊겨 자리만 남은 사용자는 넘길 소켓이 없으므로 정리 (토큰은 새 서버에서 쓸 수 없음)
+    release_away_users();
+    transfer_idle(1);
+    memset(&msg, 0, sizeof(msg));
+    msg.type = UPGRADE_MSG_DONE;
+    if (upgrade_to >= 0 && upgrade_send(upgrade_to, &msg, NULL, -1) < 0) {
+        upgrade_abort();
+    }
+    timer_entry_init(&drain_timer, drain_tick, NULL);
+    timer_wheel_schedule(&room_timers, &drain_timer, 0);
+}
+
+// 이전 서버: 게임이 끝난 방부터 새 서버로 넘기고, 남은 것이 없으면 리액터를 멈춤 (shard 종료)
+void drain_tick(void *arg) {
+    (void)arg;
+    int empty = upgrade_to >= 0 ? transfer_idle(0) : room_head == NULL && reactor.conn_count == 0;
+    if (!empty) {
+        timer_wheel_schedule(&room_timers, &drain_timer, UPGRADE_DRAIN_MS);
+        return;
+    }
+    printf("새 서버로 모두 넘겼습니다. shard %d 종료\n", shards.index);
+    log_event("새 서버로 모두 넘겼습니다. shard %d 종료\n", shards.index);
+    if (upgrade_to >= 0) {
+        close(upgrade_to);
+        upgrade_to = -1;
+    }
+    net_reactor_stop(&reactor);
+}
+
+// 새 서버: 이전 서버에서 넘어온 방 (같은 ID와 설정, 멤버는 뒤따르는 USER로 채움), 실패 시 NULL
+Room *restore_room(const UpgradeMessage *msg) {
+    Room *room = alloc_room(msg->name, -1);
+    if (room == NULL) {
+        return NULL;
+    }
+    snprintf(room->game_mode, sizeof(room->game_mode), "%s", msg->game_mode);
+    room->time_limit = clamp_time_limit(msg->time_limit);
+    room->ready_count = msg->ready_count;
+    room->game_over = msg->game_over;
+    room->id = msg->room_id;
+    if (shard_room_restore(&shards, room->id, room->name, room->game_mode, room->time_limit, 0) < 0) {
+        log_event("방 디렉터리가 가득 찼습니다.\n");
+        slab_free(&room_pool, room);
+        return NULL;
+    }
+    pthread_mutex_lock(&room_mutex);
+    room->next = room_head;
+    room_head = room;
+    pthread_mutex_unlock(&room_mutex);
+    return room;
+}
+
+// 새 서버: 넘어온 방의 멤버가 다 왔음 (방장이 넘어오지 못했으면 다른 멤버로), 미뤄 둔 입력을 처리
+void finish_restoring_room(void) {
+    Room *room = restoring_room;
+    restoring_room = NULL;
+    pthread_mutex_lock(&room_mutex);
+    int room_id = room->id;
+    if (room->users == NULL) {
+        destroy_room(room);
+    } else if (find_room_user(room, room->host_fd) == NULL) {
+        room->host_fd = room->users->user->socket_fd;
+    }
+    pthread_mutex_unlock(&room_mutex);
+    printf("이전 서버에서 방 ID %d를 넘겨받음 (%d명)\n", room_id, restoring_count);
+    log_event("이전 서버에서 방 ID %d를 넘겨받음 (%d명)\n", room_id, restoring_count);
+
+    for (int i = 0; i < restoring_count; i++) {
+        NetConn *conn = net_conn_of(&reactor, restoring_input[i].fd);
+        if (conn != NULL && net_conn_feed(conn, restoring_input[i].data, restoring_input[i].len) < 0) {
+            net_conn_close(conn);
+        }
+    }
+    restoring_count = 0;
+}
+
+// 새 서버: 넘어온 연결 등록 (밀린 출력을 먼저 보내고 입력은 이어서 처리, 방 멤버면 방이 다 채워진 뒤에)
+void restore_conn(NetReactor *r, const UpgradeMessage *msg, const char *data, int fd) {
+    int member = restoring_room != NULL && msg->room_id == restoring_room->id;
+    User *user = NULL;
+    NetConn *conn = NULL;
+    if (msg->name[0] != '\0') {
+        pthread_mutex_lock(&user_mutex);
+        user = add_user(fd, msg->name);
+        pthread_mutex_unlock(&user_mutex);
+    }
+    if (msg->name[0] == '\0' || user != NULL) {
+        conn = net_conn_open(r, fd, net_frame_line, client_message, client_closed, user);
+    }
+    if (conn == NULL) {
+        if (user != NULL) {
+            pthread_mutex_lock(&user_mutex);
+            remove_user(fd);
+            pthread_mutex_unlock(&user_mutex);
+        }
+        close(fd);
+    } else {
+        if (user != NULL) {
+            user->directory_slot = shard_user_add(&shards, user->name);
+            user->is_ready = msg->is_ready;
+        }
+        if (user != NULL && member) {
+            pthread_mutex_lock(&room_mutex);
+            if (add_user_to_room(restoring_room, user) == 0) {
+                user->room_id = restoring_room->id;
+                if (msg->is_host) {
+                    restoring_room->host_fd = fd;
+                }
+            }
+            pthread_mutex_unlock(&room_mutex);
+        }
+        if (msg->output_len > 0) {
+            net_conn_send(conn, data + msg->input_len, msg->output_len);
+        }
+        if (user != NULL) {
+            send_session(user); // 이전 서버의 토큰은 이 서버에서 쓸 수 없으므로 새 토큰
+        }
+    }
+
+    if (!member) {
+        if (conn != NULL && net_conn_feed(conn, data, msg->input_len) < 0) {
+            net_conn_close(conn);
+        }
+        return;
+    }
+    PendingInput *pending = &restoring_input[restoring_count++];
+    pending->fd = conn != NULL ? fd : -1;
+    pending->len = msg->input_len <= sizeof(pending->data) ? msg->input_len : 0;
+    memcpy(pending->data, data, pending->len);
+    if (restoring_count >= restoring_members) {
+        finish_restoring_room();
+    }
+}
+
+// 새 서버: 이전 shard가 보낸 메시지 하나 반영
+void apply_upgrade_message(NetReactor *r, const UpgradeMessage *msg, const char *data, int fd) {
+    if (msg->type == UPGRADE_MSG_LISTENER && fd >= 0) {
+        int *listener = msg->listener == UPGRADE_LISTENER_TCP ? &tcp_listen_fd : &local_listen_fd;
+        if (*listener >= 0) {
+            close(*listener);
+        }
+        *listener = fd;
+    } else if (msg->type == UPGRADE_MSG_ROOM) {
+        if (restoring_room != NULL) {
+            finish_restoring_room();
+        }
+        restoring_room = restore_room(msg);
+        restoring_members = msg->members < ROOM_MAX_MEMBERS ? msg->members : ROOM_MAX_MEMBERS;
+        restoring_count = 0;
+    } else if (msg->type == UPGRADE_MSG_PENDING) {
+        shard_room_restore(&shards, msg->room_id, msg->name, msg->game_mode, msg->time_limit, msg->members);
+    } else if (msg->type == UPGRADE_MSG_USER && fd >= 0) {
+        restore_conn(r, msg, data, fd);
+    } else if (msg->type == UPGRADE_MSG_RESULT) {
+        submit_result(msg->game_mode, msg->name, msg->score);
+    } else if (fd >= 0) {
+        close(fd);
+    }
+}
+
+// 새 서버: GO를 보내고 이전 서버의 같은 번호 shard가 처음 넘기는 것 (DONE까지)을 받음, 실패 시 -1
+int receive_upgrade(void) {
+    static char data[UPGRADE_DATA_MAX];
+    UpgradeMessage msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.type = UPGRADE_MSG_GO;
+    if (upgrade_send(upgrade_from, &msg, NULL, -1) < 0) {
+        return -1;
+    }
+    while (1) {
+        int fd;
+        if (upgrade_receive(upgrade_from, &msg, data, sizeof(data), &fd) != 1) {
+            return -1;
+        }
+        if (msg.type == UPGRADE_MSG_DONE) {
+            return 0;
+        }
+        apply_upgrade_message(&reactor, &msg, data, fd);
+    }
+}
+
+// 새 서버: 이전 shard가 게임이 끝난 방과 결과를 보냄 (리액터가 부름), 이전 shard가 끝나면 정리
+void upgrade_inbox(NetReactor *r, int fd, void *arg) {
+    static char data[UPGRADE_DATA_MAX];
+    static ShardRoom rooms[SHARD_ROOMS];
+    (void)arg;
+    UpgradeMessage msg;
+    int pass_fd;
+    int received = upgrade_receive(fd, &msg, data, sizeof(data), &pass_fd);
+    if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return;
+    }
+    if (received == 1) {
+        apply_upgrade_message(r, &msg, data, pass_fd);
+        return;
+    }
+
+    net_reactor_remove(r, fd);
+    close(fd);
+    upgrade_from = -1;
+    if (restoring_room != NULL) {
+        finish_restoring_room();
+    }
+    // 게임 중에 모두 나가 넘어오지 않은 방은 목록에서 지움
+    int count = shard_room_list(&shards, rooms, SHARD_ROOMS);
+    pthread_mutex_lock(&room_mutex);
+    for (int i = 0; i < count; i++) {
+        if (rooms[i].shard == shards.index && find_room(rooms[i].id) == NULL) {
+            shard_room_remove(&shards, rooms[i].id);
+        }
+    }
+    pthread_mutex_unlock(&room_mutex);
+    printf("이전 서버의 shard %d가 넘기기를 마쳤습니다.\n", shards.index);
+    log_event("이전 서버의 shard %d가 넘기기를 마쳤습니다.\n", shards.index);
+}
+
+// 게임 시작 함수 (모든 클라이언트가 같은 단어를 만들도록 시드와 틱 일정을 함께 보냄)
+void start_game(Room *room) {
+    char schedule[128];
+    char msg[BUFFER_SIZE];
+
+    pthread_mutex_lock(&room_mutex);
+    room->time_limit = clamp_time_limit(room->time_limit);
+    // 지금 방에 있는 멤버의 슬롯만 이번 게임에 참여
+    memset(room->playing, 0, sizeof(room->playing));
+    memset(room->reported, 0, sizeof(room->reported));
+    room->players = 0;
+    room->reports = 0;
+    for (RoomUser *member = room->users; member != NULL; member = member->next) {
+        room->playing[member->slot] = 1;
+        room->scores[member->slot] = 0;
+        room->players++;
+    }
+
+    // 방마다 다른 시드, 플레이어마다 KILL 검증 상태 준비
+    reset_room_stream(room);
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    word_stream_default(&room->stream, ((uint64_t)ts.tv_sec << 32) ^ (uint64_t)ts.tv_nsec ^ ((uint64_t)room->id << 48));
+    for (RoomUser *member = room->users; member != NULL; member = member->next) {
+        word_stream_player_init(&member->play, &room->stream, room->time_limit);
+        room->live[member->slot] = 0;
+    }
+    // 제한 시간을 맞춰 두었으므로 WORD_STREAM_MAX_WORDS를 넘지 않음
+    room->charged_capacity = word_stream_spawned(&room->stream, word_stream_ticks(&room->stream, room->time_limit)) + 1;
+    memset(room->charged, 0, (size_t)room->charged_capacity);
+    room->charge_from = 0;
+    room->board_dirty = 0;
+    word_stream_format(&room->stream, schedule, sizeof(schedule));
+    room->game_started = 1;
+    room->game_over = 0; // 게임 종료 상태 초기화
+    room->stream_active = 1;
+    room->started_ms = timer_wheel_now_ms();
+
+    // 응답하지 않는 클라이언트가 있어도 제한 시간 + 유예가 지나면 서버가 끝냄
+    unsigned limit_ms = (unsigned)room->time_limit * 1000 + GAME_END_GRACE_MS;
+    room->ends_at_ms = room->started_ms + limit_ms;
+    timer_wheel_schedule(&room_timers, &room->end_timer, limit_ms);
+    timer_wheel_schedule(&room_timers, &room->board_timer, LEADERBOARD_INTERVAL_MS);
+    pthread_mutex_unlock(&room_mutex);
+
+    // 게임 시작 메시지 전송 (GAME_STARTED <시드> <틱ms> <생성 간격> <가속 간격> <높이>)
+    snprintf(msg, sizeof(msg), "GAME_STARTED %s\n", schedule);
+    broadcast_message(msg, room->id, -1);
+    printf("GAME_STARTED 메시지 브로드캐스트: %s", msg);
+    log_event("GAME_STARTED 메시지 브로드캐스트: %s", msg);
+}
+
+// 서버 종료 시 클린업 함수
+void cleanup_server(int signum) {
+    printf("\n서버 종료 시그널 수신. 클린업을 진행합니다...\n");
+    log_event("서버 종료 시그널 수신. 클린업을 진행합니다...\n");
+
+    // 시그널 핸들러 중복 호출 방지
+    static int cleanup_in_progress = 0;
+    if (cleanup_in_progress) {
+        printf("클린업이 이미 진행 중입니다. 강제 종료합니다.\n");
+        exit(1);
+    }
+    cleanup_in_progress = 1;
+
+    // 먼저 모든 소켓을 닫는다 (브로드캐스트 없이)
+    pthread_mutex_lock(&user_mutex);
+    User *current = user_head;
+    while (current != NULL) {
+        if (current->socket_fd >= 0) {
+            shutdown(current->socket_fd, SHUT_RDWR); // 소켓을 안전하게 닫기
+            close(current->socket_fd);
+        }
+        current = current->next;
+    }
+    pthread_mutex_unlock(&user_mutex);
+
+    // 방 메모리 해제
+    pthread_mutex_lock(&room_mutex);
+    Room *room_current = room_head;
+    while (room_current != NULL) {
+        // 방 내 사용자 목록 해제
+        RoomUser *room_user = room_current->users;
+        while (room_user != NULL) {
+            RoomUser *temp_room_user = room_user;
+            room_user = room_user->next;
+            word_stream_player_free(&temp_room_user->play);
+            slab_free(&room_user_pool, temp_room_user);
+        }
+
+        timer_wheel_cancel(&room_timers, &room_current->end_timer);
+        timer_wheel_cancel(&room_timers, &room_current->board_timer);
+
+        Room *temp_room = room_current;
+        room_current = room_current->next;
+        slab_free(&room_pool, temp_room);
+    }
+    room_head = NULL; // 헤드 포인터 초기화
+    pthread_mutex_unlock(&room_mutex);
+
+    // 사용자 메모리 해제
+    pthread_mutex_lock(&user_mutex);
+    User *user_current = user_head;
+    while (user_current != NULL) {
+        User *temp_user = user_current;
+        user_current = user_current->next;
+        slab_free(&user_pool, temp_user);
+    }
+    user_head = NULL; // 헤드 포인터 초기화
+    pthread_mutex_unlock(&user_mutex);
+
+    // 로그 파일 닫기
+    if (log_fp != NULL) {
+        fclose(log_fp);
+        log_fp = NULL;
+    }
+
+    printf("서버가 정상적으로 종료되었습니다.\n");
+    exit(0);
+}
+
+// 받자마자 거절 (한 줄만 보내고 닫음, 클라이언트가 이미 보낸 이름 때문에 RST로 거절 메시지가 사라지지 않도록
+// 다 보내고 닫는 연결로 등록, 등록하지 못하면 논블로킹으로 보내고 바로 닫음)
+void reject_connection(NetReactor *r, int fd, const char *reason) {
+    rejected_connections++;
+    NetConn *conn = net_conn_open(r, fd, net_frame_line, NULL, NULL, NULL); // 바로 닫는 중이 되므로 메시지 콜백은 불리지 않음
+    if (conn == NULL) {
+        send(fd, reason, strlen(reason), MSG_DONTWAIT | MSG_NOSIGNAL);
+        close(fd);
+        return;
+    }
+    net_conn_send(conn, reason, strlen(reason));
+    net_conn_close_flush(conn);
+}
+
+// 새 연결 등록 (첫 줄은 이름, 이후 줄은 명령)
+void client_accept(NetReactor *r, int fd, void *arg) {
+    (void)arg;
+    if (limits.max_connections > 0 && r->conn_count >= (size_t)limits.max_connections) {
+        reject_connection(r, fd, "ERROR 서버가 가득 찼습니다. 잠시 후 다시 접속하세요.\n");
+        return;
+    }
+    struct sockaddr_storage peer;
+    socklen_t peer_len = sizeof(peer);
+    if (getpeername(fd, (struct sockaddr *)&peer, &peer_len) == 0 && peer.ss_family == AF_INET &&
+        !admission_ip_allow(&ip_table, &limits, ((struct sockaddr_in *)&peer)->sin_addr.s_addr, timer_wheel_now_ms())) {
+        reject_connection(r, fd, "ERROR 접속이 너무 잦습니다. 잠시 후 다시 접속하세요.\n");
+        return;
+    }
+    printf("새로운 연결: 소켓 FD %d\n", fd);
+    log_event("새로운 연결: 소켓 FD %d\n", fd);
+    if (net_conn_open(r, fd, net_frame_line, client_message, client_closed, NULL) == NULL) {
+        close(fd);
+    }
+}
+
+// 사용자의 메시지 한 줄이 제한 안인지 (아니면 알리고 버림, 계속 넘으면 연결을 끊음)
+int admit_message(NetConn *conn, User *client, const char *buffer, size_t len) {
+    // 너무 긴 줄은 줄바꿈이 나올 때까지 버림 (읽기 버퍼보다 길면 여러 조각으로 옴)
+    int line_end = len > 0 && buffer[len - 1] == '\n';
+    if (client->discarding || len > (size_t)limits.max_message) {
+        if (!client->discarding) {
+            send_message(client->socket_fd, "ERROR 메시지가 너무 깁니다.\n");
+            rejected_messages++;
+        }
+        client->discarding = !line_end;
+        return 0;
+    }
+
+    uint64_t now = timer_wheel_now_ms();
+    if (token_bucket_take(&client->messages, limits.message_rate, limits.message_burst, now)) {
+        client->dropped = 0;
+        return 1;
+    }
+    rejected_messages++;
+    if (++client->dropped > limits.message_burst * 4) {
+        log_event("메시지를 너무 빨리 보내 연결을 끊습니다: %s\n", client->name);
+        send_message(client->socket_fd, "ERROR 메시지를 너무 빨리 보내 연결을 끊습니다.\n");
+        net_conn_close_flush(conn);
+        return 0;
+    }
+    if (now - client->warned_ms >= 1000) {
+        client->warned_ms = now;
+        send_message(client->socket_fd, "ERROR 메시지를 너무 빨리 보냅니다.\n");
+    }
+    return 0;
+}
+
+// 클라이언트가 보낸 한 줄 처리 (이름을 받기 전이면 이름으로, 그 뒤로는 명령으로)
+void client_message(NetConn *conn, char *buffer, size_t len) {
+    int socket_fd = conn->fd;
+    // PING에 대한 답은 받은 것만으로 충분 (하트비트가 받은 시각을 기록함)
+    if (strcmp(buffer, "PONG\n") == 0 || strcmp(buffer, "PONG\r\n") == 0) {
+        return;
+    }
+    if (conn->user != NULL) {
+        User *client = conn->user;
+        if (!admit_message(conn, client, buffer, len)) {
+            return;
+        }
+        printf("받은 메시지 from %s: %s", client->name, buffer);
+        log_event("받은 메시지 from %s: %s", client->name, buffer);
+        handle_command(client, buffer);
+        return;
+    }
+
+    // 클라이언트로부터 이름 수신 (제한보다 긴 줄이면 끊음)
+    if (len > (size_t)limits.max_message) {
+        send_message(socket_fd, "ERROR 메시지가 너무 깁니다.\n");
+        net_conn_close_flush(conn);
+        return;
+    }
+    // 이름 대신 재접속 토큰이면 끊기 전의 사용자로 이어서
+    if (strncmp(buffer, "/resume ", 8) == 0) {
+        resume_session(conn, buffer, len);
+        return;
+    }
+    char name[50] = {0};
+    strncpy(name, buffer, sizeof(name) - 1);
+    name[sizeof(name) - 1] = '\0';
+    name[strcspn(name, "\r\n")] = '\0';
 
     printf("사용자 이름 수신: %s (소켓 FD %d)\n", name, socket_fd);
     log_event("사용자 이름 수신: %s (소켓 FD %d)\n", name, socket_fd);
 
     // 사용자 추가
     pthread_mutex_lock(&user_mutex);
-    add_user(socket_fd, name);
+    User *user = add_user(socket_fd, name);
     pthread_mutex_unlock(&user_mutex);
+    if (user == NULL) {
+        net_conn_close(conn);
+        return;
+    }
+    user->directory_slot = shard_user_add(&shards, name);
+    conn->user = user;
 
     // 환영 메시지 전송 (WELCOME <name>)
     char welcome_msg[BUFFER_SIZE];
@@ -476,457 +1755,552 @@ void *client_handler(void *arg) {
     send_message(socket_fd, welcome_msg);
     printf("환영 메시지 전송: %s", welcome_msg);
     log_event("환영 메시지 전송: %s", welcome_msg);
+    send_session(user);
+}
 
-    // 메인 루프
-    while ((bytes_read = recv(socket_fd, buffer, sizeof(buffer) - 1, 0)) > 0) {
-        buffer[bytes_read] = '\0';
-        printf("받은 메시지 from %s: %s", name, buffer);
-        log_event("받은 메시지 from %s: %s", name, buffer);
-
-        // 메시지 파싱
-        if (strncmp(buffer, "/create_room ", 13) == 0) {
-            char room_name[100];
-            sscanf(buffer + 13, "%99[^\n]", room_name);
-            printf("명령어: /create_room, 방 이름: %s\n", room_name);
-            log_event("명령어: /create_room, 방 이름: %s\n", room_name);
-
-            // 방 생성
-            pthread_mutex_lock(&room_mutex);
-            Room *new_room = create_room(room_name, name, socket_fd);
-            pthread_mutex_unlock(&room_mutex);
+// 명령 한 줄 처리 (리액터 스레드에서 호출)
+void handle_command(User *client, char *buffer) {
+    const char *name = client->name;
+    int socket_fd = client->socket_fd;
+    int current_room_id = client->room_id; // 사용자가 속한 방 ID
+
+    // 메시지 파싱
+    if (strncmp(buffer, "/create_room ", 13) == 0) {
+        char room_name[100];
+        sscanf(buffer + 13, "%99[^\n]", room_name);
+        printf("명령어: /create_room, 방 이름: %s\n", room_name);
+        log_event("명령어: /create_room, 방 이름: %s\n", room_name);
+
+        // 방 수 제한 (모든 shard 합계)
+        if (shard_room_count(&shards) >= limits.max_rooms) {
+            char msg[BUFFER_SIZE];
+            snprintf(msg, sizeof(msg), "ERROR 방을 더 만들 수 없습니다 (최대 %d개).\n", limits.max_rooms);
+            send_message(socket_fd, msg);
+            return;
+        }
 
-            if (new_room) {
-                // 방 생성 메시지 전송 (ROOM_CREATED <room_id> <room_name>)
-                char msg[BUFFER_SIZE];
-                snprintf(msg, sizeof(msg), "ROOM_CREATED %d %s\n", new_room->id, new_room->name);
-                send_message(socket_fd, msg);
-                printf("방 생성 메시지 전송: %s", msg);
-                log_event("방 생성 메시지 전송: %s", msg);
-
-                // 자동으로 방장(호스트)을 방에 참여시킴
-                pthread_mutex_lock(&room_mutex);
-                Room *room = find_room(new_room->id);
-                pthread_mutex_unlock(&room_mutex);
+        // 방 생성
+        pthread_mutex_lock(&room_mutex);
+        Room *new_room = create_room(room_name, name, socket_fd);
+        pthread_mutex_unlock(&room_mutex);
 
-                if (room) {
-                    pthread_mutex_lock(&user_mutex);
-                    User *host_user = find_user(socket_fd);
-                    pthread_mutex_unlock(&user_mutex);
-
-                    if (host_user) {
-                        pthread_mutex_lock(&room_mutex);
-                        add_user_to_room(room, host_user);
-                        host_user->room_id = room->id;
-                        pthread_mutex_unlock(&room_mutex);
-
-                        current_room_id = room->id;
-                        printf("사용자 %s가 방 ID %d에 참여했습니다.\n", name, room->id);
-                        log_event("사용자 %s가 방 ID %d에 참여했습니다.\n", name, room->id);
-
-                        // 사용자 입장 메시지 전송 (USER_JOINED <name>)
-                        char join_msg[BUFFER_SIZE];
-                        snprintf(join_msg, sizeof(join_msg), "USER_JOINED %s\n", host_user->name);
-                        broadcast_message(join_msg, room->id, socket_fd); // exclude_fd를 발신자 제외
-                        printf("USER_JOINED 메시지 브로드캐스트: %s", join_msg);
-                        log_event("USER_JOINED 메시지 브로드캐스트: %s", join_msg);
-                    }
-                }
-            } else {
-                send_message(socket_fd, "ERROR 방 생성에 실패했습니다.\n");
-                printf("방 생성 실패 메시지 전송\n");
-                log_event("방 생성 실패 메시지 전송\n");
-            }
-        } else if (strncmp(buffer, "/join_room ", 11) == 0) {
-            int room_id;
-            sscanf(buffer + 11, "%d", &room_id);
-            printf("명령어: /join_room, 방 ID: %d\n", room_id);
-            log_event("명령어: /join_room, 방 ID: %d\n", room_id);
+        if (new_room) {
+            // 방 생성 메시지 전송 (ROOM_CREATED <room_id> <room_name>)
+            char msg[BUFFER_SIZE];
+            snprintf(msg, sizeof(msg), "ROOM_CREATED %d %s\n", new_room->id, new_room->name);
+            send_message(socket_fd, msg);
+            printf("방 생성 메시지 전송: %s", msg);
+            log_event("방 생성 메시지 전송: %s", msg);
 
+            // 자동으로 방장(호스트)을 방에 참여시킴
             pthread_mutex_lock(&room_mutex);
-            Room *room = find_room(room_id);
+            Room *room = find_room(new_room->id);
             pthread_mutex_unlock(&room_mutex);
 
             if (room) {
                 pthread_mutex_lock(&user_mutex);
-                User *user = find_user(socket_fd);
+                User *host_user = find_user(socket_fd);
                 pthread_mutex_unlock(&user_mutex);
 
-                if (user->room_id != -1) {
-                    send_message(socket_fd, "ERROR 이미 방에 참여 중입니다.\n");
-                    printf("이미 방에 참여 중임을 알리는 메시지 전송\n");
-                    log_event("이미 방에 참여 중임을 알리는 메시지 전송\n");
-                    continue;
+                if (host_user) {
+                    pthread_mutex_lock(&room_mutex);
+                    add_user_to_room(room, host_user); // 새 방이므로 자리는 항상 있음
+                    host_user->room_id = room->id;
+                    pthread_mutex_unlock(&room_mutex);
+
+                    printf("사용자 %s가 방 ID %d에 참여했습니다.\n", name, room->id);
+                    log_event("사용자 %s가 방 ID %d에 참여했습니다.\n", name, room->id);
+
+                    // 사용자 입장 메시지 전송 (USER_JOINED <name>)
+                    char join_msg[BUFFER_SIZE];
+                    snprintf(join_msg, sizeof(join_msg), "USER_JOINED %s\n", host_user->name);
+                    broadcast_message(join_msg, room->id, socket_fd); // exclude_fd를 발신자 제외
+                    printf("USER_JOINED 메시지 브로드캐스트: %s", join_msg);
+                    log_event("USER_JOINED 메시지 브로드캐스트: %s", join_msg);
                 }
+            }
+        } else {
+            send_message(socket_fd, "ERROR 방 생성에 실패했습니다.\n");
+            printf("방 생성 실패 메시지 전송\n");
+            log_event("방 생성 실패 메시지 전송\n");
+        }
+    } else if (strncmp(buffer, "/join_room ", 11) == 0) {
+        int room_id;
+        sscanf(buffer + 11, "%d", &room_id);
+        printf("명령어: /join_room, 방 ID: %d\n", room_id);
+        log_event("명령어: /join_room, 방 ID: %d\n", room_id);
+
+        // 다른 shard의 방이면 연결을 그 shard로 넘기고, 이 명령은 그 shard가 처리
+        int owner = shard_room_owner(&shards, room_id);
+        if (owner >= 0 && owner != shards.index) {
+            if (current_room_id != -1) {
+                send_message(socket_fd, "ERROR 이미 방에 참여 중입니다.\n");
+                printf("이미 방에 참여 중임을 알리는 메시지 전송\n");
+                log_event("이미 방에 참여 중임을 알리는 메시지 전송\n");
+            } else if (hand_off_conn(net_conn_of(&reactor, socket_fd), owner, buffer, strlen(buffer)) < 0) {
+                send_message(socket_fd, "ERROR 잠시 후 다시 시도하세요.\n");
+                log_event("shard %d로 넘기기 실패: 사용자=%s\n", owner, name);
+            }
+            return;
+        }
 
-                pthread_mutex_lock(&room_mutex);
-                add_user_to_room(room, user);
-                user->room_id = room->id;
-                pthread_mutex_unlock(&room_mutex);
+        pthread_mutex_lock(&room_mutex);
+        Room *room = find_room(room_id);
+        pthread_mutex_unlock(&room_mutex);
 
-                current_room_id = room_id;
-                printf("사용자 %s가 방 ID %d에 참여했습니다.\n", name, room_id);
-                log_event("사용자 %s가 방 ID %d에 참여했습니다.\n", name, room_id);
+        if (room) {
+            pthread_mutex_lock(&user_mutex);
+            User *user = find_user(socket_fd);
+            pthread_mutex_unlock(&user_mutex);
 
-                // 사용자 입장 메시지 전송 (USER_JOINED <name>)
-                char msg[BUFFER_SIZE];
-                snprintf(msg, sizeof(msg), "USER_JOINED %s\n", user->name);
-                broadcast_message(msg, room_id, socket_fd); // exclude_fd를 발신자 제외
-                printf("USER_JOINED 메시지 브로드캐스트: %s", msg);
-                log_event("USER_JOINED 메시지 브로드캐스트: %s", msg);
-            } else {
-                send_message(socket_fd, "ERROR 존재하지 않는 방 ID입니다.\n");
-                printf("존재하지 않는 방 ID 메시지 전송\n");
-                log_event("존재하지 않는 방 ID 메시지 전송\n");
-            }
-        } else if (strncmp(buffer, "/chat ", 6) == 0) {
-            if (current_room_id == -1) {
-                send_message(socket_fd, "ERROR 방에 먼저 참여해야 합니다.\n");
-                printf("방에 참여하지 않은 상태에서 채팅 시도\n");
-                log_event("방에 참여하지 않은 상태에서 채팅 시도\n");
-                continue;
+            if (user->room_id != -1) {
+                send_message(socket_fd, "ERROR 이미 방에 참여 중입니다.\n");
+                printf("이미 방에 참여 중임을 알리는 메시지 전송\n");
+                log_event("이미 방에 참여 중임을 알리는 메시지 전송\n");
+                return;
             }
 
-            char chat_msg[2000]; // 채팅 메시지 길이 제한
+            pthread_mutex_lock(&room_mutex);
+            if (add_user_to_room(room, user) < 0) {
+                pthread_mutex_unlock(&room_mutex);
+                send_message(socket_fd, "ERROR 방이 가득 찼습니다.\n");
+                printf("방이 가득 참 메시지 전송\n");
+                log_event("방이 가득 참 메시지 전송\n");
+                return;
+            }
+            user->room_id = room->id;
+            pthread_mutex_unlock(&room_mutex);
 
-            // 채팅 메시지의 길이를 제한하여 버퍼 오버플로우 방지
-            sscanf(buffer + 6, "%1999[^\n]", chat_msg);
-            printf("명령어: /chat, 메시지: %s\n", chat_msg);
-            log_event("명령어: /chat, 메시지: %s\n", chat_msg);
+            printf("사용자 %s가 방 ID %d에 참여했습니다.\n", name, room_id);
+            log_event("사용자 %s가 방 ID %d에 참여했습니다.\n", name, room_id);
 
-            // 채팅 메시지 브로드캐스트 (CHAT <name>: <message>)
-            char formatted_msg[BUFFER_SIZE];
-            // snprintf을 사용하여 버퍼 오버플로우 방지
-            snprintf(formatted_msg, sizeof(formatted_msg), "CHAT %s: %s\n", name, chat_msg);
-            broadcast_message(formatted_msg, current_room_id, -1);
-            printf("CHAT 메시지 브로드캐스트: %s", formatted_msg);
-            log_event("CHAT 메시지 브로드캐스트: %s", formatted_msg);
+            // 사용자 입장 메시지 전송 (USER_JOINED <name>)
+            char msg[BUFFER_SIZE];
+            snprintf(msg, sizeof(msg), "USER_JOINED %s\n", user->name);
+            broadcast_message(msg, room_id, socket_fd); // exclude_fd를 발신자 제외
+            printf("USER_JOINED 메시지 브로드캐스트: %s", msg);
+            log_event("USER_JOINED 메시지 브로드캐스트: %s", msg);
+        } else if (owner == shards.index) {
+            // 이전 서버에서 게임 중이라 아직 넘어오지 않은 방 (게임이 끝나면 넘어옴)
+            send_message(socket_fd, "ERROR 잠시 후 다시 시도하세요.\n");
+            log_event("아직 넘어오지 않은 방 ID %d에 참여 시도\n", room_id);
+        } else {
+            send_message(socket_fd, "ERROR 존재하지 않는 방 ID입니다.\n");
+            printf("존재하지 않는 방 ID 메시지 전송\n");
+            log_event("존재하지 않는 방 ID 메시지 전송\n");
+        }
+    } else if (strncmp(buffer, "/chat ", 6) == 0) {
+        if (current_room_id == -1) {
+            send_message(socket_fd, "ERROR 방에 먼저 참여해야 합니다.\n");
+            printf("방에 참여하지 않은 상태에서 채팅 시도\n");
+            log_event("방에 참여하지 않은 상태에서 채팅 시도\n");
+            return;
         }
 
-        // GAME_OVER 처리 (점수 없이)
-        else if (strncmp(buffer, "GAME_OVER", 9) == 0 && strlen(buffer) == 9) {
-            log_event("GAME_OVER 메시지를 처리 중입니다. 발신자: 소켓 FD %d\n", socket_fd);
+        char chat_msg[2000]; // 채팅 메시지 길이 제한
 
-            // 모든 클라이언트에게 게임 종료 메시지 전송
-            handle_gameover_all_clients(socket_fd);
-            continue;
-        }
+        // 채팅 메시지의 길이를 제한하여 버퍼 오버플로우 방지
+        sscanf(buffer + 6, "%1999[^\n]", chat_msg);
+        printf("명령어: /chat, 메시지: %s\n", chat_msg);
+        log_event("명령어: /chat, 메시지: %s\n", chat_msg);
 
-        //***********************************************
+        // 채팅 메시지 브로드캐스트 (CHAT <name>: <message>)
+        char formatted_msg[BUFFER_SIZE];
+        // snprintf을 사용하여 버퍼 오버플로우 방지
+        snprintf(formatted_msg, sizeof(formatted_msg), "CHAT %s: %s\n", name, chat_msg);
+        broadcast_message(formatted_msg, current_room_id, -1);
+        printf("CHAT 메시지 브로드캐스트: %s", formatted_msg);
+        log_event("CHAT 메시지 브로드캐스트: %s", formatted_msg);
+    }
 
-        else if (strncmp(buffer, "GAME_OVER ", 10) == 0) {
-            // GAME_OVER 처리
-            if (current_room_id == -1) {
-                send_message(socket_fd, "ERROR 방에 먼저 참여해야 합니다.\n");
-                printf("방에 참여하지 않은 상태에서 GAME_OVER 시도\n");
-                log_event("방에 참여하지 않은 상태에서 GAME_OVER 시도\n");
-                continue;
-            }
+    // GAME_OVER 처리 (점수 없이)
+    else if (strncmp(buffer, "GAME_OVER", 9) == 0 && strlen(buffer) == 9) {
+        log_event("GAME_OVER 메시지를 처리 중입니다. 발신자: 소켓 FD %d\n", socket_fd);
 
-            int user_score;
-            sscanf(buffer + 10, "%d", &user_score);
-            printf("명령어: GAME_OVER, 점수: %d\n", user_score);
-            log_event("명령어: GAME_OVER, 점수: %d\n", user_score);
+        // 모든 클라이언트에게 게임 종료 메시지 전송
+        handle_gameover_all_clients(socket_fd);
+        return;
+    }
 
-            // 현재 사용자가 속한 방 찾기
-            pthread_mutex_lock(&room_mutex);
-            Room *current_room = find_room(current_room_id);
-            if (current_room == NULL) {
-                pthread_mutex_unlock(&room_mutex);
-                send_message(socket_fd, "ERROR 방을 찾을 수 없습니다.\n");
-                printf("방을 찾을 수 없음 메시지 전송\n");
-                log_event("방을 찾을 수 없음 메시지 전송\n");
-                continue;
-            }
+    //***********************************************
 
-            // 게임이 이미 종료되었는지 확인
-            if (current_room->game_over == 1) {
-                pthread_mutex_unlock(&room_mutex);
-                send_message(socket_fd, "ERROR 게임이 이미 종료되었습니다.\n");
-                printf("게임이 이미 종료됨 메시지 전송\n");
-                log_event("게임이 이미 종료됨 메시지 전송\n");
-                continue;
-            }
+    else if (strncmp(buffer, "GAME_OVER ", 10) == 0) {
+        // GAME_OVER 처리
+        if (current_room_id == -1) {
+            send_message(socket_fd, "ERROR 방에 먼저 참여해야 합니다.\n");
+            printf("방에 참여하지 않은 상태에서 GAME_OVER 시도\n");
+            log_event("방에 참여하지 않은 상태에서 GAME_OVER 시도\n");
+            return;
+        }
 
-            // 점수 기록
-            pthread_mutex_lock(&user_mutex);
-            User *user = find_user(socket_fd);
-            pthread_mutex_unlock(&user_mutex);
+        int user_score = 0, user_tick = -1; // 틱은 공용 단어 흐름을 쓰는 클라이언트만 보냄
+        sscanf(buffer + 10, "%d %d", &user_score, &user_tick);
+        printf("명령어: GAME_OVER, 점수: %d\n", user_score);
+        log_event("명령어: GAME_OVER, 점수: %d\n", user_score);
+
+        // 점수 기록 (모두 보냈거나 목표 점수에 도달하면 승자 발표)
+        report_score(socket_fd, current_room_id, user_score, user_tick);
+    } else if (strncmp(buffer, "KILL ", 5) == 0) {
+        // 공용 단어 흐름에서 맞힌 단어 보고 (KILL <틱> <단어 id>), 응답 없이 검증만 함
+        int tick, word_id;
+        if (current_room_id == -1 || sscanf(buffer + 5, "%d %d", &tick, &word_id) != 2) {
+            log_event("잘못된 KILL: %s", buffer);
+            return;
+        }
 
-            if (user == NULL) {
-                pthread_mutex_unlock(&room_mutex);
-                send_message(socket_fd, "ERROR 사용자를 찾을 수 없습니다.\n");
-                printf("사용자를 찾을 수 없음 메시지 전송\n");
-                log_event("사용자를 찾을 수 없음 메시지 전송\n");
-                continue;
+        pthread_mutex_lock(&room_mutex);
+        Room *current_room = find_room(current_room_id);
+        RoomUser *member = current_room != NULL ? find_room_user(current_room, socket_fd) : NULL;
+        int points = -1, now_tick = 0;
+        if (member != NULL && current_room->stream_active) {
+            now_tick = room_tick(current_room);
+            points = word_stream_player_kill(&member->play, &current_room->stream, tick, word_id, now_tick);
+            if (points >= 0) {
+                room_apply_kill(current_room, member, word_id, points);
             }
+        }
+        pthread_mutex_unlock(&room_mutex);
 
-            add_score(current_room, user, user_score);
+        if (points < 0) {
+            log_event("KILL 거부: 사용자=%s, 틱=%d, 단어=%d, 서버 틱=%d\n", name, tick, word_id, now_tick);
+        } else {
+            log_event("KILL 인정: 사용자=%s, 틱=%d, 단어=%d, +%d\n", name, tick, word_id, points);
+        }
+    } else if (strncmp(buffer, "/set_game ", 10) == 0) {
+        if (current_room_id == -1) {
+            send_message(socket_fd, "ERROR 방에 먼저 참여해야 합니다.\n");
+            printf("방에 참여하지 않은 상태에서 게임 설정 시도\n");
+            log_event("방에 참여하지 않은 상태에서 게임 설정 시도\n");
+            return;
+        }
 
-            // 게임 종료 상태로 설정
-            current_room->game_over = 1;
+        char game_mode[50];
+        int time_limit;
+        int parsed = sscanf(buffer + 10, "%49s %d", game_mode, &time_limit);
 
-            // 승자 결정
-            ScoreNode *max_score_node = current_room->scores;
-            ScoreNode *iter = current_room->scores->next;
-            while (iter != NULL) {
-                if (iter->score > max_score_node->score) {
-                    max_score_node = iter;
-                }
-                iter = iter->next;
-            }
+        if (parsed < 2) {
+            send_message(socket_fd, "ERROR 올바른 형식으로 입력하세요. 예: /set_game <모드> <시간>\n");
+            printf("잘못된 /set_game 명령어 형식\n");
+            log_event("잘못된 /set_game 명령어 형식\n");
+            return;
+        }
 
-            // 승자 메시지 브로드캐스트 (발신자 제외)
-            char winner_msg[BUFFER_SIZE];
-            snprintf(winner_msg, sizeof(winner_msg), "GAME_OVER\n승자가 결정되었습니다: %s님!\n", max_score_node->user->name);
-            broadcast_message(winner_msg, current_room_id, socket_fd); // exclude_fd를 발신자 제외
-            printf("GAME_OVER 메시지 브로드캐스트: %s", winner_msg);
-            log_event("GAME_OVER 메시지 브로드캐스트: %s", winner_msg);
+        if (time_limit < GAME_TIME_LIMIT_MIN || time_limit > GAME_TIME_LIMIT_MAX) {
+            char error[BUFFER_SIZE];
+            snprintf(error, sizeof(error), "ERROR 제한 시간은 %d~%d초 사이로 입력하세요.\n", GAME_TIME_LIMIT_MIN,
+                     GAME_TIME_LIMIT_MAX);
+            send_message(socket_fd, error);
+            log_event("범위를 벗어난 제한 시간: %d\n", time_limit);
+            return;
+        }
 
-            // 게임 상태 초기화
-            current_room->game_started = 0;
+        printf("명령어: /set_game, 모드: %s, 시간 제한: %d\n", game_mode, time_limit);
+        log_event("명령어: /set_game, 모드: %s, 시간 제한: %d\n", game_mode, time_limit);
 
-            // 점수 목록 초기화
-            ScoreNode *temp;
-            while (current_room->scores != NULL) {
-                temp = current_room->scores;
-                current_room->scores = current_room->scores->next;
-                free(temp);
-            }
-            pthread_mutex_unlock(&room_mutex);
-        } else if (strncmp(buffer, "/set_game ", 10) == 0) {
-            if (current_room_id == -1) {
-                send_message(socket_fd, "ERROR 방에 먼저 참여해야 합니다.\n");
-                printf("방에 참여하지 않은 상태에서 게임 설정 시도\n");
-                log_event("방에 참여하지 않은 상태에서 게임 설정 시도\n");
-                continue;
-            }
+        pthread_mutex_lock(&room_mutex);
+        Room *current_room = find_room(current_room_id);
+        pthread_mutex_unlock(&room_mutex);
 
-            char game_mode[50];
-            int time_limit;
-            int parsed = sscanf(buffer + 10, "%49s %d", game_mode, &time_limit);
+        if (current_room == NULL) {
+            send_message(socket_fd, "ERROR 방을 찾을 수 없습니다.\n");
+            printf("방을 찾을 수 없음 메시지 전송\n");
+            log_event("방을 찾을 수 없음 메시지 전송\n");
+            return;
+        }
 
-            if (parsed < 2) {
-                send_message(socket_fd, "ERROR 올바른 형식으로 입력하세요. 예: /set_game <모드> <시간>\n");
-                printf("잘못된 /set_game 명령어 형식\n");
-                log_event("잘못된 /set_game 명령어 형식\n");
-                continue;
-            }
+        // 방장이 아닌 경우
+        if (current_room->host_fd != socket_fd) {
+            send_message(socket_fd, "ERROR 게임 설정은 방장만 할 수 있습니다.\n");
+            printf("방장이 아닌 사용자가 게임 설정 시도\n");
+            log_event("방장이 아닌 사용자가 게임 설정 시도\n");
+            return;
+        }
 
-            printf("명령어: /set_game, 모드: %s, 시간 제한: %d\n", game_mode, time_limit);
-            log_event("명령어: /set_game, 모드: %s, 시간 제한: %d\n", game_mode, time_limit);
+        // 게임 설정 업데이트 (진행 중인 게임의 끝은 방 타이머가 정하므로 게임 중에는 바꾸지 않음)
+        pthread_mutex_lock(&room_mutex);
+        if (current_room->game_started && !current_room->game_over) {
+            pthread_mutex_unlock(&room_mutex);
+            send_message(socket_fd, "ERROR 게임 중에는 설정을 바꿀 수 없습니다.\n");
+            log_event("게임 중 설정 변경 거부: 방 ID=%d\n", current_room_id);
+            return;
+        }
+        strncpy(current_room->game_mode, game_mode, sizeof(current_room->game_mode) - 1);
+        current_room->game_mode[sizeof(current_room->game_mode) - 1] = '\0';
+        current_room->time_limit = time_limit;
+        current_room->ready_count = 0; // 초기화
+        current_room->game_started = 0;
+        publish_room(current_room);
+        pthread_mutex_unlock(&room_mutex);
+        printf("게임 설정 업데이트: 모드=%s, 시간 제한=%d\n", current_room->game_mode, current_room->time_limit);
+        log_event("게임 설정 업데이트: 모드=%s, 시간 제한=%d\n", current_room->game_mode, current_room->time_limit);
+
+        // 게임 설정 완료 메시지 전송 (GAME_SETTINGS <game_mode> <time_limit>)
+        char msg[BUFFER_SIZE];
+        snprintf(msg, sizeof(msg), "GAME_SETTINGS %s %d\n", current_room->game_mode, current_room->time_limit);
+        broadcast_message(msg, current_room_id, socket_fd); // exclude_fd를 발신자 제외
+        printf("GAME_SETTINGS 메시지 브로드캐스트: %s", msg);
+        log_event("GAME_SETTINGS 메시지 브로드캐스트: %s", msg);
+    } else if (strncmp(buffer, "/ready", 6) == 0) {
+        if (current_room_id == -1) {
+            send_message(socket_fd, "ERROR 방에 먼저 참여해야 합니다.\n");
+            printf("방에 참여하지 않은 상태에서 READY 시도\n");
+            log_event("방에 참여하지 않은 상태에서 READY 시도\n");
+            return;
+        }
 
-            pthread_mutex_lock(&room_mutex);
-            Room *current_room = find_room(current_room_id);
+        pthread_mutex_lock(&room_mutex);
+        Room *current_room = find_room(current_room_id);
+        if (current_room == NULL) {
             pthread_mutex_unlock(&room_mutex);
+            send_message(socket_fd, "ERROR 방을 찾을 수 없습니다.\n");
+            printf("방을 찾을 수 없음 메시지 전송\n");
+            log_event("방을 찾을 수 없음 메시지 전송\n");
+            return;
+        }
 
-            if (current_room == NULL) {
-                send_message(socket_fd, "ERROR 방을 찾을 수 없습니다.\n");
-                printf("방을 찾을 수 없음 메시지 전송\n");
-                log_event("방을 찾을 수 없음 메시지 전송\n");
-                continue;
-            }
+        // 사용자의 준비 상태 확인
+        pthread_mutex_lock(&user_mutex);
+        User *user = find_user(socket_fd);
+        if (user->is_ready) {
+            pthread_mutex_unlock(&user_mutex);
+            send_message(socket_fd, "ERROR 이미 READY 상태입니다.\n");
+            printf("이미 READY 상태임을 알리는 메시지 전송\n");
+            log_event("이미 READY 상태임을 알리는 메시지 전송\n");
+            pthread_mutex_unlock(&room_mutex);
+            return;
+        }
+        user->is_ready = 1;
+        pthread_mutex_unlock(&user_mutex);
 
-            // 방장이 아닌 경우
-            if (current_room->host_fd != socket_fd) {
-                send_message(socket_fd, "ERROR 게임 설정은 방장만 할 수 있습니다.\n");
-                printf("방장이 아닌 사용자가 게임 설정 시도\n");
-                log_event("방장이 아닌 사용자가 게임 설정 시도\n");
-                continue;
-            }
+        current_room->ready_count += 1;
+        int total_users = 0;
+        RoomUser *user_iter = current_room->users;
+        while (user_iter != NULL) {
+            total_users++;
+            user_iter = user_iter->next;
+        }
 
-            // 게임 설정 업데이트
-            pthread_mutex_lock(&room_mutex);
-            strncpy(current_room->game_mode, game_mode, sizeof(current_room->game_mode) - 1);
-            current_room->game_mode[sizeof(current_room->game_mode) - 1] = '\0';
-            current_room->time_limit = time_limit;
-            current_room->ready_count = 0; // 초기화
-            current_room->game_started = 0;
-            pthread_mutex_unlock(&room_mutex);
-            printf("게임 설정 업데이트: 모드=%s, 시간 제한=%d\n", current_room->game_mode, current_room->time_limit);
-            log_event("게임 설정 업데이트: 모드=%s, 시간 제한=%d\n", current_room->game_mode, current_room->time_limit);
+        int ready_all = (current_room->ready_count >= total_users);
+        pthread_mutex_unlock(&room_mutex);
 
-            // 게임 설정 완료 메시지 전송 (GAME_SETTINGS <game_mode> <time_limit>)
-            char msg[BUFFER_SIZE];
-            snprintf(msg, sizeof(msg), "GAME_SETTINGS %s %d\n", current_room->game_mode, current_room->time_limit);
-            broadcast_message(msg, current_room_id, socket_fd); // exclude_fd를 발신자 제외
-            printf("GAME_SETTINGS 메시지 브로드캐스트: %s", msg);
-            log_event("GAME_SETTINGS 메시지 브로드캐스트: %s", msg);
-        } else if (strncmp(buffer, "/ready", 6) == 0) {
-            if (current_room_id == -1) {
-                send_message(socket_fd, "ERROR 방에 먼저 참여해야 합니다.\n");
-                printf("방에 참여하지 않은 상태에서 READY 시도\n");
-                log_event("방에 참여하지 않은 상태에서 READY 시도\n");
-                continue;
-            }
+        printf("사용자 %s가 READY 상태 (%d/%d)\n", name, current_room->ready_count, total_users);
+        log_event("사용자 %s가 READY 상태 (%d/%d)\n", name, current_room->ready_count, total_users);
 
-            pthread_mutex_lock(&room_mutex);
-            Room *current_room = find_room(current_room_id);
-            if (current_room == NULL) {
-                pthread_mutex_unlock(&room_mutex);
-                send_message(socket_fd, "ERROR 방을 찾을 수 없습니다.\n");
-                printf("방을 찾을 수 없음 메시지 전송\n");
-                log_event("방을 찾을 수 없음 메시지 전송\n");
-                continue;
-            }
+        if (ready_all && !current_room->game_started) {
+            // 게임 시작 로직 호출 (GAME_STARTED는 start_game에서 시드와 함께 전송)
+            start_game(current_room);
+        } else {
+            send_message(socket_fd, "레디되었습니다. 모든 플레이어가 레디를 입력하면 게임이 시작됩니다.\n");
+            printf("레디 메시지 전송\n");
+            log_event("레디 메시지 전송\n");
+        }
+    } else if (strncmp(buffer, "/game_list", 10) == 0) {
+        printf("명령어: /game_list\n");
+        log_event("명령어: /game_list\n");
+        send_game_list(socket_fd);
+        printf("GAME_LIST 메시지 전송\n");
+        log_event("GAME_LIST 메시지 전송\n");
+    } else if (strncmp(buffer, "/help", 5) == 0) {
+        printf("명령어: /help\n");
+        log_event("명령어: /help\n");
+        send_help_message(socket_fd);
+        printf("HELP 메시지 전송\n");
+        log_event("HELP 메시지 전송\n");
+    } else if (strncmp(buffer, "/list", 5) == 0) {
+        printf("명령어: /list\n");
+        log_event("명령어: /list\n");
+        send_room_list(socket_fd);
+        printf("방 목록 전송\n");
+        log_event("방 목록 전송\n");
+    } else if (strncmp(buffer, "/top", 4) == 0 && (buffer[4] == ' ' || buffer[4] == '\n' || buffer[4] == '\0')) {
+        printf("명령어: /top\n");
+        log_event("명령어: /top\n");
+        send_top_list(socket_fd, buffer + 4);
+    } else if (strncmp(buffer, "/rank", 5) == 0 && (buffer[5] == ' ' || buffer[5] == '\n' || buffer[5] == '\0')) {
+        printf("명령어: /rank\n");
+        log_event("명령어: /rank\n");
+        send_rank(socket_fd, name, buffer + 5);
+    } else if (strncmp(buffer, "SCORE ", 6) == 0) {
+        if (current_room_id == -1) {
+            send_message(socket_fd, "ERROR 방에 먼저 참여해야 합니다.\n");
+            printf("방에 참여하지 않은 상태에서 SCORE 시도\n");
+            log_event("방에 참여하지 않은 상태에서 SCORE 시도\n");
+            return;
+        }
 
-            // 사용자의 준비 상태 확인
-            pthread_mutex_lock(&user_mutex);
-            User *user = find_user(socket_fd);
-            if (user->is_ready) {
-                pthread_mutex_unlock(&user_mutex);
-                send_message(socket_fd, "ERROR 이미 READY 상태입니다.\n");
-                printf("이미 READY 상태임을 알리는 메시지 전송\n");
-                log_event("이미 READY 상태임을 알리는 메시지 전송\n");
-                pthread_mutex_unlock(&room_mutex);
-                continue;
-            }
-            user->is_ready = 1;
-            pthread_mutex_unlock(&user_mutex);
+        int user_score = 0;
+        sscanf(buffer + 6, "%d", &user_score);
+        printf("명령어: SCORE, 점수: %d\n", user_score);
+        log_event("명령어: SCORE, 점수: %d\n", user_score);
 
-            current_room->ready_count += 1;
-            int total_users = 0;
-            RoomUser *user_iter = current_room->users;
-            while (user_iter != NULL) {
-                total_users++;
-                user_iter = user_iter->next;
-            }
+        report_score(socket_fd, current_room_id, user_score, -1);
+    } else {
+        send_message(socket_fd, "ERROR 알 수 없는 명령어입니다.\n");
+        printf("알 수 없는 명령어 메시지 전송\n");
+        log_event("알 수 없는 명령어 메시지 전송\n");
+    }
+}
 
-            int ready_all = (current_room->ready_count >= total_users);
-            pthread_mutex_unlock(&room_mutex);
+// 새 재접속 토큰 (shard 번호를 앞에 붙여 다른 shard로 접속해도 주인 shard를 찾음, 난수를 못 얻으면 토큰 없음)
+void new_session_token(User *user) {
+    unsigned char bytes[16];
+    user->session[0] = '\0';
+    if (getrandom(bytes, sizeof(bytes), 0) != (ssize_t)sizeof(bytes)) {
+        return;
+    }
+    int len = snprintf(user->session, sizeof(user->session), "%d.", shards.index);
+    for (size_t i = 0; i < sizeof(bytes); i++) {
+        len += snprintf(user->session + len, sizeof(user->session) - (size_t)len, "%02x", bytes[i]);
+    }
+}
 
-            printf("사용자 %s가 READY 상태 (%d/%d)\n", name, current_room->ready_count, total_users);
-            log_event("사용자 %s가 READY 상태 (%d/%d)\n", name, current_room->ready_count, total_users);
+// 재접속 토큰을 알림 (SESSION <토큰>, WELCOME 뒤와 토큰이 바뀔 때마다)
+void send_session(User *user) {
+    if (user->session[0] == '\0' || limits.resume_grace_ms <= 0) {
+        return;
+    }
+    char msg[64];
+    snprintf(msg, sizeof(msg), "SESSION %s\n", user->session);
+    send_message(user->socket_fd, msg);
+}
 
-            if (ready_all && !current_room->game_started) {
-                // 게임 시작 메시지 전송 (GAME_STARTED)
-                char msg[BUFFER_SIZE];
-                snprintf(msg, sizeof(msg), "GAME_STARTED\n");
-                broadcast_message(msg, current_room_id, -1);
-                printf("GAME_STARTED 메시지 브로드캐스트: %s", msg);
-                log_event("GAME_STARTED 메시지 브로드캐스트: %s", msg);
+// 사용자의 소켓 번호를 바꿈 (방장이면 방의 host_fd도 같이)
+void rekey_user(User *user, int socket_fd) {
+    pthread_mutex_lock(&room_mutex);
+    Room *room = user->room_id != -1 ? find_room(user->room_id) : NULL;
+    if (room != NULL && room->host_fd == user->socket_fd) {
+        room->host_fd = socket_fd;
+    }
+    pthread_mutex_lock(&user_mutex);
+    user->socket_fd = socket_fd;
+    pthread_mutex_unlock(&user_mutex);
+    pthread_mutex_unlock(&room_mutex);
+}
 
-                // 게임 시작 로직 호출
-                start_game(current_room);
-            } else {
-                send_message(socket_fd, "레디되었습니다. 모든 플레이어가 레디를 입력하면 게임이 시작됩니다.\n");
-                printf("레디 메시지 전송\n");
-                log_event("레디 메시지 전송\n");
-            }
-        } else if (strncmp(buffer, "/game_list", 10) == 0) {
-            printf("명령어: /game_list\n");
-            log_event("명령어: /game_list\n");
-            send_game_list(socket_fd);
-            printf("GAME_LIST 메시지 전송\n");
-            log_event("GAME_LIST 메시지 전송\n");
-        } else if (strncmp(buffer, "/help", 5) == 0) {
-            printf("명령어: /help\n");
-            log_event("명령어: /help\n");
-            send_help_message(socket_fd);
-            printf("HELP 메시지 전송\n");
-            log_event("HELP 메시지 전송\n");
-        } else if (strncmp(buffer, "/list", 5) == 0) {
-            printf("명령어: /list\n");
-            log_event("명령어: /list\n");
-            send_room_list(socket_fd);
-            printf("방 목록 전송\n");
-            log_event("방 목록 전송\n");
-        } else if (strncmp(buffer, "SCORE ", 6) == 0) {
-            if (current_room_id == -1) {
-                send_message(socket_fd, "ERROR 방에 먼저 참여해야 합니다.\n");
-                printf("방에 참여하지 않은 상태에서 SCORE 시도\n");
-                log_event("방에 참여하지 않은 상태에서 SCORE 시도\n");
-                continue;
-            }
+// 연결이 끊긴 사용자를 방, 준비 상태, 방장 자리째 resume_grace_ms 동안 남겨 둠
+// 소켓 번호는 새 연결이 다시 받을 수 있으므로 겹치지 않는 음수로 바꿈 (그동안 보내는 메시지는 버려짐)
+void detach_user(User *user) {
+    printf("사용자 %s의 연결이 끊겼습니다. %dms 동안 자리를 남겨 둡니다.\n", user->name, limits.resume_grace_ms);
+    log_event("사용자 %s의 연결이 끊겼습니다. %dms 동안 자리를 남겨 둡니다.\n", user->name, limits.resume_grace_ms);
+    rekey_user(user, next_away_fd);
+    next_away_fd = next_away_fd > INT_MIN + 1 ? next_away_fd - 1 : -2;
+    timer_wheel_schedule(&room_timers, &user->away_timer, (unsigned)limits.resume_grace_ms);
+}
 
-            int user_score;
-            sscanf(buffer + 6, "%d", &user_score);
-            printf("명령어: SCORE, 점수: %d\n", user_score);
-            log_event("명령어: SCORE, 점수: %d\n", user_score);
+// 자리를 남겨 둔 시간이 지남 (그새 다시 접속했으면 무시)
+void away_expired(void *arg) {
+    User *user = arg;
+    if (user->socket_fd >= 0) {
+        return;
+    }
+    expired_sessions++;
+    release_user(user);
+}
 
-            // 현재 사용자가 속한 방 찾기
-            pthread_mutex_lock(&room_mutex);
-            Room *current_room = find_room(current_room_id);
-            if (current_room == NULL) {
-                pthread_mutex_unlock(&room_mutex);
-                send_message(socket_fd, "ERROR 방을 찾을 수 없습니다.\n");
-                printf("방을 찾을 수 없음 메시지 전송\n");
-                log_event("방을 찾을 수 없음 메시지 전송\n");
-                continue;
-            }
+// 자리만 남은 사용자를 모두 정리
+void release_away_users(void) {
+    while (1) {
+        pthread_mutex_lock(&user_mutex);
+        User *user = user_head;
+        while (user != NULL && user->socket_fd >= 0) {
+            user = user->next;
+        }
+        pthread_mutex_unlock(&user_mutex);
+        if (user == NULL) {
+            return;
+        }
+        timer_wheel_cancel(&room_timers, &user->away_timer);
+        release_user(user);
+    }
+}
 
-            // 점수 기록
-            pthread_mutex_lock(&user_mutex);
-            User *user = find_user(socket_fd);
-            pthread_mutex_unlock(&user_mutex);
+// 이름 대신 받은 /resume <토큰>: 토큰의 사용자에 이 연결을 붙임 (한 번 주고받기로 방과 준비 상태가 그대로)
+// 다른 shard의 토큰이면 연결을 그 shard로 넘기고, 아직 끊긴 줄 모르는 이전 연결이 있으면 그 연결을 대신함
+void resume_session(NetConn *conn, char *buffer, size_t len) {
+    char token[40] = "";
+    sscanf(buffer + 8, "%39s", token);
+    int owner = atoi(token);
+    if (strchr(token, '.') != NULL && owner != shards.index && owner >= 0 && owner < shards.count &&
+        hand_off_conn(conn, owner, buffer, len) == 0) {
+        return;
+    }
 
-            if (user == NULL) {
-                pthread_mutex_unlock(&room_mutex);
-                send_message(socket_fd, "ERROR 사용자를 찾을 수 없습니다.\n");
-                printf("사용자를 찾을 수 없음 메시지 전송\n");
-                log_event("사용자를 찾을 수 없음 메시지 전송\n");
-                continue;
-            }
+    pthread_mutex_lock(&user_mutex);
+    User *user = user_head;
+    while (user != NULL && (token[0] == '\0' || strcmp(user->session, token) != 0)) {
+        user = user->next;
+    }
+    pthread_mutex_unlock(&user_mutex);
+    if (user == NULL) {
+        send_message(conn->fd, "ERROR 이어서 접속할 세션이 없습니다. 이름을 입력하세요.\n");
+        log_event("재접속 실패: 토큰을 찾지 못함 (소켓 FD %d)\n", conn->fd);
+        return;
+    }
 
-            add_score(current_room, user, user_score);
+    NetConn *previous = net_conn_of(&reactor, user->socket_fd);
+    if (previous != NULL) {
+        close(net_conn_detach(previous));
+    }
+    timer_wheel_cancel(&room_timers, &user->away_timer);
+    rekey_user(user, conn->fd);
+    conn->user = user;
+    token_bucket_init(&user->messages, limits.message_burst, timer_wheel_now_ms());
+    user->dropped = 0;
+    user->discarding = 0;
+    new_session_token(user); // 한 번 쓴 토큰은 다시 쓸 수 없음
+    resumed_sessions++;
 
-            // 모든 점수가 수신되었는지 확인
-            int total_users = 0;
-            int scores_received = 0;
-            RoomUser *user_iter = current_room->users;
-            while (user_iter != NULL) {
-                total_users++;
-                user_iter = user_iter->next;
-            }
+    char msg[BUFFER_SIZE];
+    snprintf(msg, sizeof(msg), "RESUMED %s %d\n", user->name, user->room_id);
+    send_message(conn->fd, msg);
+    send_session(user);
+    printf("사용자 %s가 다시 접속했습니다 (소켓 FD %d, 방 ID %d)\n", user->name, conn->fd, user->room_id);
+    log_event("사용자 %s가 다시 접속했습니다 (소켓 FD %d, 방 ID %d)\n", user->name, conn->fd, user->room_id);
+}
 
-            ScoreNode *score_iter = current_room->scores;
-            while (score_iter != NULL) {
-                scores_received++;
-                score_iter = score_iter->next;
-            }
+// 응답이 없어 하트비트가 끊는 연결 (이어서 client_closed가 방 자리와 사용자를 정리)
+void client_idle(NetConn *conn) {
+    User *client = conn->user;
+    printf("응답이 없는 연결을 끊습니다: 소켓 FD %d (%s)\n", conn->fd, client != NULL ? client->name : "이름 없음");
+    log_event("응답이 없는 연결을 끊습니다: 소켓 FD %d (%s)\n", conn->fd, client != NULL ? client->name : "이름 없음");
+}
 
-            if (scores_received >= total_users) {
-                // 승자 결정
-                ScoreNode *max_score_node = current_room->scores;
-                ScoreNode *iter = current_room->scores->next;
-                while (iter != NULL) {
-                    if (iter->score > max_score_node->score) {
-                        max_score_node = iter;
-                    }
-                    iter = iter->next;
-                }
+// 연결 종료 처리 (이 함수가 끝나면 리액터가 소켓을 닫음)
+void client_closed(NetConn *conn) {
+    int socket_fd = conn->fd;
+    User *client = conn->user;
+    if (client == NULL) {
+        printf("소켓 FD %d에서 이름을 수신하지 못했습니다. 연결 종료.\n", socket_fd);
+        log_event("소켓 FD %d에서 이름을 수신하지 못했습니다. 연결 종료.\n", socket_fd);
+        return;
+    }
+    conn->user = NULL;
 
-                // 승자 메시지 브로드캐스트 (발신자 제외)
-                char winner_msg[BUFFER_SIZE];
-                snprintf(winner_msg, sizeof(winner_msg), "GAME_OVER\n승자가 결정되었습니다: %s님!\n", max_score_node->user->name);
-                broadcast_message(winner_msg, current_room_id, -1); // exclude_fd를 -1로 설정하여 모든 클라이언트에게 전송
-                printf("GAME_OVER 메시지 브로드캐스트: %s", winner_msg);
-                log_event("GAME_OVER 메시지 브로드캐스트: %s", winner_msg);
-
-                // 게임 상태 초기화
-                current_room->game_started = 0;
-
-                // 점수 목록 초기화
-                ScoreNode *temp;
-                while (current_room->scores != NULL) {
-                    temp = current_room->scores;
-                    current_room->scores = current_room->scores->next;
-                    free(temp);
-                }
-            }
-            pthread_mutex_unlock(&room_mutex);
-        } else {
-            send_message(socket_fd, "ERROR 알 수 없는 명령어입니다.\n");
-            printf("알 수 없는 명령어 메시지 전송\n");
-            log_event("알 수 없는 명령어 메시지 전송\n");
-        }
+    // 다시 접속할 수 있도록 자리를 남겨 둠 (새 서버로 넘기는 중이면 넘길 소켓이 없으므로 바로 정리)
+    if (limits.resume_grace_ms > 0 && !draining && client->session[0] != '\0') {
+        detach_user(client);
+        return;
     }
+    release_user(client);
+}
+
+// 사용자를 방과 사용자 목록에서 지움 (연결이 끊겼거나 자리를 남겨 둔 시간이 지남)
+void release_user(User *client) {
+    int socket_fd = client->socket_fd;
+    char name[50];
+    strcpy(name, client->name);
+    int current_room_id = client->room_id;
+    shard_user_remove(&shards, client->directory_slot);
 
     // 클라이언트 연결 종료 처리
     printf("사용자 %s가 연결을 종료했습니다.\n", name);
     log_event("사용자 %s가 연결을 종료했습니다.\n", name);
 
-    // 사용자가 참여 중인 방에서 제거
+    // 사용자가 참여 중인 방에서 제거 (알림은 room_mutex를 푼 뒤에 보냄)
     if (current_room_id != -1) {
+        char left_msg[BUFFER_SIZE] = "";
+        char host_msg[BUFFER_SIZE] = "";
+        char winner_msg[BUFFER_SIZE] = "";
         pthread_mutex_lock(&room_mutex);
         Room *current_room = find_room(current_room_id);
         if (current_room != NULL) {
@@ -935,41 +2309,54 @@ void *client_handler(void *arg) {
                 remove_user_from_room(current_room, user_to_remove);
                 user_to_remove->room_id = -1; // 방 참여 상태 초기화
 
-                // 사용자 퇴장 메시지 전송 (USER_LEFT <name>)
-                char left_msg[BUFFER_SIZE];
+                // 게임 도중 나갔고 남은 플레이어가 모두 점수를 보냈으면 제한 시간을 기다리지 않고 종료
+                if (current_room->game_started && !current_room->game_over &&
+                    current_room->reports >= current_room->players) {
+                    finish_game(current_room, winner_msg, sizeof(winner_msg));
+                }
+
+                // 사용자 퇴장 메시지 (USER_LEFT <name>)
                 snprintf(left_msg, sizeof(left_msg), "USER_LEFT %s\n", name);
-                broadcast_message(left_msg, current_room_id, socket_fd); // exclude_fd를 발신자 제외
-                printf("USER_LEFT 메시지 브로드캐스트: %s", left_msg);
-                log_event("USER_LEFT 메시지 브로드캐스트: %s", left_msg);
 
                 // 만약 방장이 퇴장했다면, 다른 사용자를 새로운 방장으로 설정
                 if (current_room->host_fd == socket_fd) {
                     RoomUser *new_host = current_room->users;
                     if (new_host != NULL) {
                         current_room->host_fd = new_host->user->socket_fd;
-                        // 호스트 변경 메시지 전송
-                        char host_msg[BUFFER_SIZE];
+                        // 호스트 변경 메시지
                         snprintf(host_msg, sizeof(host_msg), "HOST_CHANGED %s\n", new_host->user->name);
-                        broadcast_message(host_msg, current_room_id, -1); // exclude_fd를 -1로 설정하여 모든 클라이언트에게 전송
-                        printf("HOST_CHANGED 메시지 브로드캐스트: %s", host_msg);
-                        log_event("HOST_CHANGED 메시지 브로드캐스트: %s", host_msg);
-                    } else {
-                        // 방에 사용자가 없으면 방 삭제
-                        // 방 삭제 로직을 추가할 수 있음
                     }
                 }
+
+                // 방에 사용자가 없으면 방 삭제 (다른 shard의 방 목록에서도 빠짐)
+                if (current_room->users == NULL) {
+                    destroy_room(current_room);
+                }
             }
         }
         pthread_mutex_unlock(&room_mutex);
+
+        if (left_msg[0] != '\0') {
+            broadcast_message(left_msg, current_room_id, socket_fd); // exclude_fd를 발신자 제외
+            printf("USER_LEFT 메시지 브로드캐스트: %s", left_msg);
+            log_event("USER_LEFT 메시지 브로드캐스트: %s", left_msg);
+        }
+        if (host_msg[0] != '\0') {
+            broadcast_message(host_msg, current_room_id, -1); // exclude_fd를 -1로 설정하여 모든 클라이언트에게 전송
+            printf("HOST_CHANGED 메시지 브로드캐스트: %s", host_msg);
+            log_event("HOST_CHANGED 메시지 브로드캐스트: %s", host_msg);
+        }
+        if (winner_msg[0] != '\0') {
+            broadcast_message(winner_msg, current_room_id, -1);
+            printf("GAME_OVER 메시지 브로드캐스트: %s", winner_msg);
+            log_event("GAME_OVER 메시지 브로드캐스트: %s", winner_msg);
+        }
     }
 
     // 사용자 제거
     pthread_mutex_lock(&user_mutex);
     remove_user(socket_fd);
     pthread_mutex_unlock(&user_mutex);
-
-    close(socket_fd);
-    pthread_exit(NULL);
 }
 
 // GAME_OVER 처리 함수
@@ -1002,104 +2389,239 @@ void handle_gameover_all_clients(int sender_fd) {
     log_event("모든 클라이언트에게 GAME_OVER 메시지 전송 완료: %s", gameover_message);
 }
 
-// main 함수
-int main() {
-    int server_fd, new_socket;
-    struct sockaddr_in address;
-    socklen_t addrlen = sizeof(address);
-    pthread_t tid;
-
-    // 로그 파일 열기
-    log_fp = fopen(LOG_FILE, "a");
-    if (log_fp == NULL) {
-        perror("로그 파일 열기 실패");
-        exit(EXIT_FAILURE);
-    }
-
+// shard 하나 실행 (리액터 루프가 끝날 때까지), 종료 코드
+// 모든 shard가 SO_REUSEPORT로 같은 포트에 자기 리스닝 소켓을 열어 커널이 새 연결을 나눠 줌
+// upgrade_from이 있으면 리스닝 소켓과 연결, 방을 이전 서버의 같은 번호 shard에서 넘겨받음
+static int run_shard(void) {
     // 시그널 핸들러 설정
     signal(SIGINT, cleanup_server);
     signal(SIGTERM, cleanup_server);
     signal(SIGQUIT, cleanup_server);
 
-    // 소켓 생성
-    if ((server_fd = socket(AF_INET, SOCK_STREAM, 0)) == 0) {
-        perror("소켓 생성 실패");
-        exit(EXIT_FAILURE);
+    // 순위표 파일은 0번 shard만 씀 (다른 shard는 결과를 메모리에만 반영)
+    if (shards.index != 0) {
+        leaderboard_detach_log(&leaderboard);
     }
 
-    // 주소 설정
-    address.sin_family = AF_INET;
-    address.sin_addr.s_addr = INADDR_ANY;
-    address.sin_port = htons(SERVER_PORT);
-
-    // 소켓 옵션 설정
-    int opt = 1;
-    if (setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt))) {
-        perror("setsockopt 실패");
-        close(server_fd);
-        exit(EXIT_FAILURE);
+    // 방 타이머 (게임 제한 시간, 순위표 체크포인트), 리액터 루프가 epoll 대기 시간으로 함께 진행
+    timer_wheel_init(&room_timers, ROOM_TIMER_TICK_MS);
+    if (shards.index == 0) {
+        timer_entry_init(&leaderboard_timer, leaderboard_checkpoint_tick, NULL);
+        timer_wheel_schedule(&room_timers, &leaderboard_timer, LEADERBOARD_CHECKPOINT_MS);
     }
+    timer_entry_init(&pool_stats_timer, pool_stats_tick, NULL);
+    timer_wheel_schedule(&room_timers, &pool_stats_timer, POOL_STATS_MS);
 
-    // 소켓 바인딩
-    if (bind(server_fd, (struct sockaddr *)&address, sizeof(address)) < 0) {
-        perror("바인딩 실패");
-        close(server_fd);
-        exit(EXIT_FAILURE);
+    if (net_reactor_init(&reactor) < 0) {
+        return EXIT_FAILURE;
     }
-
-    // 리슨
-    if (listen(server_fd, 10) < 0) {
-        perror("리슨 실패");
-        close(server_fd);
-        exit(EXIT_FAILURE);
+    net_heartbeat_start(&heartbeat, &reactor, &room_timers, (unsigned)limits.ping_interval_ms,
+                        (unsigned)limits.idle_timeout_ms, "PING\n", 5, client_idle);
+    // 이전 서버가 게임 중인 방은 게임이 끝난 뒤에 넘기므로 그때까지 제어 연결을 계속 봄
+    if (upgrade_from >= 0) {
+        if (receive_upgrade() < 0 || net_reactor_watch(&reactor, upgrade_from, upgrade_inbox, NULL) < 0) {
+            perror("이전 서버에서 넘겨받기 실패");
+            log_event("이전 서버에서 넘겨받기 실패 (shard %d)\n", shards.index);
+            close(upgrade_from);
+            upgrade_from = -1;
+        }
     }
 
-    printf("서버가 포트 %d에서 리슨 중입니다...\n", SERVER_PORT);
-    log_event("서버가 포트 %d에서 리슨 중입니다...\n", SERVER_PORT);
-
-    while (1) {
-        // select를 사용하여 타임아웃 설정 (시그널 처리 가능하도록)
-        fd_set readfds;
-        struct timeval tv;
+    // 리스닝 소켓 (넘겨받지 못했으면 새로 엶)
+    if (tcp_listen_fd < 0) {
+        tcp_listen_fd = net_listen_tcp(SERVER_PORT, SOMAXCONN, NET_LISTEN_REUSEPORT);
+    }
+    if (tcp_listen_fd < 0 || net_reactor_listen(&reactor, tcp_listen_fd, client_accept, NULL) < 0) {
+        net_reactor_destroy(&reactor);
+        return EXIT_FAILURE;
+    }
+    // 같은 컴퓨터의 클라이언트는 Unix 소켓으로 (fork 전에 연 소켓 하나를 모든 shard가 함께 받음)
+    if (local_listen_fd >= 0 && net_reactor_listen(&reactor, local_listen_fd, client_accept, NULL) < 0) {
+        close(local_listen_fd);
+        local_listen_fd = -1;
+    }
+    // 다른 shard가 넘기는 연결과 게임 결과
+    if (shards.count > 1 && net_reactor_watch(&reactor, shards.inbox[shards.index], shard_inbox, NULL) < 0) {
+        net_reactor_destroy(&reactor);
+        return EXIT_FAILURE;
+    }
+    // 다음 새 서버 (server --upgrade)가 연결해 올 제어 소켓
+    upgrade_listen_fd = upgrade_listen(shards.index);
+    if (upgrade_listen_fd >= 0 && net_reactor_listen(&reactor, upgrade_listen_fd, upgrade_accept, NULL) < 0) {
+        close(upgrade_listen_fd);
+        upgrade_listen_fd = -1;
+    }
 
-        FD_ZERO(&readfds);
-        FD_SET(server_fd, &readfds);
+    printf("서버가 포트 %d에서 리슨 중입니다... (shard %d/%d)\n", SERVER_PORT, shards.index, shards.count);
+    log_event("서버가 포트 %d에서 리슨 중입니다... (shard %d/%d)\n", SERVER_PORT, shards.index, shards.count);
 
-        tv.tv_sec = 1; // 1초 타임아웃
-        tv.tv_usec = 0;
+    // 접속, 명령, 방 타이머를 모두 이 스레드에서 처리
+    if (net_reactor_run(&reactor, &room_timers) < 0) {
+        net_reactor_destroy(&reactor);
+        return EXIT_FAILURE;
+    }
 
-        int activity = select(server_fd + 1, &readfds, NULL, NULL, &tv);
+    net_reactor_destroy(&reactor);
+    return 0;
+}
 
-        if (activity < 0) {
-            if (errno == EINTR) {
-                // 시그널에 의해 인터럽트됨
-                continue;
-            }
-            perror("select 실패");
-            continue;
+// 부모 프로세스: 종료 시그널을 모든 shard에 전달 (shard가 각자 cleanup_server로 정리)
+static void stop_shards(int signum) {
+    (void)signum;
+    for (int i = 0; i < shards.count; i++) {
+        if (shard_pids[i] > 0) {
+            kill(shard_pids[i], SIGTERM);
         }
+    }
+}
 
-        if (activity == 0) {
-            // 타임아웃 - 계속 진행
-            continue;
+// --upgrade: 실행 중인 서버의 shard마다 제어 소켓에 연결하고 HELLO를 받음 (받은 shard는 GO까지 멈춤)
+// 이전 서버의 shard 수 (실행 중인 서버가 없거나 응답이 맞지 않으면 -1)
+static int connect_upgrade(int *fds, int *next_room_id) {
+    int count = 0;
+    while (count < SHARD_MAX && (fds[count] = upgrade_connect(count)) >= 0) {
+        count++;
+    }
+    int result = count > 0 ? count : -1;
+    for (int i = 0; i < count && result > 0; i++) {
+        UpgradeMessage msg;
+        int fd;
+        if (upgrade_receive(fds[i], &msg, NULL, 0, &fd) != 1 || msg.type != UPGRADE_MSG_HELLO ||
+            msg.shard_count != count) {
+            result = -1;
+            break;
+        }
+        if (msg.next_room_id > *next_room_id) {
+            *next_room_id = msg.next_room_id;
+        }
+    }
+    if (result < 0) {
+        for (int i = 0; i < count; i++) {
+            close(fds[i]); // 이전 서버는 넘기기를 취소하고 그대로 서비스
         }
+    }
+    return result;
+}
 
-        if ((new_socket = accept(server_fd, (struct sockaddr *)&address, &addrlen)) < 0) {
-            perror("어셉트 실패");
-            continue;
+// main 함수 (인자: shard 프로세스 수, 기본은 CPU 수)
+// server --upgrade: 실행 중인 서버를 같은 shard 수로 이어받음 (끊기는 연결과 방 없이 새 실행 파일로 교체)
+int main(int argc, char **argv) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int upgrading = argc > 1 && strcmp(argv[1], "--upgrade") == 0;
+    int upgrade_fds[SHARD_MAX];
+    int next_room_id = 1;
+    int shard_count = argc > 1 && !upgrading ? atoi(argv[1]) : (int)cpus;
+    if (upgrading) {
+        shard_count = connect_upgrade(upgrade_fds, &next_room_id);
+        if (shard_count < 0) {
+            fprintf(stderr, "이어받을 서버가 없거나 응답하지 않습니다.\n");
+            exit(EXIT_FAILURE);
         }
+    }
+    if (shard_count < 1) {
+        shard_count = 1;
+    } else if (shard_count > SHARD_MAX) {
+        shard_count = SHARD_MAX;
+    }
+
+    // 로그 파일 열기 (모든 shard가 추가 모드로 함께 씀)
+    log_fp = fopen(LOG_FILE, "a");
+    if (log_fp == NULL) {
+        perror("로그 파일 열기 실패");
+        exit(EXIT_FAILURE);
+    }
+
+    // 접속 제한 (fork 전에 읽어 모든 shard가 같은 값을 씀)
+    admission_limits_load(&limits, SHARD_ROOMS, NET_READ_BUFFER);
+    log_event("접속 제한: 연결 %d개 (shard마다), IP별 초당 %d회 (최대 %d), 메시지 초당 %d개 (최대 %d), 한 줄 %d바이트, 방 %d개, PING %dms, 끊기 %dms, 자리 유지 %dms\n",
+              limits.max_connections, limits.ip_rate, limits.ip_burst, limits.message_rate, limits.message_burst,
+              limits.max_message, limits.max_rooms, limits.ping_interval_ms, limits.idle_timeout_ms, limits.resume_grace_ms);
+
+    // 객체 풀 (첫 청크를 미리 할당)
+    if (slab_pool_init(&user_pool, "User", sizeof(User), 64) < 0 ||
+        slab_pool_init(&room_pool, "Room", sizeof(Room), 16) < 0 ||
+        slab_pool_init(&room_user_pool, "RoomUser", sizeof(RoomUser), 64) < 0) {
+        exit(EXIT_FAILURE);
+    }
+
+    // 영구 순위표 (체크포인트 + 그 뒤의 결과 로그로 다시 만듦, fork 전에 한 번만 읽음)
+    // --upgrade면 이전 서버가 로그를 놓은 뒤 (HELLO를 모두 받은 뒤)에 읽음
+    if (leaderboard_open(&leaderboard, LEADERBOARD_LOG, LEADERBOARD_CHECKPOINT, available_game_modes, available_game_modes_size) < 0) {
+        fprintf(stderr, "순위표를 열 수 없습니다.\n");
+        exit(EXIT_FAILURE);
+    }
+    log_event("순위표 로드: %zu명\n", leaderboard.player_count);
+
+    // 공유 방 디렉터리, shard 사이 소켓, 모든 shard가 함께 받는 Unix 소켓
+    if (shard_set_init(&shards, shard_count, limits.max_rooms) < 0) {
+        exit(EXIT_FAILURE);
+    }
+    if (upgrading) {
+        // 리스닝 소켓은 이전 서버가 넘겨주고, 방 ID는 이전 서버가 준 다음부터
+        shard_room_reserve(&shards, next_room_id);
+        printf("실행 중인 서버 (shard %d개)를 이어받습니다.\n", shard_count);
+        log_event("실행 중인 서버 (shard %d개)를 이어받습니다.\n", shard_count);
+    } else {
+        local_listen_fd = net_listen_unix(SERVER_UNIX_SOCKET, SOMAXCONN, 0);
+    }
 
-        printf("새로운 연결: 소켓 FD %d\n", new_socket);
-        log_event("새로운 연결: 소켓 FD %d\n", new_socket);
+    if (shard_count == 1) {
+        shard_set_enter(&shards, 0);
+        upgrade_from = upgrading ? upgrade_fds[0] : -1;
+        return run_shard();
+    }
 
-        // 클라이언트 핸들러 스레드 생성
-        if (pthread_create(&tid, NULL, client_handler, (void *)(intptr_t)new_socket) != 0) {
-            perror("스레드 생성 실패");
-            close(new_socket);
+    signal(SIGINT, stop_shards);
+    signal(SIGTERM, stop_shards);
+    signal(SIGQUIT, stop_shards);
+    for (int i = 0; i < shard_count; i++) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("shard 프로세스 생성 실패");
+            stop_shards(0);
+            break;
+        }
+        if (pid == 0) {
+            shard_set_enter(&shards, i);
+            for (int j = 0; upgrading && j < shard_count; j++) {
+                if (j != i) {
+                    close(upgrade_fds[j]);
+                }
+            }
+            upgrade_from = upgrading ? upgrade_fds[i] : -1;
+            exit(run_shard());
         }
-        pthread_detach(tid); // 스레드 분리
+        shard_pids[i] = pid;
+    }
+    shard_set_close_inboxes(&shards);
+    if (local_listen_fd >= 0) {
+        close(local_listen_fd);
+    }
+    for (int i = 0; upgrading && i < shard_count; i++) {
+        close(upgrade_fds[i]);
     }
 
-    close(server_fd);
+    // shard가 끝나면 그 shard의 방과 사용자를 디렉터리에서 지움 (다른 shard가 그 방으로 넘기지 않도록)
+    int alive = 0;
+    for (int i = 0; i < shard_count; i++) {
+        alive += shard_pids[i] > 0;
+    }
+    while (alive > 0) {
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        for (int i = 0; i < shard_count; i++) {
+            if (shard_pids[i] == pid) {
+                shard_pids[i] = 0;
+                shard_forget(&shards, i);
+                alive--;
+                log_event("shard %d 종료 (상태 %d)\n", i, status);
+            }
+        }
+    }
     return 0;
 }
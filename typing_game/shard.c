@@ -0,0 +1,391 @@
+// shard.c
+#define _GNU_SOURCE
+#include "shard.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// 디렉터리 잠금 (잠금을 잡은 채 죽은 shard가 있으면 복구하고 이어서 씀)
+static void directory_lock(ShardDirectory *dir) {
+    if (pthread_mutex_lock(&dir->lock) == EOWNERDEAD) {
+        // 죽은 shard가 고치던 항목은 shard_forget이 그 shard 항목을 지우면서 정리됨
+        pthread_mutex_consistent(&dir->lock);
+    }
+}
+
+static void directory_unlock(ShardDirectory *dir) {
+    pthread_mutex_unlock(&dir->lock);
+}
+
+int shard_set_init(ShardSet *set, int count, int room_limit) {
+    memset(set, 0, sizeof(*set));
+    set->index = -1;
+    set->count = count;
+    for (int i = 0; i < SHARD_MAX; i++) {
+        set->inbox[i] = set->outbox[i] = -1;
+    }
+
+    set->dir = mmap(NULL, sizeof(ShardDirectory), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (set->dir == MAP_FAILED) {
+        perror("방 디렉터리 공유 메모리 생성 실패");
+        set->dir = NULL;
+        return -1;
+    }
+    memset(set->dir, 0, sizeof(ShardDirectory));
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    int err = pthread_mutex_init(&set->dir->lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+    if (err != 0) {
+        fprintf(stderr, "방 디렉터리 잠금 생성 실패: %s\n", strerror(err));
+        return -1;
+    }
+    set->dir->shard_count = count;
+    set->dir->room_limit = room_limit > 0 && room_limit < SHARD_ROOMS ? room_limit : SHARD_ROOMS;
+    set->dir->next_room_id = 1;
+    for (int i = 0; i < SHARD_USERS; i++) {
+        set->dir->users[i].shard = -1;
+    }
+
+    // shard마다 데이터그램 소켓 쌍 하나: [0]은 그 shard가 받고, [1]은 모두가 보냄
+    for (int i = 0; i < count; i++) {
+        int pair[2];
+        if (socketpair(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0, pair) < 0) {
+            perror("shard 소켓 생성 실패");
+            return -1;
+        }
+        set->inbox[i] = pair[0];
+        set->outbox[i] = pair[1];
+    }
+    return 0;
+}
+
+void shard_set_enter(ShardSet *set, int index) {
+    set->index = index;
+    for (int i = 0; i < set->count; i++) {
+        if (i != index && set->inbox[i] >= 0) {
+            close(set->inbox[i]);
+            set->inbox[i] = -1;
+        }
+    }
+}
+
+void shard_set_close_inboxes(ShardSet *set) {
+    for (int i = 0; i < set->count; i++) {
+        if (set->inbox[i] >= 0) {
+            close(set->inbox[i]);
+            set->inbox[i] = -1;
+        }
+    }
+}
+
+void shard_forget(ShardSet *set, int index) {
+    ShardDirectory *dir = set->dir;
+    directory_lock(dir);
+    for (int i = 0; i < SHARD_ROOMS; i++) {
+        if (dir->rooms[i].id != 0 && dir->rooms[i].shard == index) {
+            dir->rooms[i].id = 0;
+        }
+    }
+    for (int i = 0; i < SHARD_USERS; i++) {
+        if (dir->users[i].shard == index) {
+            dir->users[i].shard = -1;
+        }
+    }
+    directory_unlock(dir);
+}
+
+// 방 ID의 디렉터리 항목 (디렉터리 잠금을 잡은 상태에서 호출)
+static ShardRoom *find_entry(ShardDirectory *dir, int room_id) {
+    if (room_id <= 0) {
+        return NULL;
+    }
+    for (int i = 0; i < SHARD_ROOMS; i++) {
+        if (dir->rooms[i].id == room_id) {
+            return &dir->rooms[i];
+        }
+    }
+    return NULL;
+}
+
+// 디렉터리의 방 수 (잠금을 잡은 상태에서)
+static int count_rooms(const ShardDirectory *dir) {
+    int count = 0;
+    for (int i = 0; i < SHARD_ROOMS; i++) {
+        count += dir->rooms[i].id != 0;
+    }
+    return count;
+}
+
+int shard_room_add(ShardSet *set, const char *name, const char *game_mode, int time_limit) {
+    ShardDirectory *dir = set->dir;
+    int room_id = -1;
+    directory_lock(dir);
+    for (int i = 0; i < SHARD_ROOMS && count_rooms(dir) < dir->room_limit; i++) {
+        ShardRoom *entry = &dir->rooms[i];
+        if (entry->id != 0) {
+            continue;
+        }
+        room_id = dir->next_room_id++;
+        entry->shard = set->index;
+        entry->members = 0;
+        entry->time_limit = time_limit;
+        snprintf(entry->name, sizeof(entry->name), "%s", name);
+        snprintf(entry->game_mode, sizeof(entry->game_mode), "%s", game_mode);
+        entry->id = room_id;
+        break;
+    }
+    directory_unlock(dir);
+    return room_id;
+}
+
+void shard_room_update(ShardSet *set, int room_id, int members, const char *game_mode, int time_limit) {
+    ShardDirectory *dir = set->dir;
+    directory_lock(dir);
+    ShardRoom *entry = find_entry(dir, room_id);
+    if (entry != NULL) {
+        entry->members = members;
+        entry->time_limit = time_limit;
+        snprintf(entry->game_mode, sizeof(entry->game_mode), "%s", game_mode);
+    }
+    directory_unlock(dir);
+}
+
+void shard_room_remove(ShardSet *set, int room_id) {
+    ShardDirectory *dir = set->dir;
+    directory_lock(dir);
+    ShardRoom *entry = find_entry(dir, room_id);
+    if (entry != NULL) {
+        entry->id = 0;
+    }
+    directory_unlock(dir);
+}
+
+int shard_room_owner(ShardSet *set, int room_id) {
+    ShardDirectory *dir = set->dir;
+    directory_lock(dir);
+    ShardRoom *entry = find_entry(dir, room_id);
+    int owner = entry != NULL ? entry->shard : -1;
+    directory_unlock(dir);
+    return owner;
+}
+
+static int compare_newest(const void *a, const void *b) {
+    const ShardRoom *x = a, *y = b;
+    return (y->id > x->id) - (y->id < x->id);
+}
+
+int shard_room_list(ShardSet *set, ShardRoom *out, int max) {
+    ShardDirectory *dir = set->dir;
+    int count = 0;
+    directory_lock(dir);
+    for (int i = 0; i < SHARD_ROOMS && count < max; i++) {
+        if (dir->rooms[i].id != 0) {
+            out[count++] = dir->rooms[i];
+        }
+    }
+    directory_unlock(dir);
+    qsort(out, (size_t)count, sizeof(ShardRoom), compare_newest);
+    return count;
+}
+
+int shard_room_count(ShardSet *set) {
+    directory_lock(set->dir);
+    int count = count_rooms(set->dir);
+    directory_unlock(set->dir);
+    return count;
+}
+
+int shard_room_next_id(ShardSet *set) {
+    directory_lock(set->dir);
+    int next_id = set->dir->next_room_id;
+    directory_unlock(set->dir);
+    return next_id;
+}
+
+void shard_room_reserve(ShardSet *set, int next_id) {
+    directory_lock(set->dir);
+    if (set->dir->next_room_id < next_id) {
+        set->dir->next_room_id = next_id;
+    }
+    directory_unlock(set->dir);
+}
+
+int shard_room_restore(ShardSet *set, int room_id, const char *name, const char *game_mode, int time_limit,
+                       int members) {
+    ShardDirectory *dir = set->dir;
+    directory_lock(dir);
+    ShardRoom *entry = find_entry(dir, room_id);
+    for (int i = 0; entry == NULL && i < SHARD_ROOMS; i++) {
+        if (dir->rooms[i].id == 0) {
+            entry = &dir->rooms[i];
+        }
+    }
+    if (entry != NULL) {
+        entry->shard = set->index;
+        entry->members = members;
+        entry->time_limit = time_limit;
+        snprintf(entry->name, sizeof(entry->name), "%s", name);
+        snprintf(entry->game_mode, sizeof(entry->game_mode), "%s", game_mode);
+        entry->id = room_id;
+        if (dir->next_room_id <= room_id) {
+            dir->next_room_id = room_id + 1;
+        }
+    }
+    directory_unlock(dir);
+    return entry != NULL ? 0 : -1;
+}
+
+int shard_user_add(ShardSet *set, const char *name) {
+    ShardDirectory *dir = set->dir;
+    int slot = -1;
+    directory_lock(dir);
+    for (int i = 0; i < SHARD_USERS; i++) {
+        if (dir->users[i].shard < 0) {
+            dir->users[i].shard = set->index;
+            snprintf(dir->users[i].name, sizeof(dir->users[i].name), "%s", name);
+            slot = i;
+            break;
+        }
+    }
+    directory_unlock(dir);
+    return slot;
+}
+
+void shard_user_move(ShardSet *set, int slot, int shard) {
+    if (slot < 0 || slot >= SHARD_USERS) {
+        return;
+    }
+    directory_lock(set->dir);
+    set->dir->users[slot].shard = shard;
+    directory_unlock(set->dir);
+}
+
+void shard_user_remove(ShardSet *set, int slot) {
+    shard_user_move(set, slot, -1);
+}
+
+void shard_user_counts(ShardSet *set, int *counts) {
+    ShardDirectory *dir = set->dir;
+    memset(counts, 0, sizeof(int) * (size_t)set->count);
+    directory_lock(dir);
+    for (int i = 0; i < SHARD_USERS; i++) {
+        int shard = dir->users[i].shard;
+        if (shard >= 0 && shard < set->count) {
+            counts[shard]++;
+        }
+    }
+    directory_unlock(dir);
+}
+
+// 메시지 하나를 target shard로 (fd가 0 이상이면 SCM_RIGHTS로 함께), 받는 쪽이 밀려 있어도 기다리지 않음
+static int send_message_to(ShardSet *set, int target, const ShardMessage *msg, const char *data, size_t len, int fd) {
+    struct iovec iov[2] = {{(void *)msg, sizeof(*msg)}, {(void *)data, len}};
+    struct msghdr header;
+    memset(&header, 0, sizeof(header));
+    header.msg_iov = iov;
+    header.msg_iovlen = len > 0 ? 2 : 1;
+
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } control;
+    if (fd >= 0) {
+        memset(&control, 0, sizeof(control));
+        header.msg_control = control.buf;
+        header.msg_controllen = sizeof(control.buf);
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&header);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+    }
+
+    ssize_t n;
+    do {
+        n = sendmsg(set->outbox[target], &header, MSG_DONTWAIT | MSG_NOSIGNAL);
+    } while (n < 0 && errno == EINTR);
+    return n < 0 ? -1 : 0;
+}
+
+int shard_send_handoff(ShardSet *set, int target, int fd, int user_slot, const char *name,
+                       const char *data, size_t input_len, size_t output_len) {
+    if (target < 0 || target >= set->count || target == set->index ||
+        sizeof(ShardMessage) + input_len + output_len > SHARD_MESSAGE_MAX) {
+        errno = EINVAL;
+        return -1;
+    }
+    ShardMessage msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.type = SHARD_MSG_HANDOFF;
+    msg.user_slot = user_slot;
+    msg.input_len = (uint32_t)input_len;
+    msg.output_len = (uint32_t)output_len;
+    snprintf(msg.name, sizeof(msg.name), "%s", name);
+    return send_message_to(set, target, &msg, data, input_len + output_len, fd);
+}
+
+int shard_broadcast_result(ShardSet *set, const char *game_mode, const char *name, int score) {
+    ShardMessage msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.type = SHARD_MSG_RESULT;
+    msg.user_slot = -1;
+    msg.score = score;
+    snprintf(msg.name, sizeof(msg.name), "%s", name);
+    snprintf(msg.game_mode, sizeof(msg.game_mode), "%s", game_mode);
+    int failed = 0;
+    for (int i = 0; i < set->count; i++) {
+        if (i != set->index && send_message_to(set, i, &msg, NULL, 0, -1) < 0) {
+            failed++;
+        }
+    }
+    return failed;
+}
+
+int shard_receive(ShardSet *set, ShardMessage *msg, char *data, size_t size, int *fd) {
+    struct iovec iov[2] = {{msg, sizeof(*msg)}, {data, size}};
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } control;
+    struct msghdr header;
+    memset(&header, 0, sizeof(header));
+    header.msg_iov = iov;
+    header.msg_iovlen = 2;
+    header.msg_control = control.buf;
+    header.msg_controllen = sizeof(control.buf);
+
+    *fd = -1;
+    ssize_t n;
+    do {
+        n = recvmsg(set->inbox[set->index], &header, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    }
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&header); cmsg != NULL; cmsg = CMSG_NXTHDR(&header, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            memcpy(fd, CMSG_DATA(cmsg), sizeof(int));
+        }
+    }
+    // 잘린 메시지나 길이가 맞지 않는 메시지는 버림 (같이 온 소켓은 닫음)
+    if ((size_t)n < sizeof(*msg) || (header.msg_flags & MSG_TRUNC) ||
+        (size_t)n - sizeof(*msg) != (size_t)msg->input_len + msg->output_len) {
+        if (*fd >= 0) {
+            close(*fd);
+            *fd = -1;
+        }
+        errno = EPROTO;
+        return -1;
+    }
+    msg->name[sizeof(msg->name) - 1] = '\0';
+    msg->game_mode[sizeof(msg->game_mode) - 1] = '\0';
+    return 1;
+}
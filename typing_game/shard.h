@@ -0,0 +1,123 @@
+// shard.h
+// 타자 게임 서버 shard (여러 프로세스가 SO_REUSEPORT로 같은 포트를 나눠 받음)
+//
+// 방과 방 멤버는 방을 만든 shard 프로세스 하나에만 있고, 다른 shard는 공유 메모리의
+// 방 디렉터리와 사용자 색인으로 방 목록과 방 주인을 본다. 디렉터리는 fork 전에 만든
+// 익명 공유 매핑이고, 프로세스 공유 + robust 뮤텍스로 지킨다 (잠금을 잡은 채 죽은
+// shard가 있어도 다음 잠금에서 복구). 디렉터리 잠금은 방 생성/입퇴장/설정 변경 때
+// 항목 하나를 고치는 동안만 잡으므로 명령과 게임 진행은 shard마다 따로 돈다.
+//
+// 다른 shard의 방에 들어가려는 연결은 그 shard로 넘긴다: shard마다 받는 데이터그램
+// 소켓이 있고, 연결의 소켓을 SCM_RIGHTS로, 아직 처리하지 않은 입력과 보내지 못한
+// 출력을 본문으로 보낸다. 받은 shard는 그 입력 (/join_room 명령부터)을 이어서 처리한다.
+// 게임 결과도 같은 소켓으로 모든 shard에 보내 /top과 /rank가 어느 shard에서나 같게 보인다.
+#ifndef SHARD_H
+#define SHARD_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#define SHARD_MAX 16
+#define SHARD_ROOMS 1024            // 디렉터리의 방 수 (비어서 지운 방의 칸은 다시 씀)
+#define SHARD_USERS 4096            // 사용자 색인 크기
+#define SHARD_NAME_LENGTH 50
+#define SHARD_ROOM_NAME_LENGTH 100
+#define SHARD_MESSAGE_MAX 16384     // shard 사이 메시지 하나 (넘기는 연결의 밀린 입출력 포함)
+
+// 디렉터리의 방 하나 (id가 0이면 빈 칸)
+typedef struct {
+    int id;
+    int shard;   // 방이 있는 shard
+    int members;
+    int time_limit;
+    char name[SHARD_ROOM_NAME_LENGTH];
+    char game_mode[SHARD_NAME_LENGTH];
+} ShardRoom;
+
+// 접속한 사용자 하나 (shard가 -1이면 빈 칸)
+typedef struct {
+    int shard;
+    char name[SHARD_NAME_LENGTH];
+} ShardUser;
+
+typedef struct {
+    pthread_mutex_t lock; // 프로세스 공유 + robust
+    int shard_count;
+    int next_room_id;     // 모든 shard에서 겹치지 않는 방 ID
+    int room_limit;       // 모든 shard의 방 수 제한 (SHARD_ROOMS 이하)
+    ShardRoom rooms[SHARD_ROOMS];
+    ShardUser users[SHARD_USERS];
+} ShardDirectory;
+
+// shard 사이 메시지 종류
+#define SHARD_MSG_HANDOFF 1 // 연결 넘기기 (소켓은 SCM_RIGHTS)
+#define SHARD_MSG_RESULT 2  // 게임 결과 하나 (순위표 반영)
+
+typedef struct {
+    int type;
+    int user_slot;       // HANDOFF: 사용자 색인 칸
+    int score;           // RESULT
+    uint32_t input_len;  // HANDOFF: 본문 앞부분 (처리할 입력)
+    uint32_t output_len; // HANDOFF: 본문 뒷부분 (먼저 보낼 출력)
+    char name[SHARD_NAME_LENGTH];
+    char game_mode[SHARD_NAME_LENGTH]; // RESULT
+} ShardMessage;
+
+// 이 프로세스가 보는 shard 집합
+typedef struct {
+    ShardDirectory *dir;
+    int index;               // 이 프로세스의 shard 번호 (fork 전 부모는 -1)
+    int count;
+    int inbox[SHARD_MAX];    // shard별로 받는 소켓 (fork 뒤에는 자기 것만 남김)
+    int outbox[SHARD_MAX];   // shard별로 보내는 소켓
+} ShardSet;
+
+// 공유 디렉터리와 shard 사이 소켓을 만듦 (fork 전에), 방은 모든 shard 합쳐 room_limit개까지, 실패 시 -1
+int shard_set_init(ShardSet *set, int count, int room_limit);
+// fork한 자식에서 index번 shard가 됨 (다른 shard의 받는 소켓을 닫음)
+void shard_set_enter(ShardSet *set, int index);
+// 부모에서 받는 소켓을 모두 닫음 (자식이 모두 받은 뒤)
+void shard_set_close_inboxes(ShardSet *set);
+// 죽은 shard의 방과 사용자를 디렉터리에서 지움 (부모가 waitpid 뒤에)
+void shard_forget(ShardSet *set, int index);
+
+// 방 디렉터리
+// 새 방을 이 shard 소유로 등록, 방 ID (방 수 제한에 걸리면 -1)
+int shard_room_add(ShardSet *set, const char *name, const char *game_mode, int time_limit);
+void shard_room_update(ShardSet *set, int room_id, int members, const char *game_mode, int time_limit);
+void shard_room_remove(ShardSet *set, int room_id);
+// 방이 있는 shard, 없는 방이면 -1
+int shard_room_owner(ShardSet *set, int room_id);
+// 모든 shard의 방 목록 (최근에 만든 방부터), 방 수
+int shard_room_list(ShardSet *set, ShardRoom *out, int max);
+// 다음에 줄 방 ID
+int shard_room_next_id(ShardSet *set);
+// 모든 shard의 방 수
+int shard_room_count(ShardSet *set);
+// 방 ID를 next_id 이상에서만 주도록 (이전 서버의 방 ID와 겹치지 않게)
+void shard_room_reserve(ShardSet *set, int next_id);
+// 이전 서버에서 넘어온 방을 같은 ID로 이 shard 소유로 등록 (이미 있으면 고침), 가득 차면 -1
+int shard_room_restore(ShardSet *set, int room_id, const char *name, const char *game_mode, int time_limit,
+                       int members);
+
+// 사용자 색인
+// 이 shard의 사용자로 등록, 칸 번호 (가득 차면 -1)
+int shard_user_add(ShardSet *set, const char *name);
+void shard_user_move(ShardSet *set, int slot, int shard);
+void shard_user_remove(ShardSet *set, int slot);
+// shard별 접속자 수를 counts[0..count-1]에
+void shard_user_counts(ShardSet *set, int *counts);
+
+// shard 사이 메시지
+// 연결을 target shard로 넘김 (fd는 보낸 뒤 호출한 쪽이 닫음), 받는 쪽이 밀려 있으면 -1
+int shard_send_handoff(ShardSet *set, int target, int fd, int user_slot, const char *name,
+                       const char *data, size_t input_len, size_t output_len);
+// 게임 결과를 다른 모든 shard에 알림 (보내지 못한 shard 수)
+int shard_broadcast_result(ShardSet *set, const char *game_mode, const char *name, int score);
+// 받는 소켓에서 메시지 하나 (HANDOFF면 *fd에 받은 소켓, 아니면 -1), 본문은 data에
+// 받은 메시지가 없으면 0, 받았으면 1, 오류면 -1
+int shard_receive(ShardSet *set, ShardMessage *msg, char *data, size_t size, int *fd);
+
+#endif
@@ -0,0 +1,412 @@
+// topic_cache.c
+#define _DEFAULT_SOURCE
+#include "topic_cache.h"
+#include <curl/curl.h>
+#include <errno.h>
+#include <json-c/json.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+typedef struct {
+    char topic[TOPIC_MAX_LENGTH];
+    int notify; // 0이면 prefetch (캐시만 채움)
+} TopicRequest;
+
+static char api_url[512];
+static char api_key[256];
+static TopicWordsCallback on_ready = NULL;
+
+// 대기열과 LRU는 lock으로 보호
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wake = PTHREAD_COND_INITIALIZER;
+static TopicRequest queue[TOPIC_QUEUE_LEN];
+static unsigned queue_head = 0, queue_tail = 0;
+static volatile int stopping = 0;
+static pthread_t worker;
+static int worker_started = 0;
+
+static TopicWords lru[TOPIC_LRU_CAPACITY];
+static unsigned long lru_used[TOPIC_LRU_CAPACITY]; // 마지막 사용 시각 (0이면 빈 칸)
+static unsigned long lru_tick = 0;
+
+static int is_fresh(const TopicWords *words) {
+    return words->count > 0 && time(NULL) - words->fetched_at < TOPIC_CACHE_TTL;
+}
+
+// lock을 잡은 상태에서 호출, 유효한 항목이면 복사하고 1
+static int lru_get(const char *topic, TopicWords *out) {
+    for (int i = 0; i < TOPIC_LRU_CAPACITY; i++) {
+        if (lru_used[i] && strcmp(lru[i].topic, topic) == 0 && is_fresh(&lru[i])) {
+            lru_used[i] = ++lru_tick;
+            if (out) {
+                *out = lru[i];
+            }
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// lock을 잡은 상태에서 호출, 같은 주제가 없으면 가장 오래 안 쓴 칸을 덮어씀
+static void lru_put(const TopicWords *words) {
+    int slot = 0;
+    for (int i = 0; i < TOPIC_LRU_CAPACITY; i++) {
+        if (lru_used[i] && strcmp(lru[i].topic, words->topic) == 0) {
+            slot = i;
+            break;
+        }
+        if (lru_used[i] < lru_used[slot]) {
+            slot = i;
+        }
+    }
+    lru[slot] = *words;
+    lru_used[slot] = ++lru_tick;
+}
+
+// 주제별 캐시 파일 경로 (주제 문자열의 FNV-1a 해시, 파일 안에 주제를 다시 적어 충돌 확인)
+static void cache_path(const char *topic, char *path, size_t size) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (const unsigned char *p = (const unsigned char *)topic; *p; p++) {
+        hash = (hash ^ *p) * 1099511628211ULL;
+    }
+    snprintf(path, size, "%s/%016llx.txt", TOPIC_CACHE_DIR, (unsigned long long)hash);
+}
+
+// 캐시 파일 형식: 첫 줄 "<가져온 시각> <주제>", 이후 한 줄에 한 단어
+// 만료 여부와 관계없이 읽어 옴 (가져오기 실패 시 오래된 단어라도 사용)
+static int disk_load(const char *topic, TopicWords *out) {
+    char path[256], line[TOPIC_MAX_LENGTH + 32];
+    cache_path(topic, path, sizeof(path));
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        return -1;
+    }
+
+    long long fetched_at;
+    int offset = 0;
+    if (!fgets(line, sizeof(line), fp) || sscanf(line, "%lld %n", &fetched_at, &offset) != 1) {
+        fclose(fp);
+        return -1;
+    }
+    line[strcspn(line, "\n")] = '\0';
+    if (strcmp(line + offset, topic) != 0) {
+        fclose(fp);
+        return -1;
+    }
+
+    memset(out, 0, sizeof(*out));
+    snprintf(out->topic, sizeof(out->topic), "%s", topic);
+    out->fetched_at = (time_t)fetched_at;
+    while (out->count < TOPIC_MAX_WORDS && fgets(line, sizeof(line), fp)) {
+        line[strcspn(line, "\n")] = '\0';
+        if (line[0] != '\0' && strlen(line) < TOPIC_WORD_MAX_LENGTH) {
+            strcpy(out->words[out->count++], line);
+        }
+    }
+    fclose(fp);
+    return out->count > 0 ? 0 : -1;
+}
+
+// 임시 파일에 쓴 뒤 이름을 바꿔 반쯤 쓴 캐시 파일이 남지 않게 함
+static void disk_store(const TopicWords *words) {
+    char path[256], tmp_path[272];
+    cache_path(words->topic, path, sizeof(path));
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    if (mkdir(TOPIC_CACHE_DIR, 0755) < 0 && errno != EEXIST) {
+        perror("캐시 디렉토리 생성 실패");
+        return;
+    }
+    FILE *fp = fopen(tmp_path, "w");
+    if (!fp) {
+        perror("캐시 파일 열기 실패");
+        return;
+    }
+    fprintf(fp, "%lld %s\n", (long long)words->fetched_at, words->topic);
+    for (int i = 0; i < words->count; i++) {
+        fprintf(fp, "%s\n", words->words[i]);
+    }
+    if (fclose(fp) != 0 || rename(tmp_path, path) != 0) {
+        perror("캐시 파일 저장 실패");
+        unlink(tmp_path);
+    }
+}
+
+// 응답 본문 저장용
+struct MemoryStruct {
+    char *memory;
+    size_t size;
+};
+
+static size_t write_callback(void *contents, size_t size, size_t nmemb, void *userp) {
+    size_t realsize = size * nmemb;
+    struct MemoryStruct *mem = (struct MemoryStruct *)userp;
+
+    char *ptr = realloc(mem->memory, mem->size + realsize + 1);
+    if (!ptr) {
+        return 0;
+    }
+
+    mem->memory = ptr;
+    memcpy(&(mem->memory[mem->size]), contents, realsize);
+    mem->size += realsize;
+    mem->memory[mem->size] = 0;
+
+    return realsize;
+}
+
+// 종료 중이면 진행 중인 요청을 중단
+static int progress_callback(void *clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow) {
+    (void)clientp;
+    (void)dltotal;
+    (void)dlnow;
+    (void)ultotal;
+    (void)ulnow;
+    return stopping;
+}
+
+// 쉼표로 구분된 단어 목록 파싱
+static void parse_words(const char *content, TopicWords *out) {
+    char *copy = strdup(content);
+    char *save = NULL;
+    if (!copy) {
+        return;
+    }
+    for (char *token = strtok_r(copy, ",", &save); token != NULL && out->count < TOPIC_MAX_WORDS;
+         token = strtok_r(NULL, ",", &save)) {
+        // 공백 제거
+        while (*token == ' ' || *token == '\n' || *token == '\r') token++;
+        char *end = token + strlen(token);
+        while (end > token && (end[-1] == ' ' || end[-1] == '\n' || end[-1] == '\r')) end--;
+        *end = '\0';
+
+        if (end > token && (size_t)(end - token) < TOPIC_WORD_MAX_LENGTH) {
+            strcpy(out->words[out->count++], token);
+        }
+    }
+    free(copy);
+}
+
+// GPT API에서 단어 가져오기, 가져온 단어 수 반환
+static int fetch_words(const char *topic, TopicWords *out) {
+    CURL *curl;
+    CURLcode res;
+    struct MemoryStruct chunk;
+
+    memset(out, 0, sizeof(*out));
+    snprintf(out->topic, sizeof(out->topic), "%s", topic);
+
+    curl = curl_easy_init();
+    if (!curl) {
+        return 0;
+    }
+    chunk.memory = malloc(1);
+    chunk.size = 0;
+
+    // JSON 요청 생성
+    struct json_object *json_obj = json_object_new_object();
+    struct json_object *messages_array = json_object_new_array();
+    struct json_object *message_obj = json_object_new_object();
+
+    json_object_object_add(message_obj, "role", json_object_new_string("user"));
+
+    char prompt[1024];
+    snprintf(prompt, sizeof(prompt),
+        "다음 주제와 관련된 영어 단어 30개를 쉼표로 구분해서 알려줘. "
+        "단어는 3-10글자 사이여야 하고, 게임에서 사용할 수 있는 단순한 단어여야 해. "
+        "주제: %s", topic);
+
+    json_object_object_add(message_obj, "content", json_object_new_string(prompt));
+    json_object_array_add(messages_array, message_obj);
+    json_object_object_add(json_obj, "messages", messages_array);
+    json_object_object_add(json_obj, "model", json_object_new_string("gpt-3.5-turbo"));
+    json_object_object_add(json_obj, "max_tokens", json_object_new_int(200));
+
+    const char *json_string = json_object_to_json_string(json_obj);
+
+    // 헤더 설정
+    struct curl_slist *headers = NULL;
+    headers = curl_slist_append(headers, "Content-Type: application/json");
+    char auth_header[300];
+    snprintf(auth_header, sizeof(auth_header), "Authorization: Bearer %s", api_key);
+    headers = curl_slist_append(headers, auth_header);
+
+    curl_easy_setopt(curl, CURLOPT_URL, api_url);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&chunk);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_string);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, (long)TOPIC_FETCH_TIMEOUT);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L); // 작업 스레드에서 시그널 사용 금지
+    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+    curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, progress_callback);
+
+    res = curl_easy_perform(curl);
+
+    if (res == CURLE_OK && chunk.memory) {
+        // JSON 응답 파싱
+        struct json_object *response_obj = json_tokener_parse(chunk.memory);
+        struct json_object *choices_array, *first_choice, *message, *content;
+
+        if (response_obj && json_object_object_get_ex(response_obj, "choices", &choices_array) &&
+            json_object_array_length(choices_array) > 0) {
+            first_choice = json_object_array_get_idx(choices_array, 0);
+            if (json_object_object_get_ex(first_choice, "message", &message) &&
+                json_object_object_get_ex(message, "content", &content)) {
+                parse_words(json_object_get_string(content), out);
+            }
+        }
+        json_object_put(response_obj);
+    }
+
+    // 정리
+    curl_easy_cleanup(curl);
+    curl_slist_free_all(headers);
+    json_object_put(json_obj);
+    free(chunk.memory);
+
+    out->fetched_at = time(NULL);
+    return out->count;
+}
+
+// 요청 하나 처리: 메모리 -> 디스크 -> API 순으로 찾음
+static void handle_request(const TopicRequest *req) {
+    TopicWords *words = malloc(sizeof(TopicWords));
+    TopicWords *stale = malloc(sizeof(TopicWords));
+    if (!words || !stale) {
+        perror("malloc");
+        free(words);
+        free(stale);
+        return;
+    }
+
+    pthread_mutex_lock(&lock);
+    int hit = lru_get(req->topic, words);
+    pthread_mutex_unlock(&lock);
+    if (hit) {
+        if (req->notify)
+            on_ready(words, 1);
+        goto done;
+    }
+
+    int on_disk = disk_load(req->topic, stale) == 0;
+    if (on_disk && is_fresh(stale)) {
+        pthread_mutex_lock(&lock);
+        lru_put(stale);
+        pthread_mutex_unlock(&lock);
+        if (req->notify)
+            on_ready(stale, 1);
+        goto done;
+    }
+
+    if (fetch_words(req->topic, words) > 0) {
+        disk_store(words);
+        pthread_mutex_lock(&lock);
+        lru_put(words);
+        pthread_mutex_unlock(&lock);
+        if (req->notify)
+            on_ready(words, 0);
+    } else if (req->notify && !stopping) {
+        // 가져오기 실패 시 만료된 캐시라도 사용 (종료 중 중단된 요청은 알리지 않음)
+        on_ready(on_disk ? stale : words, on_disk);
+    }
+
+done:
+    free(words);
+    free(stale);
+}
+
+static void *worker_func(void *arg) {
+    (void)arg;
+    while (1) {
+        pthread_mutex_lock(&lock);
+        while (!stopping && queue_head == queue_tail) {
+            pthread_cond_wait(&wake, &lock);
+        }
+        if (stopping) {
+            pthread_mutex_unlock(&lock);
+            return NULL;
+        }
+        TopicRequest req = queue[queue_head++ % TOPIC_QUEUE_LEN];
+        pthread_mutex_unlock(&lock);
+
+        handle_request(&req);
+    }
+}
+
+// 작업 스레드 시작 (api_url / api_key는 환경 변수가 없을 때의 기본값)
+int topic_cache_init(const char *default_url, const char *default_key, TopicWordsCallback callback) {
+    const char *url = getenv(TOPIC_API_URL_ENV);
+    const char *key = getenv(TOPIC_API_KEY_ENV);
+    snprintf(api_url, sizeof(api_url), "%s", url && *url ? url : default_url);
+    snprintf(api_key, sizeof(api_key), "%s", key && *key ? key : default_key);
+    on_ready = callback;
+
+    stopping = 0;
+    if (pthread_create(&worker, NULL, worker_func, NULL) != 0) {
+        perror("주제 단어 쓰레드 생성 실패");
+        return -1;
+    }
+    worker_started = 1;
+    return 0;
+}
+
+// 작업 스레드 종료 (진행 중인 요청은 중단)
+void topic_cache_shutdown() {
+    if (!worker_started) {
+        return;
+    }
+    pthread_mutex_lock(&lock);
+    stopping = 1;
+    pthread_cond_signal(&wake);
+    pthread_mutex_unlock(&lock);
+    pthread_join(worker, NULL);
+    worker_started = 0;
+}
+
+// lock을 잡은 상태에서 호출, 같은 주제가 이미 대기 중이면 합침
+static int enqueue(const char *topic, int notify) {
+    for (unsigned i = queue_head; i != queue_tail; i++) {
+        TopicRequest *req = &queue[i % TOPIC_QUEUE_LEN];
+        if (strcmp(req->topic, topic) == 0) {
+            req->notify |= notify;
+            return 0;
+        }
+    }
+    if (queue_tail - queue_head == TOPIC_QUEUE_LEN) {
+        return -1;
+    }
+    TopicRequest *req = &queue[queue_tail++ % TOPIC_QUEUE_LEN];
+    snprintf(req->topic, sizeof(req->topic), "%s", topic);
+    req->notify = notify;
+    pthread_cond_signal(&wake);
+    return 0;
+}
+
+// 주제 단어 요청, 메모리에 유효한 항목이 있으면 바로 콜백 후 1 / 대기열에 넣으면 0 / 대기열이 가득 차면 -1
+int topic_cache_request(const char *topic) {
+    static TopicWords words; // 요청은 입력 쓰레드 하나에서만 함
+    pthread_mutex_lock(&lock);
+    if (lru_get(topic, &words)) {
+        pthread_mutex_unlock(&lock);
+        on_ready(&words, 1);
+        return 1;
+    }
+    int result = worker_started ? enqueue(topic, 1) : -1;
+    pthread_mutex_unlock(&lock);
+    return result;
+}
+
+// 콜백 없이 캐시만 채움 (이미 유효한 항목이 있으면 아무것도 하지 않음)
+void topic_cache_prefetch(const char *topic) {
+    pthread_mutex_lock(&lock);
+    if (worker_started && !lru_get(topic, NULL)) {
+        enqueue(topic, 0);
+    }
+    pthread_mutex_unlock(&lock);
+}
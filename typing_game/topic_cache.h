@@ -0,0 +1,43 @@
+// topic_cache.h
+// /topic 단어 가져오기 (백그라운드 작업 스레드 + 메모리 LRU + 디스크 캐시)
+#ifndef TOPIC_CACHE_H
+#define TOPIC_CACHE_H
+
+#include <time.h>
+
+#define TOPIC_MAX_LENGTH 128
+#define TOPIC_MAX_WORDS 30          // 한 주제에서 가져오는 단어 수
+#define TOPIC_WORD_MAX_LENGTH 32    // 단어 하나의 최대 길이 (NUL 포함)
+#define TOPIC_LRU_CAPACITY 16       // 메모리에 들고 있는 주제 수
+#define TOPIC_QUEUE_LEN 8           // 대기 중인 요청 수
+#define TOPIC_CACHE_DIR "topic_cache"
+#define TOPIC_CACHE_TTL (7 * 24 * 60 * 60) // 디스크 캐시 유효 기간 (초)
+#define TOPIC_FETCH_TIMEOUT 15      // API 요청 제한 시간 (초)
+
+// API 주소와 키는 환경 변수로 바꿀 수 있음 (로컬 테스트 서버 등)
+#define TOPIC_API_URL_ENV "TYPING_GPT_API_URL"
+#define TOPIC_API_KEY_ENV "TYPING_GPT_API_KEY"
+
+typedef struct {
+    char topic[TOPIC_MAX_LENGTH];
+    int count; // 0이면 가져오기 실패
+    char words[TOPIC_MAX_WORDS][TOPIC_WORD_MAX_LENGTH];
+    time_t fetched_at;
+} TopicWords;
+
+// 요청한 주제의 단어가 준비되면 호출 (캐시 적중이면 요청한 스레드, 아니면 작업 스레드에서)
+typedef void (*TopicWordsCallback)(const TopicWords *words, int from_cache);
+
+// 작업 스레드 시작 (api_url / api_key는 환경 변수가 없을 때의 기본값)
+int topic_cache_init(const char *api_url, const char *api_key, TopicWordsCallback callback);
+
+// 작업 스레드 종료 (진행 중인 요청은 중단)
+void topic_cache_shutdown();
+
+// 주제 단어 요청, 메모리에 유효한 항목이 있으면 바로 콜백 후 1 / 대기열에 넣으면 0 / 대기열이 가득 차면 -1
+int topic_cache_request(const char *topic);
+
+// 콜백 없이 캐시만 채움 (이미 유효한 항목이 있으면 아무것도 하지 않음)
+void topic_cache_prefetch(const char *topic);
+
+#endif
@@ -0,0 +1,153 @@
+// upgrade.c
+#define _GNU_SOURCE
+#include "upgrade.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// index번 shard의 제어 소켓 주소 (추상 이름공간이라 파일이 남지 않음)
+static socklen_t control_address(int index, struct sockaddr_un *address) {
+    char name[sizeof(address->sun_path)];
+    int len = snprintf(name, sizeof(name), UPGRADE_SOCKET_FORMAT, index);
+    memset(address, 0, sizeof(*address));
+    address->sun_family = AF_UNIX;
+    memcpy(address->sun_path, name, (size_t)len);
+    address->sun_path[0] = '\0';
+    return (socklen_t)(offsetof(struct sockaddr_un, sun_path) + (size_t)len);
+}
+
+// 블로킹으로 바꾸고 보내기 / 받기가 UPGRADE_TIMEOUT_MS 넘게 막히지 않도록
+static int set_timeout(int fd) {
+    struct timeval timeout = {UPGRADE_TIMEOUT_MS / 1000, (UPGRADE_TIMEOUT_MS % 1000) * 1000};
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags & ~O_NONBLOCK) < 0 ||
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) < 0 ||
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+int upgrade_listen(int index) {
+    struct sockaddr_un address;
+    socklen_t len = control_address(index, &address);
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        perror("제어 소켓 생성 실패");
+        return -1;
+    }
+    if (bind(fd, (struct sockaddr *)&address, len) < 0 || listen(fd, 4) < 0) {
+        perror("제어 소켓 바인드 실패");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int upgrade_connect(int index) {
+    struct sockaddr_un address;
+    socklen_t len = control_address(index, &address);
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (connect(fd, (struct sockaddr *)&address, len) < 0 || set_timeout(fd) < 0) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+    return fd;
+}
+
+int upgrade_accepted(int fd) {
+    // 추상 소켓은 같은 컴퓨터의 누구나 연결할 수 있으므로 연결을 넘기기 전에 상대를 확인
+    struct ucred peer;
+    socklen_t len = sizeof(peer);
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &peer, &len) < 0 || peer.uid != getuid()) {
+        return -1;
+    }
+    return set_timeout(fd);
+}
+
+int upgrade_send(int fd, const UpgradeMessage *msg, const char *data, int pass_fd) {
+    size_t len = (size_t)msg->input_len + msg->output_len;
+    if (len > UPGRADE_DATA_MAX) {
+        errno = EMSGSIZE;
+        return -1;
+    }
+    struct iovec iov[2] = {{(void *)msg, sizeof(*msg)}, {(void *)data, len}};
+    struct msghdr header;
+    memset(&header, 0, sizeof(header));
+    header.msg_iov = iov;
+    header.msg_iovlen = len > 0 ? 2 : 1;
+
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } control;
+    if (pass_fd >= 0) {
+        memset(&control, 0, sizeof(control));
+        header.msg_control = control.buf;
+        header.msg_controllen = sizeof(control.buf);
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&header);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &pass_fd, sizeof(int));
+    }
+
+    ssize_t n;
+    do {
+        n = sendmsg(fd, &header, MSG_NOSIGNAL);
+    } while (n < 0 && errno == EINTR);
+    return n < 0 ? -1 : 0;
+}
+
+int upgrade_receive(int fd, UpgradeMessage *msg, char *data, size_t size, int *pass_fd) {
+    struct iovec iov[2] = {{msg, sizeof(*msg)}, {data, size}};
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } control;
+    struct msghdr header;
+    memset(&header, 0, sizeof(header));
+    header.msg_iov = iov;
+    header.msg_iovlen = 2;
+    header.msg_control = control.buf;
+    header.msg_controllen = sizeof(control.buf);
+
+    *pass_fd = -1;
+    ssize_t n;
+    do {
+        n = recvmsg(fd, &header, MSG_CMSG_CLOEXEC);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) {
+        return n == 0 ? 0 : -1;
+    }
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&header); cmsg != NULL; cmsg = CMSG_NXTHDR(&header, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            memcpy(pass_fd, CMSG_DATA(cmsg), sizeof(int));
+        }
+    }
+    // 잘린 메시지나 길이가 맞지 않는 메시지는 버림 (같이 온 소켓은 닫음)
+    if ((size_t)n < sizeof(*msg) || (header.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) ||
+        (size_t)n - sizeof(*msg) != (size_t)msg->input_len + msg->output_len) {
+        if (*pass_fd >= 0) {
+            close(*pass_fd);
+            *pass_fd = -1;
+        }
+        errno = EPROTO;
+        return -1;
+    }
+    msg->name[sizeof(msg->name) - 1] = '\0';
+    msg->game_mode[sizeof(msg->game_mode) - 1] = '\0';
+    return 1;
+}
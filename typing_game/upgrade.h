@@ -0,0 +1,69 @@
+// upgrade.h
+// 무중단 재시작: 실행 중인 서버가 새 서버 프로세스로 리스닝 소켓, 연결, 방을 넘김
+//
+// shard마다 제어 소켓 (추상 Unix 이름, SOCK_SEQPACKET)이 있고, 새 서버 (server --upgrade)는
+// 같은 번호의 shard끼리 연결한다. 순서는
+//   1. 이전 shard: HELLO (shard 수, 다음 방 ID)를 보내고 GO까지 멈춤 (새 방 ID와 순위표 로그가 고정됨)
+//   2. 새 서버: 모든 HELLO를 받은 뒤 순위표를 읽고 shard를 띄워 GO
+//   3. 이전 shard: 리스닝 소켓 (LISTENER), 게임 중이 아닌 방 (ROOM + 멤버 USER), 로비 사용자와
+//      이름을 받기 전 연결 (USER)을 SCM_RIGHTS로 넘기고, 제어 소켓 이름을 놓은 뒤 DONE
+//   4. 이전 shard는 새 연결을 받지 않고 게임 중인 방만 계속 진행하다가 게임이 끝나는 대로 ROOM으로
+//      넘기고, 끝난 게임 결과는 RESULT로 새 서버에 기록을 맡김. 넘길 것이 없으면 종료
+// 연결을 넘길 때 아직 처리하지 않은 입력과 보내지 못한 출력도 본문으로 함께 보내므로
+// 클라이언트는 재접속 없이 같은 소켓으로 이어서 쓴다.
+#ifndef UPGRADE_H
+#define UPGRADE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define UPGRADE_SOCKET_FORMAT "@typing_game.upgrade.%d" // shard 번호별 제어 소켓
+#define UPGRADE_TIMEOUT_MS 5000                         // 상대가 이보다 오래 응답하지 않으면 넘기기 취소
+#define UPGRADE_DATA_MAX 65536                          // 연결 하나의 밀린 입출력 (넘으면 그 연결은 끊음)
+
+// 메시지 종류
+#define UPGRADE_MSG_HELLO 1    // 이전 → 새: shard 수, 다음 방 ID
+#define UPGRADE_MSG_GO 2       // 새 → 이전: 넘기기 시작
+#define UPGRADE_MSG_LISTENER 3 // 리스닝 소켓 하나
+#define UPGRADE_MSG_ROOM 4     // 게임 중이 아닌 방 (이어서 멤버 members명이 USER로)
+#define UPGRADE_MSG_PENDING 5  // 게임 중이라 이전 shard에 남은 방 (방 목록에만 보임)
+#define UPGRADE_MSG_USER 6     // 연결 하나 (본문은 [처리하지 않은 입력][보내지 못한 출력])
+#define UPGRADE_MSG_RESULT 7   // 이전 shard에서 끝난 게임 결과
+#define UPGRADE_MSG_DONE 8     // 처음 넘기기 끝 (이전 shard가 제어 소켓 이름을 놓음)
+
+#define UPGRADE_LISTENER_TCP 0
+#define UPGRADE_LISTENER_UNIX 1
+
+typedef struct {
+    int type;
+    int shard_count;    // HELLO
+    int next_room_id;   // HELLO
+    int listener;       // LISTENER: UPGRADE_LISTENER_*
+    int room_id;        // ROOM, PENDING, USER (로비 사용자는 -1)
+    int members;        // ROOM: 뒤따를 USER 수, PENDING: 목록에 보일 인원
+    int time_limit;     // ROOM, PENDING
+    int ready_count;    // ROOM
+    int game_over;      // ROOM
+    int is_ready;       // USER
+    int is_host;        // USER
+    int score;          // RESULT
+    uint32_t input_len;  // USER
+    uint32_t output_len; // USER
+    char name[100];      // 방 이름 / 사용자 이름 (이름을 받기 전 연결이면 빈 문자열)
+    char game_mode[50];  // ROOM, PENDING, RESULT
+} UpgradeMessage;
+
+// index번 shard의 제어 소켓에서 listen, 실패 시 -1
+int upgrade_listen(int index);
+// 실행 중인 서버의 index번 shard에 연결 (블로킹, 시간 제한 설정), 없으면 -1
+int upgrade_connect(int index);
+// 받은 제어 연결을 블로킹 + 시간 제한으로 바꾸고 같은 사용자의 프로세스인지 확인, 아니면 -1
+int upgrade_accepted(int fd);
+
+// 메시지 하나 (pass_fd가 0 이상이면 SCM_RIGHTS로 함께), data는 input_len + output_len바이트, 실패 시 -1
+int upgrade_send(int fd, const UpgradeMessage *msg, const char *data, int pass_fd);
+// 메시지 하나 (USER와 LISTENER면 *pass_fd에 받은 소켓, 아니면 -1)
+// 받았으면 1, 상대가 닫았으면 0, 오류 (논블로킹 소켓에 받을 것이 없으면 EAGAIN)면 -1
+int upgrade_receive(int fd, UpgradeMessage *msg, char *data, size_t size, int *pass_fd);
+
+#endif
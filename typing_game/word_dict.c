@@ -0,0 +1,105 @@
+// word_dict.c
+#define _DEFAULT_SOURCE
+#include "word_dict.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// 파일을 mmap하고 헤더와 표 크기를 검사, 실패 시 -1
+// 단어 수에 비례하는 검사는 하지 않음 (오프셋은 고를 때 범위만 확인)
+int word_dict_open(WordDict *dict, const char *path) {
+    memset(dict, 0, sizeof(*dict));
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(WordDictHeader)) {
+        close(fd);
+        return -1;
+    }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror("사전 mmap 실패");
+        return -1;
+    }
+
+    const WordDictHeader *hdr = map;
+    size_t tables = ((size_t)WORD_DICT_BUCKETS + 1 + hdr->word_count) * sizeof(uint32_t);
+    if (memcmp(hdr->magic, WORD_DICT_MAGIC, 4) != 0 || hdr->version != WORD_DICT_VERSION ||
+        hdr->buckets != WORD_DICT_BUCKETS || hdr->pool_size == 0 ||
+        (size_t)st.st_size != sizeof(WordDictHeader) + tables + hdr->pool_size) {
+        munmap(map, (size_t)st.st_size);
+        return -1;
+    }
+
+    dict->map = map;
+    dict->map_size = (size_t)st.st_size;
+    dict->word_count = hdr->word_count;
+    dict->bucket_start = (const uint32_t *)(hdr + 1);
+    dict->offsets = dict->bucket_start + WORD_DICT_BUCKETS + 1;
+    dict->pool = (const char *)(dict->offsets + hdr->word_count);
+    dict->pool_size = hdr->pool_size;
+
+    // 버킷 구간이 단어 수를 넘지 않고 풀이 NUL로 끝나야 모든 문자열이 안전
+    if (dict->bucket_start[0] != 0 || dict->bucket_start[WORD_DICT_BUCKETS] != dict->word_count ||
+        dict->pool[dict->pool_size - 1] != '\0') {
+        word_dict_close(dict);
+        return -1;
+    }
+    for (int b = 0; b < WORD_DICT_BUCKETS; b++) {
+        if (dict->bucket_start[b] > dict->bucket_start[b + 1]) {
+            word_dict_close(dict);
+            return -1;
+        }
+    }
+
+    // 고르는 위치가 무작위라 미리 읽기는 도움이 되지 않음
+    madvise(map, dict->map_size, MADV_RANDOM);
+    return 0;
+}
+
+void word_dict_close(WordDict *dict) {
+    if (dict->map) {
+        munmap(dict->map, dict->map_size);
+    }
+    memset(dict, 0, sizeof(*dict));
+}
+
+// [first, last) 구간에서 무작위 단어
+static const char *pick(const WordDict *dict, uint32_t first, uint32_t last) {
+    if (!dict->map || first >= last) {
+        return NULL;
+    }
+    // rand()는 최소 15비트만 보장되므로 두 번 섞어 백만 단어 이상도 고르게
+    uint32_t r = ((uint32_t)rand() << 15) ^ (uint32_t)rand();
+    uint32_t offset = dict->offsets[first + r % (last - first)];
+    return offset < dict->pool_size ? dict->pool + offset : NULL;
+}
+
+// 난이도 안에서 무작위 단어 (비어 있으면 NULL)
+const char *word_dict_random(const WordDict *dict, int difficulty) {
+    return word_dict_random_max_length(dict, difficulty, WORD_DICT_MAX_LENGTH);
+}
+
+// 길이 제한을 두고 난이도 안에서 무작위 단어 (길이 버킷이 연속이라 구간만 좁히면 됨)
+const char *word_dict_random_max_length(const WordDict *dict, int difficulty, int max_length) {
+    if (!dict->map || difficulty < 0 || difficulty >= WORD_DICT_DIFFICULTIES) {
+        return NULL;
+    }
+    if (max_length > WORD_DICT_MAX_LENGTH) {
+        max_length = WORD_DICT_MAX_LENGTH;
+    }
+    if (max_length < 1) {
+        return NULL;
+    }
+    uint32_t first = dict->bucket_start[word_dict_bucket(difficulty, 1)];
+    uint32_t last = dict->bucket_start[word_dict_bucket(difficulty, max_length) + 1];
+    return pick(dict, first, last);
+}
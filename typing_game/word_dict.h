@@ -0,0 +1,58 @@
+// word_dict.h
+// 미리 빌드한 단어 사전 파일 (mmap으로 열어 파싱 없이 바로 사용)
+//
+// 파일 구성 (모든 정수는 리틀 엔디언 uint32)
+//   WordDictHeader
+//   bucket_start[WORD_DICT_BUCKETS + 1]  버킷 b의 단어는 offsets[bucket_start[b] .. bucket_start[b+1])
+//   offsets[word_count]                  문자열 풀 안에서 각 단어의 시작 위치
+//   문자열 풀                            NUL로 끝나는 단어들
+// 단어는 (난이도, 길이) 순으로 정렬되어 있어 한 난이도의 단어도 연속 구간을 이룸
+#ifndef WORD_DICT_H
+#define WORD_DICT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define WORD_DICT_MAGIC "WDCT"
+#define WORD_DICT_VERSION 1
+#define WORD_DICT_FILE "words.dict"
+
+#define WORD_DICT_MAX_LENGTH 31   // 단어 풀의 텍스트 칸에 들어가는 최대 길이
+#define WORD_DICT_DIFFICULTIES 3  // 0: 쉬움, 1: 보통, 2: 어려움
+#define WORD_DICT_BUCKETS (WORD_DICT_DIFFICULTIES * (WORD_DICT_MAX_LENGTH + 1))
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t word_count;
+    uint32_t buckets;   // WORD_DICT_BUCKETS
+    uint32_t pool_size; // 문자열 풀 바이트 수
+    uint32_t reserved[3];
+} WordDictHeader;
+
+typedef struct {
+    void *map;
+    size_t map_size;
+    uint32_t word_count;
+    const uint32_t *bucket_start;
+    const uint32_t *offsets;
+    const char *pool;
+    uint32_t pool_size;
+} WordDict;
+
+// (난이도, 길이) 버킷 번호
+static inline int word_dict_bucket(int difficulty, int length) {
+    return difficulty * (WORD_DICT_MAX_LENGTH + 1) + length;
+}
+
+// 파일을 mmap하고 헤더와 표 크기를 검사, 실패 시 -1
+int word_dict_open(WordDict *dict, const char *path);
+void word_dict_close(WordDict *dict);
+
+// 난이도 안에서 무작위 단어 (비어 있으면 NULL)
+const char *word_dict_random(const WordDict *dict, int difficulty);
+
+// 길이 제한을 두고 난이도 안에서 무작위 단어 (길이 버킷이 연속이라 구간만 좁히면 됨)
+const char *word_dict_random_max_length(const WordDict *dict, int difficulty, int max_length);
+
+#endif
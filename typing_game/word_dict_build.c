@@ -0,0 +1,192 @@
+// word_dict_build.c
+// 단어 목록(텍스트)으로 사전 파일을 만드는 도구
+// 사용법 : ./word_dict_build words.txt words.dict
+//
+// 입력은 한 줄에 한 단어, "단어<TAB>난이도(0~2)" 형식이면 난이도를 지정
+// 난이도가 없으면 길이로 정함 (5자 이하 쉬움, 8자 이하 보통, 그 외 어려움)
+// 빈 줄과 '#'으로 시작하는 줄은 무시
+
+#define _DEFAULT_SOURCE
+#include "word_dict.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+typedef struct {
+    char *text;
+    int length;
+    int difficulty;
+} Entry;
+
+static int compare_entry(const void *a, const void *b) {
+    const Entry *x = a, *y = b;
+    if (x->difficulty != y->difficulty)
+        return x->difficulty - y->difficulty;
+    if (x->length != y->length)
+        return x->length - y->length;
+    return strcmp(x->text, y->text);
+}
+
+static int default_difficulty(int length) {
+    if (length <= 5)
+        return 0;
+    if (length <= 8)
+        return 1;
+    return 2;
+}
+
+// 한 줄을 단어 항목으로 변환, 건너뛸 줄이면 0
+static int parse_line(char *line, Entry *entry, long line_no) {
+    line[strcspn(line, "\r\n")] = '\0';
+    if (line[0] == '\0' || line[0] == '#')
+        return 0;
+
+    int difficulty = -1;
+    char *tab = strchr(line, '\t');
+    if (tab) {
+        *tab = '\0';
+        char *end;
+        long value = strtol(tab + 1, &end, 10);
+        if (end == tab + 1 || value < 0 || value >= WORD_DICT_DIFFICULTIES) {
+            fprintf(stderr, "%ld번째 줄: 잘못된 난이도 '%s'\n", line_no, tab + 1);
+            return 0;
+        }
+        difficulty = (int)value;
+    }
+
+    int length = (int)strlen(line);
+    if (length == 0)
+        return 0;
+    if (length > WORD_DICT_MAX_LENGTH) {
+        fprintf(stderr, "%ld번째 줄: %d바이트보다 긴 단어 건너뜀\n", line_no, WORD_DICT_MAX_LENGTH);
+        return 0;
+    }
+
+    entry->text = strdup(line);
+    if (!entry->text) {
+        perror("strdup");
+        exit(EXIT_FAILURE);
+    }
+    entry->length = length;
+    entry->difficulty = difficulty < 0 ? default_difficulty(length) : difficulty;
+    return 1;
+}
+
+static void write_all(FILE *fp, const void *data, size_t size) {
+    if (size > 0 && fwrite(data, size, 1, fp) != 1) {
+        perror("사전 쓰기 실패");
+        exit(EXIT_FAILURE);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "사용법: %s <단어목록.txt> <출력.dict>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    FILE *in = fopen(argv[1], "r");
+    if (!in) {
+        perror("단어 목록 열기 실패");
+        return EXIT_FAILURE;
+    }
+
+    size_t count = 0, capacity = 1024;
+    Entry *entries = malloc(capacity * sizeof(Entry));
+    char line[256];
+    long line_no = 0;
+    if (!entries) {
+        perror("malloc");
+        return EXIT_FAILURE;
+    }
+    while (fgets(line, sizeof(line), in)) {
+        line_no++;
+        if (count == capacity) {
+            capacity *= 2;
+            entries = realloc(entries, capacity * sizeof(Entry));
+            if (!entries) {
+                perror("realloc");
+                return EXIT_FAILURE;
+            }
+        }
+        count += parse_line(line, &entries[count], line_no);
+    }
+    fclose(in);
+
+    // (난이도, 길이, 문자열) 순 정렬 후 중복 제거
+    qsort(entries, count, sizeof(Entry), compare_entry);
+    size_t unique = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (unique > 0 && compare_entry(&entries[unique - 1], &entries[i]) == 0) {
+            free(entries[i].text);
+            continue;
+        }
+        entries[unique++] = entries[i];
+    }
+    if (unique == 0 || unique > UINT32_MAX) {
+        fprintf(stderr, "사전에 넣을 단어가 없거나 너무 많습니다\n");
+        return EXIT_FAILURE;
+    }
+
+    // 버킷 시작 위치와 문자열 오프셋 계산
+    static uint32_t bucket_start[WORD_DICT_BUCKETS + 1];
+    uint32_t *offsets = malloc(unique * sizeof(uint32_t));
+    if (!offsets) {
+        perror("malloc");
+        return EXIT_FAILURE;
+    }
+    size_t pool_size = 0;
+    for (size_t i = 0; i < unique; i++) {
+        bucket_start[word_dict_bucket(entries[i].difficulty, entries[i].length) + 1]++;
+        offsets[i] = (uint32_t)pool_size;
+        pool_size += (size_t)entries[i].length + 1;
+        if (pool_size > UINT32_MAX) {
+            fprintf(stderr, "문자열 풀이 4GB를 넘습니다\n");
+            return EXIT_FAILURE;
+        }
+    }
+    for (int b = 0; b < WORD_DICT_BUCKETS; b++) {
+        bucket_start[b + 1] += bucket_start[b];
+    }
+
+    WordDictHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, WORD_DICT_MAGIC, 4);
+    hdr.version = WORD_DICT_VERSION;
+    hdr.word_count = (uint32_t)unique;
+    hdr.buckets = WORD_DICT_BUCKETS;
+    hdr.pool_size = (uint32_t)pool_size;
+
+    // 임시 파일에 다 쓴 뒤 이름을 바꿔, 실행 중인 클라이언트가 반쯤 쓴 파일을 열지 않게 함
+    char tmp_path[512];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", argv[2]);
+    FILE *out = fopen(tmp_path, "wb");
+    if (!out) {
+        perror("출력 파일 열기 실패");
+        return EXIT_FAILURE;
+    }
+    write_all(out, &hdr, sizeof(hdr));
+    write_all(out, bucket_start, sizeof(bucket_start));
+    write_all(out, offsets, unique * sizeof(uint32_t));
+    for (size_t i = 0; i < unique; i++) {
+        write_all(out, entries[i].text, (size_t)entries[i].length + 1);
+    }
+    if (fclose(out) != 0 || rename(tmp_path, argv[2]) != 0) {
+        perror("사전 저장 실패");
+        unlink(tmp_path);
+        return EXIT_FAILURE;
+    }
+
+    int per_difficulty[WORD_DICT_DIFFICULTIES] = {0};
+    for (size_t i = 0; i < unique; i++) {
+        per_difficulty[entries[i].difficulty]++;
+        free(entries[i].text);
+    }
+    printf("%s: 단어 %zu개 (쉬움 %d, 보통 %d, 어려움 %d), %zu바이트\n", argv[2], unique,
+           per_difficulty[0], per_difficulty[1], per_difficulty[2],
+           sizeof(hdr) + sizeof(bucket_start) + unique * sizeof(uint32_t) + pool_size);
+    free(entries);
+    free(offsets);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,149 @@
+// word_index.c
+#include "word_index.h"
+
+// 자식 중 ch를 가진 노드, 없으면 WORD_INDEX_NONE
+static uint16_t find_child(const WordIndex *index, uint16_t node, unsigned char ch) {
+    uint16_t child = index->nodes[node].first_child;
+    while (child != WORD_INDEX_NONE && index->nodes[child].ch != ch) {
+        child = index->nodes[child].next_sibling;
+    }
+    return child;
+}
+
+static void reset_node(WordIndexNode *node, int depth, unsigned char ch) {
+    node->first_child = WORD_INDEX_NONE;
+    node->next_sibling = WORD_INDEX_NONE;
+    node->head = WORD_INDEX_NONE;
+    node->terminal = WORD_INDEX_NONE;
+    node->count = 0;
+    node->depth = (uint8_t)depth;
+    node->ch = ch;
+}
+
+// 색인 초기화 (루트만 남김)
+void word_index_init(WordIndex *index) {
+    reset_node(&index->nodes[0], 0, 0);
+    index->free_count = 0;
+    // 낮은 번호부터 꺼내 쓰도록 역순으로 쌓음
+    for (int i = WORD_INDEX_NODES - 1; i >= 1; i--) {
+        index->free_nodes[index->free_count++] = (uint16_t)i;
+    }
+}
+
+// 단어 칸 등록
+void word_index_insert(WordIndex *index, int slot, const char *text, int length) {
+    uint16_t node = 0;
+
+    for (int depth = 0;; depth++) {
+        WordIndexNode *n = &index->nodes[node];
+        n->count++;
+
+        // 이 접두사의 리스트 맨 앞에 추가
+        index->prev[slot][depth] = WORD_INDEX_NONE;
+        index->next[slot][depth] = n->head;
+        if (n->head != WORD_INDEX_NONE) {
+            index->prev[n->head][depth] = (uint16_t)slot;
+        }
+        n->head = (uint16_t)slot;
+
+        if (depth == length) {
+            index->terminal_next[slot] = n->terminal;
+            n->terminal = (uint16_t)slot;
+            return;
+        }
+
+        unsigned char ch = (unsigned char)text[depth];
+        uint16_t child = find_child(index, node, ch);
+        if (child == WORD_INDEX_NONE) {
+            // 노드 수는 칸 수 × 최대 길이만큼 잡혀 있어 고갈되지 않음
+            child = index->free_nodes[--index->free_count];
+            reset_node(&index->nodes[child], depth + 1, ch);
+            index->nodes[child].next_sibling = n->first_child;
+            n->first_child = child;
+        }
+        node = child;
+    }
+}
+
+// 단어 칸 해제 (아무 단어도 지나지 않게 된 노드는 반환)
+void word_index_remove(WordIndex *index, int slot, const char *text, int length) {
+    uint16_t path[WORD_INDEX_MAX_LENGTH + 1];
+    uint16_t node = 0;
+
+    for (int depth = 0; depth <= length; depth++) {
+        if (node == WORD_INDEX_NONE) {
+            return; // 등록되지 않은 단어
+        }
+        path[depth] = node;
+        if (depth < length) {
+            node = find_child(index, node, (unsigned char)text[depth]);
+        }
+    }
+
+    // 끝 노드의 terminal 리스트에서 제거
+    uint16_t *link = &index->nodes[path[length]].terminal;
+    while (*link != WORD_INDEX_NONE && *link != slot) {
+        link = &index->terminal_next[*link];
+    }
+    if (*link == WORD_INDEX_NONE) {
+        return;
+    }
+    *link = index->terminal_next[slot];
+
+    int freed_from = -1;
+    for (int depth = 0; depth <= length; depth++) {
+        WordIndexNode *n = &index->nodes[path[depth]];
+        uint16_t prev = index->prev[slot][depth], next = index->next[slot][depth];
+        if (prev != WORD_INDEX_NONE) {
+            index->next[prev][depth] = next;
+        } else {
+            n->head = next;
+        }
+        if (next != WORD_INDEX_NONE) {
+            index->prev[next][depth] = prev;
+        }
+
+        if (--n->count == 0 && depth > 0 && freed_from < 0) {
+            freed_from = depth;
+        }
+    }
+
+    if (freed_from < 0) {
+        return;
+    }
+
+    // 처음으로 비게 된 노드를 부모에서 떼어 내면 그 아래 경로도 모두 빈 노드
+    uint16_t parent = path[freed_from - 1], target = path[freed_from];
+    uint16_t *child = &index->nodes[parent].first_child;
+    while (*child != target) {
+        child = &index->nodes[*child].next_sibling;
+    }
+    *child = index->nodes[target].next_sibling;
+    for (int depth = freed_from; depth <= length; depth++) {
+        index->free_nodes[index->free_count++] = path[depth];
+    }
+}
+
+// 접두사에 해당하는 노드, 없으면 -1 (빈 접두사는 루트)
+int word_index_prefix(const WordIndex *index, const char *text, int length) {
+    if (length > WORD_INDEX_MAX_LENGTH) {
+        return -1;
+    }
+    uint16_t node = 0;
+    for (int depth = 0; depth < length; depth++) {
+        node = find_child(index, node, (unsigned char)text[depth]);
+        if (node == WORD_INDEX_NONE) {
+            return -1;
+        }
+    }
+    return node;
+}
+
+// 정확히 일치하는 단어 칸, 없으면 -1
+int word_index_exact(const WordIndex *index, const char *text, int length) {
+    int node = word_index_prefix(index, text, length);
+    if (node < 0 || index->nodes[node].terminal == WORD_INDEX_NONE) {
+        return -1;
+    }
+    return index->nodes[node].terminal;
+}
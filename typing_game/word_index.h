@@ -0,0 +1,60 @@
+// word_index.h
+// 화면에 있는 단어의 접두사 트라이 (입력 길이에 비례하는 시간으로 일치/접두사 검색)
+#ifndef WORD_INDEX_H
+#define WORD_INDEX_H
+
+#include <stdint.h>
+
+#define WORD_INDEX_SLOTS 128      // 색인할 수 있는 단어 칸 수 (단어 풀의 텍스트 칸과 1:1)
+#define WORD_INDEX_MAX_LENGTH 31  // 색인하는 단어의 최대 길이
+#define WORD_INDEX_NODES (WORD_INDEX_SLOTS * WORD_INDEX_MAX_LENGTH + 1)
+#define WORD_INDEX_NONE 0xFFFF
+
+// 노드의 자식은 first_child / next_sibling 연결 리스트
+// 각 노드는 자신을 지나는 단어 칸의 리스트(head)와 정확히 자신에서 끝나는 단어 칸의 리스트(terminal)를 가짐
+typedef struct {
+    uint16_t first_child;
+    uint16_t next_sibling;
+    uint16_t head;     // 이 접두사를 가진 단어 칸 (깊이별 링크로 연결)
+    uint16_t terminal; // 이 노드에서 끝나는 단어 칸
+    uint16_t count;    // 이 노드를 지나는 단어 수 (0이 되면 노드 반환)
+    uint8_t depth;
+    unsigned char ch;
+} WordIndexNode;
+
+typedef struct {
+    WordIndexNode nodes[WORD_INDEX_NODES]; // 0번은 루트
+    uint16_t free_nodes[WORD_INDEX_NODES];
+    int free_count;
+
+    // 단어 칸마다 깊이별 이중 연결 링크 (노드를 따로 할당하지 않는 침투형 리스트)
+    uint16_t next[WORD_INDEX_SLOTS][WORD_INDEX_MAX_LENGTH + 1];
+    uint16_t prev[WORD_INDEX_SLOTS][WORD_INDEX_MAX_LENGTH + 1];
+    uint16_t terminal_next[WORD_INDEX_SLOTS];
+} WordIndex;
+
+// 색인 초기화 (루트만 남김)
+void word_index_init(WordIndex *index);
+
+// 단어 칸 등록 / 해제 (length는 WORD_INDEX_MAX_LENGTH 이하)
+void word_index_insert(WordIndex *index, int slot, const char *text, int length);
+void word_index_remove(WordIndex *index, int slot, const char *text, int length);
+
+// 정확히 일치하는 단어 칸, 없으면 -1
+int word_index_exact(const WordIndex *index, const char *text, int length);
+
+// 접두사에 해당하는 노드, 없으면 -1 (빈 접두사는 루트)
+int word_index_prefix(const WordIndex *index, const char *text, int length);
+
+// 노드의 접두사를 가진 단어 칸 순회 (끝이면 -1)
+static inline int word_index_first(const WordIndex *index, int node) {
+    uint16_t slot = index->nodes[node].head;
+    return slot == WORD_INDEX_NONE ? -1 : slot;
+}
+
+static inline int word_index_next(const WordIndex *index, int node, int slot) {
+    uint16_t next = index->next[slot][index->nodes[node].depth];
+    return next == WORD_INDEX_NONE ? -1 : next;
+}
+
+#endif
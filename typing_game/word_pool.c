@@ -0,0 +1,92 @@
+// word_pool.c
+#include "word_pool.h"
+#include <string.h>
+
+// 풀 초기화 (모든 텍스트 칸을 빈 칸으로)
+void word_pool_init(WordPool *pool) {
+    pool->count = 0;
+    word_index_init(&pool->index);
+    pool->free_count = WORD_POOL_CAPACITY;
+    for (int i = 0; i < WORD_POOL_CAPACITY; i++) {
+        // 낮은 칸부터 꺼내 쓰도록 역순으로 쌓음
+        pool->free_text[i] = (uint16_t)((WORD_POOL_CAPACITY - 1 - i) * WORD_POOL_TEXT_STRIDE);
+    }
+}
+
+// 단어 추가, 성공 시 인덱스 / 가득 차면 -1
+int word_pool_spawn(WordPool *pool, const char *word, int row, int col, int power_up, int stream_id) {
+    if (pool->count == WORD_POOL_CAPACITY || pool->free_count == 0) {
+        return -1;
+    }
+
+    uint16_t offset = pool->free_text[--pool->free_count];
+    size_t length = strlen(word);
+    if (length > WORD_POOL_TEXT_STRIDE - 1) {
+        length = WORD_POOL_TEXT_STRIDE - 1;
+    }
+    memcpy(pool->text + offset, word, length);
+    pool->text[offset + length] = '\0';
+
+    int index = pool->count++;
+    pool->row[index] = row;
+    pool->col[index] = col;
+    pool->length[index] = (int)length;
+    pool->power_up[index] = (uint8_t)(power_up != 0);
+    pool->text_offset[index] = offset;
+    pool->stream_id[index] = stream_id;
+
+    int slot = offset / WORD_POOL_TEXT_STRIDE;
+    pool->slot_index[slot] = (int16_t)index;
+    word_index_insert(&pool->index, slot, pool->text + offset, (int)length);
+    return index;
+}
+
+// 인덱스의 단어 제거 (마지막 단어를 그 자리로 옮김)
+void word_pool_despawn(WordPool *pool, int index) {
+    if (index < 0 || index >= pool->count) {
+        return;
+    }
+    uint16_t offset = pool->text_offset[index];
+    word_index_remove(&pool->index, offset / WORD_POOL_TEXT_STRIDE, pool->text + offset, pool->length[index]);
+    pool->free_text[pool->free_count++] = offset;
+
+    int last = --pool->count;
+    if (index != last) {
+        pool->row[index] = pool->row[last];
+        pool->col[index] = pool->col[last];
+        pool->length[index] = pool->length[last];
+        pool->power_up[index] = pool->power_up[last];
+        pool->text_offset[index] = pool->text_offset[last];
+        pool->stream_id[index] = pool->stream_id[last];
+        pool->slot_index[pool->text_offset[index] / WORD_POOL_TEXT_STRIDE] = (int16_t)index;
+    }
+}
+
+// 입력과 정확히 일치하는 단어의 인덱스, 없으면 -1
+int word_pool_find(const WordPool *pool, const char *str) {
+    int slot = word_index_exact(&pool->index, str, (int)strlen(str));
+    return slot < 0 ? -1 : pool->slot_index[slot];
+}
+
+// 입력 중인 접두사로 시작하는 단어 중 가장 아래에 있는 단어의 인덱스, 없으면 -1
+int word_pool_target(const WordPool *pool, const char *prefix) {
+    int length = (int)strlen(prefix);
+    if (length == 0) {
+        return -1;
+    }
+    int node = word_index_prefix(&pool->index, prefix, length);
+    if (node < 0) {
+        return -1;
+    }
+
+    // 접두사가 같은 단어만 훑음 (곧 떨어질 단어를 우선)
+    int best = -1;
+    for (int slot = word_index_first(&pool->index, node); slot >= 0;
+         slot = word_index_next(&pool->index, node, slot)) {
+        int i = pool->slot_index[slot];
+        if (best < 0 || pool->row[i] > pool->row[best]) {
+            best = i;
+        }
+    }
+    return best;
+}
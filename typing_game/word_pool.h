@@ -0,0 +1,52 @@
+// word_pool.h
+// 떨어지는 단어 저장소 (구조체 배열 대신 필드별 배열, 게임 중 힙 할당 없음)
+#ifndef WORD_POOL_H
+#define WORD_POOL_H
+
+#include "word_index.h"
+#include <stdint.h>
+
+#define WORD_POOL_CAPACITY WORD_INDEX_SLOTS                 // 화면에 동시에 존재할 수 있는 최대 단어 수
+#define WORD_POOL_TEXT_STRIDE (WORD_INDEX_MAX_LENGTH + 1)   // 단어 하나가 차지하는 텍스트 칸 (NUL 포함)
+
+// 활성 단어는 항상 [0, count) 구간에 연속으로 모여 있음
+// 단어 문자열은 text 영역의 고정 칸에 두고 text_offset으로 가리킴 (제거 시 문자열은 옮기지 않음)
+typedef struct {
+    int count;
+    int row[WORD_POOL_CAPACITY];
+    int col[WORD_POOL_CAPACITY];
+    int length[WORD_POOL_CAPACITY];
+    uint8_t power_up[WORD_POOL_CAPACITY];
+    uint16_t text_offset[WORD_POOL_CAPACITY];
+    int stream_id[WORD_POOL_CAPACITY]; // 공용 단어 흐름의 id (혼자 만든 단어는 -1)
+
+    char text[WORD_POOL_CAPACITY * WORD_POOL_TEXT_STRIDE];
+    uint16_t free_text[WORD_POOL_CAPACITY]; // 비어 있는 텍스트 칸 스택
+    int free_count;
+
+    // 텍스트 칸 번호로 단어를 찾는 색인 (칸 번호 = text_offset / WORD_POOL_TEXT_STRIDE)
+    WordIndex index;
+    int16_t slot_index[WORD_POOL_CAPACITY]; // 칸 번호 -> 현재 배열 인덱스
+} WordPool;
+
+// 풀 초기화 (모든 텍스트 칸을 빈 칸으로)
+void word_pool_init(WordPool *pool);
+
+// 단어 추가, 성공 시 인덱스 / 가득 차면 -1
+int word_pool_spawn(WordPool *pool, const char *word, int row, int col, int power_up, int stream_id);
+
+// 인덱스의 단어 제거 (마지막 단어를 그 자리로 옮김, 뒤에서부터 순회하면 안전)
+void word_pool_despawn(WordPool *pool, int index);
+
+// 입력과 정확히 일치하는 단어의 인덱스, 없으면 -1
+int word_pool_find(const WordPool *pool, const char *str);
+
+// 입력 중인 접두사로 시작하는 단어 중 가장 아래에 있는 단어의 인덱스, 없으면 -1
+int word_pool_target(const WordPool *pool, const char *prefix);
+
+// 인덱스의 단어 문자열
+static inline const char *word_pool_text(const WordPool *pool, int index) {
+    return pool->text + pool->text_offset[index];
+}
+
+#endif
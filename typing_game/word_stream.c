@@ -0,0 +1,144 @@
+// word_stream.c
+#include "word_stream.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 기본 단어 데이터베이스
+const char *const word_stream_words[] = {
+    "apple", "banana", "cherry", "dragon", "elephant",
+    "flower", "guitar", "house", "island", "jungle",
+    "keyboard", "lemon", "mountain", "notebook", "orange",
+    "pumpkin", "queen", "river", "sunflower", "tree",
+    "umbrella", "violin", "watermelon", "xylophone", "yacht", "zebra",
+    "cloud", "horizon", "desert", "ocean", "valley",
+    "forest", "planet", "galaxy", "comet", "asteroid",
+    "rocket", "spaceship", "satellite", "meteor", "nebula",
+    "castle", "kingdom", "village", "harbor", "mountain",
+    "stream", "meadow", "canyon", "volcano", "waterfall",
+    "island", "plateau", "cliff", "prairie", "peninsula"};
+const int word_stream_words_size = sizeof(word_stream_words) / sizeof(word_stream_words[0]);
+
+// 파워업 단어 리스트
+const char *const word_stream_power_ups[] = {
+    "power", "boost", "extra", "golden", "silver", "diamond",
+    "energy", "shield", "rocket", "laser", "turbo", "invincible"};
+const int word_stream_power_ups_size = sizeof(word_stream_power_ups) / sizeof(word_stream_power_ups[0]);
+
+// splitmix64: 시드와 id만으로 단어를 바로 계산하기 위한 섞기 함수 (앞 단어를 만들 필요 없음)
+static uint64_t mix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+void word_stream_default(WordStreamSchedule *schedule, uint64_t seed) {
+    schedule->seed = seed;
+    schedule->tick_ms = WORD_STREAM_TICK_MS;
+    schedule->spawn_every = WORD_STREAM_SPAWN_EVERY;
+    schedule->speed_every = WORD_STREAM_SPEED_EVERY;
+    schedule->height = WORD_STREAM_HEIGHT;
+}
+
+int word_stream_format(const WordStreamSchedule *schedule, char *buffer, size_t size) {
+    int n = snprintf(buffer, size, "%" PRIu64 " %d %d %d %d", schedule->seed, schedule->tick_ms,
+                     schedule->spawn_every, schedule->speed_every, schedule->height);
+    return n < 0 || (size_t)n >= size ? -1 : 0;
+}
+
+int word_stream_parse(WordStreamSchedule *schedule, const char *text) {
+    WordStreamSchedule parsed;
+    if (sscanf(text, "%" SCNu64 " %d %d %d %d", &parsed.seed, &parsed.tick_ms, &parsed.spawn_every,
+               &parsed.speed_every, &parsed.height) != 5) {
+        return -1;
+    }
+    // 0으로 나누거나 끝없이 떨어지는 일정은 거부
+    if (parsed.tick_ms < 10 || parsed.spawn_every < 1 || parsed.speed_every < 1 || parsed.height < 2) {
+        return -1;
+    }
+    *schedule = parsed;
+    return 0;
+}
+
+int word_stream_ticks(const WordStreamSchedule *schedule, int seconds) {
+    return (int)((long long)seconds * 1000 / schedule->tick_ms);
+}
+
+int word_stream_spawned(const WordStreamSchedule *schedule, int tick) {
+    return tick < schedule->spawn_every ? 0 : tick / schedule->spawn_every;
+}
+
+void word_stream_word(const WordStreamSchedule *schedule, int id, WordStreamWord *out) {
+    uint64_t h = mix64(schedule->seed ^ mix64((uint64_t)id));
+
+    out->id = id;
+    out->spawn_tick = (id + 1) * schedule->spawn_every;
+    out->speed = 1 + out->spawn_tick / schedule->speed_every;
+    if (out->speed > WORD_STREAM_MAX_SPEED) {
+        out->speed = WORD_STREAM_MAX_SPEED;
+    }
+    // row(t) = 1 + (t - spawn) * speed 가 height 이상이 되는 첫 틱
+    out->expire_tick = out->spawn_tick + (schedule->height - 1 + out->speed - 1) / out->speed;
+
+    // 하위 비트는 파워업 여부와 단어, 상위 비트는 가로 위치
+    out->power_up = (int)(h % 100) < WORD_STREAM_POWER_UP_PERCENT;
+    h /= 100;
+    if (out->power_up) {
+        out->text = word_stream_power_ups[h % (uint64_t)word_stream_power_ups_size];
+    } else {
+        out->text = word_stream_words[h % (uint64_t)word_stream_words_size];
+    }
+    out->length = (int)strlen(out->text);
+    out->col_permille = (int)((h >> 32) % 1000);
+}
+
+int word_stream_player_init(WordStreamPlayer *player, const WordStreamSchedule *schedule, int seconds) {
+    memset(player, 0, sizeof(*player));
+    int capacity = word_stream_spawned(schedule, word_stream_ticks(schedule, seconds)) + 1;
+    if (capacity > WORD_STREAM_MAX_WORDS) {
+        return -1;
+    }
+    player->capacity = capacity;
+    return 0;
+}
+
+void word_stream_player_free(WordStreamPlayer *player) {
+    player->capacity = 0;
+}
+
+int word_stream_player_kill(WordStreamPlayer *player, const WordStreamSchedule *schedule, int tick, int id, int now_tick) {
+    if (id < 0 || id >= player->capacity || player->killed[id] || tick > now_tick + WORD_STREAM_KILL_SLACK) {
+        player->rejected++;
+        return -1;
+    }
+    // 그 틱에 화면에 있던 단어인지 (나타난 뒤, 바닥에 닿기 전)
+    WordStreamWord word;
+    word_stream_word(schedule, id, &word);
+    if (tick < word.spawn_tick || tick >= word.expire_tick) {
+        player->rejected++;
+        return -1;
+    }
+    player->killed[id] = 1;
+    player->kills++;
+    int points = word_stream_points(&word);
+    player->score += points;
+    return points;
+}
+
+int word_stream_player_final(const WordStreamPlayer *player, const WordStreamSchedule *schedule, int end_tick) {
+    int score = player->score;
+    int spawned = word_stream_spawned(schedule, end_tick);
+    for (int id = 0; id < spawned && id < player->capacity; id++) {
+        if (player->killed[id]) {
+            continue;
+        }
+        WordStreamWord word;
+        word_stream_word(schedule, id, &word);
+        if (word.expire_tick <= end_tick) {
+            score -= word.length;
+        }
+    }
+    return score;
+}
@@ -0,0 +1,95 @@
+// word_stream.h
+// 멀티플레이 공용 단어 흐름 (서버와 클라이언트가 같이 사용)
+//
+// 서버가 GAME_STARTED에 시드와 틱 일정을 실어 보내면 모든 클라이언트가 같은 단어를
+// 같은 틱에 만들어 냄 (단어마다 네트워크로 보내지 않음)
+// 단어 id k는 (k + 1) * spawn_every 틱에 나타나고, 그때의 속도로 height 줄까지 떨어짐
+// 단어의 모든 속성은 (시드, id)만으로 계산되므로 서버는 KILL <틱> <id>를 O(1)로 검증함
+#ifndef WORD_STREAM_H
+#define WORD_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define WORD_STREAM_TICK_MS 1000      // 기본 틱 간격
+#define WORD_STREAM_SPAWN_EVERY 2     // 기본: 2틱마다 단어 하나
+#define WORD_STREAM_SPEED_EVERY 20    // 기본: 20틱마다 하강 속도 +1
+#define WORD_STREAM_MAX_SPEED 5
+#define WORD_STREAM_HEIGHT 20         // 이 줄에 닿으면 놓친 단어 (화면 크기와 무관하게 고정)
+#define WORD_STREAM_KILL_SLACK 2      // 서버보다 앞선 틱을 허용하는 정도 (타이머 오차)
+#define WORD_STREAM_POWER_UP_PERCENT 20
+#define WORD_STREAM_MAX_SECONDS 600   // 게임 시간 상한 (검증 상태 크기가 여기에 비례)
+#define WORD_STREAM_MAX_WORDS (WORD_STREAM_MAX_SECONDS * 1000 / WORD_STREAM_TICK_MS / WORD_STREAM_SPAWN_EVERY + 1)
+
+typedef struct {
+    uint64_t seed;
+    int tick_ms;     // 시뮬레이션 틱 간격
+    int spawn_every; // 몇 틱마다 단어 하나
+    int speed_every; // 몇 틱마다 하강 속도 +1
+    int height;      // 단어가 사라지는 줄
+} WordStreamSchedule;
+
+typedef struct {
+    int id;
+    int spawn_tick;
+    int expire_tick;  // 이 틱에 바닥에 닿아 사라짐
+    int speed;
+    int power_up;
+    int col_permille; // 가로 위치 (0~999, 화면 폭에 맞춰 변환)
+    int length;
+    const char *text;
+} WordStreamWord;
+
+// 한 플레이어의 검증 상태 (서버에서 사용)
+typedef struct {
+    int score;
+    int kills;
+    int rejected;
+    int capacity;     // 확인할 수 있는 단어 수 (게임 시간 동안 나오는 단어 수, 준비 전이면 0)
+    uint8_t killed[WORD_STREAM_MAX_WORDS]; // 단어 id별로 이미 맞혔는지 (게임마다 할당하지 않음)
+} WordStreamPlayer;
+
+// 기본 단어 목록 (사전 파일이 없을 때와 멀티플레이 공용 단어)
+extern const char *const word_stream_words[];
+extern const int word_stream_words_size;
+extern const char *const word_stream_power_ups[];
+extern const int word_stream_power_ups_size;
+
+// 기본 일정으로 초기화
+void word_stream_default(WordStreamSchedule *schedule, uint64_t seed);
+
+// "시드 틱ms spawn_every speed_every height" 형식으로 쓰기 / 읽기 (실패 시 -1)
+int word_stream_format(const WordStreamSchedule *schedule, char *buffer, size_t size);
+int word_stream_parse(WordStreamSchedule *schedule, const char *text);
+
+// 게임 시간(초) 동안의 틱 수
+int word_stream_ticks(const WordStreamSchedule *schedule, int seconds);
+
+// 해당 틱까지 나타난 단어 수 (id는 0부터 이 값 - 1까지)
+int word_stream_spawned(const WordStreamSchedule *schedule, int tick);
+
+// id의 단어 속성
+void word_stream_word(const WordStreamSchedule *schedule, int id, WordStreamWord *out);
+
+// 틱에서의 줄 위치
+static inline int word_stream_row(const WordStreamWord *word, int tick) {
+    return 1 + (tick - word->spawn_tick) * word->speed;
+}
+
+// 맞혔을 때 얻는 점수 (놓치면 length만큼 감점)
+static inline int word_stream_points(const WordStreamWord *word) {
+    return word->power_up ? word->length * 2 : word->length;
+}
+
+// 검증 상태 준비, 게임 시간 동안의 단어가 WORD_STREAM_MAX_WORDS를 넘으면 -1
+int word_stream_player_init(WordStreamPlayer *player, const WordStreamSchedule *schedule, int seconds);
+void word_stream_player_free(WordStreamPlayer *player);
+
+// 틱 tick에 id를 맞혔다는 보고 검증, 인정되면 얻은 점수 / 아니면 -1
+// now_tick은 서버가 보는 현재 틱 (미래의 틱은 거부)
+int word_stream_player_kill(WordStreamPlayer *player, const WordStreamSchedule *schedule, int tick, int id, int now_tick);
+
+// end_tick까지 놓친 단어를 감점한 최종 점수
+int word_stream_player_final(const WordStreamPlayer *player, const WordStreamSchedule *schedule, int end_tick);
+
+#endif